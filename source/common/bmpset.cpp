@@ -23,11 +23,13 @@
 #include "cmemory.h"
 #include "bmpset.h"
 #include "uassert.h"
+#include "ustr_ascii.h"
 
 U_NAMESPACE_BEGIN
 
 BMPSet::BMPSet(const int32_t *parentList, int32_t parentListLength) :
-        list(parentList), listLength(parentListLength) {
+        list(parentList), listLength(parentListLength),
+        trieBits(NULL), trieIndex(NULL), trieLength(0) {
     uprv_memset(latin1Contains, 0, sizeof(latin1Contains));
     uprv_memset(table7FF, 0, sizeof(table7FF));
     uprv_memset(bmpBlockBits, 0, sizeof(bmpBlockBits));
@@ -49,18 +51,37 @@ BMPSet::BMPSet(const int32_t *parentList, int32_t parentListLength) :
 
     initBits();
     overrideIllegal();
+    initTrie();
+    initASCIISpan();
 }
 
 BMPSet::BMPSet(const BMPSet &otherBMPSet, const int32_t *newParentList, int32_t newParentListLength) :
         containsFFFD(otherBMPSet.containsFFFD),
-        list(newParentList), listLength(newParentListLength) {
+        list(newParentList), listLength(newParentListLength),
+        trieBits(NULL), trieIndex(NULL), trieLength(0) {
     uprv_memcpy(latin1Contains, otherBMPSet.latin1Contains, sizeof(latin1Contains));
     uprv_memcpy(table7FF, otherBMPSet.table7FF, sizeof(table7FF));
     uprv_memcpy(bmpBlockBits, otherBMPSet.bmpBlockBits, sizeof(bmpBlockBits));
     uprv_memcpy(list4kStarts, otherBMPSet.list4kStarts, sizeof(list4kStarts));
+    uprv_memcpy(asciiNibbleBits, otherBMPSet.asciiNibbleBits, sizeof(asciiNibbleBits));
+    uprv_memcpy(asciiRangeStarts, otherBMPSet.asciiRangeStarts, sizeof(asciiRangeStarts));
+    uprv_memcpy(asciiRangeWidths, otherBMPSet.asciiRangeWidths, sizeof(asciiRangeWidths));
+    uprv_memcpy(asciiRangeCount, otherBMPSet.asciiRangeCount, sizeof(asciiRangeCount));
+    uprv_memcpy(asciiSpanSIMD, otherBMPSet.asciiSpanSIMD, sizeof(asciiSpanSIMD));
+    if(otherBMPSet.trieBits!=NULL) {
+        // Without the trie, containsSlow() falls back to binary search.
+        trieBits=(uint32_t *)uprv_malloc(otherBMPSet.trieLength);
+        if(trieBits!=NULL) {
+            uprv_memcpy(trieBits, otherBMPSet.trieBits, otherBMPSet.trieLength);
+            trieIndex=(const uint16_t *)
+                ((const char *)trieBits+((const char *)otherBMPSet.trieIndex-(const char *)otherBMPSet.trieBits));
+            trieLength=otherBMPSet.trieLength;
+        }
+    }
 }
 
 BMPSet::~BMPSet() {
+    uprv_free(trieBits);
 }
 
 /*
@@ -254,6 +275,304 @@ void BMPSet::overrideIllegal() {
     }
 }
 
+/*
+ * Set bits in one 4k block of 128 bit trie words.
+ * 0<=start<limit<=0x1000
+ */
+static void set4kTrieBits(uint32_t words[128], int32_t start, int32_t limit) {
+    U_ASSERT(0<=start && start<limit && limit<=0x1000);
+
+    int32_t i=start>>5;
+    int32_t limitIndex=limit>>5;
+    uint32_t startBits=~(uint32_t)0<<(start&0x1f);
+    uint32_t limitBits=((uint32_t)1<<(limit&0x1f))-1;
+    if(i==limitIndex) {
+        words[i]|=startBits&limitBits;
+        return;
+    }
+    words[i++]|=startBits;
+    while(i<limitIndex) {
+        words[i++]=0xffffffff;
+    }
+    if(limitBits!=0) {
+        words[limitIndex]|=limitBits;
+    }
+}
+
+/*
+ * Lists with at most this many entries from U+0800 on are searched
+ * in a few steps, and a trie would only cost memory.
+ */
+static const int32_t MAX_BINARY_SEARCH_LIST_LENGTH=16;
+
+void BMPSet::initTrie() {
+    if((list4kStarts[0x11]-list4kStarts[0])<=MAX_BINARY_SEARCH_LIST_LENGTH) {
+        return;
+    }
+
+    // Words 0 and 1 are all-zero and all-one.
+    MaybeStackArray<uint32_t, 512> bits;
+    int32_t bitsLength=2;
+    bits[0]=0;
+    bits[1]=0xffffffff;
+
+    // The 0x110 index-1 entries are followed by all-zero and all-one index-2 blocks.
+    MaybeStackArray<uint16_t, 2048> index;
+    int32_t indexLength=0x110+2*128;
+    int32_t i;
+    for(i=0; i<128; ++i) {
+        index[0x110+i]=0;
+        index[0x110+128+i]=1;
+    }
+
+    int32_t listIndex=0;
+    for(int32_t i1=0; i1<0x110; ++i1) {
+        UChar32 start=i1<<12;
+        UChar32 limit=start+0x1000;
+
+        // The list always ends with 0x110000, so these loops stop before its end.
+        while(list[listIndex]<=start) {
+            ++listIndex;
+        }
+        UBool isIn=(UBool)(listIndex&1);
+        if(list[listIndex]>=limit) {
+            index[i1]=(uint16_t)(isIn ? 0x110+128 : 0x110);
+            continue;
+        }
+        uint32_t words[128];
+        uprv_memset(words, 0, sizeof(words));
+        UChar32 rangeStart=start;
+        do {
+            if(isIn) {
+                set4kTrieBits(words, rangeStart-start, list[listIndex]-start);
+            } else {
+                rangeStart=list[listIndex];
+            }
+            isIn=(UBool)!isIn;
+        } while(list[++listIndex]<limit);
+        if(isIn) {
+            set4kTrieBits(words, rangeStart-start, 0x1000);
+        }
+
+        // Add the new words and an index-2 block for them.
+        if((bitsLength+128)>bits.getCapacity() &&
+                bits.resize(2*bits.getCapacity(), bitsLength)==NULL) {
+            return;
+        }
+        if((indexLength+128)>index.getCapacity() &&
+                index.resize(2*index.getCapacity(), indexLength)==NULL) {
+            return;
+        }
+        uint16_t *block=index.getAlias()+indexLength;
+        for(i=0; i<128; ++i) {
+            uint32_t word=words[i];
+            if(word==0) {
+                block[i]=0;
+            } else if(word==0xffffffff) {
+                block[i]=1;
+            } else {
+                if(word!=bits[bitsLength-1]) {
+                    bits[bitsLength++]=word;
+                }
+                block[i]=(uint16_t)(bitsLength-1);
+            }
+        }
+        int32_t blockStart;
+        for(blockStart=0x110+2*128;
+                blockStart<indexLength &&
+                    uprv_memcmp(index.getAlias()+blockStart, block, 128*2)!=0;
+                blockStart+=128) {}
+        if(blockStart==indexLength) {
+            indexLength+=128;
+        }
+        index[i1]=(uint16_t)blockStart;
+    }
+
+    int32_t bitsBytes=bitsLength*4;
+    trieBits=(uint32_t *)uprv_malloc(bitsBytes+indexLength*2);
+    if(trieBits==NULL) {
+        return;
+    }
+    uprv_memcpy(trieBits, bits.getAlias(), bitsBytes);
+    uint16_t *trieIndex16=(uint16_t *)((char *)trieBits+bitsBytes);
+    uprv_memcpy(trieIndex16, index.getAlias(), indexLength*2);
+    trieIndex=trieIndex16;
+    trieLength=bitsBytes+indexLength*2;
+}
+
+void BMPSet::initASCIISpan() {
+    uprv_memset(asciiNibbleBits, 0, sizeof(asciiNibbleBits));
+    uprv_memset(asciiRangeStarts, 0, sizeof(asciiRangeStarts));
+    uprv_memset(asciiRangeWidths, 0, sizeof(asciiRangeWidths));
+    for(int32_t spanCondition=0; spanCondition<2; ++spanCondition) {
+        // latin1Contains[] values are 0 or 1, like the span condition.
+        int32_t count=0;
+        UChar32 c=0;
+        while(c<0x80) {
+            if(latin1Contains[c]!=spanCondition) {
+                ++c;
+                continue;
+            }
+            UChar32 start=c;
+            do {
+                asciiNibbleBits[spanCondition][c&0xf]|=(uint8_t)(1<<(c>>4));
+            } while(++c<0x80 && latin1Contains[c]==spanCondition);
+            if(count<4) {
+                asciiRangeStarts[spanCondition][count]=(uint8_t)start;
+                asciiRangeWidths[spanCondition][count]=(uint8_t)(c-1-start);
+            }
+            ++count;
+        }
+        asciiRangeCount[spanCondition]=(int8_t)(count<=4 ? count : 0);
+#if U_ASCII_SIMD_SSSE3 || U_ASCII_SIMD_NEON
+        asciiSpanSIMD[spanCondition]=count>0;
+#elif U_ASCII_SIMD_SSE2
+        // Without a byte shuffle, test up to four ranges with byte comparisons.
+        asciiSpanSIMD[spanCondition]=asciiRangeCount[spanCondition]>0;
+#else
+        asciiSpanSIMD[spanCondition]=FALSE;
+#endif
+    }
+}
+
+/*
+ * span() and spanUTF8() call spanASCII() only after they have spanned
+ * this many units at the start one at a time,
+ * so that short spans do not pay for the call.
+ */
+static const int32_t ASCII_SPAN_MIN_LENGTH=16;
+
+#if U_ASCII_SIMD_SSE2 || U_ASCII_SIMD_NEON
+
+namespace {
+
+/*
+ * Tests whether 16 bytes are all spanned ASCII bytes.
+ * With a byte shuffle, the low nibble of each byte selects a row of
+ * asciiNibbleBits and the high nibble selects one of its bits;
+ * high nibbles 8..F select no bit, so non-ASCII bytes are never spanned.
+ * With only SSE2, each byte is compared with up to four ranges.
+ */
+class ASCIISpanTest {
+public:
+#if U_ASCII_SIMD_SSSE3
+    ASCIISpanTest(const uint8_t nibbleBits[16], const uint8_t *, const uint8_t *, int32_t) :
+            rows(_mm_loadu_si128((const __m128i *)nibbleBits)),
+            highBits(_mm_setr_epi8(1, 2, 4, 8, 0x10, 0x20, 0x40, (char)0x80, 0, 0, 0, 0, 0, 0, 0, 0)),
+            lowNibble(_mm_set1_epi8(0xf)) {}
+
+    UBool allSpanned(__m128i v) const {
+        __m128i row=_mm_shuffle_epi8(rows, _mm_and_si128(v, lowNibble));
+        __m128i bit=_mm_shuffle_epi8(highBits, _mm_and_si128(_mm_srli_epi16(v, 4), lowNibble));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(row, bit), _mm_setzero_si128()))==0;
+    }
+
+private:
+    __m128i rows, highBits, lowNibble;
+#elif U_ASCII_SIMD_SSE2
+    ASCIISpanTest(const uint8_t *, const uint8_t starts[4], const uint8_t widths[4], int32_t rangeCount) :
+            count(rangeCount) {
+        for(int32_t i=0; i<count; ++i) {
+            rangeStarts[i]=_mm_set1_epi8((char)starts[i]);
+            rangeWidths[i]=_mm_set1_epi8((char)widths[i]);
+        }
+    }
+
+    UBool allSpanned(__m128i v) const {
+        // In range if (uint8_t)(v-start)<=width.
+        __m128i d=_mm_sub_epi8(v, rangeStarts[0]);
+        __m128i in=_mm_cmpeq_epi8(_mm_min_epu8(d, rangeWidths[0]), d);
+        for(int32_t i=1; i<count; ++i) {
+            d=_mm_sub_epi8(v, rangeStarts[i]);
+            in=_mm_or_si128(in, _mm_cmpeq_epi8(_mm_min_epu8(d, rangeWidths[i]), d));
+        }
+        return _mm_movemask_epi8(in)==0xffff;
+    }
+
+private:
+    __m128i rangeStarts[4], rangeWidths[4];
+    int32_t count;
+#else  // U_ASCII_SIMD_NEON
+    ASCIISpanTest(const uint8_t nibbleBits[16], const uint8_t *, const uint8_t *, int32_t) {
+        static const uint8_t bits[16]={ 1, 2, 4, 8, 0x10, 0x20, 0x40, 0x80, 0, 0, 0, 0, 0, 0, 0, 0 };
+        rows=vld1q_u8(nibbleBits);
+        highBits=vld1q_u8(bits);
+    }
+
+    UBool allSpanned(uint8x16_t v) const {
+        uint8x16_t row=vqtbl1q_u8(rows, vandq_u8(v, vdupq_n_u8(0xf)));
+        uint8x16_t bit=vqtbl1q_u8(highBits, vshrq_n_u8(v, 4));
+        return vminvq_u8(vtstq_u8(row, bit))!=0;
+    }
+
+private:
+    uint8x16_t rows, highBits;
+#endif
+};
+
+/* Loads 16 UChars as bytes, with units above U+00FF as 0xff. */
+#if U_ASCII_SIMD_SSE2
+inline __m128i loadUChars(const UChar *s) {
+    __m128i ff=_mm_set1_epi16(0xff);
+    __m128i a=_mm_loadu_si128((const __m128i *)s);
+    __m128i b=_mm_loadu_si128((const __m128i *)(s+8));
+    // min(x, 0xff)=x-saturated(x-0xff); _mm_packus_epi16() saturates signed values.
+    a=_mm_sub_epi16(a, _mm_subs_epu16(a, ff));
+    b=_mm_sub_epi16(b, _mm_subs_epu16(b, ff));
+    return _mm_packus_epi16(a, b);
+}
+
+inline __m128i loadBytes(const uint8_t *s) {
+    return _mm_loadu_si128((const __m128i *)s);
+}
+#else
+inline uint8x16_t loadUChars(const UChar *s) {
+    return vcombine_u8(vqmovn_u16(vld1q_u16((const uint16_t *)s)),
+                       vqmovn_u16(vld1q_u16((const uint16_t *)(s+8))));
+}
+
+inline uint8x16_t loadBytes(const uint8_t *s) {
+    return vld1q_u8(s);
+}
+#endif
+
+}  // namespace
+
+U_ASCII_NOINLINE const UChar *
+BMPSet::spanASCII(const UChar *s, const UChar *limit, int32_t spanCondition) const {
+    ASCIISpanTest test(asciiNibbleBits[spanCondition], asciiRangeStarts[spanCondition],
+                       asciiRangeWidths[spanCondition], asciiRangeCount[spanCondition]);
+    while((limit-s)>=16 && test.allSpanned(loadUChars(s))) {
+        s+=16;
+    }
+    return s;
+}
+
+U_ASCII_NOINLINE const uint8_t *
+BMPSet::spanASCIIUTF8(const uint8_t *s, const uint8_t *limit, int32_t spanCondition) const {
+    ASCIISpanTest test(asciiNibbleBits[spanCondition], asciiRangeStarts[spanCondition],
+                       asciiRangeWidths[spanCondition], asciiRangeCount[spanCondition]);
+    while((limit-s)>=16 && test.allSpanned(loadBytes(s))) {
+        s+=16;
+    }
+    return s;
+}
+
+#else
+
+// Not called: asciiSpanSIMD[] is always FALSE.
+const UChar *
+BMPSet::spanASCII(const UChar *s, const UChar *, int32_t) const {
+    return s;
+}
+
+const uint8_t *
+BMPSet::spanASCIIUTF8(const uint8_t *s, const uint8_t *, int32_t) const {
+    return s;
+}
+
+#endif
+
 int32_t BMPSet::findCodePoint(UChar32 c, int32_t lo, int32_t hi) const {
     /* Examples:
                                        findCodePoint(c)
@@ -323,6 +642,24 @@ const UChar *
 BMPSet::span(const UChar *s, const UChar *limit, USetSpanCondition spanCondition) const {
     UChar c, c2;
 
+    int32_t asciiCondition= spanCondition!=USET_SPAN_NOT_CONTAINED;
+    if(asciiSpanSIMD[asciiCondition] && (limit-s)>ASCII_SPAN_MIN_LENGTH) {
+        // Initial ASCII span: Call spanASCII() if the first few units are spanned.
+        const UChar *prefixLimit=s+ASCII_SPAN_MIN_LENGTH;
+        while((c=*s)<=0x7f) {
+            if(latin1Contains[c]!=asciiCondition) {
+                return s;
+            }
+            if(++s==prefixLimit) {
+                s=spanASCII(s, limit, asciiCondition);
+                if(s==limit) {
+                    return s;
+                }
+                break;
+            }
+        }
+    }
+
     if(spanCondition) {
         // span
         do {
@@ -512,20 +849,39 @@ BMPSet::spanUTF8(const uint8_t *s, int32_t length, USetSpanCondition spanConditi
     uint8_t b=*s;
     if(U8_IS_SINGLE(b)) {
         // Initial all-ASCII span.
-        if(spanCondition) {
+        int32_t asciiCondition= spanCondition!=USET_SPAN_NOT_CONTAINED;
+        if(asciiSpanSIMD[asciiCondition] && length>ASCII_SPAN_MIN_LENGTH) {
+            // Call spanASCIIUTF8() if the first few bytes are spanned.
+            const uint8_t *prefixLimit=s+ASCII_SPAN_MIN_LENGTH;
             do {
-                if(!latin1Contains[b] || ++s==limit) {
+                if(latin1Contains[b]!=asciiCondition) {
                     return s;
                 }
+                if(++s==prefixLimit) {
+                    s=spanASCIIUTF8(s, limit, asciiCondition);
+                    if(s==limit) {
+                        return s;
+                    }
+                    b=*s;
+                    break;
+                }
                 b=*s;
             } while(U8_IS_SINGLE(b));
+        }
+        if(spanCondition) {
+            while(U8_IS_SINGLE(b)) {
+                if(!latin1Contains[b] || ++s==limit) {
+                    return s;
+                }
+                b=*s;
+            }
         } else {
-            do {
+            while(U8_IS_SINGLE(b)) {
                 if(latin1Contains[b] || ++s==limit) {
                     return s;
                 }
                 b=*s;
-            } while(U8_IS_SINGLE(b));
+            }
         }
         length=(int32_t)(limit-s);
     }
@@ -32,8 +32,10 @@ U_NAMESPACE_BEGIN
  * 2-byte characters: Bits organized vertically.
  * 3-byte characters: Use zero/one/mixed data per 64-block in U+0000..U+FFFF,
  *                    with mixed for illegal ranges.
- * Supplementary characters: Binary search over
- * the supplementary part of the parent set's inversion list.
+ * Supplementary characters, and code points in mixed 64-blocks of 3-byte characters:
+ *                    Bit trie over U+0000..U+10FFFF, for sets whose inversion list
+ *                    is long enough above U+07FF;
+ *                    otherwise binary search over the parent set's inversion list.
  */
 class BMPSet : public UMemory {
 public:
@@ -74,6 +76,19 @@ public:
 private:
     void initBits();
     void overrideIllegal();
+    void initTrie();
+    void initASCIISpan();
+
+    /*
+     * Spans 16 code units at a time while they are all ASCII
+     * and each has spanCondition==contains(c).
+     * Requires asciiSpanSIMD[spanCondition]. spanCondition must be 0 or 1.
+     * @return the start of the first block of 16 units that does not
+     *         consist entirely of such units, or a pointer with fewer than
+     *         16 units before limit; the caller continues from there
+     */
+    const UChar *spanASCII(const UChar *s, const UChar *limit, int32_t spanCondition) const;
+    const uint8_t *spanASCIIUTF8(const uint8_t *s, const uint8_t *limit, int32_t spanCondition) const;
 
     /**
      * Same as UnicodeSet::findCodePoint(UChar32 c) const except that the
@@ -96,11 +111,27 @@ private:
 
     inline UBool containsSlow(UChar32 c, int32_t lo, int32_t hi) const;
 
+    inline UBool trieContains(UChar32 c) const;
+
     /*
      * One byte 0 or 1 per Latin-1 character.
      */
     UBool latin1Contains[0x100];
 
+    /*
+     * For spanASCII(), per span condition (index 0=not contained, 1=contained):
+     * asciiNibbleBits[][c&0xf] has bit (c>>4) set if ASCII code point c is spanned,
+     * asciiRangeStarts[][i]..asciiRangeStarts[][i]+asciiRangeWidths[][i]
+     * are up to four ranges of spanned ASCII code points, and
+     * asciiSpanSIMD[] is TRUE if the SIMD kernel compiled for the platform
+     * can use these tables.
+     */
+    uint8_t asciiNibbleBits[2][16];
+    uint8_t asciiRangeStarts[2][4];
+    uint8_t asciiRangeWidths[2][4];
+    int8_t asciiRangeCount[2];
+    UBool asciiSpanSIMD[2];
+
     /* TRUE if contains(U+FFFD). */
     UBool containsFFFD;
 
@@ -153,12 +184,36 @@ private:
      */
     const int32_t *list;
     int32_t listLength;
+
+    /*
+     * Bit trie for the code points that containsSlow() looks up,
+     * or NULL if the inversion list is short enough above U+07FF
+     * for a binary search to be about as fast, or if memory allocation failed.
+     *
+     * trieIndex[c>>12] (0x110 entries) is the start of a block of 128 entries
+     * in the same array, one per 32 code points; each is the index of the word
+     * in trieBits with one bit per code point.
+     * Words 0 and 1 are all-zero and all-one; identical words next to each other
+     * and identical index blocks are shared.
+     * trieBits is the start of a single allocation of trieLength bytes
+     * which also holds trieIndex.
+     */
+    uint32_t *trieBits;
+    const uint16_t *trieIndex;
+    int32_t trieLength;
 };
 
 inline UBool BMPSet::containsSlow(UChar32 c, int32_t lo, int32_t hi) const {
+    if(trieIndex!=NULL) {
+        return trieContains(c);
+    }
     return (UBool)(findCodePoint(c, lo, hi) & 1);
 }
 
+inline UBool BMPSet::trieContains(UChar32 c) const {
+    return (UBool)((trieBits[trieIndex[trieIndex[c>>12]+((c>>5)&0x7f)]]>>(c&0x1f))&1);
+}
+
 U_NAMESPACE_END
 
 #endif
@@ -0,0 +1,76 @@
+// © 2018 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+/*
+*******************************************************************************
+*   file name:  sharedunicodeset.h
+*   encoding:   UTF-8
+*   tab size:   8 (not used)
+*   indentation:4
+*
+*   Process-wide cache of frozen UnicodeSets for patterns and property values.
+*/
+
+#ifndef __SHARED_UNICODESET_H__
+#define __SHARED_UNICODESET_H__
+
+#include "unicode/utypes.h"
+#include "unicode/uchar.h"
+#include "unicode/uniset.h"
+#include "sharedobject.h"
+
+U_NAMESPACE_BEGIN
+
+/**
+ * A frozen UnicodeSet shared via the unified cache,
+ * so that commonly used sets are parsed or computed only once per process.
+ */
+class U_COMMON_API SharedUnicodeSet : public SharedObject {
+public:
+    SharedUnicodeSet(UnicodeSet *setToAdopt) : ptr(setToAdopt) { }
+    virtual ~SharedUnicodeSet();
+    const UnicodeSet *get() const { return ptr; }
+    const UnicodeSet *operator->() const { return ptr; }
+    const UnicodeSet &operator*() const { return *ptr; }
+
+    /**
+     * Fetches the frozen set for the pattern from the unified cache,
+     * parsing the pattern if it is not cached.
+     * Patterns are cached by their exact text:
+     * Different patterns for the same set are cached separately.
+     * Patterns that need a SymbolTable cannot be cached.
+     *
+     * @param pattern the pattern, as for UnicodeSet(const UnicodeString &, UErrorCode &)
+     * @param ptr On entry, must be NULL or included in the ref count
+     *            of the object to which it points.
+     *            On exit, the fetched value or unchanged on failure.
+     *            The caller must call removeRef() on ptr if it is not NULL.
+     * @param errorCode ICU error code
+     */
+    static void getForPattern(const UnicodeString &pattern,
+                              const SharedUnicodeSet *&ptr, UErrorCode &errorCode);
+
+    /**
+     * Fetches the frozen set of code points with the property value from the unified cache,
+     * as for UnicodeSet::applyIntPropertyValue().
+     * UnicodeSet::applyIntPropertyValue() itself copies from these cached sets.
+     *
+     * @param prop the property, as for UnicodeSet::applyIntPropertyValue()
+     * @param value the property value
+     * @param ptr On entry, must be NULL or included in the ref count
+     *            of the object to which it points.
+     *            On exit, the fetched value or unchanged on failure.
+     *            The caller must call removeRef() on ptr if it is not NULL.
+     * @param errorCode ICU error code
+     */
+    static void getForIntPropertyValue(UProperty prop, int32_t value,
+                                       const SharedUnicodeSet *&ptr, UErrorCode &errorCode);
+
+private:
+    UnicodeSet *ptr;
+    SharedUnicodeSet(const SharedUnicodeSet &);
+    SharedUnicodeSet &operator=(const SharedUnicodeSet &);
+};
+
+U_NAMESPACE_END
+
+#endif
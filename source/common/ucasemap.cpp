@@ -41,6 +41,7 @@
 #include "uassert.h"
 #include "ucase.h"
 #include "ucasemap_imp.h"
+#include "ustr_ascii.h"
 #include "ustr_imp.h"
 
 U_NAMESPACE_USE
@@ -165,6 +166,47 @@ appendResult(int32_t cpLength, int32_t result, const UChar *s,
 inline uint8_t getTwoByteLead(UChar32 c) { return (uint8_t)((c >> 6) | 0xc0); }
 inline uint8_t getTwoByteTrail(UChar32 c) { return (uint8_t)((c & 0x3f) | 0x80); }
 
+/**
+ * Case-maps a run of ASCII in bulk and appends it to the sink,
+ * if there are at least 16 ASCII bytes at srcIndex.
+ * Only for use without Edits and without U_OMIT_UNCHANGED_TEXT,
+ * and where ASCII maps only between A-Z and a-z.
+ * @return the number of bytes mapped, or 0 if there is no such run
+ */
+U_ASCII_NOINLINE int32_t
+appendASCIIRun(const uint8_t *src, int32_t srcIndex, int32_t srcLimit,
+               ByteSink &sink, UBool toUpper) {
+    int32_t length = srcLimit - srcIndex;
+    if (length < 16 || !uprv_isASCII16(src + srcIndex)) {
+        return 0;
+    }
+    src += srcIndex;
+    char scratch[256];
+    int32_t total = 0;
+    do {
+        int32_t capacity;
+        char *buffer = sink.GetAppendBuffer(16, length - total, scratch, (int32_t)sizeof(scratch),
+                                            &capacity);
+        int32_t count = length - total;
+        if (count > capacity) {
+            count = capacity;
+        }
+        int32_t mapped = uprv_asciiCaseMap((uint8_t *)buffer, src + total, count, toUpper);
+        sink.Append(buffer, mapped);
+        total += mapped;
+        if (mapped < count) { break; }  // stopped at a non-ASCII byte
+    } while (total < length);
+    return total;
+}
+
+/**
+ * The fast paths look for an ASCII run only after they changed an ASCII character,
+ * so that text which needs no changes keeps its plain loop.
+ * After a failed attempt, they do not look again for this many bytes,
+ * so that mixed text does not pay for checking each changed character.
+ */
+constexpr int32_t ASCII_RUN_RETRY_DISTANCE = 64;
+
 UChar32 U_CALLCONV
 utf8_caseContextIterator(void *context, int8_t dir) {
     UCaseContext *csc=(UCaseContext *)context;
@@ -216,6 +258,10 @@ void toLower(int32_t caseLocale, uint32_t options,
     const UTrie2 *trie = ucase_getTrie();
     int32_t prev = srcStart;
     int32_t srcIndex = srcStart;
+    // Without Edits, lowercase ASCII runs in bulk; see appendASCIIRun().
+    int32_t nextASCIIRunIndex =
+        latinToLower == LatinCase::TO_LOWER_NORMAL && edits == nullptr &&
+        (options & U_OMIT_UNCHANGED_TEXT) == 0 ? srcStart : INT32_MAX;
     for (;;) {
         // fast path for simple cases
         int32_t cpStart;
@@ -242,6 +288,14 @@ void toLower(int32_t caseLocale, uint32_t options,
                     edits->addReplace(1, 1);
                 }
                 prev = srcIndex;
+                if (srcIndex >= nextASCIIRunIndex) {
+                    int32_t count = appendASCIIRun(src, srcIndex, srcLimit, sink, FALSE);
+                    if (count > 0) {
+                        prev = srcIndex += count;
+                    } else {
+                        nextASCIIRunIndex = srcIndex + ASCII_RUN_RETRY_DISTANCE;
+                    }
+                }
                 continue;
             } else if (lead < 0xe3) {
                 uint8_t t;
@@ -324,6 +378,10 @@ void toUpper(int32_t caseLocale, uint32_t options,
     const UTrie2 *trie = ucase_getTrie();
     int32_t prev = 0;
     int32_t srcIndex = 0;
+    // Without Edits, uppercase ASCII runs in bulk; see appendASCIIRun().
+    int32_t nextASCIIRunIndex =
+        latinToUpper == LatinCase::TO_UPPER_NORMAL && edits == nullptr &&
+        (options & U_OMIT_UNCHANGED_TEXT) == 0 ? 0 : INT32_MAX;
     for (;;) {
         // fast path for simple cases
         int32_t cpStart;
@@ -350,6 +408,14 @@ void toUpper(int32_t caseLocale, uint32_t options,
                     edits->addReplace(1, 1);
                 }
                 prev = srcIndex;
+                if (srcIndex >= nextASCIIRunIndex) {
+                    int32_t count = appendASCIIRun(src, srcIndex, srcLength, sink, TRUE);
+                    if (count > 0) {
+                        prev = srcIndex += count;
+                    } else {
+                        nextASCIIRunIndex = srcIndex + ASCII_RUN_RETRY_DISTANCE;
+                    }
+                }
                 continue;
             } else if (lead < 0xe3) {
                 uint8_t t;
@@ -0,0 +1,280 @@
+// © 2018 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+/*
+*******************************************************************************
+*   file name:  ucharbundle.cpp
+*   encoding:   UTF-8
+*   tab size:   8 (not used)
+*   indentation:4
+*
+*   u_getPropertyBundle() and u_strGetPropertyBundles():
+*   Many commonly used properties of a code point with one trie lookup.
+*
+*   The properties come from several data structures (uchar, uprops vectors,
+*   ucase, ubidi), each with its own trie.
+*   The first call collects the starts of all ranges in which none of these change,
+*   computes the bundle for each range, and builds a fast UCPTrie with 16-bit indexes
+*   into the table of the distinct bundles.
+*/
+
+#include "unicode/utypes.h"
+#include "unicode/uchar.h"
+#include "unicode/uniset.h"
+#include "unicode/uset.h"
+#include "unicode/ustring.h"
+#include "unicode/utf16.h"
+#include "cmemory.h"
+#include "ubidi_props.h"
+#include "ucase.h"
+#include "ucln_cmn.h"
+#include "umutex.h"
+#include "uarrsort.h"
+#include "ucptrie.h"
+#include "uprops.h"
+#include "uset_imp.h"
+
+U_NAMESPACE_USE
+
+namespace {
+
+/**
+ * The binary properties in the order of their UCharPropertyBundle.binaryProperties bits,
+ * UCHAR_BUNDLE_ALPHABETIC=1<<0 etc.
+ */
+const UProperty bundleBinaryProperties[] = {
+    UCHAR_ALPHABETIC,
+    UCHAR_WHITE_SPACE,
+    UCHAR_LOWERCASE,
+    UCHAR_UPPERCASE,
+    UCHAR_IDEOGRAPHIC,
+    UCHAR_DEFAULT_IGNORABLE_CODE_POINT,
+    UCHAR_BIDI_MIRRORED,
+    UCHAR_DASH,
+    UCHAR_DIACRITIC,
+    UCHAR_EXTENDER,
+    UCHAR_XID_START,
+    UCHAR_XID_CONTINUE,
+    UCHAR_TERMINAL_PUNCTUATION,
+    UCHAR_EMOJI,
+    UCHAR_EMOJI_PRESENTATION,
+    UCHAR_EXTENDED_PICTOGRAPHIC
+};
+
+/** Trie of 16-bit indexes into gBundles[]. */
+UCPTrie *gBundleTrie = NULL;
+UCharPropertyBundle *gBundles = NULL;
+UInitOnce gBundlesInitOnce = U_INITONCE_INITIALIZER;
+
+UBool U_CALLCONV ucharbundle_cleanup() {
+    ucptrie_close(gBundleTrie);
+    gBundleTrie = NULL;
+    uprv_free(gBundles);
+    gBundles = NULL;
+    gBundlesInitOnce.reset();
+    return TRUE;
+}
+
+void getBundle(UChar32 c, UCharPropertyBundle &bundle) {
+    bundle.generalCategory = (int8_t)u_charType(c);
+    bundle.bidiClass = (int8_t)u_getIntPropertyValue(c, UCHAR_BIDI_CLASS);
+    bundle.wordBreak = (int8_t)u_getIntPropertyValue(c, UCHAR_WORD_BREAK);
+    bundle.lineBreak = (int8_t)u_getIntPropertyValue(c, UCHAR_LINE_BREAK);
+    bundle.sentenceBreak = (int8_t)u_getIntPropertyValue(c, UCHAR_SENTENCE_BREAK);
+    bundle.graphemeClusterBreak = (int8_t)u_getIntPropertyValue(c, UCHAR_GRAPHEME_CLUSTER_BREAK);
+    bundle.eastAsianWidth = (int8_t)u_getIntPropertyValue(c, UCHAR_EAST_ASIAN_WIDTH);
+    bundle.numericType = (int8_t)u_getIntPropertyValue(c, UCHAR_NUMERIC_TYPE);
+    bundle.script = (int16_t)u_getIntPropertyValue(c, UCHAR_SCRIPT);
+    uint16_t binaryProperties = 0;
+    for (int32_t i = 0; i < UPRV_LENGTHOF(bundleBinaryProperties); ++i) {
+        if (u_hasBinaryProperty(c, bundleBinaryProperties[i])) {
+            binaryProperties |= (uint16_t)(1 << i);
+        }
+    }
+    bundle.binaryProperties = binaryProperties;
+}
+
+int32_t U_CALLCONV
+compareBundles(const void * /*context*/, const void *left, const void *right) {
+    // The struct has no padding: 8 single bytes and two 16-bit fields.
+    return uprv_memcmp(left, right, sizeof(UCharPropertyBundle));
+}
+
+/** Binary search for a bundle that is known to be in the sorted, distinct bundles. */
+int32_t indexOfBundle(const UCharPropertyBundle *bundles, int32_t length,
+                      const UCharPropertyBundle &bundle) {
+    int32_t start = 0, limit = length;
+    for (;;) {
+        int32_t i = (start + limit) / 2;
+        int32_t cmp = compareBundles(NULL, &bundle, bundles + i);
+        if (cmp == 0) {
+            return i;
+        } else if (cmp < 0) {
+            limit = i;
+        } else {
+            start = i + 1;
+        }
+    }
+}
+
+void U_CALLCONV initBundles(UErrorCode &errorCode) {
+    ucln_common_registerCleanup(UCLN_COMMON_UCHAR_BUNDLE, ucharbundle_cleanup);
+
+    // Each code point in this set starts a range of code points
+    // with the same values for all of the bundled properties.
+    UnicodeSet starts;
+    USetAdder sa = {
+        starts.toUSet(),
+        uset_add,
+        uset_addRange,
+        uset_addString,
+        NULL,  // don't need remove()
+        NULL   // don't need removeRange()
+    };
+    starts.add(0);
+    uchar_addPropertyStarts(&sa, &errorCode);
+    upropsvec_addPropertyStarts(&sa, &errorCode);
+    ucase_addPropertyStarts(&sa, &errorCode);
+    ubidi_addPropertyStarts(&sa, &errorCode);
+    if (U_FAILURE(errorCode)) {
+        return;
+    }
+    if (starts.isBogus()) {
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+
+    // bundles[0] is for out-of-range code points, bundles[i+1] for the range at startCPs[i].
+    int32_t rangesCount = starts.size();
+    int32_t bundlesCount = rangesCount + 1;
+    LocalMemory<UChar32> startCPs((UChar32 *)uprv_malloc(rangesCount * 4));
+    LocalMemory<UCharPropertyBundle> bundles(
+        (UCharPropertyBundle *)uprv_malloc(bundlesCount * sizeof(UCharPropertyBundle)));
+    LocalMemory<UCharPropertyBundle> distinct(
+        (UCharPropertyBundle *)uprv_malloc(bundlesCount * sizeof(UCharPropertyBundle)));
+    if (startCPs.isNull() || bundles.isNull() || distinct.isNull()) {
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    getBundle(-1, bundles[0]);
+    int32_t i = 0;
+    int32_t startRangesCount = starts.getRangeCount();
+    for (int32_t r = 0; r < startRangesCount; ++r) {
+        UChar32 end = starts.getRangeEnd(r);
+        for (UChar32 c = starts.getRangeStart(r); c <= end; ++c) {
+            startCPs[i] = c;
+            getBundle(c, bundles[++i]);
+        }
+    }
+
+    // Sort a copy of the bundles and remove duplicates.
+    uprv_memcpy(distinct.getAlias(), bundles.getAlias(),
+                (size_t)bundlesCount * sizeof(UCharPropertyBundle));
+    uprv_sortArray(distinct.getAlias(), bundlesCount, sizeof(UCharPropertyBundle),
+                   compareBundles, NULL, FALSE, &errorCode);
+    if (U_FAILURE(errorCode)) {
+        return;
+    }
+    int32_t distinctCount = 1;
+    for (i = 1; i < bundlesCount; ++i) {
+        if (compareBundles(NULL, &distinct[i], &distinct[distinctCount - 1]) != 0) {
+            distinct[distinctCount++] = distinct[i];
+        }
+    }
+    if (distinctCount > 0x10000) {
+        // Too many for 16-bit trie values.
+        errorCode = U_INTERNAL_PROGRAM_ERROR;
+        return;
+    }
+
+    uint32_t errorValue = (uint32_t)indexOfBundle(distinct.getAlias(), distinctCount, bundles[0]);
+    UMutableCPTrie *mutableTrie = umutablecptrie_open(0, errorValue, &errorCode);
+    for (i = 0; i < rangesCount && U_SUCCESS(errorCode); ++i) {
+        UChar32 end = i + 1 < rangesCount ? startCPs[i + 1] - 1 : 0x10ffff;
+        uint32_t value = (uint32_t)indexOfBundle(distinct.getAlias(), distinctCount, bundles[i + 1]);
+        if (value != 0) {
+            umutablecptrie_setRange(mutableTrie, startCPs[i], end, value, &errorCode);
+        }
+    }
+    UCPTrie *trie = NULL;
+    if (U_SUCCESS(errorCode)) {
+        trie = umutablecptrie_buildImmutable(mutableTrie, UCPTRIE_TYPE_FAST,
+                                             UCPTRIE_VALUE_BITS_16, &errorCode);
+    }
+    umutablecptrie_close(mutableTrie);
+    if (U_FAILURE(errorCode)) {
+        return;
+    }
+    // Shrink the table to the distinct bundles; keep the larger block if realloc() fails.
+    UCharPropertyBundle *shrunk = (UCharPropertyBundle *)uprv_realloc(
+        distinct.getAlias(), distinctCount * sizeof(UCharPropertyBundle));
+    if (shrunk != NULL) {
+        distinct.orphan();
+        distinct.adoptInstead(shrunk);
+    }
+    gBundleTrie = trie;
+    gBundles = distinct.orphan();
+}
+
+}  // namespace
+
+U_CAPI void U_EXPORT2
+u_getPropertyBundle(UChar32 c, UCharPropertyBundle *bundle, UErrorCode *pErrorCode) {
+    if (U_FAILURE(*pErrorCode)) {
+        return;
+    }
+    if (bundle == NULL) {
+        *pErrorCode = U_ILLEGAL_ARGUMENT_ERROR;
+        return;
+    }
+    umtx_initOnce(gBundlesInitOnce, &initBundles, *pErrorCode);
+    if (U_FAILURE(*pErrorCode)) {
+        return;
+    }
+    *bundle = gBundles[UCPTRIE_FAST_GET(gBundleTrie, UCPTRIE_16, c)];
+}
+
+U_CAPI int32_t U_EXPORT2
+u_strGetPropertyBundles(const UChar *s, int32_t length,
+                        UCharPropertyBundle *dest, int32_t destCapacity,
+                        UErrorCode *pErrorCode) {
+    if (U_FAILURE(*pErrorCode)) {
+        return 0;
+    }
+    if ((s == NULL && length != 0) || length < -1 ||
+            destCapacity < 0 || (dest == NULL && destCapacity > 0)) {
+        *pErrorCode = U_ILLEGAL_ARGUMENT_ERROR;
+        return 0;
+    }
+    umtx_initOnce(gBundlesInitOnce, &initBundles, *pErrorCode);
+    if (U_FAILURE(*pErrorCode)) {
+        return 0;
+    }
+    if (length < 0) {
+        length = u_strlen(s);
+    }
+    const UCPTrie *trie = gBundleTrie;
+    const UCharPropertyBundle *bundles = gBundles;
+    const UChar *limit = s + length;
+    int32_t count = 0;
+    while (s < limit) {
+        UChar32 c = *s++;
+        UChar c2;
+        uint16_t index;
+        if (U16_IS_LEAD(c) && s != limit && U16_IS_TRAIL(c2 = *s)) {
+            ++s;
+            index = UCPTRIE_FAST_SUPP_GET(trie, UCPTRIE_16, U16_GET_SUPPLEMENTARY(c, c2));
+        } else {
+            // Not UCPTRIE_FAST_U16_NEXT() which returns the error value for
+            // an unpaired surrogate; it gets the bundle for its surrogate code point.
+            index = UCPTRIE_FAST_BMP_GET(trie, UCPTRIE_16, c);
+        }
+        if (count < destCapacity) {
+            dest[count] = bundles[index];
+        }
+        ++count;
+    }
+    if (count > destCapacity) {
+        *pErrorCode = U_BUFFER_OVERFLOW_ERROR;
+    }
+    return count;
+}
@@ -46,6 +46,7 @@ typedef enum ECleanupCommonType {
     UCLN_COMMON_NORMALIZER2,
     UCLN_COMMON_USET,
     UCLN_COMMON_UNAMES,
+    UCLN_COMMON_UCHAR_BUNDLE,
     UCLN_COMMON_UPROPS,
     UCLN_COMMON_UCNV,
     UCLN_COMMON_UCNV_IO,
@@ -1835,6 +1835,134 @@ ucnv_toUChars(UConverter *cnv,
     return u_terminateUChars(originalDest, destCapacity, destLength, pErrorCode);
 }
 
+/* shared converters for ucnv_to/fromUCharsShared() ------------------------- */
+
+struct UConverterShared {
+    /* never modified after ucnv_openShared(), only copied or cloned */
+    UConverter *cnv;
+};
+
+U_CAPI UConverterShared * U_EXPORT2
+ucnv_openShared(const char *name, UErrorCode *pErrorCode) {
+    if(U_FAILURE(*pErrorCode)) {
+        return NULL;
+    }
+    UConverterShared *shared=(UConverterShared *)uprv_malloc(sizeof(UConverterShared));
+    if(shared==NULL) {
+        *pErrorCode=U_MEMORY_ALLOCATION_ERROR;
+        return NULL;
+    }
+    shared->cnv=ucnv_open(name, pErrorCode);
+    if(U_FAILURE(*pErrorCode)) {
+        ucnv_closeShared(shared);
+        return NULL;
+    }
+    return shared;
+}
+
+U_CAPI void U_EXPORT2
+ucnv_closeShared(UConverterShared *shared) {
+    if(shared!=NULL) {
+        ucnv_close(shared->cnv);
+        uprv_free(shared);
+    }
+}
+
+/*
+ * Returns a converter in its initial state with callbacks for the action.
+ * If the shared converter has no state outside the UConverter struct,
+ * then this is a bitwise copy in the caller's stackConverter.
+ * The copy borrows the shared converter's reference to its shared data,
+ * so it must not be closed; see releaseLocalConverter().
+ * Otherwise the shared converter is cloned.
+ */
+static UConverter *
+getLocalConverter(const UConverterShared *shared, UConverterInvalidAction action,
+                  UConverter *stackConverter, UErrorCode *pErrorCode) {
+    const UConverter *cnv=shared->cnv;
+    UConverter *local;
+    if( cnv->extraInfo==NULL && cnv->sharedData->impl->safeClone==NULL &&
+        cnv->subChars==(uint8_t *)cnv->subUChars
+    ) {
+        uprv_memcpy(stackConverter, cnv, sizeof(UConverter));
+        stackConverter->subChars=(uint8_t *)stackConverter->subUChars;
+        local=stackConverter;
+    } else {
+        local=ucnv_safeClone(cnv, NULL, NULL, pErrorCode);
+        if(*pErrorCode==U_SAFECLONE_ALLOCATED_WARNING) {
+            *pErrorCode=U_ZERO_ERROR;
+        }
+        if(U_FAILURE(*pErrorCode)) {
+            return NULL;
+        }
+    }
+    /* the shared converter has the default callbacks */
+    switch(action) {
+    case UCNV_INVALID_SKIP:
+        local->fromCharErrorBehaviour=UCNV_TO_U_CALLBACK_SKIP;
+        local->fromUCharErrorBehaviour=UCNV_FROM_U_CALLBACK_SKIP;
+        break;
+    case UCNV_INVALID_STOP:
+        local->fromCharErrorBehaviour=UCNV_TO_U_CALLBACK_STOP;
+        local->fromUCharErrorBehaviour=UCNV_FROM_U_CALLBACK_STOP;
+        break;
+    default:
+        break;
+    }
+    return local;
+}
+
+static void
+releaseLocalConverter(UConverter *local, UConverter *stackConverter) {
+    if(local!=stackConverter) {
+        ucnv_close(local);
+    }
+}
+
+U_CAPI int32_t U_EXPORT2
+ucnv_toUCharsShared(const UConverterShared *shared, UConverterInvalidAction action,
+                    UChar *dest, int32_t destCapacity,
+                    const char *src, int32_t srcLength,
+                    UErrorCode *pErrorCode) {
+    if(U_FAILURE(*pErrorCode)) {
+        return 0;
+    }
+    if(shared==NULL || action<UCNV_INVALID_SUBSTITUTE || action>UCNV_INVALID_STOP) {
+        *pErrorCode=U_ILLEGAL_ARGUMENT_ERROR;
+        return 0;
+    }
+    UConverter stackConverter;
+    UConverter *cnv=getLocalConverter(shared, action, &stackConverter, pErrorCode);
+    if(cnv==NULL) {
+        return 0;
+    }
+    int32_t length=ucnv_toUChars(cnv, dest, destCapacity, src, srcLength, pErrorCode);
+    releaseLocalConverter(cnv, &stackConverter);
+    return length;
+}
+
+U_CAPI int32_t U_EXPORT2
+ucnv_fromUCharsShared(const UConverterShared *shared, UConverterInvalidAction action,
+                      char *dest, int32_t destCapacity,
+                      const UChar *src, int32_t srcLength,
+                      UErrorCode *pErrorCode) {
+    if(U_FAILURE(*pErrorCode)) {
+        return 0;
+    }
+    if(shared==NULL || action<UCNV_INVALID_SUBSTITUTE || action>UCNV_INVALID_STOP) {
+        *pErrorCode=U_ILLEGAL_ARGUMENT_ERROR;
+        return 0;
+    }
+    UConverter stackConverter;
+    UConverter *cnv=getLocalConverter(shared, action, &stackConverter, pErrorCode);
+    if(cnv==NULL) {
+        return 0;
+    }
+    int32_t length=ucnv_fromUChars(cnv, dest, destCapacity, src, srcLength, pErrorCode);
+    releaseLocalConverter(cnv, &stackConverter);
+    return length;
+}
+
 /* ucnv_getNextUChar() ------------------------------------------------------ */
 
 U_CAPI UChar32 U_EXPORT2
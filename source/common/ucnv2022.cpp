@@ -1587,6 +1587,29 @@ _2022ToSJIS(uint8_t c1, uint8_t c2, char bytes[2]) {
     bytes[1] = (char)c2;
 }
 
+/*
+ * Looks up a Shift-JIS byte pair from _2022ToSJIS() directly in the state table
+ * of the cached Shift-JIS converter, for the common case of a roundtrip
+ * BMP mapping.
+ * Returns 0xffff if the pair needs the full ucnv_MBCSSimpleGetNextUChar().
+ */
+static inline UChar
+_2022SimpleGetSJISBMP(const UConverterSharedData *sharedData, uint8_t lead, uint8_t trail) {
+    const int32_t (*stateTable)[256] = sharedData->mbcs.stateTable;
+    int32_t entry = stateTable[0][lead];
+    if(MBCS_ENTRY_IS_TRANSITION(entry)) {
+        uint32_t offset = MBCS_ENTRY_TRANSITION_OFFSET(entry);
+        entry = stateTable[MBCS_ENTRY_TRANSITION_STATE(entry)][trail];
+        if(MBCS_ENTRY_IS_FINAL(entry) && MBCS_ENTRY_FINAL_ACTION(entry) == MBCS_STATE_VALID_16) {
+            UChar c = sharedData->mbcs.unicodeCodeUnits[offset + MBCS_ENTRY_FINAL_VALUE_16(entry)];
+            if(c < 0xfffe) {
+                return c;
+            }
+        }
+    }
+    return 0xffff;
+}
+
 /*
  * JIS X 0208 has fallbacks from Unicode half-width Katakana to full-width (DBCS)
  * Katakana.
@@ -2112,6 +2135,53 @@ UConverter_toUnicode_ISO_2022_JP_OFFSETS_LOGIC(UConverterToUnicodeArgs *args,
 
         if(myTarget < args->targetLimit){
 
+            /*
+             * Convert runs of plain ASCII and of JIS X 0208 pairs without
+             * going through the byte-by-byte state machine below.
+             * Any other byte, including ESC, SO and SI, ends the run.
+             */
+            if(pToU2022State->g == 0) {
+                const char *runStart = mySource;
+                cs = (StateEnum)pToU2022State->cs[0];
+                if(cs == ASCII && pToU2022State->cs[2] == 0) {
+                    /* CR and LF would not change this state */
+                    while(mySource < mySourceLimit && myTarget < args->targetLimit) {
+                        uint8_t b = (uint8_t)*mySource;
+                        if(b > 0x7f || b == ESC_2022 || b == UCNV_SO || b == UCNV_SI) {
+                            break;
+                        }
+                        if(args->offsets) {
+                            args->offsets[myTarget - args->target] = (int32_t)(mySource - args->source);
+                        }
+                        *myTarget++ = b;
+                        ++mySource;
+                    }
+                } else if(cs == JISX208) {
+                    while((mySourceLimit - mySource) >= 2 && myTarget < args->targetLimit) {
+                        uint8_t lead = (uint8_t)mySource[0], trail = (uint8_t)mySource[1];
+                        UChar c;
+                        if((uint8_t)(lead - 0x21) > (0x7e - 0x21) || (uint8_t)(trail - 0x21) > (0x7e - 0x21)) {
+                            break;
+                        }
+                        _2022ToSJIS(lead, trail, tempBuf);
+                        c = _2022SimpleGetSJISBMP(myData->myConverterArray[JISX208],
+                                                  (uint8_t)tempBuf[0], (uint8_t)tempBuf[1]);
+                        if(c == 0xffff) {
+                            break;
+                        }
+                        if(args->offsets) {
+                            args->offsets[myTarget - args->target] = (int32_t)(mySource - args->source);
+                        }
+                        *myTarget++ = c;
+                        mySource += 2;
+                    }
+                }
+                if(mySource != runStart) {
+                    myData->isEmptySegment = FALSE;
+                    continue;
+                }
+            }
+
             mySourceChar= (unsigned char) *mySource++;
 
             switch(mySourceChar) {
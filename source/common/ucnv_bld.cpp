@@ -195,8 +195,20 @@ static struct {
 /*initializes some global variables */
 static UHashtable *SHARED_DATA_HASHTABLE = NULL;
 static UMutex cnvCacheMutex = U_MUTEX_INITIALIZER;  /* Mutex for synchronizing cnv cache access. */
-                                                    /*  Note:  the global mutex is used for      */
-                                                    /*         reference count updates.          */
+                                                    /*  Note:  reference counts are updated     */
+                                                    /*         atomically, see ucnv_unload().   */
+
+/*
+ * UConverterSharedData is also visible to C code, so its reference counter
+ * is declared as a plain uint32_t and accessed atomically through this cast.
+ */
+static_assert(sizeof(icu::u_atomic_int32_t) == sizeof(uint32_t),
+              "UConverterSharedData.referenceCounter must fit an atomic int32_t");
+
+static inline icu::u_atomic_int32_t *
+sharedDataRefCount(UConverterSharedData *sharedData) {
+    return reinterpret_cast<icu::u_atomic_int32_t *>(&sharedData->referenceCounter);
+}
 
 static const char **gAvailableConverters = NULL;
 static uint16_t gAvailableConverterCount = 0;
@@ -509,7 +521,7 @@ ucnv_deleteSharedConverterData(UConverterSharedData * deadSharedData)
     UTRACE_ENTRY_OC(UTRACE_UCNV_UNLOAD);
     UTRACE_DATA2(UTRACE_OPEN_CLOSE, "unload converter %s shared data %p", deadSharedData->staticData->name, deadSharedData);
 
-    if (deadSharedData->referenceCounter > 0) {
+    if (icu::umtx_loadAcquire(*sharedDataRefCount(deadSharedData)) > 0) {
         UTRACE_EXIT_VALUE((int32_t)FALSE);
         return FALSE;
     }
@@ -566,7 +578,7 @@ ucnv_load(UConverterLoadArgs *pArgs, UErrorCode *err) {
     {
         /* The data for this converter was already in the cache.            */
         /* Update the reference counter on the shared data: one more client */
-        mySharedConverterData->referenceCounter++;
+        icu::umtx_atomic_inc(sharedDataRefCount(mySharedConverterData));
     }
 
     return mySharedConverterData;
@@ -580,33 +592,49 @@ ucnv_load(UConverterLoadArgs *pArgs, UErrorCode *err) {
 U_CAPI void
 ucnv_unload(UConverterSharedData *sharedData) {
     if(sharedData != NULL) {
-        if (sharedData->referenceCounter > 0) {
-            sharedData->referenceCounter--;
+        int32_t count = icu::umtx_loadAcquire(*sharedDataRefCount(sharedData));
+        if (count > 0) {
+            count = icu::umtx_atomic_dec(sharedDataRefCount(sharedData));
         }
 
-        if((sharedData->referenceCounter <= 0)&&(sharedData->sharedDataCached == FALSE)) {
+        if((count <= 0)&&(sharedData->sharedDataCached == FALSE)) {
             ucnv_deleteSharedConverterData(sharedData);
         }
     }
 }
 
+/*
+ * Releasing a cached converter does not need cnvCacheMutex:
+ * Cached shared data is only deleted by ucnv_flushCache() once its
+ * reference counter is 0, and sharedDataCached does not change while the
+ * caller still holds its reference.
+ * Uncached (package) shared data is deleted here when its last
+ * reference is released, which may unload a base table, so that still
+ * happens under the mutex.
+ */
 U_CFUNC void
 ucnv_unloadSharedDataIfReady(UConverterSharedData *sharedData)
 {
     if(sharedData != NULL && sharedData->isReferenceCounted) {
-        umtx_lock(&cnvCacheMutex);
-        ucnv_unload(sharedData);
-        umtx_unlock(&cnvCacheMutex);
+        if(sharedData->sharedDataCached) {
+            icu::umtx_atomic_dec(sharedDataRefCount(sharedData));
+        } else {
+            umtx_lock(&cnvCacheMutex);
+            ucnv_unload(sharedData);
+            umtx_unlock(&cnvCacheMutex);
+        }
     }
 }
 
+/*
+ * The caller holds a reference, so the shared data can be neither
+ * flushed nor deleted concurrently, and no lock is needed.
+ */
 U_CFUNC void
 ucnv_incrementRefCount(UConverterSharedData *sharedData)
 {
     if(sharedData != NULL && sharedData->isReferenceCounted) {
-        umtx_lock(&cnvCacheMutex);
-        sharedData->referenceCounter++;
-        umtx_unlock(&cnvCacheMutex);
+        icu::umtx_atomic_inc(sharedDataRefCount(sharedData));
     }
 }
 
@@ -1051,10 +1079,12 @@ ucnv_flushCache ()
     * Synchronization:  holding cnvCacheMutex will prevent any other thread from
     *                   accessing or modifying the hash table during the iteration.
     *                   The reference count of an entry may be decremented by
-    *                   ucnv_close while the iteration is in process, but this is
-    *                   benign.  It can't be incremented (in ucnv_createConverter())
-    *                   because the sequence of looking up in the cache + incrementing
-    *                   is protected by cnvCacheMutex.
+    *                   ucnv_close without the mutex while the iteration is in process,
+    *                   but this is benign.  It can't be incremented from 0 (in
+    *                   ucnv_createConverter()) because the sequence of looking up
+    *                   in the cache + incrementing is protected by cnvCacheMutex,
+    *                   and ucnv_safeClone() only increments a count that is
+    *                   already held above 0 by the original converter.
     */
     umtx_lock(&cnvCacheMutex);
     /*
@@ -1071,7 +1101,7 @@ ucnv_flushCache ()
         {
             mySharedData = (UConverterSharedData *) e->value.pointer;
             /*deletes only if reference counter == 0 */
-            if (mySharedData->referenceCounter == 0)
+            if (icu::umtx_loadAcquire(*sharedDataRefCount(mySharedData)) == 0)
             {
                 tableDeletedNum++;
 
@@ -1123,7 +1153,13 @@ static void U_CALLCONV initAvailableConvertersList(UErrorCode &errCode) {
     for (int32_t idx = 0; idx < allConverterCount; idx++) {
         localStatus = U_ZERO_ERROR;
         const char *converterName = uenum_next(allConvEnum, NULL, &localStatus);
-        if (ucnv_canCreateConverter(converterName, &localStatus)) {
+        /*
+         * Converters whose .cnv files were built into the data together with
+         * the alias table need not be test-loaded.
+         * Others may be algorithmic, or their files may have been added separately.
+         */
+        if (ucnv_io_isConverterFileBuiltIn((uint16_t)idx, &localStatus) ||
+                ucnv_canCreateConverter(converterName, &localStatus)) {
             gAvailableConverters[gAvailableConverterCount++] = converterName;
         }
     }
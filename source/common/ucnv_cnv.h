@@ -275,6 +275,15 @@ U_CDECL_END
 #define FROM_U_USE_FALLBACK(useFallback, c) ((useFallback) || IS_PRIVATE_USE(c))
 #define UCNV_FROM_U_USE_FALLBACK(cnv, c) FROM_U_USE_FALLBACK((cnv)->useFallback, c)
 
+/**
+ * TRUE if the toUnicode callback is UCNV_TO_U_CALLBACK_FFFD.
+ * A converter may then write U+FFFD for an illegal or unassigned sequence itself
+ * and continue, rather than returning the error for the callback.
+ * (It must still return the error if it backed out bytes from a previous buffer
+ * into cnv->preToU[].)
+ */
+#define UCNV_TO_U_INLINE_FFFD(cnv) ((cnv)->fromCharErrorBehaviour==UCNV_TO_U_CALLBACK_FFFD)
+
 /**
  * Magic number for ucnv_getNextUChar(), returned by a
  * getNextUChar() implementation to indicate to use the converter's toUnicode()
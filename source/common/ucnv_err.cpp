@@ -405,6 +405,28 @@ UCNV_TO_U_CALLBACK_SUBSTITUTE (
     /* else ignore the reset, close and clone calls. */
 }
 
+/* Converters that check UCNV_TO_U_INLINE_FFFD() do not call this function. */
+U_CAPI void    U_EXPORT2
+UCNV_TO_U_CALLBACK_FFFD (
+                 const void *context,
+                 UConverterToUnicodeArgs *toArgs,
+                 const char* codeUnits,
+                 int32_t length,
+                 UConverterCallbackReason reason,
+                 UErrorCode * err)
+{
+    static const UChar kFFFD = 0xFFFD;
+    (void)context;
+    (void)codeUnits;
+    (void)length;
+    if (reason <= UCNV_IRREGULAR)
+    {
+        *err = U_ZERO_ERROR;
+        ucnv_cbToUWriteUChars(toArgs, &kFFFD, 1, 0, err);
+    }
+    /* else ignore the reset, close and clone calls. */
+}
+
 /*uses uprv_itou to get a unicode escape sequence of the offensive sequence,
  *and uses that as the substitution sequence
  */
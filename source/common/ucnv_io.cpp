@@ -44,6 +44,7 @@
 #include "cmemory.h"
 #include "ucnv_io.h"
 #include "uenumimp.h"
+#include "uinvchar.h"
 #include "ucln_cmn.h"
 
 /* Format of cnvalias.icu -----------------------------------------------------
@@ -115,6 +116,22 @@
  * and all strings lowercased. In the future, the options in section 7 may state
  * other types of normalization.
  *
+ * 10) Starting in ICU 62, when present this is a hash table over the
+ * normalized alias strings of section 3, for lookups without a binary search.
+ * The first unit is the number of buckets, a power of 2, or 0 if the table
+ * is not usable. It is followed by the buckets. Each bucket contains the
+ * index of an alias in sections 3 and 4 plus 1, or 0 if it is empty.
+ * An alias is in the first non-empty bucket at or after (wrapping around)
+ * ucnv_io_hashNormalizedName(alias) modulo the number of buckets
+ * (open addressing with linear probing).
+ * The hash function is independent of the charset family, so that
+ * the table remains valid when the data is swapped between families.
+ *
+ * 11) Starting in ICU 62, when present this is an array of flags,
+ * one per converter in section 1. UCNV_IO_CNV_FILE_BUILT_IN is set if gencnval
+ * was told that the converter's .cnv file is part of the same data build.
+ * ucnv_countAvailable() uses this instead of test-loading such converters.
+ *
  * Here is the concept of section 5 and 6. It's a 3D cube. Each tag
  * has a unique alias among all converters. That same alias can
  * be mentioned in other standards on different converters,
@@ -188,6 +205,8 @@ enum {
     tableOptionsIndex=7,
     stringTableIndex=8,
     normalizedStringTableIndex=9,
+    aliasHashTableIndex=10,
+    converterFlagsIndex=11,
     offsetsCount,    /* length of the swapper's temporary offsets[] */
     minTocLength=8 /* min. tocLength in the file, does not count the tocLengthIndex! */
 };
@@ -267,6 +286,12 @@ static void U_CALLCONV initAliasData(UErrorCode &errCode) {
     if (tableStart > 8) {
         gMainTable.normalizedStringTableSize = sectionSizes[9];
     }
+    if (tableStart > 9) {
+        gMainTable.aliasHashTableSize = sectionSizes[10];
+    }
+    if (tableStart > 10) {
+        gMainTable.converterFlagsSize = sectionSizes[11];
+    }
 
     currOffset = tableStart * (sizeof(uint32_t)/sizeof(uint16_t)) + (sizeof(uint32_t)/sizeof(uint16_t));
     gMainTable.converterList = table + currOffset;
@@ -306,6 +331,23 @@ static void U_CALLCONV initAliasData(UErrorCode &errCode) {
     currOffset += gMainTable.stringTableSize;
     gMainTable.normalizedStringTable = ((gMainTable.optionTable->stringNormalizationType == UCNV_IO_UNNORMALIZED)
         ? gMainTable.stringTable : (table + currOffset));
+
+    currOffset += gMainTable.normalizedStringTableSize;
+    if (gMainTable.optionTable->stringNormalizationType == UCNV_IO_STD_NORMALIZED
+        && gMainTable.aliasHashTableSize > 1
+        && gMainTable.aliasHashTableSize == (uint32_t)table[currOffset] + 1
+        && (table[currOffset] & (table[currOffset] - 1)) == 0)
+    {
+        gMainTable.aliasHashTable = table + currOffset;
+    }
+    else {
+        /* Use the binary search. */
+        gMainTable.aliasHashTable = NULL;
+    }
+
+    currOffset += gMainTable.aliasHashTableSize;
+    gMainTable.converterFlags = ((gMainTable.converterFlagsSize == gMainTable.converterListSize)
+        ? table + currOffset : NULL);
 }
 
 
@@ -544,6 +586,38 @@ ucnv_compareNames(const char *name1, const char *name2) {
     }
 }
 
+U_CAPI uint32_t U_EXPORT2
+ucnv_io_hashNormalizedName(const char *name) {
+    /* FNV-1a over the ASCII values of the characters */
+    uint32_t hash = 0x811c9dc5;
+    char c;
+    while ((c = *name++) != 0) {
+        hash = (hash ^ (uint8_t)uprv_invCharToLowercaseAscii(c)) * 0x01000193;
+    }
+    return hash;
+}
+
+/*
+ * Look up a normalized alias in the alias hash table.
+ * return the index into gMainTable.aliasList, or UINT32_MAX if it is not found
+ */
+static inline uint32_t
+findAliasInHashTable(const char *alias) {
+    const uint16_t *buckets = gMainTable.aliasHashTable + 1;
+    uint32_t mask = (uint32_t)gMainTable.aliasHashTable[0] - 1;
+    uint32_t i = ucnv_io_hashNormalizedName(alias) & mask;
+    uint16_t bucket;
+
+    /* gencnval leaves at least one bucket empty */
+    while ((bucket = buckets[i]) != 0) {
+        if (uprv_strcmp(alias, GET_NORMALIZED_STRING(gMainTable.aliasList[bucket - 1])) == 0) {
+            return (uint32_t)bucket - 1;
+        }
+        i = (i + 1) & mask;
+    }
+    return UINT32_MAX;
+}
+
 /*
  * search for an alias
  * return the converter number index for gConverterList
@@ -567,50 +641,57 @@ findConverter(const char *alias, UBool *containsOption, UErrorCode *pErrorCode)
         alias = strippedName;
     }
 
-    /* do a binary search for the alias */
-    start = 0;
-    limit = gMainTable.untaggedConvArraySize;
-    mid = limit;
-    lastMid = UINT32_MAX;
-
-    for (;;) {
-        mid = (uint32_t)((start + limit) / 2);
-        if (lastMid == mid) {   /* Have we moved? */
-            break;  /* We haven't moved, and it wasn't found. */
-        }
-        lastMid = mid;
-        if (isUnnormalized) {
-            result = ucnv_compareNames(alias, GET_STRING(gMainTable.aliasList[mid]));
-        }
-        else {
-            result = uprv_strcmp(alias, GET_NORMALIZED_STRING(gMainTable.aliasList[mid]));
+    if (gMainTable.aliasHashTable != NULL) {
+        mid = findAliasInHashTable(alias);
+        if (mid == UINT32_MAX) {
+            return UINT32_MAX;
         }
-
-        if (result < 0) {
-            limit = mid;
-        } else if (result > 0) {
-            start = mid;
-        } else {
-            /* Since the gencnval tool folds duplicates into one entry,
-             * this alias in gAliasList is unique, but different standards
-             * may map an alias to different converters.
-             */
-            if (gMainTable.untaggedConvArray[mid] & UCNV_AMBIGUOUS_ALIAS_MAP_BIT) {
-                *pErrorCode = U_AMBIGUOUS_ALIAS_WARNING;
+    } else {
+        /* do a binary search for the alias */
+        start = 0;
+        limit = gMainTable.untaggedConvArraySize;
+        mid = limit;
+        lastMid = UINT32_MAX;
+
+        for (;;) {
+            mid = (uint32_t)((start + limit) / 2);
+            if (lastMid == mid) {   /* Have we moved? */
+                return UINT32_MAX;  /* We haven't moved, and it wasn't found. */
+            }
+            lastMid = mid;
+            if (isUnnormalized) {
+                result = ucnv_compareNames(alias, GET_STRING(gMainTable.aliasList[mid]));
+            }
+            else {
+                result = uprv_strcmp(alias, GET_NORMALIZED_STRING(gMainTable.aliasList[mid]));
             }
-            /* State whether the canonical converter name contains an option.
-            This information is contained in this list in order to maintain backward & forward compatibility. */
-            if (containsOption) {
-                UBool containsCnvOptionInfo = (UBool)gMainTable.optionTable->containsCnvOptionInfo;
-                *containsOption = (UBool)((containsCnvOptionInfo
-                    && ((gMainTable.untaggedConvArray[mid] & UCNV_CONTAINS_OPTION_BIT) != 0))
-                    || !containsCnvOptionInfo);
+
+            if (result < 0) {
+                limit = mid;
+            } else if (result > 0) {
+                start = mid;
+            } else {
+                break;
             }
-            return gMainTable.untaggedConvArray[mid] & UCNV_CONVERTER_INDEX_MASK;
         }
     }
 
-    return UINT32_MAX;
+    /* Since the gencnval tool folds duplicates into one entry,
+     * this alias in gAliasList is unique, but different standards
+     * may map an alias to different converters.
+     */
+    if (gMainTable.untaggedConvArray[mid] & UCNV_AMBIGUOUS_ALIAS_MAP_BIT) {
+        *pErrorCode = U_AMBIGUOUS_ALIAS_WARNING;
+    }
+    /* State whether the canonical converter name contains an option.
+    This information is contained in this list in order to maintain backward & forward compatibility. */
+    if (containsOption) {
+        UBool containsCnvOptionInfo = (UBool)gMainTable.optionTable->containsCnvOptionInfo;
+        *containsOption = (UBool)((containsCnvOptionInfo
+            && ((gMainTable.untaggedConvArray[mid] & UCNV_CONTAINS_OPTION_BIT) != 0))
+            || !containsCnvOptionInfo);
+    }
+    return gMainTable.untaggedConvArray[mid] & UCNV_CONVERTER_INDEX_MASK;
 }
 
 /*
@@ -1084,6 +1165,16 @@ ucnv_openAllNames(UErrorCode *pErrorCode) {
     return myEnum;
 }
 
+U_CAPI UBool
+ucnv_io_isConverterFileBuiltIn(uint16_t n, UErrorCode *pErrorCode) {
+    if (haveAliasData(pErrorCode) && gMainTable.converterFlags != NULL
+        && n < gMainTable.converterListSize)
+    {
+        return (UBool)((gMainTable.converterFlags[n] & UCNV_IO_CNV_FILE_BUILT_IN) != 0);
+    }
+    return FALSE;
+}
+
 U_CAPI uint16_t
 ucnv_io_countKnownConverters(UErrorCode *pErrorCode) {
     if (haveAliasData(pErrorCode)) {
@@ -1291,6 +1382,35 @@ ucnv_swapAliases(const UDataSwapper *ds,
                            FALSE, pErrorCode);
 
             if(U_SUCCESS(*pErrorCode)) {
+                /*
+                 * Renumber the aliases in the hash table.
+                 * The buckets stay the same because the hash function
+                 * does not depend on the charset family.
+                 * Read all of them before the in-place permutation below.
+                 */
+                if(toc[aliasHashTableIndex]>0) {
+                    const uint16_t *pHash=inTable+offsets[aliasHashTableIndex];
+                    uint16_t *qHash=outTable+offsets[aliasHashTableIndex];
+                    uint16_t *newIndexes=tempTable.resort;
+                    uint16_t bucketCount=ds->readUInt16(pHash[0]);
+                    uint16_t bucket;
+
+                    if((uint32_t)bucketCount+1!=toc[aliasHashTableIndex]) {
+                        bucketCount=0;  /* not usable, see initAliasData() */
+                    }
+                    for(i=0; i<count; ++i) {
+                        newIndexes[tempTable.rows[i].sortIndex]=(uint16_t)i;
+                    }
+                    ds->writeUInt16(qHash, bucketCount);
+                    for(i=1; i<toc[aliasHashTableIndex]; ++i) {
+                        bucket=bucketCount!=0 ? ds->readUInt16(pHash[i]) : 0;
+                        if(0<bucket && bucket<=count) {
+                            bucket=(uint16_t)(newIndexes[bucket-1]+1);
+                        }
+                        ds->writeUInt16(qHash+i, bucket);
+                    }
+                }
+
                 /* copy/swap/permutate items */
                 if(p!=q) {
                     for(i=0; i<count; ++i) {
@@ -1342,6 +1462,20 @@ ucnv_swapAliases(const UDataSwapper *ds,
                             outTable+offsets[taggedAliasArrayIndex],
                             pErrorCode);
         }
+
+        if(ds->inCharset==ds->outCharset) {
+            /* swap the alias hash table, which follows the strings */
+            ds->swapArray16(ds,
+                            inTable+offsets[aliasHashTableIndex],
+                            2*(int32_t)toc[aliasHashTableIndex],
+                            outTable+offsets[aliasHashTableIndex],
+                            pErrorCode);
+        }
+        ds->swapArray16(ds,
+                        inTable+offsets[converterFlagsIndex],
+                        2*(int32_t)toc[converterFlagsIndex],
+                        outTable+offsets[converterFlagsIndex],
+                        pErrorCode);
     }
 
     return headerSize+2*(int32_t)topOffset;
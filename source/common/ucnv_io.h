@@ -27,6 +27,9 @@
 #define UCNV_NUM_RESERVED_TAGS 2
 #define UCNV_NUM_HIDDEN_TAGS 1
 
+/* Converter flag in the alias data: The converter's .cnv file is in the same data build. */
+#define UCNV_IO_CNV_FILE_BUILT_IN 1
+
 enum {
     UCNV_IO_UNNORMALIZED,
     UCNV_IO_STD_NORMALIZED,
@@ -48,6 +51,8 @@ typedef struct UConverterAlias {
     const UConverterAliasOptions *optionTable;
     const uint16_t *stringTable;
     const uint16_t *normalizedStringTable;
+    const uint16_t *aliasHashTable;
+    const uint16_t *converterFlags;
 
     uint32_t converterListSize;
     uint32_t tagListSize;
@@ -58,6 +63,8 @@ typedef struct UConverterAlias {
     uint32_t optionTableSize;
     uint32_t stringTableSize;
     uint32_t normalizedStringTableSize;
+    uint32_t aliasHashTableSize;
+    uint32_t converterFlagsSize;
 } UConverterAlias;
 
 /**
@@ -83,6 +90,17 @@ ucnv_io_stripASCIIForCompare(char *dst, const char *name);
 U_CAPI char * U_CALLCONV
 ucnv_io_stripEBCDICForCompare(char *dst, const char *name);
 
+/**
+ * Hash function for the alias hash table in the alias data.
+ * It gives the same value for a name normalized by
+ * ucnv_io_stripASCIIForCompare() in the ASCII charset family
+ * and by ucnv_io_stripEBCDICForCompare() in the EBCDIC family.
+ * @param name A normalized alias name.
+ * @return the hash code
+ */
+U_CAPI uint32_t U_EXPORT2
+ucnv_io_hashNormalizedName(const char *name);
+
 /**
  * Map a converter alias name to a canonical converter name.
  * The alias is searched for case-insensitively, the converter name
@@ -104,6 +122,17 @@ ucnv_io_getConverterName(const char *alias, UBool *containsOption, UErrorCode *p
 U_CAPI uint16_t
 ucnv_io_countKnownConverters(UErrorCode *pErrorCode);
 
+/**
+ * Returns TRUE if the alias table records that the n-th converter
+ * (in the order of ucnv_openAllNames()) has its .cnv file in the same data build.
+ * Returns FALSE if it does not, or if the alias table does not record this.
+ * @param n The converter number.
+ * @param pErrorCode The error code
+ * @return whether the .cnv file was built into the data
+ */
+U_CAPI UBool
+ucnv_io_isConverterFileBuiltIn(uint16_t n, UErrorCode *pErrorCode);
+
 /**
  * Swap an ICU converter alias table. See implementation for details.
  * @internal
@@ -0,0 +1,695 @@
+// © 2018 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+/*
+*******************************************************************************
+*   file name:  ucnv_par.cpp
+*   encoding:   UTF-8
+*   tab size:   8 (not used)
+*   indentation:4
+*
+*   Whole-string conversion on several threads (ucnv_convertParallel()).
+*   The source text is split at positions where the source converter is
+*   known to be in its initial state, the chunks are converted with
+*   clones of the converters, and the outputs are concatenated.
+*   Kept out of ucnv.cpp so that the threading code is only linked
+*   when this function is used.
+*/
+
+// Must be before any other #includes.
+#include "uposixdefs.h"
+
+#include "unicode/utypes.h"
+
+#if !UCONFIG_NO_CONVERSION
+
+#include "unicode/ucnv.h"
+#include "cmemory.h"
+#include "cstring.h"
+#include "umutex.h"
+#include "ustr_imp.h"
+#include "ucnv_bld.h"
+#include "ucnvmbcs.h"
+
+#if U_PLATFORM_USES_ONLY_WIN32_API
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   define VC_EXTRALEAN
+#   define NOUSER
+#   define NOSERVICE
+#   define NOIME
+#   define NOMCX
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#elif U_PLATFORM_IMPLEMENTS_POSIX
+#   include <pthread.h>
+#   include <unistd.h>
+#endif
+
+U_NAMESPACE_USE
+
+/* chunks shorter than this are not worth a thread */
+#define MIN_CHUNK_LENGTH 0x4000
+
+/* at most this many threads */
+#define MAX_THREADS 64
+
+/* size of the UTF-16 pivot buffer for one chunk */
+#define PIVOT_LENGTH 1024
+
+/* How the source text may be split. */
+enum {
+    /* do not split */
+    SPLIT_NONE,
+    /* anywhere: single-byte Unicode charsets */
+    SPLIT_ANY,
+    /* after any ASCII byte: UTF-8 */
+    SPLIT_AFTER_ASCII,
+    /* between two code points: UTF-16 */
+    SPLIT_UTF16BE,
+    SPLIT_UTF16LE,
+    /* between two code units: UTF-32 */
+    SPLIT_UTF32,
+    /* after a line feed in a byte charset */
+    SPLIT_AFTER_LF_BYTE,
+    /* after a UTF-16 or UTF-32 line feed */
+    SPLIT_AFTER_LF_UTF16BE,
+    SPLIT_AFTER_LF_UTF16LE,
+    SPLIT_AFTER_LF_UTF32BE,
+    SPLIT_AFTER_LF_UTF32LE
+};
+
+/* One piece of the source text and its converted output. */
+struct ParallelChunk {
+    const char *source;
+    int32_t sourceLength;
+    /* index of source in the whole source text */
+    int32_t sourceIndex;
+    char *output;
+    int32_t *offsets;
+    int32_t outputLength;
+    UErrorCode errorCode;
+    UBool done;
+};
+
+/* Shared by all of the threads for one ucnv_convertParallel() call. */
+struct ParallelConversion {
+    const UConverter *targetCnv, *sourceCnv;
+    ParallelChunk *chunks;
+    int32_t chunkCount;
+    UBool withOffsets;
+    u_atomic_int32_t nextChunk;
+};
+
+/*
+ * Conversions between the algorithmic Unicode charsets have no state between
+ * characters and no mappings of character sequences.
+ */
+static UBool
+isStatelessUnicodeType(UConverterType type) {
+    switch(type) {
+    case UCNV_UTF8:
+    case UCNV_UTF16_BigEndian:
+    case UCNV_UTF16_LittleEndian:
+    case UCNV_UTF32_BigEndian:
+    case UCNV_UTF32_LittleEndian:
+    case UCNV_LATIN_1:
+    case UCNV_US_ASCII:
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
+#if !UCONFIG_NO_LEGACY_CONVERSION
+
+/*
+ * Is the byte that encodes U+000A a single-byte character in the initial state,
+ * and illegal in all other states?
+ * Then the converter is in its initial state after it, even for malformed input,
+ * because MBCS conversion never includes a valid single byte in an illegal sequence.
+ */
+static UBool
+isMBCSLineFeedSafe(const UConverter *cnv, uint8_t lf) {
+    const UConverterMBCSTable *mbcsTable=&cnv->sharedData->mbcs;
+    const int32_t (*stateTable)[256];
+    int32_t entry;
+    int32_t state;
+
+    if(mbcsTable->dbcsOnlyState!=0) {
+        return FALSE;
+    }
+    if((cnv->options&UCNV_OPTION_SWAP_LFNL)!=0) {
+        stateTable=(const int32_t (*)[256])mbcsTable->swapLFNLStateTable;
+    } else {
+        stateTable=mbcsTable->stateTable;
+    }
+    entry=stateTable[0][lf];
+    if( !MBCS_ENTRY_IS_FINAL(entry) ||
+        MBCS_ENTRY_FINAL_ACTION(entry)==MBCS_STATE_ILLEGAL ||
+        MBCS_ENTRY_FINAL_ACTION(entry)==MBCS_STATE_CHANGE_ONLY
+    ) {
+        return FALSE;
+    }
+    for(state=1; state<mbcsTable->countStates; ++state) {
+        entry=stateTable[state][lf];
+        if(!MBCS_ENTRY_IS_FINAL(entry) || MBCS_ENTRY_FINAL_ACTION(entry)!=MBCS_STATE_ILLEGAL) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+#endif
+
+/*
+ * Determines where the source text may be split so that converting the pieces
+ * separately yields the same output as converting the whole text.
+ * Between two stateless Unicode charsets, the text is split between characters.
+ * When one of them is a codepage, it is split only after line feeds so that
+ * no multi-character mapping (in the codepage's extension data) crosses a split.
+ */
+static int32_t
+getSplitMode(const UConverter *targetCnv, const UConverter *sourceCnv, uint8_t *pLF) {
+    UConverterType targetType=ucnv_getType(targetCnv);
+    UConverterType sourceType=ucnv_getType(sourceCnv);
+    UBool byLine;
+
+    *pLF=0xa;
+    switch(targetType) {
+    case UCNV_SBCS:
+    case UCNV_DBCS:
+    case UCNV_MBCS:
+        byLine=TRUE;
+        break;
+    default:
+        if(!isStatelessUnicodeType(targetType)) {
+            return SPLIT_NONE;
+        }
+        byLine=FALSE;
+        break;
+    }
+
+    switch(sourceType) {
+    case UCNV_LATIN_1:
+    case UCNV_US_ASCII:
+        return byLine ? SPLIT_AFTER_LF_BYTE : SPLIT_ANY;
+    case UCNV_UTF8:
+        return byLine ? SPLIT_AFTER_LF_BYTE : SPLIT_AFTER_ASCII;
+    case UCNV_UTF16_BigEndian:
+        return byLine ? SPLIT_AFTER_LF_UTF16BE : SPLIT_UTF16BE;
+    case UCNV_UTF16_LittleEndian:
+        return byLine ? SPLIT_AFTER_LF_UTF16LE : SPLIT_UTF16LE;
+    case UCNV_UTF32_BigEndian:
+        return byLine ? SPLIT_AFTER_LF_UTF32BE : SPLIT_UTF32;
+    case UCNV_UTF32_LittleEndian:
+        return byLine ? SPLIT_AFTER_LF_UTF32LE : SPLIT_UTF32;
+#if !UCONFIG_NO_LEGACY_CONVERSION
+    case UCNV_SBCS:
+    case UCNV_DBCS:
+    case UCNV_MBCS: {
+        /* find the line feed byte, for example 0x25 in EBCDIC */
+        UErrorCode errorCode=U_ZERO_ERROR;
+        UConverter *cnv=ucnv_safeClone(sourceCnv, NULL, NULL, &errorCode);
+        static const UChar lf[1]={ 0xa };
+        char bytes[8];
+        int32_t length;
+
+        length=ucnv_fromUChars(cnv, bytes, (int32_t)sizeof(bytes), lf, 1, &errorCode);
+        ucnv_close(cnv);
+        if(U_FAILURE(errorCode) || length!=1 || !isMBCSLineFeedSafe(sourceCnv, (uint8_t)bytes[0])) {
+            return SPLIT_NONE;
+        }
+        *pLF=(uint8_t)bytes[0];
+        return SPLIT_AFTER_LF_BYTE;
+    }
+#endif
+    default:
+        return SPLIT_NONE;
+    }
+}
+
+/*
+ * Returns the first index i with start<=i<limit where the source text may be split,
+ * or limit if there is none.
+ */
+static int32_t
+findSplit(int32_t mode, uint8_t lf, const uint8_t *s, int32_t start, int32_t limit) {
+    int32_t i=start;
+    switch(mode) {
+    case SPLIT_ANY:
+        return start;
+    case SPLIT_AFTER_ASCII:
+        while(i<limit && (i==0 || s[i-1]>=0x80)) {
+            ++i;
+        }
+        return i;
+    case SPLIT_UTF16BE:
+    case SPLIT_UTF16LE: {
+        int32_t lead= mode==SPLIT_UTF16BE ? 0 : 1;
+        i=(i+1)&~1;
+        while(i<limit && (i==0 || U16_IS_LEAD((s[i-2+lead]<<8)|s[i-1-lead]))) {
+            i+=2;
+        }
+        return i<limit ? i : limit;
+    }
+    case SPLIT_UTF32:
+        i=(i+3)&~3;
+        return i<limit ? i : limit;
+    case SPLIT_AFTER_LF_BYTE:
+        while(i<limit && (i==0 || s[i-1]!=lf)) {
+            ++i;
+        }
+        return i;
+    case SPLIT_AFTER_LF_UTF16BE:
+    case SPLIT_AFTER_LF_UTF16LE: {
+        int32_t lead= mode==SPLIT_AFTER_LF_UTF16BE ? 0 : 1;
+        i=(i+1)&~1;
+        while(i<limit && (i==0 || s[i-2+lead]!=0 || s[i-1-lead]!=0xa)) {
+            i+=2;
+        }
+        return i<limit ? i : limit;
+    }
+    case SPLIT_AFTER_LF_UTF32BE:
+        i=(i+3)&~3;
+        while(i<limit && (i==0 || s[i-1]!=0xa || s[i-2]!=0 || s[i-3]!=0 || s[i-4]!=0)) {
+            i+=4;
+        }
+        return i<limit ? i : limit;
+    case SPLIT_AFTER_LF_UTF32LE:
+        i=(i+3)&~3;
+        while(i<limit && (i==0 || s[i-4]!=0xa || s[i-3]!=0 || s[i-2]!=0 || s[i-1]!=0)) {
+            i+=4;
+        }
+        return i<limit ? i : limit;
+    default:
+        return limit;
+    }
+}
+
+/* Grows the chunk output buffers to at least the given capacity. */
+static UBool
+growChunkOutput(ParallelChunk *chunk, int32_t *pCapacity, int32_t minCapacity, UBool withOffsets) {
+    int32_t capacity=*pCapacity;
+    char *output;
+    if(capacity>=minCapacity) {
+        return TRUE;
+    }
+    if(capacity<PIVOT_LENGTH) {
+        capacity=PIVOT_LENGTH;
+    }
+    while(capacity<minCapacity) {
+        if(capacity>0x3fffffff) {
+            return FALSE;
+        }
+        capacity*=2;
+    }
+    output=(char *)uprv_realloc(chunk->output, capacity);
+    if(output==NULL) {
+        return FALSE;
+    }
+    chunk->output=output;
+    if(withOffsets) {
+        int32_t *offsets=(int32_t *)uprv_realloc(chunk->offsets, (size_t)capacity*4);
+        if(offsets==NULL) {
+            return FALSE;
+        }
+        chunk->offsets=offsets;
+    }
+    *pCapacity=capacity;
+    return TRUE;
+}
+
+/*
+ * Converts one chunk via ucnv_convertEx(), which takes the direct
+ * UTF-8 conversion paths where the converters provide them.
+ */
+static void
+convertChunk(UConverter *targetCnv, UConverter *sourceCnv, ParallelChunk *chunk) {
+    UChar pivot[PIVOT_LENGTH];
+    UChar *pivotSource=pivot, *pivotTarget=pivot;
+    const char *source=chunk->source;
+    const char *sourceLimit=source+chunk->sourceLength;
+    int32_t capacity=0;
+    UBool reset=TRUE;
+
+    /* most conversions produce about as many bytes as they read */
+    if(!growChunkOutput(chunk, &capacity, chunk->sourceLength+16, FALSE)) {
+        chunk->errorCode=U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    for(;;) {
+        char *target=chunk->output+chunk->outputLength;
+        ucnv_convertEx(targetCnv, sourceCnv,
+                       &target, chunk->output+capacity,
+                       &source, sourceLimit,
+                       pivot, &pivotSource, &pivotTarget, pivot+PIVOT_LENGTH,
+                       reset, TRUE, &chunk->errorCode);
+        chunk->outputLength=(int32_t)(target-chunk->output);
+        reset=FALSE;
+        if(chunk->errorCode!=U_BUFFER_OVERFLOW_ERROR) {
+            break;
+        }
+        chunk->errorCode=U_ZERO_ERROR;
+        if(!growChunkOutput(chunk, &capacity, capacity+1, FALSE)) {
+            chunk->errorCode=U_MEMORY_ALLOCATION_ERROR;
+            return;
+        }
+    }
+    if(chunk->errorCode==U_STRING_NOT_TERMINATED_WARNING) {
+        chunk->errorCode=U_ZERO_ERROR;
+    }
+}
+
+/*
+ * Converts one chunk in two steps, via a UTF-16 buffer for the whole chunk,
+ * so that the offsets of both steps can be combined.
+ * If a buffer overflows, then the step is repeated with a larger buffer.
+ */
+static void
+convertChunkWithOffsets(UConverter *targetCnv, UConverter *sourceCnv, ParallelChunk *chunk) {
+    UChar *u=NULL;
+    int32_t *uOffsets=NULL;
+    int32_t uCapacity=chunk->sourceLength+16, uLength, capacity=0;
+    int64_t maxLength;
+    UErrorCode toUErrorCode;
+    int32_t i;
+
+    for(;;) {
+        const char *source=chunk->source;
+        UChar *uTarget;
+        uprv_free(u);
+        uprv_free(uOffsets);
+        u=(UChar *)uprv_malloc((size_t)uCapacity*U_SIZEOF_UCHAR);
+        uOffsets=(int32_t *)uprv_malloc((size_t)uCapacity*4);
+        if(u==NULL || uOffsets==NULL) {
+            chunk->errorCode=U_MEMORY_ALLOCATION_ERROR;
+            goto end;
+        }
+        uTarget=u;
+        toUErrorCode=U_ZERO_ERROR;
+        ucnv_resetToUnicode(sourceCnv);
+        ucnv_toUnicode(sourceCnv, &uTarget, u+uCapacity,
+                       &source, chunk->source+chunk->sourceLength,
+                       uOffsets, TRUE, &toUErrorCode);
+        uLength=(int32_t)(uTarget-u);
+        if(toUErrorCode!=U_BUFFER_OVERFLOW_ERROR) {
+            break;
+        }
+        if(uCapacity>0x1fffffff) {
+            chunk->errorCode=U_INDEX_OUTOFBOUNDS_ERROR;
+            goto end;
+        }
+        uCapacity*=2;
+    }
+
+    /* also convert the text before a toUnicode error, then report that error */
+    maxLength=((int64_t)uLength+10)*ucnv_getMaxCharSize(targetCnv);
+    if(!growChunkOutput(chunk, &capacity,
+                        maxLength<0x40000000 ? (int32_t)maxLength+1 : 0x40000000, TRUE)) {
+        chunk->errorCode=U_MEMORY_ALLOCATION_ERROR;
+        goto end;
+    }
+    for(;;) {
+        const UChar *uSource=u;
+        char *target=chunk->output;
+        chunk->errorCode=U_ZERO_ERROR;
+        ucnv_resetFromUnicode(targetCnv);
+        ucnv_fromUnicode(targetCnv, &target, chunk->output+capacity,
+                         &uSource, u+uLength,
+                         chunk->offsets, TRUE, &chunk->errorCode);
+        chunk->outputLength=(int32_t)(target-chunk->output);
+        if(chunk->errorCode!=U_BUFFER_OVERFLOW_ERROR) {
+            break;
+        }
+        /* for example, escape sequences from a callback */
+        if(!growChunkOutput(chunk, &capacity, capacity+1, TRUE)) {
+            chunk->errorCode=U_MEMORY_ALLOCATION_ERROR;
+            goto end;
+        }
+    }
+
+    /* map the offsets into the UTF-16 text to offsets into the whole source text */
+    for(i=0; i<chunk->outputLength; ++i) {
+        int32_t uIndex=chunk->offsets[i];
+        chunk->offsets[i]= uIndex>=0 ? chunk->sourceIndex+uOffsets[uIndex] : -1;
+    }
+    if(U_SUCCESS(chunk->errorCode) && U_FAILURE(toUErrorCode)) {
+        chunk->errorCode=toUErrorCode;
+    }
+
+end:
+    uprv_free(u);
+    uprv_free(uOffsets);
+}
+
+/* Converts chunks until none are left. Runs on each of the threads. */
+static void
+convertChunks(ParallelConversion *pc, UConverter *targetCnv, UConverter *sourceCnv) {
+    int32_t i;
+    while((i=umtx_atomic_inc(&pc->nextChunk)-1)<pc->chunkCount) {
+        ParallelChunk *chunk=pc->chunks+i;
+        if(pc->withOffsets) {
+            convertChunkWithOffsets(targetCnv, sourceCnv, chunk);
+        } else {
+            convertChunk(targetCnv, sourceCnv, chunk);
+        }
+        chunk->done=TRUE;
+    }
+}
+
+/* Thread function: converts with its own converter clones. */
+static void
+runConversionThread(ParallelConversion *pc) {
+    UErrorCode errorCode=U_ZERO_ERROR;
+    UConverter *targetCnv=ucnv_safeClone(pc->targetCnv, NULL, NULL, &errorCode);
+    UConverter *sourceCnv=ucnv_safeClone(pc->sourceCnv, NULL, NULL, &errorCode);
+    if(U_SUCCESS(errorCode)) {
+        /* otherwise leave the chunks to the other threads */
+        convertChunks(pc, targetCnv, sourceCnv);
+    }
+    ucnv_close(targetCnv);
+    ucnv_close(sourceCnv);
+}
+
+#if U_PLATFORM_USES_ONLY_WIN32_API
+
+typedef HANDLE ParallelThread;
+
+static DWORD WINAPI
+parallelThreadMain(LPVOID arg) {
+    runConversionThread((ParallelConversion *)arg);
+    return 0;
+}
+
+static UBool
+startThread(ParallelThread *pThread, ParallelConversion *pc) {
+    *pThread=CreateThread(NULL, 0, parallelThreadMain, pc, 0, NULL);
+    return *pThread!=NULL;
+}
+
+static void
+joinThread(ParallelThread thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+static int32_t
+getProcessorCount() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int32_t)info.dwNumberOfProcessors;
+}
+
+#elif U_PLATFORM_IMPLEMENTS_POSIX
+
+typedef pthread_t ParallelThread;
+
+static void *
+parallelThreadMain(void *arg) {
+    runConversionThread((ParallelConversion *)arg);
+    return NULL;
+}
+
+static UBool
+startThread(ParallelThread *pThread, ParallelConversion *pc) {
+    return pthread_create(pThread, NULL, parallelThreadMain, pc)==0;
+}
+
+static void
+joinThread(ParallelThread thread) {
+    pthread_join(thread, NULL);
+}
+
+static int32_t
+getProcessorCount() {
+#if defined(_SC_NPROCESSORS_ONLN)
+    long count=sysconf(_SC_NPROCESSORS_ONLN);
+    return count>0 ? (int32_t)count : 1;
+#else
+    return 1;
+#endif
+}
+
+#else
+
+/* no threads: the calling thread converts all chunks */
+typedef int32_t ParallelThread;
+
+static UBool
+startThread(ParallelThread *, ParallelConversion *) {
+    return FALSE;
+}
+
+static void
+joinThread(ParallelThread) {}
+
+static int32_t
+getProcessorCount() {
+    return 1;
+}
+
+#endif
+
+U_CAPI int32_t U_EXPORT2
+ucnv_convertParallel(UConverter *targetCnv, UConverter *sourceCnv,
+                     char *target, int32_t targetCapacity,
+                     const char *source, int32_t sourceLength,
+                     int32_t *offsets,
+                     int32_t numThreads,
+                     UErrorCode *pErrorCode) {
+    ParallelConversion pc;
+    ParallelChunk *chunks;
+    ParallelThread threads[MAX_THREADS];
+    int32_t threadCount=0, maxChunkCount, chunkCount, splitMode;
+    int64_t targetLength;
+    uint8_t lf;
+    int32_t i;
+
+    if(pErrorCode==NULL || U_FAILURE(*pErrorCode)) {
+        return 0;
+    }
+    if( targetCnv==NULL || sourceCnv==NULL ||
+        source==NULL || sourceLength<-1 ||
+        targetCapacity<0 || (targetCapacity>0 && target==NULL)
+    ) {
+        *pErrorCode=U_ILLEGAL_ARGUMENT_ERROR;
+        return 0;
+    }
+    if(sourceLength<0) {
+        sourceLength=(int32_t)uprv_strlen(source);
+    }
+    if(sourceLength==0) {
+        return u_terminateChars(target, targetCapacity, 0, pErrorCode);
+    }
+    if(numThreads<=0) {
+        numThreads=getProcessorCount();
+    }
+    if(numThreads>MAX_THREADS) {
+        numThreads=MAX_THREADS;
+    }
+
+    /* a few chunks per thread balance the load when they convert at different speeds */
+    splitMode=getSplitMode(targetCnv, sourceCnv, &lf);
+    maxChunkCount=sourceLength/MIN_CHUNK_LENGTH;
+    if(splitMode==SPLIT_NONE || numThreads==1 || maxChunkCount<1) {
+        maxChunkCount=1;
+    } else if(maxChunkCount>numThreads*4) {
+        maxChunkCount=numThreads*4;
+    }
+    chunks=(ParallelChunk *)uprv_malloc(maxChunkCount*sizeof(ParallelChunk));
+    if(chunks==NULL) {
+        *pErrorCode=U_MEMORY_ALLOCATION_ERROR;
+        return 0;
+    }
+
+    /* split the source text */
+    chunkCount=0;
+    for(int32_t start=0; start<sourceLength;) {
+        int32_t limit;
+        if(chunkCount==maxChunkCount-1) {
+            limit=sourceLength;
+        } else {
+            limit=(int32_t)(((int64_t)sourceLength*(chunkCount+1))/maxChunkCount);
+            if(limit<=start) {
+                limit=start+1;
+            }
+            limit=findSplit(splitMode, lf, (const uint8_t *)source, limit, sourceLength);
+        }
+        ParallelChunk *chunk=chunks+chunkCount++;
+        chunk->source=source+start;
+        chunk->sourceLength=limit-start;
+        chunk->sourceIndex=start;
+        chunk->output=NULL;
+        chunk->offsets=NULL;
+        chunk->outputLength=0;
+        chunk->errorCode=U_ZERO_ERROR;
+        chunk->done=FALSE;
+        start=limit;
+    }
+
+    pc.targetCnv=targetCnv;
+    pc.sourceCnv=sourceCnv;
+    pc.chunks=chunks;
+    pc.chunkCount=chunkCount;
+    pc.withOffsets=(UBool)(offsets!=NULL);
+    umtx_storeRelease(pc.nextChunk, 0);
+
+    /* the calling thread works on the chunks as well */
+    if(numThreads>chunkCount) {
+        numThreads=chunkCount;
+    }
+    while(threadCount<numThreads-1 && startThread(threads+threadCount, &pc)) {
+        ++threadCount;
+    }
+    runConversionThread(&pc);
+    for(i=0; i<threadCount; ++i) {
+        joinThread(threads[i]);
+    }
+
+    /* concatenate the outputs, up to and including the first one with an error */
+    targetLength=0;
+    for(i=0; i<chunkCount; ++i) {
+        ParallelChunk *chunk=chunks+i;
+        if(!chunk->done) {
+            /* no thread could clone the converters */
+            *pErrorCode=U_MEMORY_ALLOCATION_ERROR;
+            break;
+        }
+        if(targetLength<targetCapacity) {
+            int32_t length=chunk->outputLength;
+            if(length>(targetCapacity-targetLength)) {
+                length=(int32_t)(targetCapacity-targetLength);
+            }
+            uprv_memcpy(target+targetLength, chunk->output, length);
+            if(offsets!=NULL) {
+                uprv_memcpy(offsets+targetLength, chunk->offsets, (size_t)length*4);
+            }
+        }
+        targetLength+=chunk->outputLength;
+        if(U_FAILURE(chunk->errorCode)) {
+            *pErrorCode=chunk->errorCode;
+            break;
+        }
+    }
+    for(i=0; i<chunkCount; ++i) {
+        uprv_free(chunks[i].output);
+        uprv_free(chunks[i].offsets);
+    }
+    uprv_free(chunks);
+
+    if(targetLength>0x7fffffff) {
+        if(U_SUCCESS(*pErrorCode)) {
+            *pErrorCode=U_INDEX_OUTOFBOUNDS_ERROR;
+        }
+        return 0;
+    }
+    if(U_FAILURE(*pErrorCode)) {
+        return targetLength<targetCapacity ? (int32_t)targetLength : targetCapacity;
+    }
+    return u_terminateChars(target, targetCapacity, (int32_t)targetLength, pErrorCode);
+}
+
+#endif
@@ -0,0 +1,267 @@
+// © 2018 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+/*
+*******************************************************************************
+*   file name:  ucnv_pool.cpp
+*   encoding:   UTF-8
+*   tab size:   8 (not used)
+*   indentation:4
+*
+*   Pools of idle converters (UConverterPool), so that code which opens
+*   a converter per request for a small set of charset names neither
+*   resolves the name nor allocates a converter each time.
+*/
+
+#include "unicode/utypes.h"
+
+#if !UCONFIG_NO_CONVERSION
+
+#include "unicode/ucnv.h"
+#include "cmemory.h"
+#include "cstring.h"
+#include "uhash.h"
+#include "umutex.h"
+#include "ucnv_bld.h"
+#include "ucnv_imp.h"
+
+/* default and maximum for the maxIdle parameter of ucnv_openPool() */
+#define DEFAULT_MAX_IDLE 16
+#define MAX_MAX_IDLE 1024
+
+/*
+ * Idle converters for one canonical converter name.
+ * When there are none, the prototype is cloned, which avoids resolving
+ * the name again.
+ * The substitution state is saved from the freshly opened converter because
+ * some converters (e.g., ISO-2022-KR) set it in their open function,
+ * not from their static data.
+ * The name is stored after the array of converters.
+ */
+struct PoolEntry {
+    char *name;
+    UConverter *prototype;
+    uint8_t subChar[UCNV_MAX_SUBCHAR_LEN];
+    int8_t subCharLen;
+    uint8_t subChar1;
+    int32_t count;
+    UConverter *idle[1];  /* maxIdle entries */
+};
+
+struct UConverterPool {
+    /* requested name (case-insensitive) -> PoolEntry */
+    UHashtable *requestedNames;
+    /* canonical name from ucnv_getName() -> PoolEntry, owns the entries */
+    UHashtable *entries;
+    int32_t maxIdle;
+};
+
+/*
+ * Protects the hash tables and entries of all pools.
+ * The critical sections are only a hash lookup and a push or pop.
+ */
+static UMutex poolMutex = U_MUTEX_INITIALIZER;
+
+static void U_CALLCONV
+deletePoolEntry(void *obj) {
+    PoolEntry *entry = (PoolEntry *)obj;
+    for (int32_t i = 0; i < entry->count; ++i) {
+        ucnv_close(entry->idle[i]);
+    }
+    ucnv_close(entry->prototype);
+    uprv_free(entry);
+}
+
+/*
+ * Adopts the prototype, also if the entry cannot be allocated.
+ * The opened converter must not have been used yet.
+ */
+static PoolEntry *
+createPoolEntry(const char *name, UConverter *prototype, const UConverter *opened,
+                int32_t maxIdle) {
+    size_t nameLength = uprv_strlen(name);
+    size_t size = sizeof(PoolEntry) + (size_t)(maxIdle - 1) * sizeof(UConverter *);
+    PoolEntry *entry = (PoolEntry *)uprv_malloc(size + nameLength + 1);
+    if (entry == NULL) {
+        ucnv_close(prototype);
+        return NULL;
+    }
+    entry->name = (char *)entry + size;
+    uprv_memcpy(entry->name, name, nameLength + 1);
+    entry->prototype = prototype;
+    /* a freshly opened converter has a short charset substitution string in subUChars */
+    entry->subCharLen = opened->subCharLen;
+    uprv_memcpy(entry->subChar, opened->subChars, UCNV_MAX_SUBCHAR_LEN);
+    entry->subChar1 = opened->subChar1;
+    entry->count = 0;
+    return entry;
+}
+
+/*
+ * Returns TRUE if the converter can be handed out again after ucnv_reset():
+ * It was allocated by ucnv_open() or ucnv_safeClone() and still has the default
+ * callbacks. The fallback setting is restored, and an allocated substitution
+ * string is released; restoreSubstitution() then sets the entry's one.
+ */
+static UBool
+prepareForReuse(UConverter *cnv) {
+    if (cnv->isCopyLocal ||
+            cnv->fromCharErrorBehaviour != UCNV_TO_U_DEFAULT_CALLBACK ||
+            cnv->toUContext != NULL ||
+            cnv->fromUCharErrorBehaviour != UCNV_FROM_U_DEFAULT_CALLBACK ||
+            cnv->fromUContext != NULL) {
+        return FALSE;
+    }
+    ucnv_reset(cnv);
+    /* same as in ucnv_createConverterFromSharedData() */
+    if (cnv->subChars != (uint8_t *)cnv->subUChars) {
+        uprv_free(cnv->subChars);
+        cnv->subChars = (uint8_t *)cnv->subUChars;
+    }
+    cnv->useFallback = FALSE;
+    return TRUE;
+}
+
+/* Sets the substitution state that the converter had when it was opened. */
+static inline void
+restoreSubstitution(UConverter *cnv, const PoolEntry *entry) {
+    cnv->subChar1 = entry->subChar1;
+    cnv->subCharLen = entry->subCharLen;
+    uprv_memcpy(cnv->subChars, entry->subChar, UCNV_MAX_SUBCHAR_LEN);
+}
+
+U_CAPI UConverterPool * U_EXPORT2
+ucnv_openPool(int32_t maxIdle, UErrorCode *pErrorCode) {
+    if (U_FAILURE(*pErrorCode)) {
+        return NULL;
+    }
+    if (maxIdle < 0 || maxIdle > MAX_MAX_IDLE) {
+        *pErrorCode = U_ILLEGAL_ARGUMENT_ERROR;
+        return NULL;
+    }
+    UConverterPool *pool = (UConverterPool *)uprv_malloc(sizeof(UConverterPool));
+    if (pool == NULL) {
+        *pErrorCode = U_MEMORY_ALLOCATION_ERROR;
+        return NULL;
+    }
+    pool->maxIdle = maxIdle == 0 ? DEFAULT_MAX_IDLE : maxIdle;
+    pool->requestedNames = uhash_open(uhash_hashIChars, uhash_compareIChars, NULL, pErrorCode);
+    pool->entries = uhash_open(uhash_hashChars, uhash_compareChars, NULL, pErrorCode);
+    if (U_FAILURE(*pErrorCode)) {
+        ucnv_closePool(pool);
+        return NULL;
+    }
+    uhash_setKeyDeleter(pool->requestedNames, uprv_free);
+    /* the entry owns its name, which is the key in the entries table */
+    uhash_setValueDeleter(pool->entries, deletePoolEntry);
+    return pool;
+}
+
+U_CAPI void U_EXPORT2
+ucnv_closePool(UConverterPool *pool) {
+    if (pool != NULL) {
+        uhash_close(pool->requestedNames);
+        uhash_close(pool->entries);
+        uprv_free(pool);
+    }
+}
+
+U_CAPI UConverter * U_EXPORT2
+ucnv_openFromPool(UConverterPool *pool, const char *name, UErrorCode *pErrorCode) {
+    if (U_FAILURE(*pErrorCode)) {
+        return NULL;
+    }
+    if (pool == NULL || name == NULL) {
+        *pErrorCode = U_ILLEGAL_ARGUMENT_ERROR;
+        return NULL;
+    }
+
+    UConverter *cnv = NULL;
+    umtx_lock(&poolMutex);
+    PoolEntry *entry = (PoolEntry *)uhash_get(pool->requestedNames, name);
+    if (entry != NULL && entry->count > 0) {
+        cnv = entry->idle[--entry->count];
+    }
+    umtx_unlock(&poolMutex);
+    if (cnv != NULL) {
+        return cnv;
+    }
+    if (entry != NULL) {
+        /* entries are only deleted by ucnv_closePool() */
+        cnv = ucnv_safeClone(entry->prototype, NULL, NULL, pErrorCode);
+        if (*pErrorCode == U_SAFECLONE_ALLOCATED_WARNING) {
+            *pErrorCode = U_ZERO_ERROR;
+        }
+        return cnv;
+    }
+
+    /*
+     * First request for this name: resolve it and remember the result.
+     * Once the name is known, the failure to remember it is not an error;
+     * the converter is usable, and the next request tries again.
+     */
+    cnv = ucnv_open(name, pErrorCode);
+    if (U_FAILURE(*pErrorCode)) {
+        return cnv;
+    }
+    UErrorCode errorCode = U_ZERO_ERROR;
+    const char *canonicalName = ucnv_getName(cnv, &errorCode);
+    UConverter *prototype = ucnv_safeClone(cnv, NULL, NULL, &errorCode);
+    int32_t nameLength = (int32_t)uprv_strlen(name);
+    char *key = (char *)uprv_malloc(nameLength + 1);
+    if (U_FAILURE(errorCode) || key == NULL) {
+        ucnv_close(prototype);
+        uprv_free(key);
+        return cnv;
+    }
+    uprv_memcpy(key, name, nameLength + 1);
+
+    umtx_lock(&poolMutex);
+    if (uhash_get(pool->requestedNames, key) == NULL) {
+        entry = (PoolEntry *)uhash_get(pool->entries, canonicalName);
+        if (entry == NULL) {
+            entry = createPoolEntry(canonicalName, prototype, cnv, pool->maxIdle);
+            prototype = NULL;  /* adopted */
+            if (entry != NULL) {
+                uhash_put(pool->entries, entry->name, entry, &errorCode);
+                if (U_FAILURE(errorCode)) {
+                    entry = NULL;  /* deleted by uhash_put() */
+                }
+            }
+        }
+        if (entry != NULL) {
+            uhash_put(pool->requestedNames, key, entry, &errorCode);
+            key = NULL;  /* adopted (or deleted) by uhash_put() */
+        }
+    }
+    umtx_unlock(&poolMutex);
+    ucnv_close(prototype);
+    uprv_free(key);
+    return cnv;
+}
+
+U_CAPI void U_EXPORT2
+ucnv_releaseToPool(UConverterPool *pool, UConverter *cnv) {
+    if (cnv == NULL) {
+        return;
+    }
+    if (pool == NULL || !prepareForReuse(cnv)) {
+        ucnv_close(cnv);
+        return;
+    }
+    UErrorCode errorCode = U_ZERO_ERROR;
+    const char *canonicalName = ucnv_getName(cnv, &errorCode);
+    UBool pooled = FALSE;
+    umtx_lock(&poolMutex);
+    PoolEntry *entry = (PoolEntry *)uhash_get(pool->entries, canonicalName);
+    if (entry != NULL && entry->count < pool->maxIdle) {
+        restoreSubstitution(cnv, entry);
+        entry->idle[entry->count++] = cnv;
+        pooled = TRUE;
+    }
+    umtx_unlock(&poolMutex);
+    if (!pooled) {
+        ucnv_close(cnv);
+    }
+}
+
+#endif
@@ -397,6 +397,9 @@ _UTF16BEToUnicodeWithOffsets(UConverterToUnicodeArgs *pArgs,
                     --count;
                     *target++=c;
                     *target++=trail;
+                } else if(UCNV_TO_U_INLINE_FFFD(cnv) && (U16_IS_TRAIL(c) || count>=2)) {
+                    /* unmatched surrogate */
+                    *target++=0xfffd;
                 } else {
                     break;
                 }
@@ -419,6 +422,11 @@ _UTF16BEToUnicodeWithOffsets(UConverterToUnicodeArgs *pArgs,
                     *offsets++=sourceIndex;
                     *offsets++=sourceIndex;
                     sourceIndex+=4;
+                } else if(UCNV_TO_U_INLINE_FFFD(cnv) && (U16_IS_TRAIL(c) || count>=2)) {
+                    /* unmatched surrogate */
+                    *target++=0xfffd;
+                    *offsets++=sourceIndex;
+                    sourceIndex+=2;
                 } else {
                     break;
                 }
@@ -998,6 +1006,9 @@ _UTF16LEToUnicodeWithOffsets(UConverterToUnicodeArgs *pArgs,
                     --count;
                     *target++=c;
                     *target++=trail;
+                } else if(UCNV_TO_U_INLINE_FFFD(cnv) && (U16_IS_TRAIL(c) || count>=2)) {
+                    /* unmatched surrogate */
+                    *target++=0xfffd;
                 } else {
                     break;
                 }
@@ -1020,6 +1031,11 @@ _UTF16LEToUnicodeWithOffsets(UConverterToUnicodeArgs *pArgs,
                     *offsets++=sourceIndex;
                     *offsets++=sourceIndex;
                     sourceIndex+=4;
+                } else if(UCNV_TO_U_INLINE_FFFD(cnv) && (U16_IS_TRAIL(c) || count>=2)) {
+                    /* unmatched surrogate */
+                    *target++=0xfffd;
+                    *offsets++=sourceIndex;
+                    sourceIndex+=2;
                 } else {
                     break;
                 }
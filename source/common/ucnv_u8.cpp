@@ -25,6 +25,7 @@
 #if !UCONFIG_NO_CONVERSION
 
 #include "unicode/ucnv.h"
+#include "unicode/ustring.h"
 #include "unicode/utf.h"
 #include "unicode/utf8.h"
 #include "unicode/utf16.h"
@@ -32,6 +33,7 @@
 #include "ucnv_bld.h"
 #include "ucnv_cnv.h"
 #include "cmemory.h"
+#include "ustr_ascii.h"
 #include "ustr_imp.h"
 
 /* Prototypes --------------------------------------------------------------- */
@@ -73,7 +75,7 @@ static void  U_CALLCONV ucnv_toUnicode_UTF8 (UConverterToUnicodeArgs * args,
     unsigned char *toUBytes = cnv->toUBytes;
     UBool isCESU8 = hasCESU8Data(cnv);
     uint32_t ch, ch2 = 0;
-    int32_t i, inBytes;
+    int32_t i, inBytes, count;
 
     /* Restore size of current sequence */
     if (cnv->toULength > 0 && myTarget < targetLimit)
@@ -94,6 +96,15 @@ static void  U_CALLCONV ucnv_toUnicode_UTF8 (UConverterToUnicodeArgs * args,
         if (U8_IS_SINGLE(ch))        /* Simple case */
         {
             *(myTarget++) = (UChar) ch;
+
+            /* widen the following run of ASCII bytes in bulk */
+            count = (int32_t)(sourceLimit - mySource);
+            if (count > (targetLimit - myTarget)) {
+                count = (int32_t)(targetLimit - myTarget);
+            }
+            count = uprv_widenASCII(myTarget, mySource, count);
+            mySource += count;
+            myTarget += count;
         }
         else
         {
@@ -158,6 +169,11 @@ morebytes:
                     }
                 }
             }
+            else if (UCNV_TO_U_INLINE_FFFD(cnv))
+            {
+                /* nothing was written for this sequence, so there is room */
+                *(myTarget++) = 0xfffd;
+            }
             else
             {
                 cnv->toULength = (int8_t)i;
@@ -191,7 +207,7 @@ static void  U_CALLCONV ucnv_toUnicode_UTF8_OFFSETS_LOGIC (UConverterToUnicodeAr
     unsigned char *toUBytes = cnv->toUBytes;
     UBool isCESU8 = hasCESU8Data(cnv);
     uint32_t ch, ch2 = 0;
-    int32_t i, inBytes;
+    int32_t i, inBytes, count;
 
     /* Restore size of current sequence */
     if (cnv->toULength > 0 && myTarget < targetLimit)
@@ -212,6 +228,18 @@ static void  U_CALLCONV ucnv_toUnicode_UTF8_OFFSETS_LOGIC (UConverterToUnicodeAr
         {
             *(myTarget++) = (UChar) ch;
             *(myOffsets++) = offsetNum++;
+
+            /* widen the following run of ASCII bytes in bulk */
+            count = (int32_t)(sourceLimit - mySource);
+            if (count > (targetLimit - myTarget)) {
+                count = (int32_t)(targetLimit - myTarget);
+            }
+            count = uprv_widenASCII(myTarget, mySource, count);
+            uprv_fillIncreasingOffsets(myOffsets, offsetNum, count);
+            mySource += count;
+            myTarget += count;
+            myOffsets += count;
+            offsetNum += count;
         }
         else
         {
@@ -276,6 +304,12 @@ morebytes:
                 }
                 offsetNum += i;
             }
+            else if (UCNV_TO_U_INLINE_FFFD(cnv))
+            {
+                *(myTarget++) = 0xfffd;
+                *(myOffsets++) = offsetNum;
+                offsetNum += i;
+            }
             else
             {
                 cnv->toULength = (int8_t)i;
@@ -308,7 +342,7 @@ U_CFUNC void  U_CALLCONV ucnv_fromUnicode_UTF8 (UConverterFromUnicodeArgs * args
     uint8_t *tempPtr;
     UChar32 ch;
     uint8_t tempBuf[4];
-    int32_t indexToWrite;
+    int32_t indexToWrite, count;
     UBool isNotCESU8 = !hasCESU8Data(cnv);
 
     if (cnv->fromUChar32 && myTarget < targetLimit)
@@ -325,6 +359,15 @@ U_CFUNC void  U_CALLCONV ucnv_fromUnicode_UTF8 (UConverterFromUnicodeArgs * args
         if (ch < 0x80)        /* Single byte */
         {
             *(myTarget++) = (uint8_t) ch;
+
+            /* narrow the following run of ASCII code units in bulk */
+            count = (int32_t)(sourceLimit - mySource);
+            if (count > (targetLimit - myTarget)) {
+                count = (int32_t)(targetLimit - myTarget);
+            }
+            count = uprv_narrowToLatin1(myTarget, mySource, count, 0x7f);
+            mySource += count;
+            myTarget += count;
         }
         else if (ch < 0x800)  /* Double byte */
         {
@@ -423,7 +466,7 @@ U_CFUNC void  U_CALLCONV ucnv_fromUnicode_UTF8_OFFSETS_LOGIC (UConverterFromUnic
     uint8_t *tempPtr;
     UChar32 ch;
     int32_t offsetNum, nextSourceIndex;
-    int32_t indexToWrite;
+    int32_t indexToWrite, count;
     uint8_t tempBuf[4];
     UBool isNotCESU8 = !hasCESU8Data(cnv);
 
@@ -446,6 +489,18 @@ U_CFUNC void  U_CALLCONV ucnv_fromUnicode_UTF8_OFFSETS_LOGIC (UConverterFromUnic
         {
             *(myOffsets++) = offsetNum++;
             *(myTarget++) = (char) ch;
+
+            /* narrow the following run of ASCII code units in bulk */
+            count = (int32_t)(sourceLimit - mySource);
+            if (count > (targetLimit - myTarget)) {
+                count = (int32_t)(targetLimit - myTarget);
+            }
+            count = uprv_narrowToLatin1(myTarget, mySource, count, 0x7f);
+            uprv_fillIncreasingOffsets(myOffsets, offsetNum, count);
+            mySource += count;
+            myTarget += count;
+            myOffsets += count;
+            offsetNum += count;
         }
         else if (ch < 0x800)  /* Double byte */
         {
@@ -655,12 +710,12 @@ ucnv_UTF8FromUTF8(UConverterFromUnicodeArgs *pFromUArgs,
     const uint8_t *source, *sourceLimit;
     uint8_t *target;
     int32_t targetCapacity;
-    int32_t count;
+    int32_t count, length;
 
     int8_t oldToULength, toULength, toULimit;
 
     UChar32 c;
-    uint8_t b, t1, t2;
+    uint8_t b;
 
     /* set up the local pointers */
     utf8=pToUArgs->converter;
@@ -707,7 +762,7 @@ ucnv_UTF8FromUTF8(UConverterFromUnicodeArgs *pFromUArgs,
 
         // Do not go back into the bytes that will be read for finishing a partial
         // sequence from the previous buffer.
-        int32_t length=count-toULimit;
+        length=count-toULimit;
         U8_TRUNCATE_IF_INCOMPLETE(source, 0, length);
         count=toULimit+length;
     }
@@ -721,96 +776,72 @@ ucnv_UTF8FromUTF8(UConverterFromUnicodeArgs *pFromUArgs,
 
     /* conversion loop */
     while(count>0) {
+        /* copy the well-formed text in bulk */
+        length=u_strCheckUTF8((const char *)source, count, NULL);
+        uprv_memcpy(target, source, length);
+        source+=length;
+        target+=length;
+        count-=length;
+        if(count==0) {
+            break;
+        }
         b=*source++;
-        if(U8_IS_SINGLE(b)) {
-            /* convert ASCII */
-            *target++=b;
-            --count;
-            continue;
-        } else {
-            if(b>=0xe0) {
-                if( /* handle U+0800..U+FFFF inline */
-                    b<0xf0 &&
-                    U8_IS_VALID_LEAD3_AND_T1(b, t1=source[0]) &&
-                    U8_IS_TRAIL(t2=source[1])
-                ) {
-                    source+=2;
-                    *target++=b;
-                    *target++=t1;
-                    *target++=t2;
-                    count-=3;
-                    continue;
-                }
-            } else {
-                if( /* handle U+0080..U+07FF inline */
-                    b>=0xc2 &&
-                    U8_IS_TRAIL(t1=*source)
-                ) {
-                    ++source;
-                    *target++=b;
-                    *target++=t1;
-                    count-=2;
-                    continue;
-                }
-            }
-
-            /* handle "complicated" and error cases, and continuing partial characters */
-            oldToULength=0;
-            toULength=1;
-            toULimit=U8_COUNT_BYTES_NON_ASCII(b);
-            c=b;
+        /* handle error cases, and continuing partial characters */
+        oldToULength=0;
+        toULength=1;
+        toULimit=U8_COUNT_BYTES_NON_ASCII(b);
+        c=b;
 moreBytes:
-            while(toULength<toULimit) {
-                if(source<sourceLimit) {
-                    b=*source;
-                    if(icu::UTF8::isValidTrail(c, b, toULength, toULimit)) {
-                        ++source;
-                        ++toULength;
-                        c=(c<<6)+b;
-                    } else {
-                        break; /* sequence too short, stop with toULength<toULimit */
-                    }
+        while(toULength<toULimit) {
+            if(source<sourceLimit) {
+                b=*source;
+                if(icu::UTF8::isValidTrail(c, b, toULength, toULimit)) {
+                    ++source;
+                    ++toULength;
+                    c=(c<<6)+b;
                 } else {
-                    /* store the partial UTF-8 character, compatible with the regular UTF-8 converter */
-                    source-=(toULength-oldToULength);
-                    while(oldToULength<toULength) {
-                        utf8->toUBytes[oldToULength++]=*source++;
-                    }
-                    utf8->toUnicodeStatus=c;
-                    utf8->toULength=toULength;
-                    utf8->mode=toULimit;
-                    pToUArgs->source=(char *)source;
-                    pFromUArgs->target=(char *)target;
-                    return;
+                    break; /* sequence too short, stop with toULength<toULimit */
                 }
-            }
-
-            if(toULength!=toULimit) {
-                /* error handling: illegal UTF-8 byte sequence */
+            } else {
+                /* store the partial UTF-8 character, compatible with the regular UTF-8 converter */
                 source-=(toULength-oldToULength);
                 while(oldToULength<toULength) {
                     utf8->toUBytes[oldToULength++]=*source++;
                 }
+                utf8->toUnicodeStatus=c;
                 utf8->toULength=toULength;
+                utf8->mode=toULimit;
                 pToUArgs->source=(char *)source;
                 pFromUArgs->target=(char *)target;
-                *pErrorCode=U_ILLEGAL_CHAR_FOUND;
                 return;
             }
+        }
 
-            /* copy the legal byte sequence to the target */
-            {
-                int8_t i;
+        if(toULength!=toULimit) {
+            /* error handling: illegal UTF-8 byte sequence */
+            source-=(toULength-oldToULength);
+            while(oldToULength<toULength) {
+                utf8->toUBytes[oldToULength++]=*source++;
+            }
+            utf8->toULength=toULength;
+            pToUArgs->source=(char *)source;
+            pFromUArgs->target=(char *)target;
+            *pErrorCode=U_ILLEGAL_CHAR_FOUND;
+            return;
+        }
 
-                for(i=0; i<oldToULength; ++i) {
-                    *target++=utf8->toUBytes[i];
-                }
-                source-=(toULength-oldToULength);
-                for(; i<toULength; ++i) {
-                    *target++=*source++;
-                }
-                count-=toULength;
+        /* copy the legal byte sequence to the target */
+        {
+            int8_t i;
+
+            for(i=0; i<oldToULength; ++i) {
+                *target++=utf8->toUBytes[i];
+            }
+            source-=(toULength-oldToULength);
+            for(; i<toULength; ++i) {
+                *target++=*source++;
             }
+            count-=toULength;
         }
     }
     U_ASSERT(count>=0);
@@ -23,11 +23,9 @@
 #include "unicode/utf8.h"
 #include "ucnv_bld.h"
 #include "ucnv_cnv.h"
+#include "ustr_ascii.h"
 #include "ustr_imp.h"
 
-/* control optimizations according to the platform */
-#define LATIN1_UNROLL_FROM_UNICODE 1
-
 /* ISO 8859-1 --------------------------------------------------------------- */
 
 /* This is a table-less and callback-less version of ucnv_MBCSSingleToBMPWithOffsets(). */
@@ -55,53 +53,16 @@ _Latin1ToUnicodeWithOffsets(UConverterToUnicodeArgs *pArgs,
      * for the minimum of the sourceLength and targetCapacity
      */
     length=(int32_t)((const uint8_t *)pArgs->sourceLimit-source);
-    if(length<=targetCapacity) {
-        targetCapacity=length;
-    } else {
+    if(length>targetCapacity) {
         /* target will be full */
         *pErrorCode=U_BUFFER_OVERFLOW_ERROR;
         length=targetCapacity;
     }
 
-    if(targetCapacity>=8) {
-        /* This loop is unrolled for speed and improved pipelining. */
-        int32_t count, loops;
-
-        loops=count=targetCapacity>>3;
-        length=targetCapacity&=0x7;
-        do {
-            target[0]=source[0];
-            target[1]=source[1];
-            target[2]=source[2];
-            target[3]=source[3];
-            target[4]=source[4];
-            target[5]=source[5];
-            target[6]=source[6];
-            target[7]=source[7];
-            target+=8;
-            source+=8;
-        } while(--count>0);
-
-        if(offsets!=NULL) {
-            do {
-                offsets[0]=sourceIndex++;
-                offsets[1]=sourceIndex++;
-                offsets[2]=sourceIndex++;
-                offsets[3]=sourceIndex++;
-                offsets[4]=sourceIndex++;
-                offsets[5]=sourceIndex++;
-                offsets[6]=sourceIndex++;
-                offsets[7]=sourceIndex++;
-                offsets+=8;
-            } while(--loops>0);
-        }
-    }
-
     /* conversion loop */
-    while(targetCapacity>0) {
-        *target++=*source++;
-        --targetCapacity;
-    }
+    uprv_widenLatin1(target, source, length);
+    source+=length;
+    target+=length;
 
     /* write back the updated pointers */
     pArgs->source=(const char *)source;
@@ -109,11 +70,8 @@ _Latin1ToUnicodeWithOffsets(UConverterToUnicodeArgs *pArgs,
 
     /* set offsets */
     if(offsets!=NULL) {
-        while(length>0) {
-            *offsets++=sourceIndex++;
-            --length;
-        }
-        pArgs->offsets=offsets;
+        uprv_fillIncreasingOffsets(offsets, sourceIndex, length);
+        pArgs->offsets=offsets+length;
     }
 }
 
@@ -181,82 +139,13 @@ _Latin1FromUnicodeWithOffsets(UConverterFromUnicodeArgs *pArgs,
         goto getTrail;
     }
 
-#if LATIN1_UNROLL_FROM_UNICODE
-    /* unroll the loop with the most common case */
-    if(targetCapacity>=16) {
-        int32_t count, loops;
-        UChar u, oredChars;
-
-        loops=count=targetCapacity>>4;
-        do {
-            oredChars=u=*source++;
-            *target++=(uint8_t)u;
-            oredChars|=u=*source++;
-            *target++=(uint8_t)u;
-            oredChars|=u=*source++;
-            *target++=(uint8_t)u;
-            oredChars|=u=*source++;
-            *target++=(uint8_t)u;
-            oredChars|=u=*source++;
-            *target++=(uint8_t)u;
-            oredChars|=u=*source++;
-            *target++=(uint8_t)u;
-            oredChars|=u=*source++;
-            *target++=(uint8_t)u;
-            oredChars|=u=*source++;
-            *target++=(uint8_t)u;
-            oredChars|=u=*source++;
-            *target++=(uint8_t)u;
-            oredChars|=u=*source++;
-            *target++=(uint8_t)u;
-            oredChars|=u=*source++;
-            *target++=(uint8_t)u;
-            oredChars|=u=*source++;
-            *target++=(uint8_t)u;
-            oredChars|=u=*source++;
-            *target++=(uint8_t)u;
-            oredChars|=u=*source++;
-            *target++=(uint8_t)u;
-            oredChars|=u=*source++;
-            *target++=(uint8_t)u;
-            oredChars|=u=*source++;
-            *target++=(uint8_t)u;
-
-            /* were all 16 entries really valid? */
-            if(oredChars>max) {
-                /* no, return to the first of these 16 */
-                source-=16;
-                target-=16;
-                break;
-            }
-        } while(--count>0);
-        count=loops-count;
-        targetCapacity-=16*count;
-
-        if(offsets!=NULL) {
-            oldTarget+=16*count;
-            while(count>0) {
-                *offsets++=sourceIndex++;
-                *offsets++=sourceIndex++;
-                *offsets++=sourceIndex++;
-                *offsets++=sourceIndex++;
-                *offsets++=sourceIndex++;
-                *offsets++=sourceIndex++;
-                *offsets++=sourceIndex++;
-                *offsets++=sourceIndex++;
-                *offsets++=sourceIndex++;
-                *offsets++=sourceIndex++;
-                *offsets++=sourceIndex++;
-                *offsets++=sourceIndex++;
-                *offsets++=sourceIndex++;
-                *offsets++=sourceIndex++;
-                *offsets++=sourceIndex++;
-                *offsets++=sourceIndex++;
-                --count;
-            }
-        }
+    /* convert the initial run of mappable characters in bulk */
+    if(targetCapacity>0) {
+        length=uprv_narrowToLatin1(target, source, targetCapacity, max);
+        source+=length;
+        target+=length;
+        targetCapacity-=length;
     }
-#endif
 
     /* conversion loop */
     c=0;
@@ -301,11 +190,9 @@ noMoreInput:
 
     /* set offsets since the start */
     if(offsets!=NULL) {
-        size_t count=target-oldTarget;
-        while(count>0) {
-            *offsets++=sourceIndex++;
-            --count;
-        }
+        length=(int32_t)(target-oldTarget);
+        uprv_fillIncreasingOffsets(offsets, sourceIndex, length);
+        offsets+=length;
     }
 
     if(U_SUCCESS(*pErrorCode) && source<sourceLimit && target>=(uint8_t *)pArgs->targetLimit) {
@@ -327,7 +214,7 @@ ucnv_Latin1FromUTF8(UConverterFromUnicodeArgs *pFromUArgs,
     UConverter *utf8;
     const uint8_t *source, *sourceLimit;
     uint8_t *target;
-    int32_t targetCapacity;
+    int32_t targetCapacity, length;
 
     UChar32 c;
     uint8_t b, t1;
@@ -380,9 +267,18 @@ ucnv_Latin1FromUTF8(UConverterFromUnicodeArgs *pFromUArgs,
         if(targetCapacity>0) {
             b=*source++;
             if(U8_IS_SINGLE(b)) {
-                /* convert ASCII */
+                /* convert ASCII, and copy the following ASCII run in bulk */
                 *target++=(uint8_t)b;
                 --targetCapacity;
+                length=(int32_t)(sourceLimit-source);
+                if(length>targetCapacity) {
+                    length=targetCapacity;
+                }
+                length=uprv_asciiSpan(source, length);
+                uprv_memcpy(target, source, length);
+                source+=length;
+                target+=length;
+                targetCapacity-=length;
             } else if( /* handle U+0080..U+00FF inline */
                        b>=0xc2 && b<=0xc3 &&
                        (t1=(uint8_t)(*source-0x80)) <= 0x3f
@@ -509,48 +405,12 @@ _ASCIIToUnicodeWithOffsets(UConverterToUnicodeArgs *pArgs,
         targetCapacity=length;
     }
 
-    if(targetCapacity>=8) {
-        /* This loop is unrolled for speed and improved pipelining. */
-        int32_t count, loops;
-        UChar oredChars;
-
-        loops=count=targetCapacity>>3;
-        do {
-            oredChars=target[0]=source[0];
-            oredChars|=target[1]=source[1];
-            oredChars|=target[2]=source[2];
-            oredChars|=target[3]=source[3];
-            oredChars|=target[4]=source[4];
-            oredChars|=target[5]=source[5];
-            oredChars|=target[6]=source[6];
-            oredChars|=target[7]=source[7];
-
-            /* were all 16 entries really valid? */
-            if(oredChars>0x7f) {
-                /* no, return to the first of these 16 */
-                break;
-            }
-            source+=8;
-            target+=8;
-        } while(--count>0);
-        count=loops-count;
-        targetCapacity-=count*8;
-
-        if(offsets!=NULL) {
-            oldTarget+=count*8;
-            while(count>0) {
-                offsets[0]=sourceIndex++;
-                offsets[1]=sourceIndex++;
-                offsets[2]=sourceIndex++;
-                offsets[3]=sourceIndex++;
-                offsets[4]=sourceIndex++;
-                offsets[5]=sourceIndex++;
-                offsets[6]=sourceIndex++;
-                offsets[7]=sourceIndex++;
-                offsets+=8;
-                --count;
-            }
-        }
+    /* convert the initial run of ASCII bytes in bulk */
+    if(targetCapacity>0) {
+        length=uprv_widenASCII(target, source, targetCapacity);
+        source+=length;
+        target+=length;
+        targetCapacity-=length;
     }
 
     /* conversion loop */
@@ -573,11 +433,9 @@ _ASCIIToUnicodeWithOffsets(UConverterToUnicodeArgs *pArgs,
 
     /* set offsets since the start */
     if(offsets!=NULL) {
-        size_t count=target-oldTarget;
-        while(count>0) {
-            *offsets++=sourceIndex++;
-            --count;
-        }
+        length=(int32_t)(target-oldTarget);
+        uprv_fillIncreasingOffsets(offsets, sourceIndex, length);
+        offsets+=length;
     }
 
     /* write back the updated pointers */
@@ -645,41 +503,12 @@ ucnv_ASCIIFromUTF8(UConverterFromUnicodeArgs *pFromUArgs,
         targetCapacity=length;
     }
 
-    /* unroll the loop with the most common case */
-    if(targetCapacity>=16) {
-        int32_t count, loops;
-        uint8_t oredChars;
-
-        loops=count=targetCapacity>>4;
-        do {
-            oredChars=*target++=*source++;
-            oredChars|=*target++=*source++;
-            oredChars|=*target++=*source++;
-            oredChars|=*target++=*source++;
-            oredChars|=*target++=*source++;
-            oredChars|=*target++=*source++;
-            oredChars|=*target++=*source++;
-            oredChars|=*target++=*source++;
-            oredChars|=*target++=*source++;
-            oredChars|=*target++=*source++;
-            oredChars|=*target++=*source++;
-            oredChars|=*target++=*source++;
-            oredChars|=*target++=*source++;
-            oredChars|=*target++=*source++;
-            oredChars|=*target++=*source++;
-            oredChars|=*target++=*source++;
-
-            /* were all 16 entries really valid? */
-            if(oredChars>0x7f) {
-                /* no, return to the first of these 16 */
-                source-=16;
-                target-=16;
-                break;
-            }
-        } while(--count>0);
-        count=loops-count;
-        targetCapacity-=16*count;
-    }
+    /* copy the initial run of ASCII bytes in bulk */
+    length=uprv_asciiSpan(source, targetCapacity);
+    uprv_memcpy(target, source, length);
+    source+=length;
+    target+=length;
+    targetCapacity-=length;
 
     /* conversion loop */
     c=0;
@@ -59,6 +59,7 @@
 #include "cmemory.h"
 #include "cstring.h"
 #include "umutex.h"
+#include "ustr_ascii.h"
 #include "ustr_imp.h"
 
 /* control optimizations according to the platform */
@@ -431,6 +432,26 @@ ucnv_DBCSFromUTF8(UConverterFromUnicodeArgs *pFromUArgs,
                   UConverterToUnicodeArgs *pToUArgs,
                   UErrorCode *pErrorCode);
 
+static void U_CALLCONV
+ucnv_SBCSToUTF8(UConverterFromUnicodeArgs *pFromUArgs,
+                UConverterToUnicodeArgs *pToUArgs,
+                UErrorCode *pErrorCode);
+
+static void U_CALLCONV
+ucnv_DBCSToUTF8(UConverterFromUnicodeArgs *pFromUArgs,
+                UConverterToUnicodeArgs *pToUArgs,
+                UErrorCode *pErrorCode);
+
+static void U_CALLCONV
+ucnv_GB18030FromUTF8(UConverterFromUnicodeArgs *pFromUArgs,
+                     UConverterToUnicodeArgs *pToUArgs,
+                     UErrorCode *pErrorCode);
+
+static void U_CALLCONV
+ucnv_GB18030ToUTF8(UConverterFromUnicodeArgs *pFromUArgs,
+                   UConverterToUnicodeArgs *pToUArgs,
+                   UErrorCode *pErrorCode);
+
 static const UConverterImpl _SBCSUTF8Impl={
     UCNV_MBCS,
 
@@ -453,7 +474,7 @@ static const UConverterImpl _SBCSUTF8Impl={
     NULL,
     ucnv_MBCSGetUnicodeSet,
 
-    NULL,
+    ucnv_SBCSToUTF8,
     ucnv_SBCSFromUTF8
 };
 
@@ -479,10 +500,36 @@ static const UConverterImpl _DBCSUTF8Impl={
     NULL,
     ucnv_MBCSGetUnicodeSet,
 
-    NULL,
+    ucnv_DBCSToUTF8,
     ucnv_DBCSFromUTF8
 };
 
+static const UConverterImpl _GB18030UTF8Impl={
+    UCNV_MBCS,
+
+    ucnv_MBCSLoad,
+    ucnv_MBCSUnload,
+
+    ucnv_MBCSOpen,
+    NULL,
+    NULL,
+
+    ucnv_MBCSToUnicodeWithOffsets,
+    ucnv_MBCSToUnicodeWithOffsets,
+    ucnv_MBCSFromUnicodeWithOffsets,
+    ucnv_MBCSFromUnicodeWithOffsets,
+    ucnv_MBCSGetNextUChar,
+
+    ucnv_MBCSGetStarters,
+    ucnv_MBCSGetName,
+    ucnv_MBCSWriteSub,
+    NULL,
+    ucnv_MBCSGetUnicodeSet,
+
+    ucnv_GB18030ToUTF8,
+    ucnv_GB18030FromUTF8
+};
+
 static const UConverterImpl _MBCSImpl={
     UCNV_MBCS,
 
@@ -534,27 +581,105 @@ const UConverterSharedData _MBCSData={
  * the special callback functions below.
  * The values are start & end of Unicode & GB codes.
  *
+ * The ranges are sorted by code point, which also sorts them by GB code,
+ * so that they can be binary-searched in both directions.
+ * The supplementary range is last; it is handled without a search.
+ *
  * Note that single surrogates are not mapped by GB 18030
  * as of the re-released mapping tables from 2000-nov-30.
  */
 static const uint32_t
 gb18030Ranges[14][4]={
-    {0x10000, 0x10FFFF, LINEAR(0x90308130), LINEAR(0xE3329A35)},
-    {0x9FA6, 0xD7FF, LINEAR(0x82358F33), LINEAR(0x8336C738)},
     {0x0452, 0x1E3E, LINEAR(0x8130D330), LINEAR(0x8135F436)},
     {0x1E40, 0x200F, LINEAR(0x8135F438), LINEAR(0x8136A531)},
-    {0xE865, 0xF92B, LINEAR(0x8336D030), LINEAR(0x84308534)},
     {0x2643, 0x2E80, LINEAR(0x8137A839), LINEAR(0x8138FD38)},
-    {0xFA2A, 0xFE2F, LINEAR(0x84309C38), LINEAR(0x84318537)},
-    {0x3CE1, 0x4055, LINEAR(0x8231D438), LINEAR(0x8232AF32)},
     {0x361B, 0x3917, LINEAR(0x8230A633), LINEAR(0x8230F237)},
-    {0x49B8, 0x4C76, LINEAR(0x8234A131), LINEAR(0x8234E733)},
+    {0x3CE1, 0x4055, LINEAR(0x8231D438), LINEAR(0x8232AF32)},
     {0x4160, 0x4336, LINEAR(0x8232C937), LINEAR(0x8232F837)},
-    {0x478E, 0x4946, LINEAR(0x8233E838), LINEAR(0x82349638)},
     {0x44D7, 0x464B, LINEAR(0x8233A339), LINEAR(0x8233C931)},
-    {0xFFE6, 0xFFFF, LINEAR(0x8431A234), LINEAR(0x8431A439)}
+    {0x478E, 0x4946, LINEAR(0x8233E838), LINEAR(0x82349638)},
+    {0x49B8, 0x4C76, LINEAR(0x8234A131), LINEAR(0x8234E733)},
+    {0x9FA6, 0xD7FF, LINEAR(0x82358F33), LINEAR(0x8336C738)},
+    {0xE865, 0xF92B, LINEAR(0x8336D030), LINEAR(0x84308534)},
+    {0xFA2A, 0xFE2F, LINEAR(0x84309C38), LINEAR(0x84318537)},
+    {0xFFE6, 0xFFFF, LINEAR(0x8431A234), LINEAR(0x8431A439)},
+    {0x10000, 0x10FFFF, LINEAR(0x90308130), LINEAR(0xE3329A35)}
 };
 
+#define GB18030_SUPPLEMENTARY_RANGE (UPRV_LENGTHOF(gb18030Ranges)-1)
+
+/*
+ * Returns the range (start and end of Unicode & GB codes) that contains the
+ * value, or NULL if there is none.
+ * @param which 0 to look up a code point, 2 to look up a GB 18030 linear value
+ */
+static const uint32_t *
+gb18030FindRange(uint32_t value, int32_t which) {
+    const uint32_t *range=gb18030Ranges[GB18030_SUPPLEMENTARY_RANGE];
+    int32_t start, limit;
+
+    if(value>=range[which]) {
+        return value<=range[which+1] ? range : NULL;
+    }
+    start=0;
+    limit=GB18030_SUPPLEMENTARY_RANGE;
+    while(start<limit) {
+        int32_t i=(start+limit)/2;
+        range=gb18030Ranges[i];
+        if(value<range[which]) {
+            limit=i;
+        } else if(value>range[which+1]) {
+            start=i+1;
+        } else {
+            return range;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Writes the four-byte sequence for c to bytes[] and returns TRUE
+ * if c is in one of the algorithmic ranges.
+ */
+static UBool
+gb18030FromUnicode(UChar32 c, uint8_t bytes[4]) {
+    const uint32_t *range=gb18030FindRange((uint32_t)c, 0);
+    uint32_t linear;
+
+    if(range==NULL) {
+        return FALSE;
+    }
+
+    /* get the linear value of the first GB 18030 code in this range */
+    linear=range[2]-LINEAR_18030_BASE;
+
+    /* add the offset from the beginning of the range */
+    linear+=((uint32_t)c-range[0]);
+
+    /* turn this into a four-byte sequence */
+    bytes[3]=(uint8_t)(0x30+linear%10); linear/=10;
+    bytes[2]=(uint8_t)(0x81+linear%126); linear/=126;
+    bytes[1]=(uint8_t)(0x30+linear%10); linear/=10;
+    bytes[0]=(uint8_t)(0x81+linear);
+    return TRUE;
+}
+
+/*
+ * Returns the code point for a four-byte sequence
+ * in one of the algorithmic ranges, or a negative value if there is none.
+ */
+static UChar32
+gb18030ToUnicode(const uint8_t bytes[4]) {
+    uint32_t linear=LINEAR_18030(bytes[0], bytes[1], bytes[2], bytes[3]);
+    const uint32_t *range=gb18030FindRange(linear, 2);
+
+    if(range==NULL) {
+        return -1;
+    }
+    /* add the linear difference between the input and start sequences to the start code point */
+    return (UChar32)(range[0]+(linear-range[2]));
+}
+
 /* bit flag for UConverter.options indicating GB 18030 special handling */
 #define _MBCS_OPTION_GB18030 0x8000
 
@@ -1127,34 +1252,14 @@ _extFromU(UConverter *cnv, const UConverterSharedData *sharedData,
 
     /* GB 18030 */
     if((cnv->options&_MBCS_OPTION_GB18030)!=0) {
-        const uint32_t *range;
-        int32_t i;
-
-        range=gb18030Ranges[0];
-        for(i=0; i<UPRV_LENGTHOF(gb18030Ranges); range+=4, ++i) {
-            if(range[0]<=(uint32_t)cp && (uint32_t)cp<=range[1]) {
-                /* found the Unicode code point, output the four-byte sequence for it */
-                uint32_t linear;
-                char bytes[4];
-
-                /* get the linear value of the first GB 18030 code in this range */
-                linear=range[2]-LINEAR_18030_BASE;
-
-                /* add the offset from the beginning of the range */
-                linear+=((uint32_t)cp-range[0]);
-
-                /* turn this into a four-byte sequence */
-                bytes[3]=(char)(0x30+linear%10); linear/=10;
-                bytes[2]=(char)(0x81+linear%126); linear/=126;
-                bytes[1]=(char)(0x30+linear%10); linear/=10;
-                bytes[0]=(char)(0x81+linear);
-
-                /* output this sequence */
-                ucnv_fromUWriteBytes(cnv,
-                                     bytes, 4, (char **)target, (char *)targetLimit,
-                                     offsets, sourceIndex, pErrorCode);
-                return 0;
-            }
+        uint8_t bytes[4];
+
+        if(gb18030FromUnicode(cp, bytes)) {
+            /* found the Unicode code point, output the four-byte sequence for it */
+            ucnv_fromUWriteBytes(cnv,
+                                 (const char *)bytes, 4, (char **)target, (char *)targetLimit,
+                                 offsets, sourceIndex, pErrorCode);
+            return 0;
         }
     }
 
@@ -1192,25 +1297,13 @@ _extToU(UConverter *cnv, const UConverterSharedData *sharedData,
 
     /* GB 18030 */
     if(length==4 && (cnv->options&_MBCS_OPTION_GB18030)!=0) {
-        const uint32_t *range;
-        uint32_t linear;
-        int32_t i;
-
-        linear=LINEAR_18030(cnv->toUBytes[0], cnv->toUBytes[1], cnv->toUBytes[2], cnv->toUBytes[3]);
-        range=gb18030Ranges[0];
-        for(i=0; i<UPRV_LENGTHOF(gb18030Ranges); range+=4, ++i) {
-            if(range[2]<=linear && linear<=range[3]) {
-                /* found the sequence, output the Unicode code point for it */
-                *pErrorCode=U_ZERO_ERROR;
-
-                /* add the linear difference between the input and start sequences to the start code point */
-                linear=range[0]+(linear-range[2]);
+        UChar32 c=gb18030ToUnicode(cnv->toUBytes);
 
-                /* output this code point */
-                ucnv_toUWriteCodePoint(cnv, linear, target, targetLimit, offsets, sourceIndex, pErrorCode);
-
-                return 0;
-            }
+        if(c>=0) {
+            /* found the sequence, output the code point for it */
+            *pErrorCode=U_ZERO_ERROR;
+            ucnv_toUWriteCodePoint(cnv, c, target, targetLimit, offsets, sourceIndex, pErrorCode);
+            return 0;
         }
     }
 
@@ -1551,6 +1644,49 @@ reconstituteData(UConverterMBCSTable *mbcsTable,
 
 /* MBCS setup functions ----------------------------------------------------- */
 
+/*
+ * Build flat tables for SBCS converters with only BMP mappings,
+ * so that the most common bytes and characters are converted with
+ * a single lookup each, and in runs of 16 units.
+ */
+static void
+buildSBCSFlatTables(UConverterMBCSTable *mbcsTable, UErrorCode *pErrorCode) {
+    const uint16_t *table, *results;
+    uint16_t *flat;
+    int32_t entry;
+    uint8_t action;
+    UChar32 c;
+
+    flat=(uint16_t *)uprv_malloc(0x200*2);
+    if(flat==NULL) {
+        *pErrorCode=U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+
+    /* toUnicode: direct roundtrips and fallbacks (toUnicode always uses fallbacks) */
+    for(c=0; c<=0xff; ++c) {
+        entry=mbcsTable->stateTable[0][c];
+        action=(uint8_t)(MBCS_ENTRY_FINAL_ACTION(entry));
+        if(action==MBCS_STATE_VALID_DIRECT_16 || action==MBCS_STATE_FALLBACK_DIRECT_16) {
+            flat[c]=(uint16_t)MBCS_ENTRY_FINAL_VALUE_16(entry);
+            if(flat[c]>0xfffe) {
+                flat[c]=0xfffe;
+            }
+        } else {
+            flat[c]=0xfffe;
+        }
+    }
+
+    /* fromUnicode: the stage 3 results for Latin-1 */
+    table=mbcsTable->fromUnicodeTable;
+    results=(const uint16_t *)mbcsTable->fromUnicodeBytes;
+    for(c=0; c<=0xff; ++c) {
+        flat[0x100+c]=MBCS_SINGLE_RESULT_FROM_U(table, results, c);
+    }
+
+    mbcsTable->sbcsFlatTables=flat;
+}
+
 static void U_CALLCONV
 ucnv_MBCSLoad(UConverterSharedData *sharedData,
           UConverterLoadArgs *pArgs,
@@ -1666,6 +1802,7 @@ ucnv_MBCSLoad(UConverterSharedData *sharedData,
          * is unloaded.
          */
         mbcsTable->reconstitutedData=NULL;
+        mbcsTable->sbcsFlatTables=NULL;
 
         /*
          * Set a special, runtime-only outputType if the extension converter
@@ -1854,6 +1991,12 @@ ucnv_MBCSLoad(UConverterSharedData *sharedData,
                 stage1Length/2;
             reconstituteData(mbcsTable, stage1Length, stage2Length, header->fullStage2Length, pErrorCode);
         }
+
+        if( U_SUCCESS(*pErrorCode) &&
+            mbcsTable->countStates==1 && !(mbcsTable->unicodeMask&UCNV_HAS_SUPPLEMENTARY)
+        ) {
+            buildSBCSFlatTables(mbcsTable, pErrorCode);
+        }
     }
 
     /* Set the impl pointer here so that it is set for both extension-only and base tables. */
@@ -1863,6 +2006,11 @@ ucnv_MBCSLoad(UConverterSharedData *sharedData,
         } else {
             if(mbcsTable->outputType==MBCS_OUTPUT_2) {
                 sharedData->impl=&_DBCSUTF8Impl;
+            } else if(mbcsTable->outputType==MBCS_OUTPUT_4 &&
+                      (uprv_strstr(sharedData->staticData->name, "gb18030")!=NULL ||
+                       uprv_strstr(sharedData->staticData->name, "GB18030")!=NULL)) {
+                /* same test as for _MBCS_OPTION_GB18030 in ucnv_MBCSOpen() */
+                sharedData->impl=&_GB18030UTF8Impl;
             }
         }
     }
@@ -1892,6 +2040,9 @@ ucnv_MBCSUnload(UConverterSharedData *sharedData) {
     if(mbcsTable->reconstitutedData!=NULL) {
         uprv_free(mbcsTable->reconstitutedData);
     }
+    if(mbcsTable->sbcsFlatTables!=NULL) {
+        uprv_free(mbcsTable->sbcsFlatTables);
+    }
 }
 
 static void U_CALLCONV
@@ -2149,7 +2300,15 @@ ucnv_MBCSSingleToUnicodeWithOffsets(UConverterToUnicodeArgs *pArgs,
 
         if(U_FAILURE(*pErrorCode)) {
             /* callback(illegal) */
-            break;
+            if(!UCNV_TO_U_INLINE_FFFD(cnv)) {
+                break;
+            }
+            *pErrorCode=U_ZERO_ERROR;
+            *target++=0xfffd;
+            if(offsets!=NULL) {
+                *offsets++=sourceIndex;
+            }
+            ++sourceIndex;
         } else /* unassigned sequences indicated with byteIndex>0 */ {
             /* try an extension mapping */
             pArgs->source=(const char *)source;
@@ -2160,6 +2319,11 @@ ucnv_MBCSSingleToUnicodeWithOffsets(UConverterToUnicodeArgs *pArgs,
                                     &offsets, sourceIndex,
                                     pArgs->flush,
                                     pErrorCode);
+            if(*pErrorCode==U_INVALID_CHAR_FOUND && UCNV_TO_U_INLINE_FFFD(cnv)) {
+                *pErrorCode=U_ZERO_ERROR;
+                cnv->toULength=0;
+                ucnv_toUWriteCodePoint(cnv, 0xfffd, &target, targetLimit, &offsets, sourceIndex, pErrorCode);
+            }
             sourceIndex+=1+(int32_t)(source-(const uint8_t *)pArgs->source);
 
             if(U_FAILURE(*pErrorCode)) {
@@ -2191,6 +2355,7 @@ ucnv_MBCSSingleToBMPWithOffsets(UConverterToUnicodeArgs *pArgs,
     int32_t *offsets;
 
     const int32_t (*stateTable)[256];
+    const uint16_t *toUTable;
 
     int32_t sourceIndex;
 
@@ -2207,8 +2372,10 @@ ucnv_MBCSSingleToBMPWithOffsets(UConverterToUnicodeArgs *pArgs,
 
     if((cnv->options&UCNV_OPTION_SWAP_LFNL)!=0) {
         stateTable=(const int32_t (*)[256])cnv->sharedData->mbcs.swapLFNLStateTable;
+        toUTable=NULL;
     } else {
         stateTable=cnv->sharedData->mbcs.stateTable;
+        toUTable=cnv->sharedData->mbcs.sbcsFlatTables;
     }
 
     /* sourceIndex=-1 if the current character began in the previous buffer */
@@ -2232,48 +2399,71 @@ unrolled:
         int32_t count, loops, oredEntries;
 
         loops=count=targetCapacity>>4;
-        do {
-            oredEntries=entry=stateTable[0][*source++];
-            *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
-            oredEntries|=entry=stateTable[0][*source++];
-            *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
-            oredEntries|=entry=stateTable[0][*source++];
-            *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
-            oredEntries|=entry=stateTable[0][*source++];
-            *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
-            oredEntries|=entry=stateTable[0][*source++];
-            *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
-            oredEntries|=entry=stateTable[0][*source++];
-            *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
-            oredEntries|=entry=stateTable[0][*source++];
-            *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
-            oredEntries|=entry=stateTable[0][*source++];
-            *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
-            oredEntries|=entry=stateTable[0][*source++];
-            *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
-            oredEntries|=entry=stateTable[0][*source++];
-            *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
-            oredEntries|=entry=stateTable[0][*source++];
-            *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
-            oredEntries|=entry=stateTable[0][*source++];
-            *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
-            oredEntries|=entry=stateTable[0][*source++];
-            *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
-            oredEntries|=entry=stateTable[0][*source++];
-            *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
-            oredEntries|=entry=stateTable[0][*source++];
-            *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
-            oredEntries|=entry=stateTable[0][*source++];
-            *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
+        if(toUTable!=NULL) {
+            /*
+             * Look up 16 bytes at a time in the flat table.
+             * There is no gather instruction in the baseline instruction sets,
+             * but the independent loads pipeline well, and one test
+             * per 16 bytes catches both unassigned and illegal bytes.
+             */
+            do {
+                uint32_t oredValues=0;
+                int32_t i;
+                for(i=0; i<16; ++i) {
+                    UChar u=toUTable[source[i]];
+                    target[i]=u;
+                    oredValues|=(uint32_t)u+2; /* >0xffff for 0xfffe: not direct */
+                }
+                if(oredValues>0xffff) {
+                    break;
+                }
+                source+=16;
+                target+=16;
+            } while(--count>0);
+        } else {
+            do {
+                oredEntries=entry=stateTable[0][*source++];
+                *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
+                oredEntries|=entry=stateTable[0][*source++];
+                *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
+                oredEntries|=entry=stateTable[0][*source++];
+                *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
+                oredEntries|=entry=stateTable[0][*source++];
+                *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
+                oredEntries|=entry=stateTable[0][*source++];
+                *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
+                oredEntries|=entry=stateTable[0][*source++];
+                *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
+                oredEntries|=entry=stateTable[0][*source++];
+                *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
+                oredEntries|=entry=stateTable[0][*source++];
+                *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
+                oredEntries|=entry=stateTable[0][*source++];
+                *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
+                oredEntries|=entry=stateTable[0][*source++];
+                *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
+                oredEntries|=entry=stateTable[0][*source++];
+                *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
+                oredEntries|=entry=stateTable[0][*source++];
+                *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
+                oredEntries|=entry=stateTable[0][*source++];
+                *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
+                oredEntries|=entry=stateTable[0][*source++];
+                *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
+                oredEntries|=entry=stateTable[0][*source++];
+                *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
+                oredEntries|=entry=stateTable[0][*source++];
+                *target++=(UChar)MBCS_ENTRY_FINAL_VALUE_16(entry);
 
-            /* were all 16 entries really valid? */
-            if(!MBCS_ENTRY_FINAL_IS_VALID_DIRECT_16(oredEntries)) {
-                /* no, return to the first of these 16 */
-                source-=16;
-                target-=16;
-                break;
-            }
-        } while(--count>0);
+                /* were all 16 entries really valid? */
+                if(!MBCS_ENTRY_FINAL_IS_VALID_DIRECT_16(oredEntries)) {
+                    /* no, return to the first of these 16 */
+                    source-=16;
+                    target-=16;
+                    break;
+                }
+            } while(--count>0);
+        }
         count=loops-count;
         targetCapacity-=16*count;
 
@@ -2350,7 +2540,17 @@ unrolled:
 
         if(U_FAILURE(*pErrorCode)) {
             /* callback(illegal) */
-            break;
+            if(!UCNV_TO_U_INLINE_FFFD(cnv)) {
+                break;
+            }
+            *pErrorCode=U_ZERO_ERROR;
+            lastSource=source;
+            *target++=0xfffd;
+            --targetCapacity;
+            if(offsets!=NULL) {
+                *offsets++=sourceIndex;
+            }
+            ++sourceIndex;
         } else /* unassigned sequences indicated with byteIndex>0 */ {
             /* try an extension mapping */
             lastSource=source;
@@ -2361,6 +2561,11 @@ unrolled:
                                     &offsets, sourceIndex,
                                     pArgs->flush,
                                     pErrorCode);
+            if(*pErrorCode==U_INVALID_CHAR_FOUND && UCNV_TO_U_INLINE_FFFD(cnv)) {
+                *pErrorCode=U_ZERO_ERROR;
+                cnv->toULength=0;
+                ucnv_toUWriteCodePoint(cnv, 0xfffd, &target, pArgs->targetLimit, &offsets, sourceIndex, pErrorCode);
+            }
             sourceIndex+=1+(int32_t)(source-lastSource);
 
             if(U_FAILURE(*pErrorCode)) {
@@ -2835,6 +3040,7 @@ ucnv_MBCSToUnicodeWithOffsets(UConverterToUnicodeArgs *pArgs,
                     byteIndex=i;  /* length of reported illegal byte sequence */
                     if(backOutDistance<=bytesFromThisBuffer) {
                         source-=backOutDistance;
+                        nextSourceIndex-=backOutDistance;
                     } else {
                         /* Back out bytes from the previous buffer: Need to replay them. */
                         cnv->preToULength=(int8_t)(bytesFromThisBuffer-backOutDistance);
@@ -2844,7 +3050,17 @@ ucnv_MBCSToUnicodeWithOffsets(UConverterToUnicodeArgs *pArgs,
                     }
                 }
             }
-            break;
+            if(!UCNV_TO_U_INLINE_FFFD(cnv) || cnv->preToULength<0) {
+                break;
+            }
+            /* nothing was written for this sequence, so there is room */
+            *pErrorCode=U_ZERO_ERROR;
+            *target++=0xfffd;
+            if(offsets!=NULL) {
+                *offsets++=sourceIndex;
+            }
+            byteIndex=0;
+            sourceIndex=nextSourceIndex;
         } else /* unassigned sequences indicated with byteIndex>0 */ {
             /* try an extension mapping */
             pArgs->source=(const char *)source;
@@ -2854,6 +3070,11 @@ ucnv_MBCSToUnicodeWithOffsets(UConverterToUnicodeArgs *pArgs,
                               &offsets, sourceIndex,
                               pArgs->flush,
                               pErrorCode);
+            if(*pErrorCode==U_INVALID_CHAR_FOUND && UCNV_TO_U_INLINE_FFFD(cnv)) {
+                *pErrorCode=U_ZERO_ERROR;
+                byteIndex=0;
+                ucnv_toUWriteCodePoint(cnv, 0xfffd, &target, targetLimit, &offsets, sourceIndex, pErrorCode);
+            }
             sourceIndex=nextSourceIndex+=(int32_t)(source-(const uint8_t *)pArgs->source);
 
             if(U_FAILURE(*pErrorCode)) {
@@ -3814,13 +4035,14 @@ static void
 ucnv_MBCSSingleFromBMPWithOffsets(UConverterFromUnicodeArgs *pArgs,
                               UErrorCode *pErrorCode) {
     UConverter *cnv;
-    const UChar *source, *sourceLimit, *lastSource;
+    const UChar *source, *sourceLimit, *lastSource, *latin1Probe;
     uint8_t *target;
     int32_t targetCapacity, length;
     int32_t *offsets;
 
     const uint16_t *table;
     const uint16_t *results;
+    const uint16_t *fromLatin1;
 
     UChar32 c;
 
@@ -3840,8 +4062,13 @@ ucnv_MBCSSingleFromBMPWithOffsets(UConverterFromUnicodeArgs *pArgs,
     table=cnv->sharedData->mbcs.fromUnicodeTable;
     if((cnv->options&UCNV_OPTION_SWAP_LFNL)!=0) {
         results=(uint16_t *)cnv->sharedData->mbcs.swapLFNLFromUnicodeBytes;
+        fromLatin1=NULL;
     } else {
         results=(uint16_t *)cnv->sharedData->mbcs.fromUnicodeBytes;
+        fromLatin1=cnv->sharedData->mbcs.sbcsFlatTables;
+        if(fromLatin1!=NULL) {
+            fromLatin1+=0x100;
+        }
     }
     asciiRoundtrips=cnv->sharedData->mbcs.asciiRoundtrips;
 
@@ -3858,7 +4085,7 @@ ucnv_MBCSSingleFromBMPWithOffsets(UConverterFromUnicodeArgs *pArgs,
 
     /* sourceIndex=-1 if the current character began in the previous buffer */
     sourceIndex= c==0 ? 0 : -1;
-    lastSource=source;
+    lastSource=latin1Probe=source;
 
     /*
      * since the conversion here is 1:1 UChar:uint8_t, we need only one counter
@@ -3924,6 +4151,41 @@ unrolled:
 #endif
 
     while(targetCapacity>0) {
+        if(fromLatin1!=NULL && targetCapacity>=16 && source>=latin1Probe) {
+            /*
+             * Convert runs of Latin-1 characters 16 at a time
+             * with one lookup each in the flat table.
+             * If a block has other characters or unmappable ones, then
+             * convert it one by one before probing again.
+             * The offsets are set lazily, as for the loop below.
+             */
+            do {
+                UChar oredChars=0;
+                uint16_t andedValues=0xffff;
+                int32_t i;
+                for(i=0; i<16; ++i) {
+                    oredChars|=source[i];
+                }
+                if(oredChars>0xff) {
+                    break;
+                }
+                for(i=0; i<16; ++i) {
+                    andedValues&=value=fromLatin1[source[i]];
+                    target[i]=(uint8_t)value;
+                }
+                if(andedValues<minValue) {
+                    break;
+                }
+                source+=16;
+                target+=16;
+                targetCapacity-=16;
+            } while(targetCapacity>=16);
+            latin1Probe=source+16;
+            if(targetCapacity==0) {
+                break;
+            }
+        }
+
         /*
          * Get a correct Unicode code point:
          * a single UChar for a BMP code point or
@@ -3942,7 +4204,11 @@ unrolled:
             c=0;
             continue;
         }
-        value=MBCS_SINGLE_RESULT_FROM_U(table, results, c);
+        if(c<=0xff && fromLatin1!=NULL) {
+            value=fromLatin1[c];
+        } else {
+            value=MBCS_SINGLE_RESULT_FROM_U(table, results, c);
+        }
         /* is this code point assigned, or do we use fallbacks? */
         if(value>=minValue) {
             /* assigned, write the output character bytes from value and length */
@@ -5622,6 +5888,160 @@ unassigned:
     pFromUArgs->target=(char *)target;
 }
 
+/*
+ * Convert UTF-8 to GB 18030 without pivoting through UTF-16.
+ * Code points that are not in the main table are looked up in the
+ * algorithmic four-byte ranges.
+ * Everything else, including extension mappings, ill-formed or truncated
+ * UTF-8 and target overflows in the middle of a character,
+ * falls back to the pivoting implementation.
+ */
+static void U_CALLCONV
+ucnv_GB18030FromUTF8(UConverterFromUnicodeArgs *pFromUArgs,
+                     UConverterToUnicodeArgs *pToUArgs,
+                     UErrorCode *pErrorCode) {
+    UConverter *utf8, *cnv;
+    const uint8_t *source, *sourceLimit;
+    uint8_t *target;
+    int32_t targetCapacity, length, i;
+
+    const uint16_t *table, *mbcsIndex;
+    const uint32_t *results;
+    uint32_t asciiRoundtrips, stage2Entry, value;
+    UBool hasSupplementary;
+
+    uint8_t bytes[4];
+    UChar32 c;
+
+    utf8=pToUArgs->converter;
+    cnv=pFromUArgs->converter;
+    if( utf8->toULength>0 || cnv->fromUChar32!=0 ||
+        (cnv->options&(_MBCS_OPTION_GB18030|UCNV_OPTION_SWAP_LFNL))!=_MBCS_OPTION_GB18030
+    ) {
+        /* no handling of partial characters here, fall back to pivoting */
+        *pErrorCode=U_USING_DEFAULT_WARNING;
+        return;
+    }
+
+    /* set up the local pointers */
+    source=(const uint8_t *)pToUArgs->source;
+    sourceLimit=(const uint8_t *)pToUArgs->sourceLimit;
+    target=(uint8_t *)pFromUArgs->target;
+    targetCapacity=(int32_t)(pFromUArgs->targetLimit-pFromUArgs->target);
+
+    table=cnv->sharedData->mbcs.fromUnicodeTable;
+    mbcsIndex=cnv->sharedData->mbcs.mbcsIndex;
+    results=(const uint32_t *)cnv->sharedData->mbcs.fromUnicodeBytes;
+    asciiRoundtrips=cnv->sharedData->mbcs.asciiRoundtrips;
+    hasSupplementary=(UBool)(cnv->sharedData->mbcs.unicodeMask&UCNV_HAS_SUPPLEMENTARY);
+
+    /* conversion loop */
+    while(source<sourceLimit) {
+        if(targetCapacity==0) {
+            /* target is full */
+            *pErrorCode=U_BUFFER_OVERFLOW_ERROR;
+            break;
+        }
+
+        c=*source;
+        if(U8_IS_SINGLE(c) && IS_ASCII_ROUNDTRIP(c, asciiRoundtrips)) {
+            ++source;
+            *target++=(uint8_t)c;
+            --targetCapacity;
+            if(asciiRoundtrips==0xffffffff) {
+                /* all ASCII characters map to themselves: copy the following ASCII run in bulk */
+                length=(int32_t)(sourceLimit-source);
+                if(length>targetCapacity) {
+                    length=targetCapacity;
+                }
+                length=uprv_asciiSpan(source, length);
+                uprv_memcpy(target, source, length);
+                source+=length;
+                target+=length;
+                targetCapacity-=length;
+            }
+            continue;
+        }
+
+        i=0;
+        length=(int32_t)(sourceLimit-source);
+        U8_NEXT(source, i, length, c);
+        if(c<0) {
+            /* ill-formed or truncated sequence: fall back to the pivoting implementation */
+            *pErrorCode=U_USING_DEFAULT_WARNING;
+            break;
+        }
+
+        /*
+         * utf8Friendly table: The mbcsIndex covers U+0000..U+D7FF
+         * and contains only roundtrips (!=0) and no-mapping (==0) entries.
+         */
+        if(c<=0xd7ff) {
+            value=results[mbcsIndex[c>>6]+(c&0x3f)];
+        } else if(c<=0xffff || hasSupplementary) {
+            stage2Entry=MBCS_STAGE_2_FROM_U(table, c);
+            value=MBCS_VALUE_4_FROM_STAGE_2(results, stage2Entry, c);
+            if(!(MBCS_FROM_U_IS_ROUNDTRIP(stage2Entry, c) ||
+                 (UCNV_FROM_U_USE_FALLBACK(cnv, c) && value!=0))
+            ) {
+                value=0;
+            }
+        } else {
+            value=0;
+        }
+
+        if(value!=0) {
+            if(value<=0xff) {
+                length=1;
+            } else if(value<=0xffff) {
+                length=2;
+            } else if(value<=0xffffff) {
+                length=3;
+            } else {
+                length=4;
+            }
+            if(length>targetCapacity) {
+                /* partial-character target overflow: fall back to the pivoting implementation */
+                *pErrorCode=U_USING_DEFAULT_WARNING;
+                break;
+            }
+            switch(length) {
+            case 4:
+                *target++=(uint8_t)(value>>24);
+                U_FALLTHROUGH;
+            case 3:
+                *target++=(uint8_t)(value>>16);
+                U_FALLTHROUGH;
+            case 2:
+                *target++=(uint8_t)(value>>8);
+                U_FALLTHROUGH;
+            default:
+                *target++=(uint8_t)value;
+                break;
+            }
+        } else if(gb18030FromUnicode(c, bytes)) {
+            length=4;
+            if(length>targetCapacity) {
+                /* partial-character target overflow: fall back to the pivoting implementation */
+                *pErrorCode=U_USING_DEFAULT_WARNING;
+                break;
+            }
+            uprv_memcpy(target, bytes, 4);
+            target+=4;
+        } else {
+            /* extension mapping or unmappable code point */
+            *pErrorCode=U_USING_DEFAULT_WARNING;
+            break;
+        }
+        source+=i;
+        targetCapacity-=length;
+    }
+
+    /* write back the updated pointers */
+    pToUArgs->source=(const char *)source;
+    pFromUArgs->target=(char *)target;
+}
+
 /* miscellaneous ------------------------------------------------------------ */
 
 static void U_CALLCONV
@@ -5638,6 +6058,363 @@ ucnv_MBCSGetStarters(const UConverter* cnv,
     }
 }
 
+/* MBCS-to-UTF-8 conversion functions --------------------------------------- */
+
+/*
+ * Write the UTF-8 form of c to target if it fits into targetCapacity.
+ * Returns the number of bytes written, or 0 if c does not fit.
+ */
+static inline int32_t
+writeUTF8(uint8_t *target, int32_t targetCapacity, UChar32 c) {
+    int32_t length=0;
+    if(U8_LENGTH(c)>targetCapacity) {
+        return 0;
+    }
+    U8_APPEND_UNSAFE(target, length, c);
+    return length;
+}
+
+/*
+ * Convert SBCS to UTF-8 without pivoting through UTF-16.
+ * Unassigned and illegal bytes, and target overflows in the middle of a
+ * UTF-8 sequence, fall back to the pivoting implementation
+ * which calls the extension and the callbacks.
+ */
+static void U_CALLCONV
+ucnv_SBCSToUTF8(UConverterFromUnicodeArgs *pFromUArgs,
+                UConverterToUnicodeArgs *pToUArgs,
+                UErrorCode *pErrorCode) {
+    UConverter *cnv;
+    const uint8_t *source, *sourceLimit;
+    uint8_t *target;
+    int32_t targetCapacity, length;
+
+    const int32_t (*stateTable)[256];
+    uint32_t asciiRoundtrips;
+
+    int32_t entry;
+    UChar32 c;
+    uint8_t action;
+
+    cnv=pToUArgs->converter;
+    if(cnv->toULength>0 || pFromUArgs->converter->fromUChar32!=0) {
+        /* no handling of partial characters here, fall back to pivoting */
+        *pErrorCode=U_USING_DEFAULT_WARNING;
+        return;
+    }
+
+    /* set up the local pointers */
+    source=(const uint8_t *)pToUArgs->source;
+    sourceLimit=(const uint8_t *)pToUArgs->sourceLimit;
+    target=(uint8_t *)pFromUArgs->target;
+    targetCapacity=(int32_t)(pFromUArgs->targetLimit-pFromUArgs->target);
+
+    if((cnv->options&UCNV_OPTION_SWAP_LFNL)!=0) {
+        stateTable=(const int32_t (*)[256])cnv->sharedData->mbcs.swapLFNLStateTable;
+    } else {
+        stateTable=cnv->sharedData->mbcs.stateTable;
+    }
+    asciiRoundtrips=cnv->sharedData->mbcs.asciiRoundtrips;
+
+    /* conversion loop */
+    while(source<sourceLimit) {
+        if(targetCapacity==0) {
+            /* target is full */
+            *pErrorCode=U_BUFFER_OVERFLOW_ERROR;
+            break;
+        }
+
+        entry=stateTable[0][*source];
+        /* MBCS_ENTRY_IS_FINAL(entry) */
+
+        /* test the most common case first */
+        if(MBCS_ENTRY_FINAL_IS_VALID_DIRECT_16(entry) &&
+                (c=MBCS_ENTRY_FINAL_VALUE_16(entry))<=0x7f) {
+            ++source;
+            *target++=(uint8_t)c;
+            --targetCapacity;
+            if(asciiRoundtrips==0xffffffff) {
+                /* all ASCII bytes map to themselves: copy the following ASCII run in bulk */
+                length=(int32_t)(sourceLimit-source);
+                if(length>targetCapacity) {
+                    length=targetCapacity;
+                }
+                length=uprv_asciiSpan(source, length);
+                uprv_memcpy(target, source, length);
+                source+=length;
+                target+=length;
+                targetCapacity-=length;
+            }
+            continue;
+        }
+
+        action=(uint8_t)(MBCS_ENTRY_FINAL_ACTION(entry));
+        if(action==MBCS_STATE_VALID_DIRECT_16 || action==MBCS_STATE_FALLBACK_DIRECT_16) {
+            c=MBCS_ENTRY_FINAL_VALUE_16(entry);
+        } else if(action==MBCS_STATE_VALID_DIRECT_20 || action==MBCS_STATE_FALLBACK_DIRECT_20) {
+            c=(UChar32)(MBCS_ENTRY_FINAL_VALUE(entry)+0x10000);
+        } else {
+            /* unassigned or illegal byte: fall back to the pivoting implementation */
+            *pErrorCode=U_USING_DEFAULT_WARNING;
+            break;
+        }
+
+        if((length=writeUTF8(target, targetCapacity, c))==0) {
+            /* partial-sequence target overflow: fall back to the pivoting implementation */
+            *pErrorCode=U_USING_DEFAULT_WARNING;
+            break;
+        }
+        ++source;
+        target+=length;
+        targetCapacity-=length;
+    }
+
+    /* write back the updated pointers */
+    pToUArgs->source=(const char *)source;
+    pFromUArgs->target=(char *)target;
+}
+
+/*
+ * Convert DBCS (one or two bytes per character) to UTF-8
+ * without pivoting through UTF-16.
+ * Only characters that start and end in the initial state are handled here;
+ * everything else, including unassigned and illegal sequences,
+ * falls back to the pivoting implementation.
+ */
+static void U_CALLCONV
+ucnv_DBCSToUTF8(UConverterFromUnicodeArgs *pFromUArgs,
+                UConverterToUnicodeArgs *pToUArgs,
+                UErrorCode *pErrorCode) {
+    UConverter *cnv;
+    const uint8_t *source, *sourceLimit;
+    uint8_t *target;
+    int32_t targetCapacity, length;
+
+    const int32_t (*stateTable)[256];
+    const uint16_t *unicodeCodeUnits;
+    uint32_t asciiRoundtrips;
+
+    int32_t entry, byteLength;
+    UChar32 c;
+    uint8_t action;
+
+    cnv=pToUArgs->converter;
+    if( cnv->toULength>0 || cnv->mode!=0 || cnv->sharedData->mbcs.dbcsOnlyState!=0 ||
+        pFromUArgs->converter->fromUChar32!=0
+    ) {
+        /* no handling of partial characters or non-initial states here, fall back to pivoting */
+        *pErrorCode=U_USING_DEFAULT_WARNING;
+        return;
+    }
+
+    /* set up the local pointers */
+    source=(const uint8_t *)pToUArgs->source;
+    sourceLimit=(const uint8_t *)pToUArgs->sourceLimit;
+    target=(uint8_t *)pFromUArgs->target;
+    targetCapacity=(int32_t)(pFromUArgs->targetLimit-pFromUArgs->target);
+
+    if((cnv->options&UCNV_OPTION_SWAP_LFNL)!=0) {
+        stateTable=(const int32_t (*)[256])cnv->sharedData->mbcs.swapLFNLStateTable;
+    } else {
+        stateTable=cnv->sharedData->mbcs.stateTable;
+    }
+    unicodeCodeUnits=cnv->sharedData->mbcs.unicodeCodeUnits;
+    asciiRoundtrips=cnv->sharedData->mbcs.asciiRoundtrips;
+
+    /* conversion loop */
+    while(source<sourceLimit) {
+        if(targetCapacity==0) {
+            /* target is full */
+            *pErrorCode=U_BUFFER_OVERFLOW_ERROR;
+            break;
+        }
+
+        entry=stateTable[0][*source];
+        if(MBCS_ENTRY_IS_TRANSITION(entry)) {
+            /* lead byte */
+            uint32_t offset;
+
+            if((sourceLimit-source)<2) {
+                /* let the pivoting implementation collect the truncated sequence */
+                *pErrorCode=U_USING_DEFAULT_WARNING;
+                break;
+            }
+            offset=MBCS_ENTRY_TRANSITION_OFFSET(entry);
+            entry=stateTable[MBCS_ENTRY_TRANSITION_STATE(entry)][source[1]];
+            if( MBCS_ENTRY_IS_FINAL(entry) &&
+                MBCS_ENTRY_FINAL_STATE(entry)==0 &&
+                MBCS_ENTRY_FINAL_ACTION(entry)==MBCS_STATE_VALID_16 &&
+                (c=unicodeCodeUnits[offset+MBCS_ENTRY_FINAL_VALUE_16(entry)])<0xfffe
+            ) {
+                byteLength=2;
+            } else {
+                /* unassigned, illegal, fallback or other complicated sequence */
+                *pErrorCode=U_USING_DEFAULT_WARNING;
+                break;
+            }
+        } else if(MBCS_ENTRY_FINAL_STATE(entry)==0 &&
+                  ((action=(uint8_t)(MBCS_ENTRY_FINAL_ACTION(entry)))==MBCS_STATE_VALID_DIRECT_16 ||
+                   action==MBCS_STATE_FALLBACK_DIRECT_16)) {
+            c=MBCS_ENTRY_FINAL_VALUE_16(entry);
+            if(c<=0x7f) {
+                ++source;
+                *target++=(uint8_t)c;
+                --targetCapacity;
+                if(asciiRoundtrips==0xffffffff) {
+                    /* all ASCII bytes map to themselves: copy the following ASCII run in bulk */
+                    length=(int32_t)(sourceLimit-source);
+                    if(length>targetCapacity) {
+                        length=targetCapacity;
+                    }
+                    length=uprv_asciiSpan(source, length);
+                    uprv_memcpy(target, source, length);
+                    source+=length;
+                    target+=length;
+                    targetCapacity-=length;
+                }
+                continue;
+            }
+            byteLength=1;
+        } else {
+            /* unassigned or illegal byte, or a state change */
+            *pErrorCode=U_USING_DEFAULT_WARNING;
+            break;
+        }
+
+        if((length=writeUTF8(target, targetCapacity, c))==0) {
+            /* partial-sequence target overflow: fall back to the pivoting implementation */
+            *pErrorCode=U_USING_DEFAULT_WARNING;
+            break;
+        }
+        source+=byteLength;
+        target+=length;
+        targetCapacity-=length;
+    }
+
+    /* write back the updated pointers */
+    pToUArgs->source=(const char *)source;
+    pFromUArgs->target=(char *)target;
+}
+
+/*
+ * Convert GB 18030 to UTF-8 without pivoting through UTF-16.
+ * Four-byte sequences that are not in the main table are looked up in the
+ * algorithmic ranges.
+ * Everything else, including extension mappings, unassigned, illegal and
+ * truncated sequences, falls back to the pivoting implementation.
+ */
+static void U_CALLCONV
+ucnv_GB18030ToUTF8(UConverterFromUnicodeArgs *pFromUArgs,
+                   UConverterToUnicodeArgs *pToUArgs,
+                   UErrorCode *pErrorCode) {
+    UConverter *cnv;
+    const uint8_t *source, *sourceLimit;
+    uint8_t *target;
+    int32_t targetCapacity, length;
+
+    const int32_t (*stateTable)[256];
+    const uint16_t *unicodeCodeUnits;
+    uint32_t asciiRoundtrips, offset;
+    UBool hasToUFallbacks;
+
+    int32_t entry, byteLength;
+    UChar32 c;
+    uint8_t action;
+
+    cnv=pToUArgs->converter;
+    if( cnv->toULength>0 || pFromUArgs->converter->fromUChar32!=0 ||
+        (cnv->options&(_MBCS_OPTION_GB18030|UCNV_OPTION_SWAP_LFNL))!=_MBCS_OPTION_GB18030
+    ) {
+        /* no handling of partial characters here, fall back to pivoting */
+        *pErrorCode=U_USING_DEFAULT_WARNING;
+        return;
+    }
+
+    /* set up the local pointers */
+    source=(const uint8_t *)pToUArgs->source;
+    sourceLimit=(const uint8_t *)pToUArgs->sourceLimit;
+    target=(uint8_t *)pFromUArgs->target;
+    targetCapacity=(int32_t)(pFromUArgs->targetLimit-pFromUArgs->target);
+
+    stateTable=cnv->sharedData->mbcs.stateTable;
+    unicodeCodeUnits=cnv->sharedData->mbcs.unicodeCodeUnits;
+    asciiRoundtrips=cnv->sharedData->mbcs.asciiRoundtrips;
+    hasToUFallbacks=(UBool)(cnv->sharedData->mbcs.countToUFallbacks!=0);
+
+    /* conversion loop */
+    while(source<sourceLimit) {
+        if(targetCapacity==0) {
+            /* target is full */
+            *pErrorCode=U_BUFFER_OVERFLOW_ERROR;
+            break;
+        }
+
+        entry=stateTable[0][*source];
+        if( MBCS_ENTRY_FINAL_IS_VALID_DIRECT_16(entry) &&
+            (c=MBCS_ENTRY_FINAL_VALUE_16(entry))<=0x7f
+        ) {
+            ++source;
+            *target++=(uint8_t)c;
+            --targetCapacity;
+            if(asciiRoundtrips==0xffffffff) {
+                /* all ASCII bytes map to themselves: copy the following ASCII run in bulk */
+                length=(int32_t)(sourceLimit-source);
+                if(length>targetCapacity) {
+                    length=targetCapacity;
+                }
+                length=uprv_asciiSpan(source, length);
+                uprv_memcpy(target, source, length);
+                source+=length;
+                target+=length;
+                targetCapacity-=length;
+            }
+            continue;
+        }
+
+        /* follow the state transitions through the rest of the byte sequence */
+        offset=0;
+        byteLength=1;
+        while(MBCS_ENTRY_IS_TRANSITION(entry) && byteLength<(sourceLimit-source)) {
+            offset+=MBCS_ENTRY_TRANSITION_OFFSET(entry);
+            entry=stateTable[MBCS_ENTRY_TRANSITION_STATE(entry)][source[byteLength++]];
+        }
+        c=-1;
+        if(MBCS_ENTRY_IS_FINAL(entry) && MBCS_ENTRY_FINAL_STATE(entry)==0) {
+            action=(uint8_t)(MBCS_ENTRY_FINAL_ACTION(entry));
+            if(action==MBCS_STATE_VALID_DIRECT_16 || action==MBCS_STATE_FALLBACK_DIRECT_16) {
+                c=MBCS_ENTRY_FINAL_VALUE_16(entry);
+            } else if(action==MBCS_STATE_VALID_16) {
+                c=unicodeCodeUnits[offset+MBCS_ENTRY_FINAL_VALUE_16(entry)];
+            } else if(action==MBCS_STATE_UNASSIGNED) {
+                c=0xfffe;
+            }
+            if(c==0xfffe && byteLength==4 && !hasToUFallbacks) {
+                c=gb18030ToUnicode(source);
+            } else if(c>=0xfffe) {
+                c=-1;
+            }
+        }
+        if(c<0) {
+            /* truncated, unassigned, illegal or otherwise complicated sequence */
+            *pErrorCode=U_USING_DEFAULT_WARNING;
+            break;
+        }
+
+        if((length=writeUTF8(target, targetCapacity, c))==0) {
+            /* partial-sequence target overflow: fall back to the pivoting implementation */
+            *pErrorCode=U_USING_DEFAULT_WARNING;
+            break;
+        }
+        source+=byteLength;
+        target+=length;
+        targetCapacity-=length;
+    }
+
+    /* write back the updated pointers */
+    pToUArgs->source=(const char *)source;
+    pFromUArgs->target=(char *)target;
+}
+
 /*
  * This is an internal function that allows other converter implementations
  * to check whether a byte is a lead byte.
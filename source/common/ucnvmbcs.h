@@ -391,6 +391,15 @@ typedef struct UConverterMBCSTable {
     /* roundtrips */
     uint32_t asciiRoundtrips;
 
+    /*
+     * flat lookup tables for SBCS with only BMP mappings, NULL otherwise:
+     * [0..0xff] toUnicode code points for bytes 00..FF, 0xfffe if a byte
+     *     needs the state table (unassigned, illegal, or U+FFFE/U+FFFF);
+     * [0x100..0x1ff] fromUnicode results for U+0000..U+00FF,
+     *     as from MBCS_SINGLE_RESULT_FROM_U()
+     */
+    uint16_t *sbcsFlatTables;
+
     /* reconstituted data that was omitted from the .cnv file */
     uint8_t *reconstitutedData;
 
@@ -426,6 +435,9 @@ typedef struct UConverterMBCSTable {
     /* roundtrips */ \
     0, \
      \
+    /* flat SBCS tables */ \
+    NULL, \
+     \
     /* reconstituted data that was omitted from the .cnv file */ \
     NULL, \
      \
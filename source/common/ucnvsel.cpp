@@ -662,15 +662,109 @@ static const UEnumeration defaultEncodings = {
 };
 
 
-// internal fn to intersect two sets of masks
+// The encodings that can still be selected, one bit per encoding,
+// plus shortcuts for intersecting it with the pv row of each code point.
+struct SelectionMask {
+  uint32_t *bits;
+  int32_t columns;
+  int32_t lastPvIndex;  // the row that was intersected last, or -1
+  int32_t oneColumn;    // if exactly one encoding is left: its column, otherwise -1
+  uint32_t oneBit;      // if exactly one encoding is left: its bit
+};
+
+// internal fn to start with all of the selector's encodings
+static void initMask(const UConverterSelector* sel, SelectionMask *m, uint32_t *bits) {
+  int32_t columns = (sel->encodingsCount+31)/32;
+  m->bits = bits;
+  m->columns = columns;
+  m->lastPvIndex = -1;
+  m->oneColumn = -1;
+  m->oneBit = 0;
+  if (columns > 0) {
+    uprv_memset(bits, ~0, columns *4);
+    // clear the bits beyond the last encoding so that the masks can be counted
+    if ((sel->encodingsCount & 31) != 0) {
+      bits[columns - 1] = ((uint32_t)1 << (sel->encodingsCount & 31)) - 1;
+    }
+    if (sel->encodingsCount == 1) {
+      m->oneColumn = 0;
+      m->oneBit = 1;
+    }
+  }
+}
+
+// internal fn to intersect the mask with one row of pv
 // returns whether the mask has reduced to all zeros
-static UBool intersectMasks(uint32_t* dest, const uint32_t* source1, int32_t len) {
+static inline UBool intersectMask(SelectionMask *m, const uint32_t* pv, int32_t pvIndex) {
+  if (pvIndex == m->lastPvIndex) {
+    // same row as for the previous code point: nothing changes
+    return FALSE;
+  }
+  m->lastPvIndex = pvIndex;
+  const uint32_t *row = pv + pvIndex;
+  if (m->oneColumn >= 0) {
+    // only one encoding is left: test just its bit
+    if ((row[m->oneColumn] & m->oneBit) != 0) {
+      return FALSE;
+    }
+    m->bits[m->oneColumn] = 0;
+    return TRUE;
+  }
+  uint32_t *bits = m->bits;
+  int32_t columns = m->columns;
   int32_t i;
   uint32_t oredDest = 0;
-  for (i = 0 ; i < len ; ++i) {
-    oredDest |= (dest[i] &= source1[i]);
+  for (i = 0 ; i < columns ; ++i) {
+    oredDest |= (bits[i] &= row[i]);
+  }
+  if (oredDest == 0) {
+    return TRUE;
+  }
+  if ((oredDest & (oredDest - 1)) == 0) {
+    // maybe only one encoding is left, if there is only one non-zero column
+    int32_t oneColumn = -1;
+    for (i = 0 ; i < columns ; ++i) {
+      if (bits[i] != 0) {
+        if (oneColumn >= 0) {
+          return FALSE;
+        }
+        oneColumn = i;
+      }
+    }
+    m->oneColumn = oneColumn;
+    m->oneBit = oredDest;
+  }
+  return FALSE;
+}
+
+// internal fn to intersect the mask with the rows for UTF-16 text
+// limit==NULL for NUL-terminated text
+// returns whether the mask has reduced to all zeros
+static UBool intersectUTF16(const UConverterSelector* sel, SelectionMask *m,
+                            const UChar *s, const UChar *limit) {
+  while (limit == NULL ? *s != 0 : s != limit) {
+    UChar32 c;
+    uint16_t pvIndex;
+    UTRIE2_U16_NEXT16(sel->trie, s, limit, c, pvIndex);
+    if (intersectMask(m, sel->pv, pvIndex)) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+// internal fn to intersect the mask with the rows for UTF-8 text
+// returns whether the mask has reduced to all zeros
+static UBool intersectUTF8(const UConverterSelector* sel, SelectionMask *m,
+                           const char *s, const char *limit) {
+  while (s != limit) {
+    uint16_t pvIndex;
+    UTRIE2_U8_NEXT16(sel->trie, s, limit, pvIndex);
+    if (intersectMask(m, sel->pv, pvIndex)) {
+      return TRUE;
+    }
   }
-  return oredDest == 0;
+  return FALSE;
 }
 
 // internal fn to count how many 1's are there in a mask
@@ -757,24 +851,11 @@ ucnvsel_selectForString(const UConverterSelector* sel,
     *status = U_MEMORY_ALLOCATION_ERROR;
     return NULL;
   }
-  uprv_memset(mask, ~0, columns *4);
+  SelectionMask m;
+  initMask(sel, &m, mask);
 
   if(s!=NULL) {
-    const UChar *limit;
-    if (length >= 0) {
-      limit = s + length;
-    } else {
-      limit = NULL;
-    }
-    
-    while (limit == NULL ? *s != 0 : s != limit) {
-      UChar32 c;
-      uint16_t pvIndex;
-      UTRIE2_U16_NEXT16(sel->trie, s, limit, c, pvIndex);
-      if (intersectMasks(mask, sel->pv+pvIndex, columns)) {
-        break;
-      }
-    }
+    intersectUTF16(sel, &m, s, length >= 0 ? s + length : NULL);
   }
   return selectForMask(sel, mask, status);
 }
@@ -799,24 +880,266 @@ ucnvsel_selectForUTF8(const UConverterSelector* sel,
     *status = U_MEMORY_ALLOCATION_ERROR;
     return NULL;
   }
-  uprv_memset(mask, ~0, columns *4);
+  SelectionMask m;
+  initMask(sel, &m, mask);
 
   if (length < 0) {
     length = (int32_t)uprv_strlen(s);
   }
 
   if(s!=NULL) {
-    const char *limit = s + length;
-    
-    while (s != limit) {
-      uint16_t pvIndex;
-      UTRIE2_U8_NEXT16(sel->trie, s, limit, pvIndex);
-      if (intersectMasks(mask, sel->pv+pvIndex, columns)) {
-        break;
+    intersectUTF8(sel, &m, s, s + length);
+  }
+  return selectForMask(sel, mask, status);
+}
+
+// incremental selection ------------------------------------------------------
+
+struct UConverterSelectorState {
+  const UConverterSelector *sel;
+  SelectionMask mask;
+  UBool isEmpty;        // no encoding is left; further text is ignored
+  UChar lead;           // lead surrogate at the end of the last UTF-16 chunk, or 0
+  int8_t pendingLength; // length of a partial character at the end of the last UTF-8 chunk
+  uint8_t pending[4];
+  // followed by the mask bits
+};
+
+// internal fn to get the length of a partial but so far well-formed
+// UTF-8 character at the end of s, or 0 if there is none
+static int32_t getPartialUTF8Length(const uint8_t *s, int32_t length) {
+  int32_t i = length;
+  // the lead byte is at most 3 bytes before the end
+  while (i > 0 && (length - i) < 3) {
+    uint8_t b = s[--i];
+    if (!U8_IS_TRAIL(b)) {
+      int32_t partialLength = length - i;
+      int32_t count = U8_COUNT_TRAIL_BYTES(b) + 1;
+      if (partialLength >= count ||
+          (partialLength >= 2 &&
+           !(count == 3 ? U8_IS_VALID_LEAD3_AND_T1(b, s[i + 1]) :
+                          U8_IS_VALID_LEAD4_AND_T1(b, s[i + 1])))) {
+        return 0;
       }
+      return partialLength;
     }
   }
-  return selectForMask(sel, mask, status);
+  return 0;
+}
+
+// internal fn to handle a pending partial code point as if the text ended there
+// returns whether the mask has reduced to all zeros
+static UBool finishPending(const UConverterSelectorState* state, SelectionMask *m) {
+  const UConverterSelector* sel = state->sel;
+  if (state->lead != 0) {
+    // an unpaired lead surrogate, as in UTRIE2_U16_NEXT16()
+    return intersectMask(m, sel->pv, UTRIE2_GET16(sel->trie, state->lead));
+  } else if (state->pendingLength > 0) {
+    const char *p = (const char *)state->pending;
+    return intersectUTF8(sel, m, p, p + state->pendingLength);
+  }
+  return FALSE;
+}
+
+// internal fn to return the number of selected encodings
+static int32_t countSelected(const UConverterSelectorState* state) {
+  if (state->isEmpty) {
+    return 0;
+  } else if (state->mask.oneColumn >= 0) {
+    return 1;
+  }
+  return countOnes(state->mask.bits, state->mask.columns);
+}
+
+U_CAPI UConverterSelectorState* U_EXPORT2
+ucnvsel_openState(const UConverterSelector* sel, UErrorCode* status) {
+  if (U_FAILURE(*status)) {
+    return NULL;
+  }
+  if (sel == NULL) {
+    *status = U_ILLEGAL_ARGUMENT_ERROR;
+    return NULL;
+  }
+  int32_t columns = (sel->encodingsCount+31)/32;
+  UConverterSelectorState* state = (UConverterSelectorState*)
+    uprv_malloc(sizeof(UConverterSelectorState) + columns * 4);
+  if (state == NULL) {
+    *status = U_MEMORY_ALLOCATION_ERROR;
+    return NULL;
+  }
+  state->sel = sel;
+  ucnvsel_resetState(state);
+  return state;
+}
+
+U_CAPI void U_EXPORT2
+ucnvsel_closeState(UConverterSelectorState* state) {
+  uprv_free(state);
+}
+
+U_CAPI void U_EXPORT2
+ucnvsel_resetState(UConverterSelectorState* state) {
+  if (state == NULL) {
+    return;
+  }
+  initMask(state->sel, &state->mask, (uint32_t *)(state + 1));
+  state->isEmpty = (UBool)(state->sel->encodingsCount == 0);
+  state->lead = 0;
+  state->pendingLength = 0;
+}
+
+U_CAPI int32_t U_EXPORT2
+ucnvsel_addString(UConverterSelectorState* state,
+                  const UChar* s, int32_t length, UErrorCode* status) {
+  if (U_FAILURE(*status)) {
+    return 0;
+  }
+  if (state == NULL || (s == NULL && length != 0)) {
+    *status = U_ILLEGAL_ARGUMENT_ERROR;
+    return 0;
+  }
+  if (state->isEmpty) {
+    return 0;
+  }
+  if (length < 0) {
+    length = u_strlen(s);
+  }
+  if (length == 0) {
+    return countSelected(state);
+  }
+
+  const UConverterSelector* sel = state->sel;
+  SelectionMask *m = &state->mask;
+  const UChar *limit = s + length;
+  UBool isEmpty = FALSE;
+  if (state->pendingLength > 0) {
+    // switching from UTF-8 input
+    isEmpty = finishPending(state, m);
+    state->pendingLength = 0;
+  } else if (state->lead != 0) {
+    UChar lead = state->lead;
+    state->lead = 0;
+    if (U16_IS_TRAIL(*s)) {
+      UChar32 c = U16_GET_SUPPLEMENTARY(lead, *s++);
+      isEmpty = intersectMask(m, sel->pv, UTRIE2_GET16_FROM_SUPP(sel->trie, c));
+    } else {
+      isEmpty = intersectMask(m, sel->pv, UTRIE2_GET16(sel->trie, lead));
+    }
+  }
+  if (!isEmpty && s != limit) {
+    // keep a lead surrogate at the end for the next chunk
+    UChar last = *(limit - 1);
+    if (U16_IS_LEAD(last)) {
+      --limit;
+    }
+    isEmpty = intersectUTF16(sel, m, s, limit);
+    if (!isEmpty && U16_IS_LEAD(last)) {
+      state->lead = last;
+    }
+  }
+  if (isEmpty) {
+    state->isEmpty = TRUE;
+    state->lead = 0;
+    return 0;
+  }
+  return countSelected(state);
+}
+
+U_CAPI int32_t U_EXPORT2
+ucnvsel_addUTF8(UConverterSelectorState* state,
+                const char* s, int32_t length, UErrorCode* status) {
+  if (U_FAILURE(*status)) {
+    return 0;
+  }
+  if (state == NULL || (s == NULL && length != 0)) {
+    *status = U_ILLEGAL_ARGUMENT_ERROR;
+    return 0;
+  }
+  if (state->isEmpty) {
+    return 0;
+  }
+  if (length < 0) {
+    length = (int32_t)uprv_strlen(s);
+  }
+  if (length == 0) {
+    return countSelected(state);
+  }
+
+  const UConverterSelector* sel = state->sel;
+  SelectionMask *m = &state->mask;
+  const char *limit = s + length;
+  UBool isEmpty = FALSE;
+  if (state->lead != 0) {
+    // switching from UTF-16 input
+    isEmpty = finishPending(state, m);
+    state->lead = 0;
+  } else if (state->pendingLength > 0) {
+    // complete the partial character with bytes from this chunk
+    uint8_t buffer[4];
+    int32_t pendingLength = state->pendingLength;
+    int32_t bufferLength = 4 - pendingLength;
+    if (bufferLength > length) {
+      bufferLength = length;
+    }
+    uprv_memcpy(buffer, state->pending, pendingLength);
+    uprv_memcpy(buffer + pendingLength, s, bufferLength);
+    bufferLength += pendingLength;
+    if (getPartialUTF8Length(buffer, bufferLength) == bufferLength) {
+      // still incomplete
+      uprv_memcpy(state->pending, buffer, bufferLength);
+      state->pendingLength = (int8_t)bufferLength;
+      return countSelected(state);
+    }
+    const char *p = (const char *)buffer;
+    uint16_t pvIndex;
+    UTRIE2_U8_NEXT16(sel->trie, p, (const char *)buffer + bufferLength, pvIndex);
+    // the partial character was well-formed so far, so all of it is consumed
+    U_ASSERT((p - (const char *)buffer) >= pendingLength);
+    s += (p - (const char *)buffer) - pendingLength;
+    state->pendingLength = 0;
+    isEmpty = intersectMask(m, sel->pv, pvIndex);
+  }
+  if (!isEmpty && s != limit) {
+    // keep a partial character at the end for the next chunk
+    int32_t partialLength = getPartialUTF8Length((const uint8_t *)s, (int32_t)(limit - s));
+    isEmpty = intersectUTF8(sel, m, s, limit - partialLength);
+    if (!isEmpty && partialLength > 0) {
+      uprv_memcpy(state->pending, limit - partialLength, partialLength);
+      state->pendingLength = (int8_t)partialLength;
+    }
+  }
+  if (isEmpty) {
+    state->isEmpty = TRUE;
+    state->pendingLength = 0;
+    return 0;
+  }
+  return countSelected(state);
+}
+
+U_CAPI UEnumeration * U_EXPORT2
+ucnvsel_selectForState(const UConverterSelectorState* state, UErrorCode* status) {
+  if (U_FAILURE(*status)) {
+    return NULL;
+  }
+  if (state == NULL) {
+    *status = U_ILLEGAL_ARGUMENT_ERROR;
+    return NULL;
+  }
+  int32_t columns = state->mask.columns;
+  uint32_t* mask = (uint32_t*) uprv_malloc(columns * 4);
+  if (mask == NULL) {
+    *status = U_MEMORY_ALLOCATION_ERROR;
+    return NULL;
+  }
+  if (state->isEmpty) {
+    uprv_memset(mask, 0, columns * 4);
+  } else {
+    SelectionMask m = state->mask;
+    uprv_memcpy(mask, m.bits, columns * 4);
+    m.bits = mask;
+    finishPending(state, &m);
+  }
+  return selectForMask(state->sel, mask, status);
 }
 
 #endif  // !UCONFIG_NO_CONVERSION
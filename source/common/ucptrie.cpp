@@ -0,0 +1,391 @@
+// © 2018 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+/*
+******************************************************************************
+*   file name:  ucptrie.cpp
+*   encoding:   UTF-8
+*   tab size:   8 (not used)
+*   indentation:4
+*
+*   This file contains only the runtime functions of UCPTrie:
+*   lookups, range enumeration and the binary form.
+*   See ucptrie_builder.cpp for building tries.
+*/
+
+#include "unicode/utypes.h"
+#include "unicode/utf.h"
+#include "unicode/utf8.h"
+#include "unicode/utf16.h"
+#include "cmemory.h"
+#include "uassert.h"
+#include "ucptrie.h"
+#include "ucptrie_impl.h"
+
+namespace {
+
+inline uint32_t getValueFromData(const UCPTrie *trie, int32_t dataIndex) {
+    switch (trie->valueWidth) {
+    case UCPTRIE_VALUE_BITS_16:
+        return trie->data.ptr16[dataIndex];
+    case UCPTRIE_VALUE_BITS_32:
+        return trie->data.ptr32[dataIndex];
+    case UCPTRIE_VALUE_BITS_8:
+        return trie->data.ptr8[dataIndex];
+    default:
+        // Unreachable if the trie is properly initialized.
+        return 0xffffffff;
+    }
+}
+
+inline uint32_t maybeFilterValue(uint32_t value, UCPMapValueFilter *filter, const void *context) {
+    if (filter != NULL) {
+        value = filter(context, value);
+    }
+    return value;
+}
+
+inline int32_t cpIndex(const UCPTrie *trie, UChar32 c) {
+    UChar32 fastMax = trie->type == UCPTRIE_TYPE_FAST ? 0xffff : UCPTRIE_SMALL_MAX;
+    return _UCPTRIE_CP_INDEX(trie, fastMax, c);
+}
+
+}  // namespace
+
+U_CAPI UCPTrie * U_EXPORT2
+ucptrie_openFromBinary(UCPTrieType type, UCPTrieValueWidth valueWidth,
+                       const void *data, int32_t length, int32_t *pActualLength,
+                       UErrorCode *pErrorCode) {
+    if (U_FAILURE(*pErrorCode)) {
+        return NULL;
+    }
+
+    if (length <= 0 || (U_POINTER_MASK_LSB(data, 3) != 0) ||
+            type < UCPTRIE_TYPE_ANY || UCPTRIE_TYPE_SMALL < type ||
+            valueWidth < UCPTRIE_VALUE_BITS_ANY || UCPTRIE_VALUE_BITS_8 < valueWidth) {
+        *pErrorCode = U_ILLEGAL_ARGUMENT_ERROR;
+        return NULL;
+    }
+
+    // Enough data for a trie header?
+    if (length < (int32_t)sizeof(UCPTrieHeader)) {
+        *pErrorCode = U_INVALID_FORMAT_ERROR;
+        return NULL;
+    }
+
+    // Check the signature.
+    const UCPTrieHeader *header = (const UCPTrieHeader *)data;
+    if (header->signature != UCPTRIE_SIG) {
+        *pErrorCode = U_INVALID_FORMAT_ERROR;
+        return NULL;
+    }
+
+    int32_t options = header->options;
+    int32_t typeInt = (options >> 6) & 3;
+    int32_t valueWidthInt = options & UCPTRIE_OPTIONS_VALUE_BITS_MASK;
+    if (typeInt > UCPTRIE_TYPE_SMALL || valueWidthInt > UCPTRIE_VALUE_BITS_8 ||
+            (options & UCPTRIE_OPTIONS_RESERVED_MASK) != 0) {
+        *pErrorCode = U_INVALID_FORMAT_ERROR;
+        return NULL;
+    }
+    UCPTrieType actualType = (UCPTrieType)typeInt;
+    UCPTrieValueWidth actualValueWidth = (UCPTrieValueWidth)valueWidthInt;
+    if (type < 0) {
+        type = actualType;
+    }
+    if (valueWidth < 0) {
+        valueWidth = actualValueWidth;
+    }
+    if (type != actualType || valueWidth != actualValueWidth) {
+        *pErrorCode = U_INVALID_FORMAT_ERROR;
+        return NULL;
+    }
+
+    // Get the length values and offsets.
+    UCPTrie tempTrie;
+    uprv_memset(&tempTrie, 0, sizeof(tempTrie));
+    tempTrie.indexLength = header->indexLength;
+    tempTrie.dataLength =
+        ((options & UCPTRIE_OPTIONS_DATA_LENGTH_MASK) << 4) | header->dataLength;
+    tempTrie.index3NullOffset = header->index3NullOffset;
+    tempTrie.dataNullOffset =
+        ((options & UCPTRIE_OPTIONS_DATA_NULL_OFFSET_MASK) << 8) | header->dataNullOffset;
+
+    tempTrie.highStart = header->shiftedHighStart << UCPTRIE_SHIFT_2;
+    tempTrie.shifted12HighStart = (tempTrie.highStart + 0xfff) >> 12;
+    tempTrie.type = type;
+    tempTrie.valueWidth = valueWidth;
+
+    // Calculate the actual length.
+    int32_t actualLength = (int32_t)sizeof(UCPTrieHeader) + tempTrie.indexLength * 2;
+    if (valueWidth == UCPTRIE_VALUE_BITS_16) {
+        actualLength += tempTrie.dataLength * 2;
+    } else if (valueWidth == UCPTRIE_VALUE_BITS_32) {
+        actualLength += tempTrie.dataLength * 4;
+    } else {
+        actualLength += tempTrie.dataLength;
+    }
+    if (length < actualLength || tempTrie.dataLength < 2 ||
+            tempTrie.indexLength < (type == UCPTRIE_TYPE_FAST ?
+                UCPTRIE_BMP_INDEX_LENGTH : UCPTRIE_SMALL_INDEX_LENGTH)) {
+        *pErrorCode = U_INVALID_FORMAT_ERROR;  // Not enough bytes, or bad lengths.
+        return NULL;
+    }
+
+    // Allocate the trie.
+    UCPTrie *trie = (UCPTrie *)uprv_malloc(sizeof(UCPTrie));
+    if (trie == NULL) {
+        *pErrorCode = U_MEMORY_ALLOCATION_ERROR;
+        return NULL;
+    }
+    uprv_memcpy(trie, &tempTrie, sizeof(tempTrie));
+
+    // Set the pointers to its index and data arrays.
+    const uint16_t *p16 = (const uint16_t *)(header + 1);
+    trie->index = p16;
+    p16 += trie->indexLength;
+
+    // Get the data.
+    int32_t nullValueOffset = trie->dataNullOffset;
+    if (nullValueOffset >= trie->dataLength) {
+        nullValueOffset = trie->dataLength - UCPTRIE_HIGH_VALUE_NEG_DATA_OFFSET;
+    }
+    switch (valueWidth) {
+    case UCPTRIE_VALUE_BITS_16:
+        trie->data.ptr16 = p16;
+        break;
+    case UCPTRIE_VALUE_BITS_32:
+        trie->data.ptr32 = (const uint32_t *)p16;
+        break;
+    case UCPTRIE_VALUE_BITS_8:
+        trie->data.ptr8 = (const uint8_t *)p16;
+        break;
+    default:
+        // Unreachable because valueWidth was checked above.
+        *pErrorCode = U_INVALID_FORMAT_ERROR;
+        uprv_free(trie);
+        return NULL;
+    }
+    trie->nullValue = getValueFromData(trie, nullValueOffset);
+
+    if (pActualLength != NULL) {
+        *pActualLength = actualLength;
+    }
+    return trie;
+}
+
+U_CAPI void U_EXPORT2
+ucptrie_close(UCPTrie *trie) {
+    // A built trie is allocated together with its arrays.
+    uprv_free(trie);
+}
+
+U_CAPI UCPTrieType U_EXPORT2
+ucptrie_getType(const UCPTrie *trie) {
+    return (UCPTrieType)trie->type;
+}
+
+U_CAPI UCPTrieValueWidth U_EXPORT2
+ucptrie_getValueWidth(const UCPTrie *trie) {
+    return (UCPTrieValueWidth)trie->valueWidth;
+}
+
+U_CAPI int32_t U_EXPORT2
+ucptrie_internalSmallIndex(const UCPTrie *trie, UChar32 c) {
+    int32_t i1 = c >> UCPTRIE_SHIFT_1;
+    if (trie->type == UCPTRIE_TYPE_FAST) {
+        U_ASSERT(0xffff < c && c < trie->highStart);
+        i1 += UCPTRIE_BMP_INDEX_LENGTH - UCPTRIE_OMITTED_BMP_INDEX_1_LENGTH;
+    } else {
+        U_ASSERT((uint32_t)c < (uint32_t)trie->highStart && trie->highStart > UCPTRIE_SMALL_LIMIT);
+        i1 += UCPTRIE_SMALL_INDEX_LENGTH;
+    }
+    int32_t i3Block = trie->index[
+        (int32_t)trie->index[i1] + ((c >> UCPTRIE_SHIFT_2) & UCPTRIE_INDEX_2_MASK)];
+    int32_t i3 = (c >> UCPTRIE_SHIFT_3) & UCPTRIE_INDEX_3_MASK;
+    int32_t dataBlock;
+    if ((i3Block & 0x8000) == 0) {
+        // 16-bit indexes
+        dataBlock = trie->index[i3Block + i3];
+    } else {
+        // 18-bit indexes stored in groups of 9 entries per 8 indexes.
+        i3Block = (i3Block & 0x7fff) + (i3 & ~7) + (i3 >> 3);
+        i3 &= 7;
+        dataBlock = ((int32_t)trie->index[i3Block++] << (2 + (2 * i3))) & 0x30000;
+        dataBlock |= trie->index[i3Block + i3];
+    }
+    return dataBlock + (c & UCPTRIE_SMALL_DATA_MASK);
+}
+
+U_CAPI int32_t U_EXPORT2
+ucptrie_internalSmallU8Index(const UCPTrie *trie, int32_t lt1, uint8_t t2, uint8_t t3) {
+    UChar32 c = (lt1 << 12) | (t2 << 6) | t3;
+    if (c >= trie->highStart) {
+        // Possible because the UTF-8 macro compares with shifted12HighStart which may be higher.
+        return trie->dataLength - UCPTRIE_HIGH_VALUE_NEG_DATA_OFFSET;
+    }
+    return ucptrie_internalSmallIndex(trie, c);
+}
+
+U_CAPI int32_t U_EXPORT2
+ucptrie_internalU8PrevIndex(const UCPTrie *trie, UChar32 c,
+                            const uint8_t *start, const uint8_t *src) {
+    int32_t i, length;
+    // Support 64-bit pointers by avoiding cast of arbitrary difference.
+    if ((src - start) <= 7) {
+        i = length = (int32_t)(src - start);
+    } else {
+        i = length = 7;
+        start = src - 7;
+    }
+    c = utf8_prevCharSafeBody(start, 0, &i, c, -1);
+    i = length - i;  // Number of bytes read backward from src.
+    int32_t idx = _UCPTRIE_CP_INDEX(trie, 0xffff, c);
+    return (idx << 3) | i;
+}
+
+U_CAPI uint32_t U_EXPORT2
+ucptrie_get(const UCPTrie *trie, UChar32 c) {
+    return getValueFromData(trie, cpIndex(trie, c));
+}
+
+U_CAPI UChar32 U_EXPORT2
+ucptrie_getRange(const UCPTrie *trie, UChar32 start,
+                 UCPMapValueFilter *filter, const void *context, uint32_t *pValue) {
+    if ((uint32_t)start > 0x10ffff) {
+        return U_SENTINEL;
+    }
+    if (start >= trie->highStart) {
+        if (pValue != NULL) {
+            int32_t di = trie->dataLength - UCPTRIE_HIGH_VALUE_NEG_DATA_OFFSET;
+            *pValue = maybeFilterValue(getValueFromData(trie, di), filter, context);
+        }
+        return 0x10ffff;
+    }
+
+    UChar32 fastLimit = trie->type == UCPTRIE_TYPE_FAST ? 0x10000 : UCPTRIE_SMALL_LIMIT;
+    uint32_t value = maybeFilterValue(getValueFromData(trie, cpIndex(trie, start)), filter, context);
+    uint32_t nullValue = maybeFilterValue(trie->nullValue, filter, context);
+    // Data block offset of the last whole block whose values all equal value, if any.
+    // Fast 64-value blocks precede small 16-value blocks in code point order,
+    // so a matching prevBlock always covers at least the current block length.
+    int32_t prevBlock = -1;
+    UChar32 c = start + 1;
+    while (c < trie->highStart) {
+        int32_t block, blockLength;
+        if (c < fastLimit) {
+            block = trie->index[c >> UCPTRIE_FAST_SHIFT];
+            blockLength = UCPTRIE_FAST_DATA_BLOCK_LENGTH;
+        } else {
+            if ((c & (UCPTRIE_CP_PER_INDEX_2_ENTRY - 1)) == 0 &&
+                    trie->index3NullOffset != UCPTRIE_NO_INDEX3_NULL_OFFSET &&
+                    value == nullValue) {
+                // Skip a whole 512-code point range that maps to the null index-3 block.
+                int32_t i1 = c >> UCPTRIE_SHIFT_1;
+                i1 += trie->type == UCPTRIE_TYPE_FAST ?
+                    UCPTRIE_BMP_INDEX_LENGTH - UCPTRIE_OMITTED_BMP_INDEX_1_LENGTH :
+                    UCPTRIE_SMALL_INDEX_LENGTH;
+                int32_t i3Block = trie->index[
+                    (int32_t)trie->index[i1] + ((c >> UCPTRIE_SHIFT_2) & UCPTRIE_INDEX_2_MASK)];
+                if (i3Block == trie->index3NullOffset) {
+                    c += UCPTRIE_CP_PER_INDEX_2_ENTRY;
+                    continue;
+                }
+            }
+            block = ucptrie_internalSmallIndex(trie, c & ~UCPTRIE_SMALL_DATA_MASK);
+            blockLength = UCPTRIE_SMALL_DATA_BLOCK_LENGTH;
+        }
+        int32_t i = c & (blockLength - 1);
+        if (i == 0 && block == prevBlock) {
+            // Same data block as the previous one, whose values all matched.
+            c += blockLength;
+            continue;
+        }
+        UBool wholeBlock = i == 0;
+        for (; i < blockLength; ++i, ++c) {
+            if (maybeFilterValue(getValueFromData(trie, block + i), filter, context) != value) {
+                if (pValue != NULL) { *pValue = value; }
+                return c - 1;
+            }
+        }
+        if (wholeBlock) {
+            prevBlock = block;
+        }
+    }
+    if (pValue != NULL) { *pValue = value; }
+    int32_t di = trie->dataLength - UCPTRIE_HIGH_VALUE_NEG_DATA_OFFSET;
+    if (maybeFilterValue(getValueFromData(trie, di), filter, context) != value) {
+        return trie->highStart - 1;
+    }
+    return 0x10ffff;
+}
+
+U_CAPI int32_t U_EXPORT2
+ucptrie_toBinary(const UCPTrie *trie, void *data, int32_t capacity, UErrorCode *pErrorCode) {
+    if (U_FAILURE(*pErrorCode)) {
+        return 0;
+    }
+
+    UCPTrieType type = (UCPTrieType)trie->type;
+    UCPTrieValueWidth valueWidth = (UCPTrieValueWidth)trie->valueWidth;
+    if (type < UCPTRIE_TYPE_FAST || UCPTRIE_TYPE_SMALL < type ||
+            valueWidth < UCPTRIE_VALUE_BITS_16 || UCPTRIE_VALUE_BITS_8 < valueWidth ||
+            capacity < 0 ||
+            (capacity > 0 && (data == NULL || (U_POINTER_MASK_LSB(data, 3) != 0)))) {
+        *pErrorCode = U_ILLEGAL_ARGUMENT_ERROR;
+        return 0;
+    }
+
+    int32_t length = (int32_t)sizeof(UCPTrieHeader) + trie->indexLength * 2;
+    switch (valueWidth) {
+    case UCPTRIE_VALUE_BITS_16:
+        length += trie->dataLength * 2;
+        break;
+    case UCPTRIE_VALUE_BITS_32:
+        length += trie->dataLength * 4;
+        break;
+    case UCPTRIE_VALUE_BITS_8:
+        length += trie->dataLength;
+        break;
+    default:
+        // Unreachable because valueWidth was checked above.
+        break;
+    }
+    if (capacity < length) {
+        *pErrorCode = U_BUFFER_OVERFLOW_ERROR;
+        return length;
+    }
+
+    char *bytes = (char *)data;
+    UCPTrieHeader *header = (UCPTrieHeader *)bytes;
+    header->signature = UCPTRIE_SIG;  // "Tri3"
+    header->options = (uint16_t)(
+        ((trie->dataLength & 0xf0000) >> 4) |
+        ((trie->dataNullOffset & 0xf0000) >> 8) |
+        (trie->type << 6) |
+        valueWidth);
+    header->indexLength = (uint16_t)trie->indexLength;
+    header->dataLength = (uint16_t)trie->dataLength;
+    header->index3NullOffset = trie->index3NullOffset;
+    header->dataNullOffset = (uint16_t)trie->dataNullOffset;
+    header->shiftedHighStart = trie->highStart >> UCPTRIE_SHIFT_2;
+    bytes += sizeof(UCPTrieHeader);
+
+    uprv_memcpy(bytes, trie->index, trie->indexLength * 2);
+    bytes += trie->indexLength * 2;
+
+    switch (valueWidth) {
+    case UCPTRIE_VALUE_BITS_16:
+        uprv_memcpy(bytes, trie->data.ptr16, trie->dataLength * 2);
+        break;
+    case UCPTRIE_VALUE_BITS_32:
+        uprv_memcpy(bytes, trie->data.ptr32, trie->dataLength * 4);
+        break;
+    case UCPTRIE_VALUE_BITS_8:
+        uprv_memcpy(bytes, trie->data.ptr8, trie->dataLength);
+        break;
+    default:
+        // Unreachable because valueWidth was checked above.
+        break;
+    }
+    return length;
+}
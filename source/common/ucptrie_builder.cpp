@@ -0,0 +1,906 @@
+// © 2018 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+/*
+******************************************************************************
+*   file name:  ucptrie_builder.cpp
+*   encoding:   UTF-8
+*   tab size:   8 (not used)
+*   indentation:4
+*
+*   This file contains only the builder code for UCPTrie:
+*   the mutable trie UMutableCPTrie and its compaction into an immutable UCPTrie.
+*   See ucptrie.cpp for the runtime functions.
+*
+*   The mutable trie stores one entry per 16-code point block:
+*   either the single value of all of the block's code points,
+*   or the offset of the block's 16 values in a growable data array.
+*
+*   Building an immutable trie
+*   - writes the ASCII values to the start of the data,
+*   - adds the data blocks for the fast-index range in 64-value blocks
+*     and the rest in 16-value blocks, reusing identical blocks (also at unaligned
+*     positions, found via a hash table) and overlapping each new block
+*     with the end of the data where possible,
+*   - and builds the index-3, index-2 and index-1 tables, sharing identical blocks.
+*/
+
+#include "unicode/utypes.h"
+#include "unicode/localpointer.h"
+#include "unicode/uobject.h"
+#include "unicode/utf.h"
+#include "cmemory.h"
+#include "uassert.h"
+#include "ucptrie.h"
+#include "ucptrie_impl.h"
+
+U_NAMESPACE_BEGIN
+
+namespace {
+
+const int32_t MAX_UNICODE = 0x10ffff;
+
+/** Number of 16-code point blocks in the mutable trie. */
+const int32_t BLOCK_COUNT = (MAX_UNICODE + 1) >> UCPTRIE_SHIFT_3;
+
+const int32_t INITIAL_DATA_LENGTH = 1 << 12;
+
+/** Mutable trie block flags. */
+const uint8_t ALL_SAME = 0;
+const uint8_t MIXED = 1;
+
+inline uint32_t maybeFilterValue(uint32_t value, UCPMapValueFilter *filter, const void *context) {
+    if (filter != NULL) {
+        value = filter(context, value);
+    }
+    return value;
+}
+
+inline UBool equalBlocks(const uint32_t *s, const uint32_t *t, int32_t length) {
+    while (length > 0 && *s == *t) {
+        ++s;
+        ++t;
+        --length;
+    }
+    return length == 0;
+}
+
+inline UBool allValuesSameAs(const uint32_t *p, int32_t length, uint32_t value) {
+    for (int32_t i = 0; i < length; ++i) {
+        if (p[i] != value) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/** Growable array of 32-bit values. */
+class UInt32Array {
+public:
+    UInt32Array() : array(NULL), length(0), capacity(0) {}
+    ~UInt32Array() { uprv_free(array); }
+
+    UBool ensureCapacity(int32_t minCapacity) {
+        if (minCapacity <= capacity) {
+            return TRUE;
+        }
+        int32_t newCapacity = capacity == 0 ? INITIAL_DATA_LENGTH : capacity;
+        while (newCapacity < minCapacity) {
+            newCapacity *= 2;
+        }
+        uint32_t *newArray = (uint32_t *)uprv_realloc(array, (size_t)newCapacity * 4);
+        if (newArray == NULL) {
+            return FALSE;
+        }
+        array = newArray;
+        capacity = newCapacity;
+        return TRUE;
+    }
+
+    UBool append(const uint32_t *values, int32_t count) {
+        if (!ensureCapacity(length + count)) {
+            return FALSE;
+        }
+        uprv_memcpy(array + length, values, (size_t)count * 4);
+        length += count;
+        return TRUE;
+    }
+
+    uint32_t *array;
+    int32_t length;
+    int32_t capacity;
+
+private:
+    UInt32Array(const UInt32Array &other);  // no copy constructor
+    UInt32Array &operator=(const UInt32Array &other);  // no assignment operator
+};
+
+/**
+ * Hash table of the blocks of blockLength values in an append-only array,
+ * for those blocks which start at multiples of step.
+ * Finds an existing block with the same values as a new one.
+ */
+class BlockHashTable {
+public:
+    BlockHashTable(int32_t blockLen, int32_t stepLen) :
+            offsets(NULL), hashes(NULL), capacity(0), count(0),
+            blockLength(blockLen), step(stepLen), nextStart(0) {}
+    ~BlockHashTable() {
+        uprv_free(offsets);
+        uprv_free(hashes);
+    }
+
+    /** Adds all blocks that end at or before arrayLength and were not added before. */
+    UBool extend(const uint32_t *array, int32_t arrayLength) {
+        for (; (nextStart + blockLength) <= arrayLength; nextStart += step) {
+            if (!insert(makeHashCode(array + nextStart), nextStart)) {
+                return FALSE;
+            }
+        }
+        return TRUE;
+    }
+
+    /** Returns the offset of a block in the array with the same values, or -1 if none. */
+    int32_t find(const uint32_t *array, const uint32_t *block) const {
+        if (count == 0) {
+            return -1;
+        }
+        uint32_t hashCode = makeHashCode(block);
+        int32_t mask = capacity - 1;
+        for (int32_t i = (int32_t)(hashCode & mask);; i = (i + 1) & mask) {
+            int32_t offset = offsets[i];
+            if (offset < 0) {
+                return -1;
+            }
+            if (hashes[i] == hashCode && equalBlocks(array + offset, block, blockLength)) {
+                return offset;
+            }
+        }
+    }
+
+private:
+    uint32_t makeHashCode(const uint32_t *block) const {
+        uint32_t hashCode = (uint32_t)blockLength;
+        for (int32_t i = 0; i < blockLength; ++i) {
+            hashCode = hashCode * 37 + block[i];
+        }
+        return hashCode ^ (hashCode >> 15);
+    }
+
+    UBool insert(uint32_t hashCode, int32_t offset) {
+        // Keep the table at most half full.
+        if ((count + 1) * 2 > capacity) {
+            int32_t newCapacity = capacity == 0 ? 1024 : capacity * 2;
+            int32_t *newOffsets = (int32_t *)uprv_malloc((size_t)newCapacity * 4);
+            uint32_t *newHashes = (uint32_t *)uprv_malloc((size_t)newCapacity * 4);
+            if (newOffsets == NULL || newHashes == NULL) {
+                uprv_free(newOffsets);
+                uprv_free(newHashes);
+                return FALSE;
+            }
+            uprv_memset(newOffsets, 0xff, (size_t)newCapacity * 4);
+            int32_t newMask = newCapacity - 1;
+            for (int32_t i = 0; i < capacity; ++i) {
+                if (offsets[i] >= 0) {
+                    int32_t j = (int32_t)(hashes[i] & newMask);
+                    while (newOffsets[j] >= 0) {
+                        j = (j + 1) & newMask;
+                    }
+                    newOffsets[j] = offsets[i];
+                    newHashes[j] = hashes[i];
+                }
+            }
+            uprv_free(offsets);
+            uprv_free(hashes);
+            offsets = newOffsets;
+            hashes = newHashes;
+            capacity = newCapacity;
+        }
+        int32_t mask = capacity - 1;
+        int32_t i = (int32_t)(hashCode & mask);
+        while (offsets[i] >= 0) {
+            i = (i + 1) & mask;
+        }
+        offsets[i] = offset;
+        hashes[i] = hashCode;
+        ++count;
+        return TRUE;
+    }
+
+    int32_t *offsets;
+    uint32_t *hashes;
+    int32_t capacity;
+    int32_t count;
+    int32_t blockLength;
+    int32_t step;
+    int32_t nextStart;
+
+    BlockHashTable(const BlockHashTable &other);  // no copy constructor
+    BlockHashTable &operator=(const BlockHashTable &other);  // no assignment operator
+};
+
+/**
+ * Appends a data block unless the same values are already in the data.
+ * Overlaps the new block with the end of the data where possible.
+ * @return the data offset of the block, or -1 if memory allocation failed
+ */
+int32_t addDataBlock(UInt32Array &data, BlockHashTable &table,
+                     const uint32_t *block, int32_t blockLength) {
+    int32_t offset = table.find(data.array, block);
+    if (offset >= 0) {
+        return offset;
+    }
+    int32_t overlap = blockLength - 1;
+    if (overlap > data.length) {
+        overlap = data.length;
+    }
+    while (overlap > 0 && !equalBlocks(data.array + data.length - overlap, block, overlap)) {
+        --overlap;
+    }
+    offset = data.length - overlap;
+    if (!data.append(block + overlap, blockLength - overlap) ||
+            !table.extend(data.array, data.length)) {
+        return -1;
+    }
+    return offset;
+}
+
+/**
+ * Appends an index block unless the same block was added before.
+ * Index blocks are not overlapped.
+ * @return the number of the block, or -1 if memory allocation failed
+ */
+int32_t addIndexBlock(UInt32Array &blocks, BlockHashTable &table,
+                      const uint32_t *block, int32_t blockLength) {
+    int32_t offset = table.find(blocks.array, block);
+    if (offset < 0) {
+        offset = blocks.length;
+        if (!blocks.append(block, blockLength) || !table.extend(blocks.array, blocks.length)) {
+            return -1;
+        }
+    }
+    return offset / blockLength;
+}
+
+class MutableCodePointTrie : public UMemory {
+public:
+    MutableCodePointTrie(uint32_t initialValue, uint32_t errorValue, UErrorCode &errorCode);
+    MutableCodePointTrie(const MutableCodePointTrie &other, UErrorCode &errorCode);
+    ~MutableCodePointTrie();
+
+    static MutableCodePointTrie *fromUCPTrie(const UCPTrie *trie, UErrorCode &errorCode);
+
+    uint32_t get(UChar32 c) const;
+    UChar32 getRange(UChar32 start, UCPMapValueFilter *filter, const void *context,
+                     uint32_t *pValue) const;
+
+    void set(UChar32 c, uint32_t value, UErrorCode &errorCode);
+    void setRange(UChar32 start, UChar32 end, uint32_t value, UErrorCode &errorCode);
+
+    UCPTrie *build(UCPTrieType type, UCPTrieValueWidth valueWidth, UErrorCode &errorCode) const;
+
+private:
+    MutableCodePointTrie(const MutableCodePointTrie &other);  // no copy constructor
+    MutableCodePointTrie &operator=(const MutableCodePointTrie &other);  // no assignment operator
+
+    /** Makes block i a MIXED block if necessary and returns its data offset. */
+    int32_t getDataBlock(int32_t i, UErrorCode &errorCode);
+
+    /** Writes the masked values of length/16 consecutive blocks starting with block i. */
+    void getMaskedValues(int32_t i, int32_t length, uint32_t mask, uint32_t *dest) const;
+
+    /** Per 16-code point block: the value for ALL_SAME, or the data offset for MIXED. */
+    uint32_t *index;
+    uint8_t *flags;
+
+    uint32_t *data;
+    int32_t dataCapacity;
+    int32_t dataLength;
+
+    uint32_t initialValue;
+    uint32_t errorValue;
+};
+
+MutableCodePointTrie::MutableCodePointTrie(uint32_t iniValue, uint32_t errValue, UErrorCode &errorCode) :
+        index(NULL), flags(NULL), data(NULL), dataCapacity(0), dataLength(0),
+        initialValue(iniValue), errorValue(errValue) {
+    if (U_FAILURE(errorCode)) { return; }
+    index = (uint32_t *)uprv_malloc(BLOCK_COUNT * 4);
+    flags = (uint8_t *)uprv_malloc(BLOCK_COUNT);
+    if (index == NULL || flags == NULL) {
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    for (int32_t i = 0; i < BLOCK_COUNT; ++i) {
+        index[i] = initialValue;
+    }
+    uprv_memset(flags, ALL_SAME, BLOCK_COUNT);
+}
+
+MutableCodePointTrie::MutableCodePointTrie(const MutableCodePointTrie &other, UErrorCode &errorCode) :
+        index(NULL), flags(NULL), data(NULL), dataCapacity(0), dataLength(0),
+        initialValue(other.initialValue), errorValue(other.errorValue) {
+    if (U_FAILURE(errorCode)) { return; }
+    index = (uint32_t *)uprv_malloc(BLOCK_COUNT * 4);
+    flags = (uint8_t *)uprv_malloc(BLOCK_COUNT);
+    if (index == NULL || flags == NULL) {
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    uprv_memcpy(index, other.index, BLOCK_COUNT * 4);
+    uprv_memcpy(flags, other.flags, BLOCK_COUNT);
+    if (other.dataLength > 0) {
+        data = (uint32_t *)uprv_malloc((size_t)other.dataCapacity * 4);
+        if (data == NULL) {
+            errorCode = U_MEMORY_ALLOCATION_ERROR;
+            return;
+        }
+        uprv_memcpy(data, other.data, (size_t)other.dataLength * 4);
+        dataCapacity = other.dataCapacity;
+        dataLength = other.dataLength;
+    }
+}
+
+MutableCodePointTrie::~MutableCodePointTrie() {
+    uprv_free(index);
+    uprv_free(flags);
+    uprv_free(data);
+}
+
+MutableCodePointTrie *MutableCodePointTrie::fromUCPTrie(const UCPTrie *trie, UErrorCode &errorCode) {
+    uint32_t errorValue = ucptrie_get(trie, -1);
+    LocalPointer<MutableCodePointTrie> mutableTrie(
+        new MutableCodePointTrie(trie->nullValue, errorValue, errorCode), errorCode);
+    if (U_FAILURE(errorCode)) {
+        return NULL;
+    }
+    UChar32 start = 0, end;
+    uint32_t value;
+    while ((end = ucptrie_getRange(trie, start, NULL, NULL, &value)) >= 0) {
+        if (value != trie->nullValue) {
+            mutableTrie->setRange(start, end, value, errorCode);
+            if (U_FAILURE(errorCode)) {
+                return NULL;
+            }
+        }
+        start = end + 1;
+    }
+    return mutableTrie.orphan();
+}
+
+uint32_t MutableCodePointTrie::get(UChar32 c) const {
+    if ((uint32_t)c > MAX_UNICODE) {
+        return errorValue;
+    }
+    int32_t i = c >> UCPTRIE_SHIFT_3;
+    if (flags[i] == ALL_SAME) {
+        return index[i];
+    } else {
+        return data[index[i] + (c & UCPTRIE_SMALL_DATA_MASK)];
+    }
+}
+
+UChar32 MutableCodePointTrie::getRange(UChar32 start, UCPMapValueFilter *filter,
+                                       const void *context, uint32_t *pValue) const {
+    if ((uint32_t)start > MAX_UNICODE) {
+        return U_SENTINEL;
+    }
+    uint32_t value = maybeFilterValue(get(start), filter, context);
+    UChar32 c = start + 1;
+    while (c <= MAX_UNICODE) {
+        int32_t i = c >> UCPTRIE_SHIFT_3;
+        if (flags[i] == ALL_SAME) {
+            if (maybeFilterValue(index[i], filter, context) != value) {
+                break;
+            }
+            c = (c | UCPTRIE_SMALL_DATA_MASK) + 1;
+        } else {
+            const uint32_t *block = data + index[i];
+            do {
+                if (maybeFilterValue(block[c & UCPTRIE_SMALL_DATA_MASK], filter, context) != value) {
+                    goto rangeEnd;
+                }
+            } while ((++c & UCPTRIE_SMALL_DATA_MASK) != 0);
+        }
+    }
+rangeEnd:
+    if (pValue != NULL) {
+        *pValue = value;
+    }
+    return c - 1;
+}
+
+int32_t MutableCodePointTrie::getDataBlock(int32_t i, UErrorCode &errorCode) {
+    if (flags[i] == MIXED) {
+        return index[i];
+    }
+    if ((dataLength + UCPTRIE_SMALL_DATA_BLOCK_LENGTH) > dataCapacity) {
+        // setRange() abandons the data blocks of whole blocks that it overwrites,
+        // so the data can grow beyond one block per 16 code points.
+        int32_t newCapacity = dataCapacity == 0 ? INITIAL_DATA_LENGTH : dataCapacity * 2;
+        uint32_t *newData = (uint32_t *)uprv_realloc(data, (size_t)newCapacity * 4);
+        if (newData == NULL) {
+            errorCode = U_MEMORY_ALLOCATION_ERROR;
+            return -1;
+        }
+        data = newData;
+        dataCapacity = newCapacity;
+    }
+    int32_t block = dataLength;
+    dataLength += UCPTRIE_SMALL_DATA_BLOCK_LENGTH;
+    uint32_t value = index[i];
+    for (int32_t j = 0; j < UCPTRIE_SMALL_DATA_BLOCK_LENGTH; ++j) {
+        data[block + j] = value;
+    }
+    flags[i] = MIXED;
+    index[i] = block;
+    return block;
+}
+
+void MutableCodePointTrie::set(UChar32 c, uint32_t value, UErrorCode &errorCode) {
+    if (U_FAILURE(errorCode)) {
+        return;
+    }
+    if ((uint32_t)c > MAX_UNICODE) {
+        errorCode = U_ILLEGAL_ARGUMENT_ERROR;
+        return;
+    }
+    int32_t block = getDataBlock(c >> UCPTRIE_SHIFT_3, errorCode);
+    if (U_FAILURE(errorCode)) {
+        return;
+    }
+    data[block + (c & UCPTRIE_SMALL_DATA_MASK)] = value;
+}
+
+void MutableCodePointTrie::setRange(UChar32 start, UChar32 end, uint32_t value,
+                                    UErrorCode &errorCode) {
+    if (U_FAILURE(errorCode)) {
+        return;
+    }
+    if ((uint32_t)start > MAX_UNICODE || (uint32_t)end > MAX_UNICODE || start > end) {
+        errorCode = U_ILLEGAL_ARGUMENT_ERROR;
+        return;
+    }
+    UChar32 limit = end + 1;
+    if (start & UCPTRIE_SMALL_DATA_MASK) {
+        // Set partial block at [start..following block boundary[.
+        int32_t block = getDataBlock(start >> UCPTRIE_SHIFT_3, errorCode);
+        if (U_FAILURE(errorCode)) {
+            return;
+        }
+        UChar32 nextStart = (start + UCPTRIE_SMALL_DATA_MASK) & ~UCPTRIE_SMALL_DATA_MASK;
+        UChar32 blockLimit = nextStart <= limit ? nextStart : limit;
+        for (; start < blockLimit; ++start) {
+            data[block + (start & UCPTRIE_SMALL_DATA_MASK)] = value;
+        }
+        if (start == limit) {
+            return;
+        }
+    }
+
+    // Set whole blocks, dropping their data blocks if they had any.
+    int32_t rest = limit & UCPTRIE_SMALL_DATA_MASK;
+    limit &= ~UCPTRIE_SMALL_DATA_MASK;
+    for (; start < limit; start += UCPTRIE_SMALL_DATA_BLOCK_LENGTH) {
+        int32_t i = start >> UCPTRIE_SHIFT_3;
+        flags[i] = ALL_SAME;
+        index[i] = value;
+    }
+
+    if (rest > 0) {
+        // Set partial block at [last block boundary..limit[.
+        int32_t block = getDataBlock(start >> UCPTRIE_SHIFT_3, errorCode);
+        if (U_FAILURE(errorCode)) {
+            return;
+        }
+        for (int32_t j = 0; j < rest; ++j) {
+            data[block + j] = value;
+        }
+    }
+}
+
+void MutableCodePointTrie::getMaskedValues(int32_t i, int32_t length, uint32_t mask,
+                                           uint32_t *dest) const {
+    for (uint32_t *limit = dest + length; dest < limit; ++i) {
+        if (flags[i] == ALL_SAME) {
+            uint32_t value = index[i] & mask;
+            for (int32_t j = 0; j < UCPTRIE_SMALL_DATA_BLOCK_LENGTH; ++j) {
+                *dest++ = value;
+            }
+        } else {
+            const uint32_t *block = data + index[i];
+            for (int32_t j = 0; j < UCPTRIE_SMALL_DATA_BLOCK_LENGTH; ++j) {
+                *dest++ = block[j] & mask;
+            }
+        }
+    }
+}
+
+UCPTrie *MutableCodePointTrie::build(UCPTrieType type, UCPTrieValueWidth valueWidth,
+                                     UErrorCode &errorCode) const {
+    if (U_FAILURE(errorCode)) {
+        return NULL;
+    }
+    uint32_t mask;
+    switch (valueWidth) {
+    case UCPTRIE_VALUE_BITS_16:
+        mask = 0xffff;
+        break;
+    case UCPTRIE_VALUE_BITS_32:
+        mask = 0xffffffff;
+        break;
+    case UCPTRIE_VALUE_BITS_8:
+        mask = 0xff;
+        break;
+    default:
+        errorCode = U_ILLEGAL_ARGUMENT_ERROR;
+        return NULL;
+    }
+    if (type != UCPTRIE_TYPE_FAST && type != UCPTRIE_TYPE_SMALL) {
+        errorCode = U_ILLEGAL_ARGUMENT_ERROR;
+        return NULL;
+    }
+    UChar32 fastLimit = type == UCPTRIE_TYPE_FAST ? 0x10000 : UCPTRIE_SMALL_LIMIT;
+    uint32_t nullValue = initialValue & mask;
+    uint32_t highValue = get(MAX_UNICODE) & mask;
+    uint32_t block[UCPTRIE_FAST_DATA_BLOCK_LENGTH];
+
+    // Find the start of the last range, where all values are the same as for U+10FFFF,
+    // rounded up to a whole index-2 entry and at least the fast limit.
+    int32_t i = BLOCK_COUNT;
+    while (i > 0) {
+        getMaskedValues(i - 1, UCPTRIE_SMALL_DATA_BLOCK_LENGTH, mask, block);
+        if (!allValuesSameAs(block, UCPTRIE_SMALL_DATA_BLOCK_LENGTH, highValue)) {
+            break;
+        }
+        --i;
+    }
+    UChar32 highStart = i << UCPTRIE_SHIFT_3;
+    highStart = (highStart + (UCPTRIE_CP_PER_INDEX_2_ENTRY - 1)) & ~(UCPTRIE_CP_PER_INDEX_2_ENTRY - 1);
+    if (highStart < fastLimit) {
+        highStart = fastLimit;
+    }
+
+    // Data: ASCII first, so that UCPTRIE_ASCII_GET() can index it directly,
+    // then the fast-index blocks, then the small blocks.
+    UInt32Array newData;
+    int32_t fastIndexLength = fastLimit >> UCPTRIE_FAST_SHIFT;
+    LocalMemory<uint16_t> fastIndex((uint16_t *)uprv_malloc(fastIndexLength * 2));
+    int32_t smallBlockCount = (highStart - fastLimit) >> UCPTRIE_SHIFT_3;
+    LocalMemory<uint32_t> smallBlocks(
+        (uint32_t *)uprv_malloc((smallBlockCount > 0 ? smallBlockCount : 1) * 4));
+    if (fastIndex.isNull() || smallBlocks.isNull() || !newData.ensureCapacity(fastLimit + 128)) {
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+        return NULL;
+    }
+    BlockHashTable fastTable(UCPTRIE_FAST_DATA_BLOCK_LENGTH, 1);
+    for (UChar32 c = 0; c < fastLimit; c += UCPTRIE_FAST_DATA_BLOCK_LENGTH) {
+        getMaskedValues(c >> UCPTRIE_SHIFT_3, UCPTRIE_FAST_DATA_BLOCK_LENGTH, mask, block);
+        int32_t offset;
+        if (c < 0x80) {
+            // Always copy ASCII blocks, do not share them.
+            offset = newData.length;
+            if (!newData.append(block, UCPTRIE_FAST_DATA_BLOCK_LENGTH) ||
+                    !fastTable.extend(newData.array, newData.length)) {
+                offset = -1;
+            }
+        } else {
+            offset = addDataBlock(newData, fastTable, block, UCPTRIE_FAST_DATA_BLOCK_LENGTH);
+        }
+        if (offset < 0) {
+            errorCode = U_MEMORY_ALLOCATION_ERROR;
+            return NULL;
+        }
+        // Up to 1024 blocks of 64 values, in 16-bit offsets.
+        U_ASSERT(offset <= 0xffff);
+        fastIndex[c >> UCPTRIE_FAST_SHIFT] = (uint16_t)offset;
+    }
+
+    int32_t dataNullOffset = -1;
+    if (smallBlockCount > 0) {
+        BlockHashTable smallTable(UCPTRIE_SMALL_DATA_BLOCK_LENGTH, 1);
+        if (!smallTable.extend(newData.array, newData.length)) {
+            errorCode = U_MEMORY_ALLOCATION_ERROR;
+            return NULL;
+        }
+        for (i = 0; i < smallBlockCount; ++i) {
+            getMaskedValues((fastLimit >> UCPTRIE_SHIFT_3) + i,
+                            UCPTRIE_SMALL_DATA_BLOCK_LENGTH, mask, block);
+            UBool isNull = allValuesSameAs(block, UCPTRIE_SMALL_DATA_BLOCK_LENGTH, nullValue);
+            int32_t offset;
+            if (isNull && dataNullOffset >= 0) {
+                offset = dataNullOffset;
+            } else {
+                offset = addDataBlock(newData, smallTable, block, UCPTRIE_SMALL_DATA_BLOCK_LENGTH);
+                if (offset < 0) {
+                    errorCode = U_MEMORY_ALLOCATION_ERROR;
+                    return NULL;
+                }
+                if (offset >= UCPTRIE_MAX_DATA_LENGTH) {
+                    // Data offsets are limited to 18 bits.
+                    errorCode = U_INDEX_OUTOFBOUNDS_ERROR;
+                    return NULL;
+                }
+                if (isNull) {
+                    dataNullOffset = offset;
+                }
+            }
+            smallBlocks[i] = (uint32_t)offset;
+        }
+    }
+
+    // Index-3 blocks: 32 data block offsets per 512 code points. Collect the distinct ones.
+    int32_t i3Count = smallBlockCount / UCPTRIE_INDEX_3_BLOCK_LENGTH;
+    UInt32Array i3Blocks;
+    LocalMemory<uint32_t> i3Numbers((uint32_t *)uprv_malloc((i3Count > 0 ? i3Count : 1) * 4));
+    if (i3Numbers.isNull()) {
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+        return NULL;
+    }
+    BlockHashTable i3Table(UCPTRIE_INDEX_3_BLOCK_LENGTH, UCPTRIE_INDEX_3_BLOCK_LENGTH);
+    for (i = 0; i < i3Count; ++i) {
+        int32_t n = addIndexBlock(i3Blocks, i3Table,
+                                  smallBlocks.getAlias() + i * UCPTRIE_INDEX_3_BLOCK_LENGTH,
+                                  UCPTRIE_INDEX_3_BLOCK_LENGTH);
+        if (n < 0) {
+            errorCode = U_MEMORY_ALLOCATION_ERROR;
+            return NULL;
+        }
+        i3Numbers[i] = (uint32_t)n;
+    }
+    int32_t i3Distinct = i3Blocks.length / UCPTRIE_INDEX_3_BLOCK_LENGTH;
+
+    // Index-2 blocks: 32 index-3 block numbers per 16k code points. Collect the distinct ones.
+    // Entries below the fast limit or at/above highStart are never used; they get block 0.
+    int32_t i1Start = type == UCPTRIE_TYPE_FAST ? UCPTRIE_OMITTED_BMP_INDEX_1_LENGTH : 0;
+    int32_t i1Length = 0;
+    if (highStart > fastLimit) {
+        i1Length = ((highStart + (UCPTRIE_CP_PER_INDEX_1_ENTRY - 1)) >> UCPTRIE_SHIFT_1) - i1Start;
+    }
+    UInt32Array i2Blocks;
+    LocalMemory<uint32_t> i2Numbers((uint32_t *)uprv_malloc((i1Length > 0 ? i1Length : 1) * 4));
+    if (i2Numbers.isNull()) {
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+        return NULL;
+    }
+    BlockHashTable i2Table(UCPTRIE_INDEX_2_BLOCK_LENGTH, UCPTRIE_INDEX_2_BLOCK_LENGTH);
+    for (i = 0; i < i1Length; ++i) {
+        UChar32 c = (i1Start + i) << UCPTRIE_SHIFT_1;
+        for (int32_t j = 0; j < UCPTRIE_INDEX_2_BLOCK_LENGTH; ++j, c += UCPTRIE_CP_PER_INDEX_2_ENTRY) {
+            block[j] = (fastLimit <= c && c < highStart) ?
+                i3Numbers[(c - fastLimit) >> UCPTRIE_SHIFT_2] : 0;
+        }
+        int32_t n = addIndexBlock(i2Blocks, i2Table, block, UCPTRIE_INDEX_2_BLOCK_LENGTH);
+        if (n < 0) {
+            errorCode = U_MEMORY_ALLOCATION_ERROR;
+            return NULL;
+        }
+        i2Numbers[i] = (uint32_t)n;
+    }
+    int32_t i2Distinct = i2Blocks.length / UCPTRIE_INDEX_2_BLOCK_LENGTH;
+
+    // Lay out the index: fast index, index-1, index-2 blocks, index-3 blocks.
+    // An index-3 block needs 18-bit offsets if any of its data offsets does not fit into 16 bits.
+    LocalMemory<uint32_t> i3Entries((uint32_t *)uprv_malloc((i3Distinct > 0 ? i3Distinct : 1) * 4));
+    if (i3Entries.isNull()) {
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+        return NULL;
+    }
+    int32_t i2Start = fastIndexLength + i1Length;
+    int32_t indexLength = i2Start + i2Distinct * UCPTRIE_INDEX_2_BLOCK_LENGTH;
+    int32_t index3NullOffset = UCPTRIE_NO_INDEX3_NULL_OFFSET;
+    for (i = 0; i < i3Distinct; ++i) {
+        const uint32_t *i3Block = i3Blocks.array + i * UCPTRIE_INDEX_3_BLOCK_LENGTH;
+        UBool is18Bit = FALSE;
+        for (int32_t j = 0; j < UCPTRIE_INDEX_3_BLOCK_LENGTH; ++j) {
+            if (i3Block[j] > 0xffff) {
+                is18Bit = TRUE;
+                break;
+            }
+        }
+        if (indexLength > UCPTRIE_MAX_INDEX_3_OFFSET) {
+            errorCode = U_INDEX_OUTOFBOUNDS_ERROR;
+            return NULL;
+        }
+        uint32_t entry = is18Bit ? (0x8000 | indexLength) : indexLength;
+        i3Entries[i] = entry;
+        if (dataNullOffset >= 0 && entry != UCPTRIE_NO_INDEX3_NULL_OFFSET &&
+                allValuesSameAs(i3Block, UCPTRIE_INDEX_3_BLOCK_LENGTH, (uint32_t)dataNullOffset)) {
+            index3NullOffset = entry;
+        }
+        indexLength += is18Bit ? 36 : UCPTRIE_INDEX_3_BLOCK_LENGTH;
+    }
+    if (indexLength & 1) {
+        ++indexLength;  // Pad so that the data is 32-bit-aligned.
+    }
+    if (indexLength > 0xffff) {
+        errorCode = U_INDEX_OUTOFBOUNDS_ERROR;
+        return NULL;
+    }
+
+    // Pad the data with the high value so that the data including the final
+    // high and error values ends on a 32-bit boundary.
+    int32_t valueSize = valueWidth == UCPTRIE_VALUE_BITS_16 ? 2 :
+        valueWidth == UCPTRIE_VALUE_BITS_32 ? 4 : 1;
+    while (((newData.length + 2) * valueSize) & 3) {
+        if (!newData.append(&highValue, 1)) {
+            errorCode = U_MEMORY_ALLOCATION_ERROR;
+            return NULL;
+        }
+    }
+
+    // Allocate the trie together with its index and data arrays.
+    int32_t dataLength = newData.length + 2;
+    int32_t length = (int32_t)sizeof(UCPTrie) + indexLength * 2 + dataLength * valueSize;
+    UCPTrie *trie = (UCPTrie *)uprv_malloc(length);
+    if (trie == NULL) {
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+        return NULL;
+    }
+    uprv_memset(trie, 0, sizeof(UCPTrie));
+    trie->indexLength = indexLength;
+    trie->dataLength = dataLength;
+    trie->highStart = highStart;
+    trie->shifted12HighStart = (uint16_t)((highStart + 0xfff) >> 12);
+    trie->type = (int8_t)type;
+    trie->valueWidth = (int8_t)valueWidth;
+    trie->index3NullOffset = (uint16_t)index3NullOffset;
+    if (dataNullOffset >= 0) {
+        trie->dataNullOffset = dataNullOffset;
+        trie->nullValue = nullValue;
+    } else {
+        trie->dataNullOffset = UCPTRIE_NO_DATA_NULL_OFFSET;
+        trie->nullValue = highValue;
+    }
+
+    uint16_t *dest16 = (uint16_t *)(trie + 1);
+    trie->index = dest16;
+    uprv_memcpy(dest16, fastIndex.getAlias(), fastIndexLength * 2);
+    dest16 += fastIndexLength;
+    for (i = 0; i < i1Length; ++i) {
+        *dest16++ = (uint16_t)(i2Start + i2Numbers[i] * UCPTRIE_INDEX_2_BLOCK_LENGTH);
+    }
+    for (i = 0; i < i2Blocks.length; ++i) {
+        *dest16++ = (uint16_t)i3Entries[i2Blocks.array[i]];
+    }
+    for (i = 0; i < i3Distinct; ++i) {
+        const uint32_t *i3Block = i3Blocks.array + i * UCPTRIE_INDEX_3_BLOCK_LENGTH;
+        if ((i3Entries[i] & 0x8000) == 0) {
+            for (int32_t j = 0; j < UCPTRIE_INDEX_3_BLOCK_LENGTH; ++j) {
+                *dest16++ = (uint16_t)i3Block[j];
+            }
+        } else {
+            // Groups of 8 offsets: first the upper 2 bits of each, then the lower 16 bits.
+            for (int32_t j = 0; j < UCPTRIE_INDEX_3_BLOCK_LENGTH; j += 8) {
+                uint32_t upper = 0;
+                for (int32_t k = 0; k < 8; ++k) {
+                    upper |= ((i3Block[j + k] >> 16) & 3) << (14 - 2 * k);
+                }
+                *dest16++ = (uint16_t)upper;
+                for (int32_t k = 0; k < 8; ++k) {
+                    *dest16++ = (uint16_t)i3Block[j + k];
+                }
+            }
+        }
+    }
+    if (dest16 < trie->index + indexLength) {
+        *dest16++ = 0xffee;  // padding
+    }
+
+    const uint32_t *p = newData.array;
+    uint32_t errValue = errorValue & mask;
+    switch (valueWidth) {
+    case UCPTRIE_VALUE_BITS_16: {
+        trie->data.ptr16 = dest16;
+        for (i = 0; i < newData.length; ++i) {
+            *dest16++ = (uint16_t)p[i];
+        }
+        *dest16++ = (uint16_t)highValue;
+        *dest16 = (uint16_t)errValue;
+        break;
+    }
+    case UCPTRIE_VALUE_BITS_32: {
+        uint32_t *dest32 = (uint32_t *)dest16;
+        trie->data.ptr32 = dest32;
+        uprv_memcpy(dest32, p, (size_t)newData.length * 4);
+        dest32 += newData.length;
+        *dest32++ = highValue;
+        *dest32 = errValue;
+        break;
+    }
+    case UCPTRIE_VALUE_BITS_8: {
+        uint8_t *dest8 = (uint8_t *)dest16;
+        trie->data.ptr8 = dest8;
+        for (i = 0; i < newData.length; ++i) {
+            *dest8++ = (uint8_t)p[i];
+        }
+        *dest8++ = (uint8_t)highValue;
+        *dest8 = (uint8_t)errValue;
+        break;
+    }
+    default:
+        // Unreachable because valueWidth was checked above.
+        break;
+    }
+    return trie;
+}
+
+}  // namespace
+
+U_NAMESPACE_END
+
+U_NAMESPACE_USE
+
+U_CAPI UMutableCPTrie * U_EXPORT2
+umutablecptrie_open(uint32_t initialValue, uint32_t errorValue, UErrorCode *pErrorCode) {
+    if (U_FAILURE(*pErrorCode)) {
+        return NULL;
+    }
+    LocalPointer<MutableCodePointTrie> trie(
+        new MutableCodePointTrie(initialValue, errorValue, *pErrorCode), *pErrorCode);
+    if (U_FAILURE(*pErrorCode)) {
+        return NULL;
+    }
+    return reinterpret_cast<UMutableCPTrie *>(trie.orphan());
+}
+
+U_CAPI UMutableCPTrie * U_EXPORT2
+umutablecptrie_clone(const UMutableCPTrie *other, UErrorCode *pErrorCode) {
+    if (U_FAILURE(*pErrorCode)) {
+        return NULL;
+    }
+    if (other == NULL) {
+        return NULL;
+    }
+    LocalPointer<MutableCodePointTrie> clone(
+        new MutableCodePointTrie(*reinterpret_cast<const MutableCodePointTrie *>(other), *pErrorCode),
+        *pErrorCode);
+    if (U_FAILURE(*pErrorCode)) {
+        return NULL;
+    }
+    return reinterpret_cast<UMutableCPTrie *>(clone.orphan());
+}
+
+U_CAPI void U_EXPORT2
+umutablecptrie_close(UMutableCPTrie *trie) {
+    delete reinterpret_cast<MutableCodePointTrie *>(trie);
+}
+
+U_CAPI UMutableCPTrie * U_EXPORT2
+umutablecptrie_fromUCPTrie(const UCPTrie *trie, UErrorCode *pErrorCode) {
+    if (U_FAILURE(*pErrorCode)) {
+        return NULL;
+    }
+    if (trie == NULL) {
+        *pErrorCode = U_ILLEGAL_ARGUMENT_ERROR;
+        return NULL;
+    }
+    return reinterpret_cast<UMutableCPTrie *>(MutableCodePointTrie::fromUCPTrie(trie, *pErrorCode));
+}
+
+U_CAPI uint32_t U_EXPORT2
+umutablecptrie_get(const UMutableCPTrie *trie, UChar32 c) {
+    return reinterpret_cast<const MutableCodePointTrie *>(trie)->get(c);
+}
+
+U_CAPI UChar32 U_EXPORT2
+umutablecptrie_getRange(const UMutableCPTrie *trie, UChar32 start,
+                        UCPMapValueFilter *filter, const void *context, uint32_t *pValue) {
+    return reinterpret_cast<const MutableCodePointTrie *>(trie)->getRange(start, filter, context, pValue);
+}
+
+U_CAPI void U_EXPORT2
+umutablecptrie_set(UMutableCPTrie *trie, UChar32 c, uint32_t value, UErrorCode *pErrorCode) {
+    reinterpret_cast<MutableCodePointTrie *>(trie)->set(c, value, *pErrorCode);
+}
+
+U_CAPI void U_EXPORT2
+umutablecptrie_setRange(UMutableCPTrie *trie, UChar32 start, UChar32 end,
+                        uint32_t value, UErrorCode *pErrorCode) {
+    reinterpret_cast<MutableCodePointTrie *>(trie)->setRange(start, end, value, *pErrorCode);
+}
+
+U_CAPI UCPTrie * U_EXPORT2
+umutablecptrie_buildImmutable(const UMutableCPTrie *trie, UCPTrieType type, UCPTrieValueWidth valueWidth,
+                              UErrorCode *pErrorCode) {
+    return reinterpret_cast<const MutableCodePointTrie *>(trie)->build(type, valueWidth, *pErrorCode);
+}
@@ -0,0 +1,178 @@
+// © 2018 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+/*
+******************************************************************************
+*   file name:  ucptrie_impl.h
+*   encoding:   UTF-8
+*   tab size:   8 (not used)
+*   indentation:4
+*
+*   Definitions needed for both ucptrie.cpp and ucptrie_builder.cpp.
+*/
+
+#ifndef __UCPTRIE_IMPL_H__
+#define __UCPTRIE_IMPL_H__
+
+#include "ucptrie.h"
+
+/* Serialized format -------------------------------------------------------- */
+
+/*
+ * The binary form of a UCPTrie is
+ * - the UCPTrieHeader, followed by
+ * - the index (indexLength uint16_t units, padded to an even number of units), followed by
+ * - the data (dataLength values of the trie's value width).
+ *
+ * The index has these parts:
+ * - The "fast" index for code points below the fast limit (U+10000 for a fast trie,
+ *   U+1000 for a small trie): one 16-bit data block offset per 64 code points.
+ * - The index-1 table: one offset of an index-2 block per 16k code points,
+ *   starting at U+10000 for a fast trie and at U+0000 for a small trie,
+ *   ending at highStart.
+ * - Index-2 blocks: 32 offsets of index-3 blocks each, one per 512 code points.
+ *   Bit 15 of an index-2 entry is set if the index-3 block has 18-bit data offsets.
+ * - Index-3 blocks: 32 data block offsets each, one per 16 code points.
+ *   A block with 16-bit data offsets has 32 units.
+ *   A block with 18-bit data offsets has 4 groups of 9 units each:
+ *   One unit with the upper 2 bits of each of the group's 8 offsets
+ *   (bits 15..14 for the first one, bits 1..0 for the last one),
+ *   followed by the lower 16 bits of the 8 offsets.
+ *
+ * The data has the values for ASCII (U+0000..U+007F) first, at data offset c,
+ * then the 64-value blocks for the fast-index range, then the 16-value blocks,
+ * and finally the high value and the error value.
+ */
+
+/**
+ * Trie data structure in serialized form:
+ *
+ * UCPTrieHeader header;
+ * const uint16_t index[header.indexLength];
+ * const uint8_t/uint16_t/uint32_t data[header.dataLength];
+ */
+typedef struct UCPTrieHeader {
+    /** "Tri3" in big-endian US-ASCII (0x54726933) */
+    uint32_t signature;
+
+    /**
+     * Options bit field:
+     * Bits 15..12: Data length bits 19..16.
+     * Bits 11..8: Data null block offset bits 19..16.
+     * Bits 7..6: UCPTrieType
+     * Bits 5..3: Reserved (0).
+     * Bits 2..0: UCPTrieValueWidth
+     */
+    uint16_t options;
+
+    /** Total length of the index tables. */
+    uint16_t indexLength;
+
+    /** Data length bits 15..0. */
+    uint16_t dataLength;
+
+    /** Index-3 null block offset, 0x7fff if none. */
+    uint16_t index3NullOffset;
+
+    /** Data null block offset bits 15..0, 0xfffff if none. */
+    uint16_t dataNullOffset;
+
+    /**
+     * First code point of the single-value range ending with U+10ffff,
+     * rounded up and then shifted right by UCPTRIE_SHIFT_2.
+     */
+    uint16_t shiftedHighStart;
+} UCPTrieHeader;
+
+/**
+ * Constants for use with UCPTrieHeader.options.
+ */
+enum {
+    /** Signature, "Tri3" in US-ASCII. */
+    UCPTRIE_SIG = 0x54726933,
+    /** Signature of a trie in the other byte order. */
+    UCPTRIE_OE_SIG = 0x33697254,
+
+    UCPTRIE_OPTIONS_DATA_LENGTH_MASK = 0xf000,
+    UCPTRIE_OPTIONS_DATA_NULL_OFFSET_MASK = 0xf00,
+    UCPTRIE_OPTIONS_RESERVED_MASK = 0x38,
+    UCPTRIE_OPTIONS_VALUE_BITS_MASK = 7,
+
+    /**
+     * Value for index3NullOffset which indicates that there is no index-3 null block.
+     * Bit 15 is unused for this value because this bit is used if the index-3 contains
+     * 18-bit indexes.
+     */
+    UCPTRIE_NO_INDEX3_NULL_OFFSET = 0x7fff,
+    UCPTRIE_NO_DATA_NULL_OFFSET = 0xfffff
+};
+
+/* Internal constants. */
+enum {
+    /** The length of the BMP index table. 1024=0x400 */
+    UCPTRIE_BMP_INDEX_LENGTH = 0x10000 >> UCPTRIE_FAST_SHIFT,
+
+    UCPTRIE_SMALL_LIMIT = 0x1000,
+    UCPTRIE_SMALL_INDEX_LENGTH = UCPTRIE_SMALL_LIMIT >> UCPTRIE_FAST_SHIFT,
+
+    /** Shift size for getting the index-3 table offset. */
+    UCPTRIE_SHIFT_3 = 4,
+
+    /** Shift size for getting the index-2 table offset. */
+    UCPTRIE_SHIFT_2 = 5 + UCPTRIE_SHIFT_3,
+
+    /** Shift size for getting the index-1 table offset. */
+    UCPTRIE_SHIFT_1 = 5 + UCPTRIE_SHIFT_2,
+
+    /**
+     * Difference between two shift sizes,
+     * for getting an index-2 offset from an index-3 offset. 5=9-4
+     */
+    UCPTRIE_SHIFT_2_3 = UCPTRIE_SHIFT_2 - UCPTRIE_SHIFT_3,
+
+    /**
+     * Difference between two shift sizes,
+     * for getting an index-1 offset from an index-2 offset. 5=14-9
+     */
+    UCPTRIE_SHIFT_1_2 = UCPTRIE_SHIFT_1 - UCPTRIE_SHIFT_2,
+
+    /**
+     * Number of index-1 entries for the BMP. (4)
+     * This part of the index-1 table is omitted from the serialized form of a fast trie.
+     */
+    UCPTRIE_OMITTED_BMP_INDEX_1_LENGTH = 0x10000 >> UCPTRIE_SHIFT_1,
+
+    /** Number of entries in an index-2 block. 32=0x20 */
+    UCPTRIE_INDEX_2_BLOCK_LENGTH = 1 << UCPTRIE_SHIFT_1_2,
+
+    /** Mask for getting the lower bits for the in-index-2-block offset. */
+    UCPTRIE_INDEX_2_MASK = UCPTRIE_INDEX_2_BLOCK_LENGTH - 1,
+
+    /** Number of code points per index-2 table entry. 512=0x200 */
+    UCPTRIE_CP_PER_INDEX_2_ENTRY = 1 << UCPTRIE_SHIFT_2,
+
+    /** Number of entries in an index-3 block. 32=0x20 */
+    UCPTRIE_INDEX_3_BLOCK_LENGTH = 1 << UCPTRIE_SHIFT_2_3,
+
+    /** Mask for getting the lower bits for the in-index-3-block offset. */
+    UCPTRIE_INDEX_3_MASK = UCPTRIE_INDEX_3_BLOCK_LENGTH - 1,
+
+    /** Number of entries in a small data block. 16=0x10 */
+    UCPTRIE_SMALL_DATA_BLOCK_LENGTH = 1 << UCPTRIE_SHIFT_3,
+
+    /** Mask for getting the lower bits for the in-small-data-block offset. */
+    UCPTRIE_SMALL_DATA_MASK = UCPTRIE_SMALL_DATA_BLOCK_LENGTH - 1,
+
+    /** Number of code points per index-1 table entry. 16k=0x4000 */
+    UCPTRIE_CP_PER_INDEX_1_ENTRY = 1 << UCPTRIE_SHIFT_1,
+
+    /** Maximum data length that data offsets in the index can address: 18 bits. */
+    UCPTRIE_MAX_DATA_LENGTH = 0x40000,
+
+    /**
+     * Maximum offset of an index-3 block in the index,
+     * limited by bit 15 of the index-2 entries.
+     */
+    UCPTRIE_MAX_INDEX_3_OFFSET = 0x7fff
+};
+
+#endif
@@ -2509,6 +2509,124 @@ u_getIntPropertyMinValue(UProperty which);
 U_STABLE int32_t U_EXPORT2
 u_getIntPropertyMaxValue(UProperty which);
 
+#ifndef U_HIDE_DRAFT_API
+/**
+ * Bit for UCHAR_ALPHABETIC in UCharPropertyBundle.binaryProperties.
+ * @draft ICU 62
+ */
+#define UCHAR_BUNDLE_ALPHABETIC 1
+/** Bit for UCHAR_WHITE_SPACE in UCharPropertyBundle.binaryProperties. @draft ICU 62 */
+#define UCHAR_BUNDLE_WHITE_SPACE 2
+/** Bit for UCHAR_LOWERCASE in UCharPropertyBundle.binaryProperties. @draft ICU 62 */
+#define UCHAR_BUNDLE_LOWERCASE 4
+/** Bit for UCHAR_UPPERCASE in UCharPropertyBundle.binaryProperties. @draft ICU 62 */
+#define UCHAR_BUNDLE_UPPERCASE 8
+/** Bit for UCHAR_IDEOGRAPHIC in UCharPropertyBundle.binaryProperties. @draft ICU 62 */
+#define UCHAR_BUNDLE_IDEOGRAPHIC 0x10
+/** Bit for UCHAR_DEFAULT_IGNORABLE_CODE_POINT in UCharPropertyBundle.binaryProperties. @draft ICU 62 */
+#define UCHAR_BUNDLE_DEFAULT_IGNORABLE_CODE_POINT 0x20
+/** Bit for UCHAR_BIDI_MIRRORED in UCharPropertyBundle.binaryProperties. @draft ICU 62 */
+#define UCHAR_BUNDLE_BIDI_MIRRORED 0x40
+/** Bit for UCHAR_DASH in UCharPropertyBundle.binaryProperties. @draft ICU 62 */
+#define UCHAR_BUNDLE_DASH 0x80
+/** Bit for UCHAR_DIACRITIC in UCharPropertyBundle.binaryProperties. @draft ICU 62 */
+#define UCHAR_BUNDLE_DIACRITIC 0x100
+/** Bit for UCHAR_EXTENDER in UCharPropertyBundle.binaryProperties. @draft ICU 62 */
+#define UCHAR_BUNDLE_EXTENDER 0x200
+/** Bit for UCHAR_XID_START in UCharPropertyBundle.binaryProperties. @draft ICU 62 */
+#define UCHAR_BUNDLE_XID_START 0x400
+/** Bit for UCHAR_XID_CONTINUE in UCharPropertyBundle.binaryProperties. @draft ICU 62 */
+#define UCHAR_BUNDLE_XID_CONTINUE 0x800
+/** Bit for UCHAR_TERMINAL_PUNCTUATION in UCharPropertyBundle.binaryProperties. @draft ICU 62 */
+#define UCHAR_BUNDLE_TERMINAL_PUNCTUATION 0x1000
+/** Bit for UCHAR_EMOJI in UCharPropertyBundle.binaryProperties. @draft ICU 62 */
+#define UCHAR_BUNDLE_EMOJI 0x2000
+/** Bit for UCHAR_EMOJI_PRESENTATION in UCharPropertyBundle.binaryProperties. @draft ICU 62 */
+#define UCHAR_BUNDLE_EMOJI_PRESENTATION 0x4000
+/** Bit for UCHAR_EXTENDED_PICTOGRAPHIC in UCharPropertyBundle.binaryProperties. @draft ICU 62 */
+#define UCHAR_BUNDLE_EXTENDED_PICTOGRAPHIC 0x8000
+
+/**
+ * Commonly used properties of a code point, fetched all at once
+ * with u_getPropertyBundle() or u_strGetPropertyBundles().
+ * Each enumerated field has the value that u_getIntPropertyValue() returns
+ * for its property, so that it can be cast to the respective enum type.
+ *
+ * @draft ICU 62
+ */
+typedef struct UCharPropertyBundle {
+    /** UCharCategory, as for u_charType() and UCHAR_GENERAL_CATEGORY. @draft ICU 62 */
+    int8_t generalCategory;
+    /** UCharDirection, as for u_charDirection() and UCHAR_BIDI_CLASS. @draft ICU 62 */
+    int8_t bidiClass;
+    /** UWordBreakValues, as for UCHAR_WORD_BREAK. @draft ICU 62 */
+    int8_t wordBreak;
+    /** ULineBreak, as for UCHAR_LINE_BREAK. @draft ICU 62 */
+    int8_t lineBreak;
+    /** USentenceBreak, as for UCHAR_SENTENCE_BREAK. @draft ICU 62 */
+    int8_t sentenceBreak;
+    /** UGraphemeClusterBreak, as for UCHAR_GRAPHEME_CLUSTER_BREAK. @draft ICU 62 */
+    int8_t graphemeClusterBreak;
+    /** UEastAsianWidth, as for UCHAR_EAST_ASIAN_WIDTH. @draft ICU 62 */
+    int8_t eastAsianWidth;
+    /** UNumericType, as for UCHAR_NUMERIC_TYPE. @draft ICU 62 */
+    int8_t numericType;
+    /** UScriptCode, as for UCHAR_SCRIPT and uscript_getScript(). @draft ICU 62 */
+    int16_t script;
+    /**
+     * Binary properties: Bit set of UCHAR_BUNDLE_ALPHABETIC etc.
+     * for the properties that are true for the code point.
+     * @draft ICU 62
+     */
+    uint16_t binaryProperties;
+} UCharPropertyBundle;
+
+/**
+ * Gets many commonly used properties of a code point at once.
+ * This is faster than separate calls to u_charType(), u_getIntPropertyValue()
+ * and u_hasBinaryProperty() because all of the bundled properties
+ * are looked up with a single trie lookup.
+ *
+ * The combined data is built from the individual property data
+ * the first time this function or u_strGetPropertyBundles() is called.
+ *
+ * @param c the code point; for a value outside 0..U+10FFFF
+ *          the bundle gets the same property values as from u_getIntPropertyValue()
+ * @param bundle receives the property values
+ * @param pErrorCode ICU error code in/out parameter.
+ *                   Must fulfill U_SUCCESS before the function call.
+ * @see u_strGetPropertyBundles
+ * @draft ICU 62
+ */
+U_DRAFT void U_EXPORT2
+u_getPropertyBundle(UChar32 c, UCharPropertyBundle *bundle, UErrorCode *pErrorCode);
+
+/**
+ * Gets the property bundle (see u_getPropertyBundle()) for each code point
+ * in a UTF-16 string.
+ * Each supplementary code point yields one bundle, so the output index
+ * counts code points, not code units.
+ * An unpaired surrogate yields the bundle for its surrogate code point.
+ *
+ * @param s the UTF-16 string
+ * @param length the length of s, or -1 if it is NUL-terminated
+ * @param dest destination array; can be NULL if destCapacity==0 for pure preflighting
+ * @param destCapacity the number of UCharPropertyBundle items that fit into dest
+ * @param pErrorCode ICU error code in/out parameter.
+ *                   Must fulfill U_SUCCESS before the function call.
+ *                   Set to U_BUFFER_OVERFLOW_ERROR if destCapacity is less than
+ *                   the number of code points in s.
+ * @return the number of code points in s, which is the number of bundles
+ *         written to dest if it is not larger than destCapacity
+ * @see u_getPropertyBundle
+ * @draft ICU 62
+ */
+U_DRAFT int32_t U_EXPORT2
+u_strGetPropertyBundles(const UChar *s, int32_t length,
+                        UCharPropertyBundle *dest, int32_t destCapacity,
+                        UErrorCode *pErrorCode);
+#endif  /* U_HIDE_DRAFT_API */
+
 /**
  * Get the numeric value for a Unicode code point as defined in the
  * Unicode Character Database.
@@ -589,6 +589,254 @@ U_NAMESPACE_END
 
 #endif
 
+#ifndef U_HIDE_DRAFT_API
+
+/**
+ * A pool of idle converters, for code that opens and closes converters
+ * for the same few charset names over and over again,
+ * for example one converter per request with the charset from a protocol header.
+ *
+ * @see ucnv_openPool
+ * @draft ICU 62
+ */
+struct UConverterPool;
+/** @draft ICU 62 */
+typedef struct UConverterPool UConverterPool;
+
+/**
+ * Opens an empty converter pool.
+ *
+ * @param maxIdle the maximum number of idle converters that the pool keeps
+ *                per converter; 0 for a default value.
+ *                Values above 1024 result in U_ILLEGAL_ARGUMENT_ERROR.
+ * @param pErrorCode ICU error code in/out parameter.
+ *                   Must fulfill U_SUCCESS before the function call.
+ * @return the pool, to be closed with ucnv_closePool()
+ * @see ucnv_openFromPool
+ * @draft ICU 62
+ */
+U_DRAFT UConverterPool * U_EXPORT2
+ucnv_openPool(int32_t maxIdle, UErrorCode *pErrorCode);
+
+/**
+ * Closes a converter pool and all of its idle converters.
+ * Converters that were taken from the pool and not yet released
+ * remain valid and must be closed with ucnv_close().
+ *
+ * @param pool the converter pool, can be NULL
+ * @draft ICU 62
+ */
+U_DRAFT void U_EXPORT2
+ucnv_closePool(UConverterPool *pool);
+
+/**
+ * Returns a converter for the charset name, like ucnv_open().
+ * The name is resolved only the first time that it is requested from the pool
+ * (names are compared case-insensitively).
+ * After that, an idle converter is returned if there is one,
+ * or else a clone of a converter that the pool keeps for this charset.
+ *
+ * The converter is in its initial state and has the default callbacks,
+ * substitution characters and fallback setting.
+ * It must be used by one thread at a time and returned with ucnv_releaseToPool(),
+ * or closed with ucnv_close().
+ * The pool itself is thread-safe.
+ *
+ * @param pool the converter pool
+ * @param name the charset name, see ucnv_open()
+ * @param pErrorCode ICU error code in/out parameter.
+ *                   Must fulfill U_SUCCESS before the function call.
+ * @return the converter, or NULL if an error occurred
+ * @see ucnv_releaseToPool
+ * @draft ICU 62
+ */
+U_DRAFT UConverter * U_EXPORT2
+ucnv_openFromPool(UConverterPool *pool, const char *name, UErrorCode *pErrorCode);
+
+/**
+ * Returns a converter to the pool, after resetting it with ucnv_reset()
+ * and restoring its substitution characters and fallback setting.
+ * If the converter has custom callbacks, or if the pool already keeps
+ * enough idle converters of its kind, then it is closed instead.
+ *
+ * @param pool the converter pool
+ * @param cnv the converter, can be NULL;
+ *            normally one from ucnv_openFromPool() of the same pool
+ * @see ucnv_openFromPool
+ * @draft ICU 62
+ */
+U_DRAFT void U_EXPORT2
+ucnv_releaseToPool(UConverterPool *pool, UConverter *cnv);
+
+#if U_SHOW_CPLUSPLUS_API
+
+U_NAMESPACE_BEGIN
+
+/**
+ * \class LocalUConverterPoolPointer
+ * "Smart pointer" class, closes a UConverterPool via ucnv_closePool().
+ * For most methods see the LocalPointerBase base class.
+ *
+ * @see LocalPointerBase
+ * @see LocalPointer
+ * @draft ICU 62
+ */
+U_DEFINE_LOCAL_OPEN_POINTER(LocalUConverterPoolPointer, UConverterPool, ucnv_closePool);
+
+U_NAMESPACE_END
+
+#endif
+
+#endif  /* U_HIDE_DRAFT_API */
+
+#ifndef U_HIDE_DRAFT_API
+
+/**
+ * An immutable converter for one charset, for whole-string conversion
+ * with ucnv_toUCharsShared() and ucnv_fromUCharsShared().
+ * Unlike a UConverter, it has no conversion state and no callbacks,
+ * and it can be used by any number of threads at the same time.
+ *
+ * @see ucnv_openShared
+ * @draft ICU 62
+ */
+struct UConverterShared;
+/** @draft ICU 62 */
+typedef struct UConverterShared UConverterShared;
+
+/**
+ * How ucnv_toUCharsShared() and ucnv_fromUCharsShared() handle
+ * illegal, irregular and unassigned input.
+ *
+ * @draft ICU 62
+ */
+typedef enum UConverterInvalidAction {
+    /**
+     * Write the substitution character or string,
+     * like UCNV_TO_U_CALLBACK_SUBSTITUTE and UCNV_FROM_U_CALLBACK_SUBSTITUTE
+     * (the default callbacks of a UConverter).
+     * @draft ICU 62
+     */
+    UCNV_INVALID_SUBSTITUTE,
+    /**
+     * Skip the input, like UCNV_TO_U_CALLBACK_SKIP and UCNV_FROM_U_CALLBACK_SKIP.
+     * @draft ICU 62
+     */
+    UCNV_INVALID_SKIP,
+    /**
+     * Stop with an error code, like UCNV_TO_U_CALLBACK_STOP and UCNV_FROM_U_CALLBACK_STOP.
+     * @draft ICU 62
+     */
+    UCNV_INVALID_STOP
+} UConverterInvalidAction;
+
+/**
+ * Opens a shared converter for the charset name.
+ * The name is resolved, and the converter data loaded, only once.
+ *
+ * @param name the charset name, see ucnv_open()
+ * @param pErrorCode ICU error code in/out parameter.
+ *                   Must fulfill U_SUCCESS before the function call.
+ * @return the shared converter, to be closed with ucnv_closeShared(),
+ *         or NULL if an error occurred
+ * @see ucnv_toUCharsShared
+ * @see ucnv_fromUCharsShared
+ * @draft ICU 62
+ */
+U_DRAFT UConverterShared * U_EXPORT2
+ucnv_openShared(const char *name, UErrorCode *pErrorCode);
+
+/**
+ * Closes a shared converter.
+ * It must not be in use by any thread.
+ *
+ * @param shared the shared converter, can be NULL
+ * @draft ICU 62
+ */
+U_DRAFT void U_EXPORT2
+ucnv_closeShared(UConverterShared *shared);
+
+/**
+ * Converts a codepage string into a Unicode string, like ucnv_toUChars()
+ * with a newly opened converter.
+ * The shared converter is not modified; this function is thread-safe.
+ *
+ * For converters without conversion state, which includes UTF-8
+ * and the table-based single- and multi-byte charsets,
+ * this function does not allocate memory.
+ * Stateful converters like ISO-2022 are cloned for each call.
+ *
+ * @param shared the shared converter
+ * @param action how to handle illegal and unassigned input
+ * @param dest destination string buffer, can be NULL if destCapacity==0
+ * @param destCapacity the number of UChars available at dest
+ * @param src the input codepage string
+ * @param srcLength the input string length, or -1 if NUL-terminated
+ * @param pErrorCode ICU error code in/out parameter.
+ *                   Must fulfill U_SUCCESS before the function call.
+ *                   With UCNV_INVALID_STOP, conversion errors are set
+ *                   as with ucnv_toUChars() and UCNV_TO_U_CALLBACK_STOP.
+ * @return the length of the output string, not counting the terminating NUL;
+ *         if the length is greater than destCapacity, then the string will not fit
+ *         and a buffer of the indicated length would need to be passed in
+ * @see ucnv_toUChars
+ * @draft ICU 62
+ */
+U_DRAFT int32_t U_EXPORT2
+ucnv_toUCharsShared(const UConverterShared *shared, UConverterInvalidAction action,
+                    UChar *dest, int32_t destCapacity,
+                    const char *src, int32_t srcLength,
+                    UErrorCode *pErrorCode);
+
+/**
+ * Converts a Unicode string into a codepage string, like ucnv_fromUChars()
+ * with a newly opened converter.
+ * The shared converter is not modified; this function is thread-safe.
+ * See ucnv_toUCharsShared() for when this function allocates memory.
+ *
+ * @param shared the shared converter
+ * @param action how to handle unpaired surrogates and unassigned input
+ * @param dest destination string buffer, can be NULL if destCapacity==0
+ * @param destCapacity the number of chars available at dest
+ * @param src the input Unicode string
+ * @param srcLength the input string length, or -1 if NUL-terminated
+ * @param pErrorCode ICU error code in/out parameter.
+ *                   Must fulfill U_SUCCESS before the function call.
+ *                   With UCNV_INVALID_STOP, conversion errors are set
+ *                   as with ucnv_fromUChars() and UCNV_FROM_U_CALLBACK_STOP.
+ * @return the length of the output string, not counting the terminating NUL;
+ *         if the length is greater than destCapacity, then the string will not fit
+ *         and a buffer of the indicated length would need to be passed in
+ * @see ucnv_fromUChars
+ * @draft ICU 62
+ */
+U_DRAFT int32_t U_EXPORT2
+ucnv_fromUCharsShared(const UConverterShared *shared, UConverterInvalidAction action,
+                      char *dest, int32_t destCapacity,
+                      const UChar *src, int32_t srcLength,
+                      UErrorCode *pErrorCode);
+
+#if U_SHOW_CPLUSPLUS_API
+
+U_NAMESPACE_BEGIN
+
+/**
+ * \class LocalUConverterSharedPointer
+ * "Smart pointer" class, closes a UConverterShared via ucnv_closeShared().
+ * For most methods see the LocalPointerBase base class.
+ *
+ * @see LocalPointerBase
+ * @see LocalPointer
+ * @draft ICU 62
+ */
+U_DEFINE_LOCAL_OPEN_POINTER(LocalUConverterSharedPointer, UConverterShared, ucnv_closeShared);
+
+U_NAMESPACE_END
+
+#endif
+
+#endif  /* U_HIDE_DRAFT_API */
+
 /**
  * Fills in the output parameter, subChars, with the substitution characters
  * as multiple bytes.
@@ -1571,6 +1819,65 @@ ucnv_convert(const char *toConverterName,
              int32_t sourceLength,
              UErrorCode *pErrorCode);
 
+#ifndef U_HIDE_DRAFT_API
+/**
+ * Convert a complete string from one external charset to another,
+ * using several threads for long strings.
+ * The result is the same as for ucnv_convertEx() with reset and flush set
+ * and the same converters, except that offsets are available.
+ *
+ * The source text is split into chunks where the source converter is
+ * known to be in its initial state, and the chunks are converted with clones
+ * of the two converters; the converters themselves are not modified.
+ * - Between the stateless Unicode charsets (UTF-8, UTF-16BE/LE, UTF-32BE/LE,
+ *   ISO-8859-1 and US-ASCII), the text is split between characters.
+ * - If one of the charsets is an SBCS, DBCS or MBCS codepage, then the text is
+ *   split only after line feeds, and only if the source charset encodes
+ *   line feeds so that they cannot be part of a multi-byte character.
+ * - Otherwise, for example for ISO-2022 or for UTF-16 with a BOM,
+ *   or for short strings, the text is converted on the calling thread.
+ *
+ * The error callbacks and their contexts are shared by all threads.
+ * The predefined callbacks are safe for this; custom callbacks must be
+ * thread-safe and must not depend on the text before the current character.
+ *
+ * Like ucnv_convert(), this function supports preflighting and
+ * NUL-terminates the output if there is space for it.
+ * If a conversion error occurs, then the output before the error
+ * is written to the target and its length is returned.
+ *
+ * @param targetCnv     Output converter, used to convert from the UTF-16 pivot
+ *                      to the target.
+ * @param sourceCnv     Input converter, used to convert from the source to
+ *                      the UTF-16 pivot.
+ * @param target        Pointer to the output buffer.
+ * @param targetCapacity Capacity of the target, in bytes.
+ * @param source        Pointer to the input buffer.
+ * @param sourceLength  Length of the input text, in bytes, or -1 for NUL-terminated input.
+ * @param offsets       If not NULL, then an array of targetCapacity entries
+ *                      which receives for each output byte the index of the source byte
+ *                      where its character begins, or -1 if unknown.
+ * @param numThreads    The maximum number of threads to use, including the calling thread.
+ *                      0 or less for as many threads as there are processors.
+ * @param pErrorCode    ICU error code in/out parameter.
+ *                      Must fulfill U_SUCCESS before the function call.
+ * @return Length of the complete output text in bytes, even if it exceeds the targetCapacity
+ *         and a U_BUFFER_OVERFLOW_ERROR is set.
+ *
+ * @see ucnv_convertEx
+ * @see ucnv_convert
+ * @see ucnv_safeClone
+ * @draft ICU 62
+ */
+U_DRAFT int32_t U_EXPORT2
+ucnv_convertParallel(UConverter *targetCnv, UConverter *sourceCnv,
+                     char *target, int32_t targetCapacity,
+                     const char *source, int32_t sourceLength,
+                     int32_t *offsets,
+                     int32_t numThreads,
+                     UErrorCode *pErrorCode);
+#endif  /* U_HIDE_DRAFT_API */
+
 /**
  * Convert from one external charset to another.
  * Internally, the text is converted to and from the 16-bit Unicode "pivot"
@@ -458,6 +458,35 @@ U_STABLE void U_EXPORT2 UCNV_TO_U_CALLBACK_ESCAPE (
                   UConverterCallbackReason reason,
                   UErrorCode * err);
 
+#ifndef U_HIDE_DRAFT_API
+/**
+ * DO NOT CALL THIS FUNCTION DIRECTLY!
+ * This To Unicode callback replaces each ILLEGAL, IRREGULAR or UNASSIGNED
+ * sequence with one U+FFFD, regardless of the converter's substitution character.
+ *
+ * The UTF-8, UTF-16 and table-based (MBCS/SBCS) converters recognize this callback
+ * and write U+FFFD themselves without leaving their conversion loops,
+ * which is much faster for input with many errors.
+ * As a result, ucnv_getInvalidChars() need not return the last replaced sequence.
+ *
+ * @param context  Ignored.
+ * @param toUArgs Information about the conversion in progress
+ * @param codeUnits Points to 'length' bytes of the concerned codepage sequence
+ * @param length Size (in bytes) of the concerned codepage sequence
+ * @param reason Defines the reason the callback was invoked
+ * @param err Return value will be set to success if the callback was handled,
+ *      otherwise this value will be set to a failure status.
+ * @draft ICU 62
+ */
+U_DRAFT void U_EXPORT2 UCNV_TO_U_CALLBACK_FFFD (
+                  const void *context,
+                  UConverterToUnicodeArgs *toUArgs,
+                  const char* codeUnits,
+                  int32_t length,
+                  UConverterCallbackReason reason,
+                  UErrorCode * err);
+#endif  /* U_HIDE_DRAFT_API */
+
 #endif
 
 #endif
@@ -184,6 +184,134 @@ U_STABLE UEnumeration * U_EXPORT2
 ucnvsel_selectForUTF8(const UConverterSelector* sel,
                       const char *s, int32_t length, UErrorCode *status);
 
+#ifndef U_HIDE_DRAFT_API
+
+/**
+ * Selection state for text that arrives in chunks.
+ * It starts with all of the selector's encodings and removes those
+ * that cannot map a code point of the text added so far.
+ * A code point that is split across chunks is assembled first.
+ *
+ * A state can be used while its selector is open;
+ * one state must not be used by multiple threads at the same time.
+ *
+ * @draft ICU 62
+ */
+struct UConverterSelectorState;
+/** @draft ICU 62 */
+typedef struct UConverterSelectorState UConverterSelectorState;
+
+/**
+ * Opens a selection state for the selector, starting with all of its encodings.
+ *
+ * @param sel a selector; must remain open while the state is used
+ * @param status an in/out ICU UErrorCode
+ * @return the new selection state
+ *
+ * @draft ICU 62
+ */
+U_DRAFT UConverterSelectorState* U_EXPORT2
+ucnvsel_openState(const UConverterSelector* sel, UErrorCode* status);
+
+/**
+ * Closes a selection state.
+ *
+ * @param state the selection state to close
+ *
+ * @draft ICU 62
+ */
+U_DRAFT void U_EXPORT2
+ucnvsel_closeState(UConverterSelectorState* state);
+
+/**
+ * Resets a selection state to all of the selector's encodings and no
+ * pending partial code point, for reuse with a new text.
+ *
+ * @param state the selection state
+ *
+ * @draft ICU 62
+ */
+U_DRAFT void U_EXPORT2
+ucnvsel_resetState(UConverterSelectorState* state);
+
+/**
+ * Adds a chunk of UTF-16 text to the selection.
+ * A lead surrogate at the end of the chunk is paired with a trail surrogate
+ * at the start of the next chunk.
+ *
+ * Once no encoding is left, the text is not looked at any more,
+ * so the caller can stop adding text when this function returns 0.
+ *
+ * @param state the selection state
+ * @param s UTF-16 text
+ * @param length length of the text, or -1 if NUL-terminated
+ * @param status an in/out ICU UErrorCode
+ * @return the number of encodings that can map all of the text added so far
+ *
+ * @draft ICU 62
+ */
+U_DRAFT int32_t U_EXPORT2
+ucnvsel_addString(UConverterSelectorState* state,
+                  const UChar* s, int32_t length, UErrorCode* status);
+
+/**
+ * Adds a chunk of UTF-8 text to the selection.
+ * A character that is split across chunks is assembled first.
+ * As with ucnvsel_selectForUTF8(), ill-formed sequences do not remove any encodings.
+ *
+ * Once no encoding is left, the text is not looked at any more,
+ * so the caller can stop adding text when this function returns 0.
+ *
+ * @param state the selection state
+ * @param s UTF-8 text
+ * @param length length of the text, or -1 if NUL-terminated
+ * @param status an in/out ICU UErrorCode
+ * @return the number of encodings that can map all of the text added so far
+ *
+ * @draft ICU 62
+ */
+U_DRAFT int32_t U_EXPORT2
+ucnvsel_addUTF8(UConverterSelectorState* state,
+                const char* s, int32_t length, UErrorCode* status);
+
+/**
+ * Returns the encodings that can map all of the text added so far,
+ * as if the text ended here: A pending partial code point is treated like
+ * at the end of the input of ucnvsel_selectForString() or ucnvsel_selectForUTF8().
+ * The state is not modified; more text can be added afterwards.
+ *
+ * @param state the selection state
+ * @param status an in/out ICU UErrorCode
+ * @return an enumeration containing encoding names, in the same order as
+ *         supplied when building the selector.
+ *         The enumeration must not be used after the selector is closed.
+ *
+ * @draft ICU 62
+ */
+U_DRAFT UEnumeration * U_EXPORT2
+ucnvsel_selectForState(const UConverterSelectorState* state, UErrorCode* status);
+
+#if U_SHOW_CPLUSPLUS_API
+
+U_NAMESPACE_BEGIN
+
+/**
+ * \class LocalUConverterSelectorStatePointer
+ * "Smart pointer" class, closes a UConverterSelectorState via ucnvsel_closeState().
+ * For most methods see the LocalPointerBase base class.
+ *
+ * @see LocalPointerBase
+ * @see LocalPointer
+ * @draft ICU 62
+ */
+U_DEFINE_LOCAL_OPEN_POINTER(LocalUConverterSelectorStatePointer, UConverterSelectorState, ucnvsel_closeState);
+
+U_NAMESPACE_END
+
+#endif
+
+#endif  /* U_HIDE_DRAFT_API */
+
 #endif  /* !UCONFIG_NO_CONVERSION */
 
 #endif  /* __ICU_UCNV_SEL_H__ */
@@ -28,6 +28,7 @@ U_NAMESPACE_BEGIN
 void U_CALLCONV UnicodeSet_initInclusion(int32_t src, UErrorCode &status); /**< @internal */
 
 class BMPSet;
+class IntPropertySetCacheKey;
 class ParsePosition;
 class RBBIRuleScanner;
 class SymbolTable;
@@ -1617,6 +1618,9 @@ private:
     friend void U_CALLCONV UnicodeSet_initInclusion(int32_t src, UErrorCode &status);
     static const UnicodeSet* getInclusions(int32_t src, UErrorCode &status);
 
+    // Computes the sets for applyIntPropertyValue() which it then caches.
+    friend class IntPropertySetCacheKey;
+
     /**
      * A filter that returns TRUE if the given code point should be
      * included in the UnicodeSet being constructed.
@@ -646,6 +646,104 @@ u_strncasecmp(const UChar *s1, const UChar *s2, int32_t n, uint32_t options);
 U_STABLE int32_t U_EXPORT2
 u_memcasecmp(const UChar *s1, const UChar *s2, int32_t length, uint32_t options);
 
+#ifndef U_HIDE_DRAFT_API
+/**
+ * Compare two UTF-8 strings case-insensitively using full case folding.
+ * This is equivalent to comparing the case foldings of the two strings
+ * in code point order, without converting them to UTF-16 or folding them
+ * into buffers. Runs of ASCII are compared directly.
+ *
+ * Ill-formed UTF-8 sequences are compared like U+FFFD.
+ *
+ * @param s1 First source string.
+ * @param length1 Length of first source string in bytes, or -1 if NUL-terminated.
+ *
+ * @param s2 Second source string.
+ * @param length2 Length of second source string in bytes, or -1 if NUL-terminated.
+ *
+ * @param options A bit set of options:
+ *   - U_FOLD_CASE_DEFAULT or 0 is used for default options:
+ *     Comparison in code point order with default case folding.
+ *
+ *   - U_COMPARE_CODE_POINT_ORDER
+ *     Ignored: UTF-8 strings are always compared in code point order.
+ *
+ *   - U_FOLD_CASE_EXCLUDE_SPECIAL_I
+ *
+ * @param pErrorCode Must be a valid pointer to an error code value,
+ *                  which must not indicate a failure before the function call.
+ *
+ * @return <0 or 0 or >0 as usual for string comparisons
+ *
+ * @see u_strCaseCompare
+ * @draft ICU 62
+ */
+U_DRAFT int32_t U_EXPORT2
+u_strCaseCompareUTF8(const char *s1, int32_t length1,
+                     const char *s2, int32_t length2,
+                     uint32_t options,
+                     UErrorCode *pErrorCode);
+
+/**
+ * Find the first occurrence of a substring in a string, case-insensitively,
+ * using full case folding.
+ * The substring is found where the case folding of a sequence of
+ * whole code points of s equals the case folding of the substring;
+ * for example, "ss" matches U+00DF (sharp s, which folds to "ss")
+ * but "s" alone does not.
+ *
+ * The text is case-folded incrementally while it is searched;
+ * no folded copy of the whole string is made.
+ *
+ * @param s The string to search.
+ * @param length The length of s, or -1 if NUL-terminated.
+ * @param sub The substring to find.
+ * @param subLength The length of sub, or -1 if NUL-terminated.
+ * @param options Either U_FOLD_CASE_DEFAULT or U_FOLD_CASE_EXCLUDE_SPECIAL_I
+ * @param pMatchLength If not NULL, receives the length of the match in s,
+ *                     which can differ from subLength.
+ * @param pErrorCode Must be a valid pointer to an error code value,
+ *                  which must not indicate a failure before the function call.
+ * @return The index of the first occurrence in s, 0 if sub is empty,
+ *         or -1 if sub is not found.
+ *
+ * @see u_strFindFirst
+ * @see u_strCaseCompare
+ * @draft ICU 62
+ */
+U_DRAFT int32_t U_EXPORT2
+u_strCaseFind(const UChar *s, int32_t length,
+              const UChar *sub, int32_t subLength,
+              uint32_t options, int32_t *pMatchLength,
+              UErrorCode *pErrorCode);
+
+/**
+ * Find the first occurrence of a substring in a UTF-8 string, case-insensitively,
+ * using full case folding.
+ * Same as u_strCaseFind() but for UTF-8 strings;
+ * ill-formed UTF-8 sequences are matched like U+FFFD.
+ *
+ * @param s The string to search.
+ * @param length The length of s in bytes, or -1 if NUL-terminated.
+ * @param sub The substring to find.
+ * @param subLength The length of sub in bytes, or -1 if NUL-terminated.
+ * @param options Either U_FOLD_CASE_DEFAULT or U_FOLD_CASE_EXCLUDE_SPECIAL_I
+ * @param pMatchLength If not NULL, receives the length of the match in s, in bytes.
+ * @param pErrorCode Must be a valid pointer to an error code value,
+ *                  which must not indicate a failure before the function call.
+ * @return The byte index of the first occurrence in s, 0 if sub is empty,
+ *         or -1 if sub is not found.
+ *
+ * @see u_strCaseFind
+ * @draft ICU 62
+ */
+U_DRAFT int32_t U_EXPORT2
+u_strCaseFindUTF8(const char *s, int32_t length,
+                  const char *sub, int32_t subLength,
+                  uint32_t options, int32_t *pMatchLength,
+                  UErrorCode *pErrorCode);
+#endif  /* U_HIDE_DRAFT_API */
+
 /**
  * Copy a ustring. Adds a null terminator.
  *
@@ -1449,6 +1547,53 @@ u_strFromUTF8Lenient(UChar *dest,
                      int32_t srcLength,
                      UErrorCode *pErrorCode);
 
+#ifndef U_HIDE_DRAFT_API
+/**
+ * Checks whether a UTF-8 string is well-formed, and counts the UTF-16 code units
+ * of its well-formed part, without converting it.
+ * This is faster than pre-flighting u_strFromUTF8() when only the validity
+ * or the converted length is needed.
+ *
+ * Well-formedness is the same as for u_strFromUTF8():
+ * Surrogate code points, non-shortest forms and code points above U+10FFFF
+ * are ill-formed, as are truncated sequences at the end of the string.
+ *
+ * @param src           The UTF-8 string.
+ * @param srcLength     The length of the string. If -1, then src must be zero-terminated.
+ * @param pUTF16Length  If not NULL, receives the number of UTF-16 code units
+ *                      that the well-formed part of the string converts to.
+ * @return The length of the initial well-formed part of the string:
+ *         The string is well-formed if this equals srcLength,
+ *         or if srcLength==-1 and src[returned index]==0.
+ * @see u_strFromUTF8
+ * @see u_strCheckUTF16
+ * @draft ICU 62
+ */
+U_DRAFT int32_t U_EXPORT2
+u_strCheckUTF8(const char *src, int32_t srcLength, int32_t *pUTF16Length);
+
+/**
+ * Checks whether a UTF-16 string is well-formed, that is, whether all of its
+ * surrogates are paired, and counts the UTF-8 bytes of its well-formed part,
+ * without converting it.
+ * This is faster than pre-flighting u_strToUTF8() when only the validity
+ * or the converted length is needed.
+ *
+ * @param src           The UTF-16 string.
+ * @param srcLength     The length of the string. If -1, then src must be zero-terminated.
+ * @param pUTF8Length   If not NULL, receives the number of UTF-8 bytes
+ *                      that the well-formed part of the string converts to.
+ * @return The length of the initial well-formed part of the string:
+ *         The string is well-formed if this equals srcLength,
+ *         or if srcLength==-1 and src[returned index]==0.
+ * @see u_strToUTF8
+ * @see u_strCheckUTF8
+ * @draft ICU 62
+ */
+U_DRAFT int32_t U_EXPORT2
+u_strCheckUTF16(const UChar *src, int32_t srcLength, int32_t *pUTF8Length);
+#endif  /* U_HIDE_DRAFT_API */
+
 /**
  * Convert a UTF-16 string to UTF-32.
  * If the input string is not well-formed, then the U_INVALID_CHAR_FOUND error code is set.
@@ -46,6 +46,8 @@
 #include "umutex.h"
 #include "uassert.h"
 #include "hash.h"
+#include "sharedunicodeset.h"
+#include "unifiedcache.h"
 
 U_NAMESPACE_USE
 
@@ -942,6 +944,156 @@ void UnicodeSet::applyFilter(UnicodeSet::Filter filter,
     }
 }
 
+//----------------------------------------------------------------
+// Cached frozen sets
+//----------------------------------------------------------------
+
+SharedUnicodeSet::~SharedUnicodeSet() {
+    delete ptr;
+}
+
+namespace {
+
+/**
+ * Freezes the set and wraps it for the unified cache.
+ * Adopts the set even on failure.
+ */
+const SharedUnicodeSet *adoptAsShared(UnicodeSet *set, UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        delete set;
+        return NULL;
+    }
+    if (set == NULL || set->isBogus()) {
+        delete set;
+        status = U_MEMORY_ALLOCATION_ERROR;
+        return NULL;
+    }
+    set->freeze();
+    SharedUnicodeSet *shared = new SharedUnicodeSet(set);
+    if (shared == NULL) {
+        delete set;
+        status = U_MEMORY_ALLOCATION_ERROR;
+        return NULL;
+    }
+    shared->addRef();
+    return shared;
+}
+
+}  // namespace
+
+class UnicodeSetPatternCacheKey : public CacheKey<SharedUnicodeSet> {
+private:
+    UnicodeString fPattern;
+public:
+    UnicodeSetPatternCacheKey(const UnicodeString &pattern) : fPattern(pattern) { }
+    UnicodeSetPatternCacheKey(const UnicodeSetPatternCacheKey &other)
+            : CacheKey<SharedUnicodeSet>(other), fPattern(other.fPattern) { }
+    virtual ~UnicodeSetPatternCacheKey();
+    virtual int32_t hashCode() const {
+        return (int32_t)(37u * (uint32_t)CacheKey<SharedUnicodeSet>::hashCode() +
+                         (uint32_t)fPattern.hashCode());
+    }
+    virtual UBool operator==(const CacheKeyBase &other) const {
+        // reflexive
+        if (this == &other) {
+            return TRUE;
+        }
+        if (!CacheKey<SharedUnicodeSet>::operator==(other)) {
+            return FALSE;
+        }
+        // We know that this and other are of same class if we get this far.
+        const UnicodeSetPatternCacheKey &realOther =
+                static_cast<const UnicodeSetPatternCacheKey &>(other);
+        return realOther.fPattern == fPattern;
+    }
+    virtual CacheKeyBase *clone() const {
+        return new UnicodeSetPatternCacheKey(*this);
+    }
+    virtual const SharedUnicodeSet *createObject(
+            const void * /*unused*/, UErrorCode &status) const {
+        if (U_FAILURE(status)) {
+            return NULL;
+        }
+        return adoptAsShared(new UnicodeSet(fPattern, status), status);
+    }
+};
+
+UnicodeSetPatternCacheKey::~UnicodeSetPatternCacheKey() { }
+
+class IntPropertySetCacheKey : public CacheKey<SharedUnicodeSet> {
+private:
+    UProperty fProp;
+    int32_t fValue;
+public:
+    IntPropertySetCacheKey(UProperty prop, int32_t value) : fProp(prop), fValue(value) { }
+    IntPropertySetCacheKey(const IntPropertySetCacheKey &other)
+            : CacheKey<SharedUnicodeSet>(other),
+              fProp(other.fProp), fValue(other.fValue) { }
+    virtual ~IntPropertySetCacheKey();
+    virtual int32_t hashCode() const {
+        return (int32_t)(37u * (37u * (uint32_t)CacheKey<SharedUnicodeSet>::hashCode() +
+                                (uint32_t)fProp) + (uint32_t)fValue);
+    }
+    virtual UBool operator==(const CacheKeyBase &other) const {
+        // reflexive
+        if (this == &other) {
+            return TRUE;
+        }
+        if (!CacheKey<SharedUnicodeSet>::operator==(other)) {
+            return FALSE;
+        }
+        // We know that this and other are of same class if we get this far.
+        const IntPropertySetCacheKey &realOther =
+                static_cast<const IntPropertySetCacheKey &>(other);
+        return realOther.fProp == fProp && realOther.fValue == fValue;
+    }
+    virtual CacheKeyBase *clone() const {
+        return new IntPropertySetCacheKey(*this);
+    }
+    virtual const SharedUnicodeSet *createObject(
+            const void * /*unused*/, UErrorCode &status) const {
+        if (U_FAILURE(status)) {
+            return NULL;
+        }
+        UnicodeSet *set = new UnicodeSet();
+        if (set == NULL) {
+            status = U_MEMORY_ALLOCATION_ERROR;
+            return NULL;
+        }
+        if (fProp == UCHAR_GENERAL_CATEGORY_MASK) {
+            int32_t value = fValue;
+            set->applyFilter(generalCategoryMaskFilter, &value, UPROPS_SRC_CHAR, status);
+        } else if (fProp == UCHAR_SCRIPT_EXTENSIONS) {
+            UScriptCode script = (UScriptCode)fValue;
+            set->applyFilter(scriptExtensionsFilter, &script, UPROPS_SRC_PROPSVEC, status);
+        } else {
+            IntPropertyContext c = {fProp, fValue};
+            set->applyFilter(intPropertyFilter, &c, uprops_getSource(fProp), status);
+        }
+        return adoptAsShared(set, status);
+    }
+};
+
+IntPropertySetCacheKey::~IntPropertySetCacheKey() { }
+
+void SharedUnicodeSet::getForPattern(const UnicodeString &pattern,
+                                     const SharedUnicodeSet *&ptr, UErrorCode &errorCode) {
+    const UnifiedCache *cache = UnifiedCache::getInstance(errorCode);
+    if (U_FAILURE(errorCode)) {
+        return;
+    }
+    cache->get(UnicodeSetPatternCacheKey(pattern), ptr, errorCode);
+}
+
+void SharedUnicodeSet::getForIntPropertyValue(UProperty prop, int32_t value,
+                                              const SharedUnicodeSet *&ptr, UErrorCode &errorCode) {
+    const UnifiedCache *cache = UnifiedCache::getInstance(errorCode);
+    if (U_FAILURE(errorCode)) {
+        return;
+    }
+    cache->get(IntPropertySetCacheKey(prop, value), ptr, errorCode);
+}
+
 namespace {
 
 static UBool mungeCharName(char* dst, const char* src, int32_t dstCapacity) {
@@ -973,15 +1125,16 @@ UnicodeSet&
 UnicodeSet::applyIntPropertyValue(UProperty prop, int32_t value, UErrorCode& ec) {
     if (U_FAILURE(ec) || isFrozen()) return *this;
 
-    if (prop == UCHAR_GENERAL_CATEGORY_MASK) {
-        applyFilter(generalCategoryMaskFilter, &value, UPROPS_SRC_CHAR, ec);
-    } else if (prop == UCHAR_SCRIPT_EXTENSIONS) {
-        UScriptCode script = (UScriptCode)value;
-        applyFilter(scriptExtensionsFilter, &script, UPROPS_SRC_PROPSVEC, ec);
-    } else {
-        IntPropertyContext c = {prop, value};
-        applyFilter(intPropertyFilter, &c, uprops_getSource(prop), ec);
+    // Each set is computed once (see IntPropertySetCacheKey) and then copied.
+    const SharedUnicodeSet *shared = NULL;
+    SharedUnicodeSet::getForIntPropertyValue(prop, value, shared, ec);
+    if (U_SUCCESS(ec)) {
+        clear().addAll(**shared);
+        if (isBogus()) {
+            ec = U_MEMORY_ALLOCATION_ERROR;
+        }
     }
+    SharedObject::clearPtr(shared);
     return *this;
 }
 
@@ -22,6 +22,7 @@
 #include "unicode/utf8.h"
 #include "unicode/utf16.h"
 #include "cmemory.h"
+#include "uarrsort.h"
 #include "uvector.h"
 #include "unisetspan.h"
 
@@ -193,12 +194,385 @@ appendUTF8(const UChar *s, int32_t length, uint8_t *t, int32_t capacity) {
     }
 }
 
+// A frozen set with at least this many strings matches them with automata.
+static const int32_t MIN_AUTOMATON_STRINGS=8;
+
 static inline uint8_t
 makeSpanLengthByte(int32_t spanLength) {
     // 0xfe==UnicodeSetStringSpan::LONG_SPAN
     return spanLength<0xfe ? (uint8_t)spanLength : (uint8_t)0xfe;
 }
 
+/*
+ * Aho-Corasick automaton over the strings of a frozen set, for one span() variant:
+ * The UTF-16 or UTF-8 strings, reversed for spanBack() and spanBackUTF8().
+ *
+ * span() etc. try to match every string at every position in a window around
+ * the current position, which becomes slow for sets with many strings.
+ * Instead, the automaton reads the text once across the window and reports
+ * all string matches there.
+ * For the backward variants it reads the text backward, so that it sees the
+ * strings forward in the text as it sees the reversed strings in its own order;
+ * positions are then counted from the end of the text.
+ *
+ * The states are numbered in breadth-first order.
+ * The children of each state are consecutive states, sorted by the unit
+ * on the edge from the parent, so that a transition is a binary search.
+ * A state is terminal, that is, a whole string ends there, if simpleOverlaps[state]>=0.
+ */
+class StringSpanAutomaton : public UMemory {
+public:
+    /*
+     * @param strings count unit sequences, concatenated;
+     *        already reversed for a backward variant
+     * @param limits limits[i] is the end of sequence i in strings
+     * @param stringContainedOverlaps for each string, how far it may overlap
+     *        with a preceding code point span in span(USET_SPAN_CONTAINED),
+     *        or -1 if it is irrelevant there
+     * @param stringSimpleOverlaps for each string, how far it may overlap
+     *        with a preceding code point span in span(USET_SPAN_SIMPLE)
+     */
+    StringSpanAutomaton(const uint16_t *strings, const int32_t *limits,
+                        const int32_t *stringContainedOverlaps, const int32_t *stringSimpleOverlaps,
+                        int32_t count, UErrorCode &errorCode);
+    StringSpanAutomaton(const StringSpanAutomaton &other, UErrorCode &errorCode);
+    ~StringSpanAutomaton();
+
+    /*
+     * Finds the string matches for span(USET_SPAN_CONTAINED) at pos
+     * which may overlap with the preceding spanLength units,
+     * and adds their ends as offsets from pos.
+     * For backward, pos and spanLength are as in spanBack() and the offsets
+     * are decrements.
+     * @return TRUE if a match reaches the end (start for backward) of the text
+     */
+    template<UBool backward, typename Unit>
+    UBool matchContained(const Unit *s, int32_t length, int32_t pos, int32_t spanLength,
+                         OffsetList &offsets) const;
+
+    /*
+     * Finds the longest string match from the earliest start for span(USET_SPAN_SIMPLE)
+     * at pos which may overlap with the preceding spanLength units.
+     * Sets maxInc and maxOverlap as the string matching loop would.
+     */
+    template<UBool backward, typename Unit>
+    void matchLongest(const Unit *s, int32_t length, int32_t pos, int32_t spanLength,
+                      int32_t &maxInc, int32_t &maxOverlap) const;
+
+private:
+    StringSpanAutomaton(const StringSpanAutomaton &other);  // no default copy constructor
+    StringSpanAutomaton &operator=(const StringSpanAutomaton &other);  // no assignment operator
+
+    // Six int32_t arrays of capacity items (childStarts has one more) and the units.
+    static int32_t getMemorySize(int32_t capacity) { return capacity*(6*4+2)+4; }
+    UBool allocate(int32_t capacity, UErrorCode &errorCode);
+    int32_t findChild(int32_t state, uint16_t unit) const;
+
+    // Follows failure links until there is an edge for the unit.
+    inline int32_t next(int32_t state, uint16_t unit) const {
+        for(;;) {
+            int32_t child=findChild(state, unit);
+            if(child>0 || state==0) {
+                return child;
+            }
+            state=failures[state];
+        }
+    }
+
+    int32_t capacity;
+    int32_t stateCount;
+    // Maximum overlaps over all strings.
+    int32_t maxContainedOverlap;
+    int32_t maxSimpleOverlap;
+
+    // One memory block for all of the following arrays.
+    int32_t *memory;
+    // childStarts[state]..childStarts[state+1]-1 are the children of the state.
+    int32_t *childStarts;
+    int32_t *failures;
+    // Next terminal state on the failure chain, or 0 if there is none.
+    int32_t *outputs;
+    // Number of units from the root; for a terminal state, the length of its string.
+    int32_t *depths;
+    // Per-string data for terminal states, -1 for others.
+    int32_t *containedOverlaps;
+    int32_t *simpleOverlaps;
+    // The unit on the edge from the parent.
+    uint16_t *units;
+};
+
+namespace {
+
+struct SequenceArray {
+    const uint16_t *strings;
+    const int32_t *limits;
+
+    int32_t start(int32_t i) const { return i==0 ? 0 : limits[i-1]; }
+    int32_t length(int32_t i) const { return limits[i]-start(i); }
+};
+
+}  // namespace
+
+U_CDECL_BEGIN
+
+static int32_t U_CALLCONV
+compareSequences(const void *context, const void *left, const void *right) {
+    const SequenceArray &sequences=*static_cast<const SequenceArray *>(context);
+    int32_t i=*static_cast<const int32_t *>(left);
+    int32_t j=*static_cast<const int32_t *>(right);
+    const uint16_t *s=sequences.strings+sequences.start(i);
+    const uint16_t *t=sequences.strings+sequences.start(j);
+    int32_t sLength=sequences.length(i), tLength=sequences.length(j);
+    int32_t minLength=sLength<tLength ? sLength : tLength;
+    for(int32_t k=0; k<minLength; ++k) {
+        if(s[k]!=t[k]) {
+            return (int32_t)s[k]-(int32_t)t[k];
+        }
+    }
+    return sLength-tLength;
+}
+
+U_CDECL_END
+
+StringSpanAutomaton::StringSpanAutomaton(const uint16_t *strings, const int32_t *limits,
+                                         const int32_t *stringContainedOverlaps,
+                                         const int32_t *stringSimpleOverlaps,
+                                         int32_t count, UErrorCode &errorCode)
+        : capacity(0), stateCount(0), maxContainedOverlap(0), maxSimpleOverlap(0),
+          memory(NULL) {
+    if(U_FAILURE(errorCode)) {
+        return;
+    }
+    // At most one state per unit, plus the root.
+    if(count<=0 || !allocate(limits[count-1]+1, errorCode)) {
+        return;
+    }
+    SequenceArray sequences={ strings, limits };
+    LocalMemory<int32_t> order((int32_t *)uprv_malloc(count*4));
+    // Range of sorted strings with the same prefix up to each state.
+    LocalMemory<int32_t> starts((int32_t *)uprv_malloc(capacity*4));
+    LocalMemory<int32_t> ends((int32_t *)uprv_malloc(capacity*4));
+    if(order.isNull() || starts.isNull() || ends.isNull()) {
+        errorCode=U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    for(int32_t i=0; i<count; ++i) {
+        order[i]=i;
+    }
+    uprv_sortArray(order.getAlias(), count, 4, compareSequences, &sequences, FALSE, &errorCode);
+    if(U_FAILURE(errorCode)) {
+        return;
+    }
+
+    // Build the trie breadth-first, so that each state's children are consecutive.
+    stateCount=1;
+    depths[0]=0;
+    starts[0]=0;
+    ends[0]=count;
+    for(int32_t state=0; state<stateCount; ++state) {
+        childStarts[state]=stateCount;
+        int32_t depth=depths[state];
+        int32_t k=starts[state], limit=ends[state];
+        containedOverlaps[state]=simpleOverlaps[state]=-1;
+        // A string that ends here sorts before its extensions.
+        if(k<limit && sequences.length(order[k])==depth) {
+            int32_t i=order[k++];
+            containedOverlaps[state]=stringContainedOverlaps[i];
+            simpleOverlaps[state]=stringSimpleOverlaps[i];
+            if(stringContainedOverlaps[i]>maxContainedOverlap) {
+                maxContainedOverlap=stringContainedOverlaps[i];
+            }
+            if(stringSimpleOverlaps[i]>maxSimpleOverlap) {
+                maxSimpleOverlap=stringSimpleOverlaps[i];
+            }
+        }
+        while(k<limit) {
+            uint16_t unit=strings[sequences.start(order[k])+depth];
+            int32_t groupLimit=k+1;
+            while(groupLimit<limit && strings[sequences.start(order[groupLimit])+depth]==unit) {
+                ++groupLimit;
+            }
+            int32_t child=stateCount++;
+            units[child]=unit;
+            depths[child]=depth+1;
+            starts[child]=k;
+            ends[child]=groupLimit;
+            k=groupLimit;
+        }
+    }
+    childStarts[stateCount]=stateCount;
+
+    // Failure links: The longest proper suffix of a state's units that is also a state.
+    // Parents precede their children, and failure states have lower depths.
+    failures[0]=outputs[0]=0;
+    for(int32_t state=0; state<stateCount; ++state) {
+        for(int32_t child=childStarts[state]; child<childStarts[state+1]; ++child) {
+            int32_t failure=0;
+            if(state!=0) {
+                failure=next(failures[state], units[child]);
+            }
+            failures[child]=failure;
+            outputs[child]=simpleOverlaps[failure]>=0 ? failure : outputs[failure];
+        }
+    }
+}
+
+StringSpanAutomaton::StringSpanAutomaton(const StringSpanAutomaton &other, UErrorCode &errorCode)
+        : capacity(0), stateCount(other.stateCount),
+          maxContainedOverlap(other.maxContainedOverlap), maxSimpleOverlap(other.maxSimpleOverlap),
+          memory(NULL) {
+    if(U_SUCCESS(errorCode) && allocate(other.capacity, errorCode)) {
+        uprv_memcpy(memory, other.memory, getMemorySize(capacity));
+    }
+}
+
+StringSpanAutomaton::~StringSpanAutomaton() {
+    uprv_free(memory);
+}
+
+UBool StringSpanAutomaton::allocate(int32_t newCapacity, UErrorCode &errorCode) {
+    memory=(int32_t *)uprv_malloc(getMemorySize(newCapacity));
+    if(memory==NULL) {
+        errorCode=U_MEMORY_ALLOCATION_ERROR;
+        return FALSE;
+    }
+    capacity=newCapacity;
+    childStarts=memory;
+    failures=childStarts+capacity+1;
+    outputs=failures+capacity;
+    depths=outputs+capacity;
+    containedOverlaps=depths+capacity;
+    simpleOverlaps=containedOverlaps+capacity;
+    units=(uint16_t *)(simpleOverlaps+capacity);
+    return TRUE;
+}
+
+int32_t StringSpanAutomaton::findChild(int32_t state, uint16_t unit) const {
+    int32_t start=childStarts[state], limit=childStarts[state+1];
+    while(start<limit) {
+        int32_t i=(start+limit)/2;
+        uint16_t u=units[i];
+        if(unit<u) {
+            limit=i;
+        } else if(unit>u) {
+            start=i+1;
+        } else {
+            return i;
+        }
+    }
+    return 0;
+}
+
+// Does a match from start to limit begin and end at code point boundaries?
+// Same as the boundary checks in matches16CPB().
+static inline UBool
+isMatchBoundary(const UChar *s, int32_t length, int32_t start, int32_t limit) {
+    return !(0<start && U16_IS_LEAD(s[start-1]) && U16_IS_TRAIL(s[start])) &&
+           !(limit<length && U16_IS_LEAD(s[limit-1]) && U16_IS_TRAIL(s[limit]));
+}
+
+// The UTF-8 strings are well-formed, so only the start needs to be checked,
+// as in the UTF-8 string matching loops.
+static inline UBool
+isMatchBoundary(const uint8_t *s, int32_t /*length*/, int32_t start, int32_t /*limit*/) {
+    return !U8_IS_TRAIL(s[start]);
+}
+
+/*
+ * The automaton reads the text from pos-min(spanLength, maxOverlap) on.
+ * At text index i (after reading the unit before i), each terminal state
+ * on the output chain is a string match ending at i;
+ * it is usable if it starts at or before pos and does not overlap more than
+ * spanLength and the string's own maximum overlap.
+ * The output chain goes to shorter strings, and once the current state's units
+ * start after pos, no later match can start at or before pos.
+ *
+ * For backward, index i counts units from the end of the text,
+ * and the match from i-depth to i is s[length-i..length-i+depth-1].
+ */
+template<UBool backward, typename Unit>
+UBool StringSpanAutomaton::matchContained(const Unit *s, int32_t length,
+                                          int32_t pos, int32_t spanLength,
+                                          OffsetList &offsets) const {
+    if(backward) {
+        pos=length-pos;
+    }
+    int32_t rest=length-pos;
+    int32_t i=pos-(spanLength<maxContainedOverlap ? spanLength : maxContainedOverlap);
+    int32_t state=0;
+    while(i<length) {
+        state=next(state, backward ? s[length-1-i] : s[i]);
+        ++i;
+        if((i-depths[state])>pos) {
+            break;
+        }
+        int32_t inc=i-pos;
+        if(inc<=0) {
+            continue;  // While contained, a string match must end after pos.
+        }
+        int32_t t= simpleOverlaps[state]>=0 ? state : outputs[state];
+        while(t!=0) {
+            int32_t overlap=depths[t]-inc;
+            if(overlap<0) {
+                break;
+            }
+            if( overlap<=spanLength && overlap<=containedOverlaps[t] &&
+                !offsets.containsOffset(inc) &&
+                (backward ?
+                    isMatchBoundary(s, length, length-i, length-i+depths[t]) :
+                    isMatchBoundary(s, length, i-depths[t], i))
+            ) {
+                if(inc==rest) {
+                    return TRUE;
+                }
+                offsets.addOffset(inc);
+            }
+            t=outputs[t];
+        }
+    }
+    return FALSE;
+}
+
+template<UBool backward, typename Unit>
+void StringSpanAutomaton::matchLongest(const Unit *s, int32_t length,
+                                       int32_t pos, int32_t spanLength,
+                                       int32_t &maxInc, int32_t &maxOverlap) const {
+    if(backward) {
+        pos=length-pos;
+    }
+    int32_t i=pos-(spanLength<maxSimpleOverlap ? spanLength : maxSimpleOverlap);
+    int32_t state=0;
+    while(i<length) {
+        state=next(state, backward ? s[length-1-i] : s[i]);
+        ++i;
+        if((i-depths[state])>pos) {
+            break;
+        }
+        int32_t inc=i-pos;
+        if(inc<0) {
+            continue;
+        }
+        int32_t t= simpleOverlaps[state]>=0 ? state : outputs[state];
+        while(t!=0) {
+            int32_t overlap=depths[t]-inc;
+            if(overlap<maxOverlap) {
+                break;  // Shorter strings start later.
+            }
+            // Longer, or starts earlier.
+            if( overlap<=spanLength && overlap<=simpleOverlaps[t] &&
+                (overlap>maxOverlap || inc>maxInc) &&
+                (backward ?
+                    isMatchBoundary(s, length, length-i, length-i+depths[t]) :
+                    isMatchBoundary(s, length, i-depths[t], i))
+            ) {
+                maxInc=inc;
+                maxOverlap=overlap;
+            }
+            t=outputs[t];
+        }
+    }
+}
+
 // Construct for all variants of span(), or only for any one variant.
 // Initialize as little as possible, for single use.
 UnicodeSetStringSpan::UnicodeSetStringSpan(const UnicodeSet &set,
@@ -209,6 +583,7 @@ UnicodeSetStringSpan::UnicodeSetStringSpan(const UnicodeSet &set,
           utf8Length(0),
           maxLength16(0), maxLength8(0),
           all((UBool)(which==ALL)) {
+    uprv_memset(automata, 0, sizeof(automata));
     spanSet.retainAll(set);
     if(which&NOT_CONTAINED) {
         // Default to the same sets.
@@ -386,6 +761,9 @@ UnicodeSetStringSpan::UnicodeSetStringSpan(const UnicodeSet &set,
     // Finish.
     if(all) {
         pSpanNotSet->freeze();
+        if(stringsLength>=MIN_AUTOMATON_STRINGS) {
+            buildAutomata();
+        }
     }
 }
 
@@ -397,6 +775,7 @@ UnicodeSetStringSpan::UnicodeSetStringSpan(const UnicodeSetStringSpan &otherStri
           utf8Length(otherStringSpan.utf8Length),
           maxLength16(otherStringSpan.maxLength16), maxLength8(otherStringSpan.maxLength8),
           all(TRUE) {
+    uprv_memset(automata, 0, sizeof(automata));
     if(otherStringSpan.pSpanNotSet==&otherStringSpan.spanSet) {
         pSpanNotSet=&spanSet;
     } else {
@@ -420,6 +799,18 @@ UnicodeSetStringSpan::UnicodeSetStringSpan(const UnicodeSetStringSpan &otherStri
     spanLengths=(uint8_t *)(utf8Lengths+stringsLength);
     utf8=spanLengths+stringsLength*4;
     uprv_memcpy(utf8Lengths, otherStringSpan.utf8Lengths, allocSize);
+
+    for(int32_t i=0; i<4; ++i) {
+        if(otherStringSpan.automata[i]!=NULL) {
+            // Without an automaton, span() etc. match each string in turn.
+            UErrorCode errorCode=U_ZERO_ERROR;
+            automata[i]=new StringSpanAutomaton(*otherStringSpan.automata[i], errorCode);
+            if(U_FAILURE(errorCode)) {
+                delete automata[i];
+                automata[i]=NULL;
+            }
+        }
+    }
 }
 
 UnicodeSetStringSpan::~UnicodeSetStringSpan() {
@@ -429,6 +820,100 @@ UnicodeSetStringSpan::~UnicodeSetStringSpan() {
     if(utf8Lengths!=NULL && utf8Lengths!=staticLengths) {
         uprv_free(utf8Lengths);
     }
+    for(int32_t i=0; i<4; ++i) {
+        delete automata[i];
+    }
+}
+
+void UnicodeSetStringSpan::buildAutomata() {
+    // Each automaton stores the strings as they are matched,
+    // as UTF-16 or UTF-8 units, reversed for the backward variants.
+    int32_t stringsLength=strings.size();
+    int32_t capacity=utf8Length;
+    for(int32_t i=0; i<stringsLength; ++i) {
+        capacity+=((const UnicodeString *)strings.elementAt(i))->length();
+    }
+    LocalMemory<uint16_t> units((uint16_t *)uprv_malloc(capacity*2));
+    LocalMemory<int32_t> limits((int32_t *)uprv_malloc(stringsLength*4*3));
+    if(units.isNull() || limits.isNull()) {
+        return;  // Out of memory: Match each string in turn.
+    }
+    int32_t *containedOverlaps=limits.getAlias()+stringsLength;
+    int32_t *simpleOverlaps=containedOverlaps+stringsLength;
+
+    for(int32_t variant=0; variant<4; ++variant) {
+        UBool backward=(UBool)((variant&1)!=0);
+        UBool isUTF8=(UBool)(variant>=2);
+        const uint8_t *variantSpanLengths=spanLengths+variant*stringsLength;
+        const uint8_t *s8=utf8;
+        int32_t count=0, unitsLength=0;
+        for(int32_t i=0; i<stringsLength; ++i) {
+            int32_t spanLength=variantSpanLengths[i];
+            int32_t length, contained;
+            if(!isUTF8) {
+                const UnicodeString &string=*(const UnicodeString *)strings.elementAt(i);
+                const UChar *s16=string.getBuffer();
+                length=string.length();
+                for(int32_t j=0; j<length; ++j) {
+                    units[unitsLength+j]=s16[backward ? length-1-j : j];
+                }
+                // Same overlaps as in the string matching loops.
+                if(spanLength==ALL_CP_CONTAINED) {
+                    contained=-1;
+                } else if(spanLength==LONG_SPAN) {
+                    if(backward) {
+                        int32_t len1=0;
+                        U16_FWD_1(s16, len1, length);
+                        contained=length-len1;
+                    } else {
+                        contained=length;
+                        U16_BACK_1(s16, 0, contained);
+                    }
+                } else {
+                    contained=spanLength;
+                }
+            } else {
+                length=utf8Lengths[i];
+                if(length==0) {
+                    continue;  // String not representable in UTF-8.
+                }
+                for(int32_t j=0; j<length; ++j) {
+                    units[unitsLength+j]=s8[backward ? length-1-j : j];
+                }
+                if(spanLength==ALL_CP_CONTAINED) {
+                    contained=-1;
+                } else if(spanLength==LONG_SPAN) {
+                    if(backward) {
+                        int32_t len1=0;
+                        U8_FWD_1(s8, len1, length);
+                        contained=length-len1;
+                    } else {
+                        contained=length;
+                        U8_BACK_1(s8, 0, contained);
+                    }
+                } else {
+                    contained=spanLength;
+                }
+                s8+=length;
+            }
+            unitsLength+=length;
+            limits[count]=unitsLength;
+            containedOverlaps[count]=contained;
+            simpleOverlaps[count]=spanLength>=LONG_SPAN ? length : spanLength;
+            ++count;
+        }
+        if(count==0) {
+            continue;
+        }
+        UErrorCode errorCode=U_ZERO_ERROR;
+        automata[variant]=new StringSpanAutomaton(units.getAlias(), limits.getAlias(),
+                                                  containedOverlaps, simpleOverlaps,
+                                                  count, errorCode);
+        if(U_FAILURE(errorCode)) {
+            delete automata[variant];
+            automata[variant]=NULL;
+        }
+    }
 }
 
 void UnicodeSetStringSpan::addToSpanNotSet(UChar32 c) {
@@ -648,80 +1133,91 @@ int32_t UnicodeSetStringSpan::span(const UChar *s, int32_t length, USetSpanCondi
     }
     int32_t pos=spanLength, rest=length-pos;
     int32_t i, stringsLength=strings.size();
+    const StringSpanAutomaton *automaton=automata[0];
     for(;;) {
         if(spanCondition==USET_SPAN_CONTAINED) {
-            for(i=0; i<stringsLength; ++i) {
-                int32_t overlap=spanLengths[i];
-                if(overlap==ALL_CP_CONTAINED) {
-                    continue;  // Irrelevant string.
-                }
-                const UnicodeString &string=*(const UnicodeString *)strings.elementAt(i);
-                const UChar *s16=string.getBuffer();
-                int32_t length16=string.length();
-
-                // Try to match this string at pos-overlap..pos.
-                if(overlap>=LONG_SPAN) {
-                    overlap=length16;
-                    // While contained: No point matching fully inside the code point span.
-                    U16_BACK_1(s16, 0, overlap);  // Length of the string minus the last code point.
-                }
-                if(overlap>spanLength) {
-                    overlap=spanLength;
+            if(automaton!=NULL) {
+                if(automaton->matchContained<FALSE>(s, length, pos, spanLength, offsets)) {
+                    return length;  // Reached the end of the string.
                 }
-                int32_t inc=length16-overlap;  // Keep overlap+inc==length16.
-                for(;;) {
-                    if(inc>rest) {
-                        break;
+            } else {
+                for(i=0; i<stringsLength; ++i) {
+                    int32_t overlap=spanLengths[i];
+                    if(overlap==ALL_CP_CONTAINED) {
+                        continue;  // Irrelevant string.
                     }
-                    // Try to match if the increment is not listed already.
-                    if(!offsets.containsOffset(inc) && matches16CPB(s, pos-overlap, length, s16, length16)) {
-                        if(inc==rest) {
-                            return length;  // Reached the end of the string.
-                        }
-                        offsets.addOffset(inc);
+                    const UnicodeString &string=*(const UnicodeString *)strings.elementAt(i);
+                    const UChar *s16=string.getBuffer();
+                    int32_t length16=string.length();
+
+                    // Try to match this string at pos-overlap..pos.
+                    if(overlap>=LONG_SPAN) {
+                        overlap=length16;
+                        // While contained: No point matching fully inside the code point span.
+                        U16_BACK_1(s16, 0, overlap);  // Length of the string minus the last code point.
                     }
-                    if(overlap==0) {
-                        break;
+                    if(overlap>spanLength) {
+                        overlap=spanLength;
+                    }
+                    int32_t inc=length16-overlap;  // Keep overlap+inc==length16.
+                    for(;;) {
+                        if(inc>rest) {
+                            break;
+                        }
+                        // Try to match if the increment is not listed already.
+                        if(!offsets.containsOffset(inc) && matches16CPB(s, pos-overlap, length, s16, length16)) {
+                            if(inc==rest) {
+                                return length;  // Reached the end of the string.
+                            }
+                            offsets.addOffset(inc);
+                        }
+                        if(overlap==0) {
+                            break;
+                        }
+                        --overlap;
+                        ++inc;
                     }
-                    --overlap;
-                    ++inc;
                 }
             }
         } else /* USET_SPAN_SIMPLE */ {
             int32_t maxInc=0, maxOverlap=0;
-            for(i=0; i<stringsLength; ++i) {
-                int32_t overlap=spanLengths[i];
-                // For longest match, we do need to try to match even an all-contained string
-                // to find the match from the earliest start.
+            if(automaton!=NULL) {
+                automaton->matchLongest<FALSE>(s, length, pos, spanLength, maxInc, maxOverlap);
+            } else {
+                for(i=0; i<stringsLength; ++i) {
+                    int32_t overlap=spanLengths[i];
+                    // For longest match, we do need to try to match even an all-contained string
+                    // to find the match from the earliest start.
 
-                const UnicodeString &string=*(const UnicodeString *)strings.elementAt(i);
-                const UChar *s16=string.getBuffer();
-                int32_t length16=string.length();
+                    const UnicodeString &string=*(const UnicodeString *)strings.elementAt(i);
+                    const UChar *s16=string.getBuffer();
+                    int32_t length16=string.length();
 
-                // Try to match this string at pos-overlap..pos.
-                if(overlap>=LONG_SPAN) {
-                    overlap=length16;
-                    // Longest match: Need to match fully inside the code point span
-                    // to find the match from the earliest start.
-                }
-                if(overlap>spanLength) {
-                    overlap=spanLength;
-                }
-                int32_t inc=length16-overlap;  // Keep overlap+inc==length16.
-                for(;;) {
-                    if(inc>rest || overlap<maxOverlap) {
-                        break;
+                    // Try to match this string at pos-overlap..pos.
+                    if(overlap>=LONG_SPAN) {
+                        overlap=length16;
+                        // Longest match: Need to match fully inside the code point span
+                        // to find the match from the earliest start.
                     }
-                    // Try to match if the string is longer or starts earlier.
-                    if( (overlap>maxOverlap || /* redundant overlap==maxOverlap && */ inc>maxInc) &&
-                        matches16CPB(s, pos-overlap, length, s16, length16)
-                    ) {
-                        maxInc=inc;  // Longest match from earliest start.
-                        maxOverlap=overlap;
-                        break;
+                    if(overlap>spanLength) {
+                        overlap=spanLength;
+                    }
+                    int32_t inc=length16-overlap;  // Keep overlap+inc==length16.
+                    for(;;) {
+                        if(inc>rest || overlap<maxOverlap) {
+                            break;
+                        }
+                        // Try to match if the string is longer or starts earlier.
+                        if( (overlap>maxOverlap || /* redundant overlap==maxOverlap && */ inc>maxInc) &&
+                            matches16CPB(s, pos-overlap, length, s16, length16)
+                        ) {
+                            maxInc=inc;  // Longest match from earliest start.
+                            maxOverlap=overlap;
+                            break;
+                        }
+                        --overlap;
+                        ++inc;
                     }
-                    --overlap;
-                    ++inc;
                 }
             }
 
@@ -808,86 +1304,97 @@ int32_t UnicodeSetStringSpan::spanBack(const UChar *s, int32_t length, USetSpanC
         offsets.setMaxLength(maxLength16);
     }
     int32_t i, stringsLength=strings.size();
+    const StringSpanAutomaton *automaton=automata[1];
     uint8_t *spanBackLengths=spanLengths;
     if(all) {
         spanBackLengths+=stringsLength;
     }
     for(;;) {
         if(spanCondition==USET_SPAN_CONTAINED) {
-            for(i=0; i<stringsLength; ++i) {
-                int32_t overlap=spanBackLengths[i];
-                if(overlap==ALL_CP_CONTAINED) {
-                    continue;  // Irrelevant string.
-                }
-                const UnicodeString &string=*(const UnicodeString *)strings.elementAt(i);
-                const UChar *s16=string.getBuffer();
-                int32_t length16=string.length();
-
-                // Try to match this string at pos-(length16-overlap)..pos-length16.
-                if(overlap>=LONG_SPAN) {
-                    overlap=length16;
-                    // While contained: No point matching fully inside the code point span.
-                    int32_t len1=0;
-                    U16_FWD_1(s16, len1, overlap);
-                    overlap-=len1;  // Length of the string minus the first code point.
-                }
-                if(overlap>spanLength) {
-                    overlap=spanLength;
+            if(automaton!=NULL) {
+                if(automaton->matchContained<TRUE>(s, length, pos, spanLength, offsets)) {
+                    return 0;  // Reached the start of the string.
                 }
-                int32_t dec=length16-overlap;  // Keep dec+overlap==length16.
-                for(;;) {
-                    if(dec>pos) {
-                        break;
+            } else {
+                for(i=0; i<stringsLength; ++i) {
+                    int32_t overlap=spanBackLengths[i];
+                    if(overlap==ALL_CP_CONTAINED) {
+                        continue;  // Irrelevant string.
                     }
-                    // Try to match if the decrement is not listed already.
-                    if(!offsets.containsOffset(dec) && matches16CPB(s, pos-dec, length, s16, length16)) {
-                        if(dec==pos) {
-                            return 0;  // Reached the start of the string.
-                        }
-                        offsets.addOffset(dec);
+                    const UnicodeString &string=*(const UnicodeString *)strings.elementAt(i);
+                    const UChar *s16=string.getBuffer();
+                    int32_t length16=string.length();
+
+                    // Try to match this string at pos-(length16-overlap)..pos-length16.
+                    if(overlap>=LONG_SPAN) {
+                        overlap=length16;
+                        // While contained: No point matching fully inside the code point span.
+                        int32_t len1=0;
+                        U16_FWD_1(s16, len1, overlap);
+                        overlap-=len1;  // Length of the string minus the first code point.
                     }
-                    if(overlap==0) {
-                        break;
+                    if(overlap>spanLength) {
+                        overlap=spanLength;
+                    }
+                    int32_t dec=length16-overlap;  // Keep dec+overlap==length16.
+                    for(;;) {
+                        if(dec>pos) {
+                            break;
+                        }
+                        // Try to match if the decrement is not listed already.
+                        if(!offsets.containsOffset(dec) && matches16CPB(s, pos-dec, length, s16, length16)) {
+                            if(dec==pos) {
+                                return 0;  // Reached the start of the string.
+                            }
+                            offsets.addOffset(dec);
+                        }
+                        if(overlap==0) {
+                            break;
+                        }
+                        --overlap;
+                        ++dec;
                     }
-                    --overlap;
-                    ++dec;
                 }
             }
         } else /* USET_SPAN_SIMPLE */ {
             int32_t maxDec=0, maxOverlap=0;
-            for(i=0; i<stringsLength; ++i) {
-                int32_t overlap=spanBackLengths[i];
-                // For longest match, we do need to try to match even an all-contained string
-                // to find the match from the latest end.
+            if(automaton!=NULL) {
+                automaton->matchLongest<TRUE>(s, length, pos, spanLength, maxDec, maxOverlap);
+            } else {
+                for(i=0; i<stringsLength; ++i) {
+                    int32_t overlap=spanBackLengths[i];
+                    // For longest match, we do need to try to match even an all-contained string
+                    // to find the match from the latest end.
 
-                const UnicodeString &string=*(const UnicodeString *)strings.elementAt(i);
-                const UChar *s16=string.getBuffer();
-                int32_t length16=string.length();
+                    const UnicodeString &string=*(const UnicodeString *)strings.elementAt(i);
+                    const UChar *s16=string.getBuffer();
+                    int32_t length16=string.length();
 
-                // Try to match this string at pos-(length16-overlap)..pos-length16.
-                if(overlap>=LONG_SPAN) {
-                    overlap=length16;
-                    // Longest match: Need to match fully inside the code point span
-                    // to find the match from the latest end.
-                }
-                if(overlap>spanLength) {
-                    overlap=spanLength;
-                }
-                int32_t dec=length16-overlap;  // Keep dec+overlap==length16.
-                for(;;) {
-                    if(dec>pos || overlap<maxOverlap) {
-                        break;
+                    // Try to match this string at pos-(length16-overlap)..pos-length16.
+                    if(overlap>=LONG_SPAN) {
+                        overlap=length16;
+                        // Longest match: Need to match fully inside the code point span
+                        // to find the match from the latest end.
                     }
-                    // Try to match if the string is longer or ends later.
-                    if( (overlap>maxOverlap || /* redundant overlap==maxOverlap && */ dec>maxDec) &&
-                        matches16CPB(s, pos-dec, length, s16, length16)
-                    ) {
-                        maxDec=dec;  // Longest match from latest end.
-                        maxOverlap=overlap;
-                        break;
+                    if(overlap>spanLength) {
+                        overlap=spanLength;
+                    }
+                    int32_t dec=length16-overlap;  // Keep dec+overlap==length16.
+                    for(;;) {
+                        if(dec>pos || overlap<maxOverlap) {
+                            break;
+                        }
+                        // Try to match if the string is longer or ends later.
+                        if( (overlap>maxOverlap || /* redundant overlap==maxOverlap && */ dec>maxDec) &&
+                            matches16CPB(s, pos-dec, length, s16, length16)
+                        ) {
+                            maxDec=dec;  // Longest match from latest end.
+                            maxOverlap=overlap;
+                            break;
+                        }
+                        --overlap;
+                        ++dec;
                     }
-                    --overlap;
-                    ++dec;
                 }
             }
 
@@ -970,6 +1477,7 @@ int32_t UnicodeSetStringSpan::spanUTF8(const uint8_t *s, int32_t length, USetSpa
     }
     int32_t pos=spanLength, rest=length-pos;
     int32_t i, stringsLength=strings.size();
+    const StringSpanAutomaton *automaton=automata[2];
     uint8_t *spanUTF8Lengths=spanLengths;
     if(all) {
         spanUTF8Lengths+=2*stringsLength;
@@ -978,90 +1486,100 @@ int32_t UnicodeSetStringSpan::spanUTF8(const uint8_t *s, int32_t length, USetSpa
         const uint8_t *s8=utf8;
         int32_t length8;
         if(spanCondition==USET_SPAN_CONTAINED) {
-            for(i=0; i<stringsLength; ++i) {
-                length8=utf8Lengths[i];
-                if(length8==0) {
-                    continue;  // String not representable in UTF-8.
-                }
-                int32_t overlap=spanUTF8Lengths[i];
-                if(overlap==ALL_CP_CONTAINED) {
-                    s8+=length8;
-                    continue;  // Irrelevant string.
+            if(automaton!=NULL) {
+                if(automaton->matchContained<FALSE>(s, length, pos, spanLength, offsets)) {
+                    return length;  // Reached the end of the string.
                 }
+            } else {
+                for(i=0; i<stringsLength; ++i) {
+                    length8=utf8Lengths[i];
+                    if(length8==0) {
+                        continue;  // String not representable in UTF-8.
+                    }
+                    int32_t overlap=spanUTF8Lengths[i];
+                    if(overlap==ALL_CP_CONTAINED) {
+                        s8+=length8;
+                        continue;  // Irrelevant string.
+                    }
 
-                // Try to match this string at pos-overlap..pos.
-                if(overlap>=LONG_SPAN) {
-                    overlap=length8;
-                    // While contained: No point matching fully inside the code point span.
-                    U8_BACK_1(s8, 0, overlap);  // Length of the string minus the last code point.
-                }
-                if(overlap>spanLength) {
-                    overlap=spanLength;
-                }
-                int32_t inc=length8-overlap;  // Keep overlap+inc==length8.
-                for(;;) {
-                    if(inc>rest) {
-                        break;
+                    // Try to match this string at pos-overlap..pos.
+                    if(overlap>=LONG_SPAN) {
+                        overlap=length8;
+                        // While contained: No point matching fully inside the code point span.
+                        U8_BACK_1(s8, 0, overlap);  // Length of the string minus the last code point.
                     }
-                    // Try to match if the increment is not listed already.
-                    // Match at code point boundaries. (The UTF-8 strings were converted
-                    // from UTF-16 and are guaranteed to be well-formed.)
-                    if(!U8_IS_TRAIL(s[pos-overlap]) &&
-                            !offsets.containsOffset(inc) &&
-                            matches8(s+pos-overlap, s8, length8)) {
-                        if(inc==rest) {
-                            return length;  // Reached the end of the string.
-                        }
-                        offsets.addOffset(inc);
+                    if(overlap>spanLength) {
+                        overlap=spanLength;
                     }
-                    if(overlap==0) {
-                        break;
+                    int32_t inc=length8-overlap;  // Keep overlap+inc==length8.
+                    for(;;) {
+                        if(inc>rest) {
+                            break;
+                        }
+                        // Try to match if the increment is not listed already.
+                        // Match at code point boundaries. (The UTF-8 strings were converted
+                        // from UTF-16 and are guaranteed to be well-formed.)
+                        if(!U8_IS_TRAIL(s[pos-overlap]) &&
+                                !offsets.containsOffset(inc) &&
+                                matches8(s+pos-overlap, s8, length8)) {
+                            if(inc==rest) {
+                                return length;  // Reached the end of the string.
+                            }
+                            offsets.addOffset(inc);
+                        }
+                        if(overlap==0) {
+                            break;
+                        }
+                        --overlap;
+                        ++inc;
                     }
-                    --overlap;
-                    ++inc;
+                    s8+=length8;
                 }
-                s8+=length8;
             }
         } else /* USET_SPAN_SIMPLE */ {
             int32_t maxInc=0, maxOverlap=0;
-            for(i=0; i<stringsLength; ++i) {
-                length8=utf8Lengths[i];
-                if(length8==0) {
-                    continue;  // String not representable in UTF-8.
-                }
-                int32_t overlap=spanUTF8Lengths[i];
-                // For longest match, we do need to try to match even an all-contained string
-                // to find the match from the earliest start.
-
-                // Try to match this string at pos-overlap..pos.
-                if(overlap>=LONG_SPAN) {
-                    overlap=length8;
-                    // Longest match: Need to match fully inside the code point span
+            if(automaton!=NULL) {
+                automaton->matchLongest<FALSE>(s, length, pos, spanLength, maxInc, maxOverlap);
+            } else {
+                for(i=0; i<stringsLength; ++i) {
+                    length8=utf8Lengths[i];
+                    if(length8==0) {
+                        continue;  // String not representable in UTF-8.
+                    }
+                    int32_t overlap=spanUTF8Lengths[i];
+                    // For longest match, we do need to try to match even an all-contained string
                     // to find the match from the earliest start.
-                }
-                if(overlap>spanLength) {
-                    overlap=spanLength;
-                }
-                int32_t inc=length8-overlap;  // Keep overlap+inc==length8.
-                for(;;) {
-                    if(inc>rest || overlap<maxOverlap) {
-                        break;
+
+                    // Try to match this string at pos-overlap..pos.
+                    if(overlap>=LONG_SPAN) {
+                        overlap=length8;
+                        // Longest match: Need to match fully inside the code point span
+                        // to find the match from the earliest start.
                     }
-                    // Try to match if the string is longer or starts earlier.
-                    // Match at code point boundaries. (The UTF-8 strings were converted
-                    // from UTF-16 and are guaranteed to be well-formed.)
-                    if(!U8_IS_TRAIL(s[pos-overlap]) &&
-                            (overlap>maxOverlap ||
-                                /* redundant overlap==maxOverlap && */ inc>maxInc) &&
-                            matches8(s+pos-overlap, s8, length8)) {
-                        maxInc=inc;  // Longest match from earliest start.
-                        maxOverlap=overlap;
-                        break;
+                    if(overlap>spanLength) {
+                        overlap=spanLength;
+                    }
+                    int32_t inc=length8-overlap;  // Keep overlap+inc==length8.
+                    for(;;) {
+                        if(inc>rest || overlap<maxOverlap) {
+                            break;
+                        }
+                        // Try to match if the string is longer or starts earlier.
+                        // Match at code point boundaries. (The UTF-8 strings were converted
+                        // from UTF-16 and are guaranteed to be well-formed.)
+                        if(!U8_IS_TRAIL(s[pos-overlap]) &&
+                                (overlap>maxOverlap ||
+                                    /* redundant overlap==maxOverlap && */ inc>maxInc) &&
+                                matches8(s+pos-overlap, s8, length8)) {
+                            maxInc=inc;  // Longest match from earliest start.
+                            maxOverlap=overlap;
+                            break;
+                        }
+                        --overlap;
+                        ++inc;
                     }
-                    --overlap;
-                    ++inc;
+                    s8+=length8;
                 }
-                s8+=length8;
             }
 
             if(maxInc!=0 || maxOverlap!=0) {
@@ -1147,6 +1665,7 @@ int32_t UnicodeSetStringSpan::spanBackUTF8(const uint8_t *s, int32_t length, USe
         offsets.setMaxLength(maxLength8);
     }
     int32_t i, stringsLength=strings.size();
+    const StringSpanAutomaton *automaton=automata[3];
     uint8_t *spanBackUTF8Lengths=spanLengths;
     if(all) {
         spanBackUTF8Lengths+=3*stringsLength;
@@ -1155,93 +1674,103 @@ int32_t UnicodeSetStringSpan::spanBackUTF8(const uint8_t *s, int32_t length, USe
         const uint8_t *s8=utf8;
         int32_t length8;
         if(spanCondition==USET_SPAN_CONTAINED) {
-            for(i=0; i<stringsLength; ++i) {
-                length8=utf8Lengths[i];
-                if(length8==0) {
-                    continue;  // String not representable in UTF-8.
-                }
-                int32_t overlap=spanBackUTF8Lengths[i];
-                if(overlap==ALL_CP_CONTAINED) {
-                    s8+=length8;
-                    continue;  // Irrelevant string.
+            if(automaton!=NULL) {
+                if(automaton->matchContained<TRUE>(s, length, pos, spanLength, offsets)) {
+                    return 0;  // Reached the start of the string.
                 }
+            } else {
+                for(i=0; i<stringsLength; ++i) {
+                    length8=utf8Lengths[i];
+                    if(length8==0) {
+                        continue;  // String not representable in UTF-8.
+                    }
+                    int32_t overlap=spanBackUTF8Lengths[i];
+                    if(overlap==ALL_CP_CONTAINED) {
+                        s8+=length8;
+                        continue;  // Irrelevant string.
+                    }
 
-                // Try to match this string at pos-(length8-overlap)..pos-length8.
-                if(overlap>=LONG_SPAN) {
-                    overlap=length8;
-                    // While contained: No point matching fully inside the code point span.
-                    int32_t len1=0;
-                    U8_FWD_1(s8, len1, overlap);
-                    overlap-=len1;  // Length of the string minus the first code point.
-                }
-                if(overlap>spanLength) {
-                    overlap=spanLength;
-                }
-                int32_t dec=length8-overlap;  // Keep dec+overlap==length8.
-                for(;;) {
-                    if(dec>pos) {
-                        break;
+                    // Try to match this string at pos-(length8-overlap)..pos-length8.
+                    if(overlap>=LONG_SPAN) {
+                        overlap=length8;
+                        // While contained: No point matching fully inside the code point span.
+                        int32_t len1=0;
+                        U8_FWD_1(s8, len1, overlap);
+                        overlap-=len1;  // Length of the string minus the first code point.
                     }
-                    // Try to match if the decrement is not listed already.
-                    // Match at code point boundaries. (The UTF-8 strings were converted
-                    // from UTF-16 and are guaranteed to be well-formed.)
-                    if( !U8_IS_TRAIL(s[pos-dec]) &&
-                        !offsets.containsOffset(dec) &&
-                        matches8(s+pos-dec, s8, length8)
-                    ) {
-                        if(dec==pos) {
-                            return 0;  // Reached the start of the string.
-                        }
-                        offsets.addOffset(dec);
+                    if(overlap>spanLength) {
+                        overlap=spanLength;
                     }
-                    if(overlap==0) {
-                        break;
+                    int32_t dec=length8-overlap;  // Keep dec+overlap==length8.
+                    for(;;) {
+                        if(dec>pos) {
+                            break;
+                        }
+                        // Try to match if the decrement is not listed already.
+                        // Match at code point boundaries. (The UTF-8 strings were converted
+                        // from UTF-16 and are guaranteed to be well-formed.)
+                        if( !U8_IS_TRAIL(s[pos-dec]) &&
+                            !offsets.containsOffset(dec) &&
+                            matches8(s+pos-dec, s8, length8)
+                        ) {
+                            if(dec==pos) {
+                                return 0;  // Reached the start of the string.
+                            }
+                            offsets.addOffset(dec);
+                        }
+                        if(overlap==0) {
+                            break;
+                        }
+                        --overlap;
+                        ++dec;
                     }
-                    --overlap;
-                    ++dec;
+                    s8+=length8;
                 }
-                s8+=length8;
             }
         } else /* USET_SPAN_SIMPLE */ {
             int32_t maxDec=0, maxOverlap=0;
-            for(i=0; i<stringsLength; ++i) {
-                length8=utf8Lengths[i];
-                if(length8==0) {
-                    continue;  // String not representable in UTF-8.
-                }
-                int32_t overlap=spanBackUTF8Lengths[i];
-                // For longest match, we do need to try to match even an all-contained string
-                // to find the match from the latest end.
-
-                // Try to match this string at pos-(length8-overlap)..pos-length8.
-                if(overlap>=LONG_SPAN) {
-                    overlap=length8;
-                    // Longest match: Need to match fully inside the code point span
+            if(automaton!=NULL) {
+                automaton->matchLongest<TRUE>(s, length, pos, spanLength, maxDec, maxOverlap);
+            } else {
+                for(i=0; i<stringsLength; ++i) {
+                    length8=utf8Lengths[i];
+                    if(length8==0) {
+                        continue;  // String not representable in UTF-8.
+                    }
+                    int32_t overlap=spanBackUTF8Lengths[i];
+                    // For longest match, we do need to try to match even an all-contained string
                     // to find the match from the latest end.
-                }
-                if(overlap>spanLength) {
-                    overlap=spanLength;
-                }
-                int32_t dec=length8-overlap;  // Keep dec+overlap==length8.
-                for(;;) {
-                    if(dec>pos || overlap<maxOverlap) {
-                        break;
+
+                    // Try to match this string at pos-(length8-overlap)..pos-length8.
+                    if(overlap>=LONG_SPAN) {
+                        overlap=length8;
+                        // Longest match: Need to match fully inside the code point span
+                        // to find the match from the latest end.
+                    }
+                    if(overlap>spanLength) {
+                        overlap=spanLength;
                     }
-                    // Try to match if the string is longer or ends later.
-                    // Match at code point boundaries. (The UTF-8 strings were converted
-                    // from UTF-16 and are guaranteed to be well-formed.)
-                    if( !U8_IS_TRAIL(s[pos-dec]) &&
-                        (overlap>maxOverlap || /* redundant overlap==maxOverlap && */ dec>maxDec) &&
-                        matches8(s+pos-dec, s8, length8)
-                    ) {
-                        maxDec=dec;  // Longest match from latest end.
-                        maxOverlap=overlap;
-                        break;
+                    int32_t dec=length8-overlap;  // Keep dec+overlap==length8.
+                    for(;;) {
+                        if(dec>pos || overlap<maxOverlap) {
+                            break;
+                        }
+                        // Try to match if the string is longer or ends later.
+                        // Match at code point boundaries. (The UTF-8 strings were converted
+                        // from UTF-16 and are guaranteed to be well-formed.)
+                        if( !U8_IS_TRAIL(s[pos-dec]) &&
+                            (overlap>maxOverlap || /* redundant overlap==maxOverlap && */ dec>maxDec) &&
+                            matches8(s+pos-dec, s8, length8)
+                        ) {
+                            maxDec=dec;  // Longest match from latest end.
+                            maxOverlap=overlap;
+                            break;
+                        }
+                        --overlap;
+                        ++dec;
                     }
-                    --overlap;
-                    ++dec;
+                    s8+=length8;
                 }
-                s8+=length8;
             }
 
             if(maxDec!=0 || maxOverlap!=0) {
@@ -24,6 +24,8 @@
 
 U_NAMESPACE_BEGIN
 
+class StringSpanAutomaton;
+
 /*
  * Implement span() etc. for a set with strings.
  * Avoid recursion because of its exponential complexity.
@@ -95,6 +97,9 @@ private:
     // so that a character span ends before any string.
     void addToSpanNotSet(UChar32 c);
 
+    // Build the string matching automata for a frozen set with many strings.
+    void buildAutomata();
+
     int32_t spanNot(const UChar *s, int32_t length) const;
     int32_t spanNotBack(const UChar *s, int32_t length) const;
     int32_t spanNotUTF8(const uint8_t *s, int32_t length) const;
@@ -133,6 +138,11 @@ private:
     // Set up for all variants of span()?
     UBool all;
 
+    // String matching automata for span(), spanBack(), spanUTF8() and spanBackUTF8()
+    // in the same order as the span lengths, or NULL.
+    // Only built for all variants and many strings.
+    StringSpanAutomaton *automata[4];
+
     // Memory for small numbers and lengths of strings.
     // For example, for 8 strings:
     // 8 UTF-8 lengths, 8*4 bytes span lengths, 8*2 3-byte UTF-8 characters
@@ -0,0 +1,388 @@
+// © 2018 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+/*
+*******************************************************************************
+*   file name:  ustr_ascii.h
+*   encoding:   UTF-8
+*   tab size:   8 (not used)
+*   indentation:4
+*
+*   Bulk processing of runs of ASCII (and Latin-1) code units, shared by
+*   the converters and the string transformation functions.
+*
+*   The kernels work on 16 code units at a time with SSE2 on x86 and with
+*   Advanced SIMD on AArch64; both are part of the baseline instruction set
+*   on these platforms, so the variant is chosen at compile time and needs
+*   no CPU feature detection. Elsewhere, 8 bytes are tested at a time
+*   as a 64-bit word.
+*   U_ASCII_SIMD_SSSE3 is additionally defined when the compiler targets
+*   SSSE3 (for example, with -mssse3), for kernels that need byte shuffles.
+*/
+
+#ifndef __USTR_ASCII_H__
+#define __USTR_ASCII_H__
+
+#include "unicode/utypes.h"
+#include "cmemory.h"
+
+#ifndef U_ASCII_SIMD_DISABLE
+#   if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#       define U_ASCII_SIMD_SSE2 1
+#       include <emmintrin.h>
+#       if defined(__SSSE3__) || defined(__AVX__)
+#           define U_ASCII_SIMD_SSSE3 1
+#           include <tmmintrin.h>
+#       endif
+#   elif defined(__aarch64__) && defined(__ARM_NEON)
+#       define U_ASCII_SIMD_NEON 1
+#       include <arm_neon.h>
+#   endif
+#endif
+
+/*
+ * For the functions that call these kernels from a per-character loop:
+ * Inlining the kernels into such a loop made it measurably slower
+ * on text that is not mostly ASCII, so the callers keep them out of line.
+ */
+#if U_GCC_MAJOR_MINOR >= 301 || defined(__clang__)
+#   define U_ASCII_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#   define U_ASCII_NOINLINE __declspec(noinline)
+#else
+#   define U_ASCII_NOINLINE
+#endif
+
+/**
+ * Returns the length of the initial run of ASCII bytes (00..7F) in s[0..length[.
+ */
+static inline int32_t
+uprv_asciiSpan(const uint8_t *s, int32_t length) {
+    int32_t i=0;
+#if U_ASCII_SIMD_SSE2
+    for(; (length-i)>=16; i+=16) {
+        if(_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(s+i)))!=0) {
+            break;
+        }
+    }
+#elif U_ASCII_SIMD_NEON
+    for(; (length-i)>=16; i+=16) {
+        if(vmaxvq_u8(vld1q_u8(s+i))>=0x80) {
+            break;
+        }
+    }
+#else
+    for(; (length-i)>=8; i+=8) {
+        uint64_t w;
+        uprv_memcpy(&w, s+i, 8);
+        if((w&0x8080808080808080ULL)!=0) {
+            break;
+        }
+    }
+#endif
+    while(i<length && s[i]<=0x7f) {
+        ++i;
+    }
+    return i;
+}
+
+/**
+ * Returns TRUE if s[0..15] are all ASCII bytes (00..7F).
+ */
+static inline UBool
+uprv_isASCII16(const uint8_t *s) {
+#if U_ASCII_SIMD_SSE2
+    return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)s))==0;
+#elif U_ASCII_SIMD_NEON
+    return vmaxvq_u8(vld1q_u8(s))<0x80;
+#else
+    uint64_t w[2];
+    uprv_memcpy(w, s, 16);
+    return ((w[0]|w[1])&0x8080808080808080ULL)==0;
+#endif
+}
+
+/**
+ * Returns TRUE if s[0..15] are all ASCII UChars (0000..007F).
+ */
+static inline UBool
+uprv_isASCII16_UChars(const UChar *s) {
+#if U_ASCII_SIMD_SSE2
+    __m128i v=_mm_or_si128(_mm_loadu_si128((const __m128i *)s),
+                           _mm_loadu_si128((const __m128i *)(s+8)));
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16((short)0xff80)),
+                                             _mm_setzero_si128()))==0xffff;
+#elif U_ASCII_SIMD_NEON
+    return vmaxvq_u16(vorrq_u16(vld1q_u16((const uint16_t *)s),
+                                vld1q_u16((const uint16_t *)(s+8))))<0x80;
+#else
+    uint64_t w[4];
+    uprv_memcpy(w, s, 32);
+    return ((w[0]|w[1]|w[2]|w[3])&0xff80ff80ff80ff80ULL)==0;
+#endif
+}
+
+/**
+ * Copies the initial run of ASCII bytes from src to dest,
+ * widening each byte to a UChar.
+ * Stops before the first non-ASCII byte or after length bytes.
+ * @return the number of bytes copied
+ */
+static inline int32_t
+uprv_widenASCII(UChar *dest, const uint8_t *src, int32_t length) {
+    int32_t i=0;
+#if U_ASCII_SIMD_SSE2
+    __m128i zero=_mm_setzero_si128();
+    for(; (length-i)>=16; i+=16) {
+        __m128i v=_mm_loadu_si128((const __m128i *)(src+i));
+        if(_mm_movemask_epi8(v)!=0) {
+            break;
+        }
+        _mm_storeu_si128((__m128i *)(dest+i), _mm_unpacklo_epi8(v, zero));
+        _mm_storeu_si128((__m128i *)(dest+i+8), _mm_unpackhi_epi8(v, zero));
+    }
+#elif U_ASCII_SIMD_NEON
+    for(; (length-i)>=16; i+=16) {
+        uint8x16_t v=vld1q_u8(src+i);
+        if(vmaxvq_u8(v)>=0x80) {
+            break;
+        }
+        vst1q_u16((uint16_t *)(dest+i), vmovl_u8(vget_low_u8(v)));
+        vst1q_u16((uint16_t *)(dest+i+8), vmovl_high_u8(v));
+    }
+#else
+    for(; (length-i)>=8; i+=8) {
+        uint64_t w;
+        uprv_memcpy(&w, src+i, 8);
+        if((w&0x8080808080808080ULL)!=0) {
+            break;
+        }
+        dest[i]=src[i];
+        dest[i+1]=src[i+1];
+        dest[i+2]=src[i+2];
+        dest[i+3]=src[i+3];
+        dest[i+4]=src[i+4];
+        dest[i+5]=src[i+5];
+        dest[i+6]=src[i+6];
+        dest[i+7]=src[i+7];
+    }
+#endif
+    uint8_t b;
+    while(i<length && (b=src[i])<=0x7f) {
+        dest[i++]=b;
+    }
+    return i;
+}
+
+/**
+ * Widens length Latin-1 bytes from src to UChars in dest.
+ */
+static inline void
+uprv_widenLatin1(UChar *dest, const uint8_t *src, int32_t length) {
+    int32_t i=0;
+#if U_ASCII_SIMD_SSE2
+    __m128i zero=_mm_setzero_si128();
+    for(; (length-i)>=16; i+=16) {
+        __m128i v=_mm_loadu_si128((const __m128i *)(src+i));
+        _mm_storeu_si128((__m128i *)(dest+i), _mm_unpacklo_epi8(v, zero));
+        _mm_storeu_si128((__m128i *)(dest+i+8), _mm_unpackhi_epi8(v, zero));
+    }
+#elif U_ASCII_SIMD_NEON
+    for(; (length-i)>=16; i+=16) {
+        uint8x16_t v=vld1q_u8(src+i);
+        vst1q_u16((uint16_t *)(dest+i), vmovl_u8(vget_low_u8(v)));
+        vst1q_u16((uint16_t *)(dest+i+8), vmovl_high_u8(v));
+    }
+#else
+    for(; (length-i)>=8; i+=8) {
+        dest[i]=src[i];
+        dest[i+1]=src[i+1];
+        dest[i+2]=src[i+2];
+        dest[i+3]=src[i+3];
+        dest[i+4]=src[i+4];
+        dest[i+5]=src[i+5];
+        dest[i+6]=src[i+6];
+        dest[i+7]=src[i+7];
+    }
+#endif
+    for(; i<length; ++i) {
+        dest[i]=src[i];
+    }
+}
+
+/**
+ * Copies the initial run of UChars that are at most max from src to dest,
+ * narrowing each one to a byte.
+ * Stops before the first UChar above max or after length UChars.
+ * @param max 0x7f for ASCII or 0xff for Latin-1
+ * @return the number of UChars copied
+ */
+static inline int32_t
+uprv_narrowToLatin1(uint8_t *dest, const UChar *src, int32_t length, UChar max) {
+    int32_t i=0;
+#if U_ASCII_SIMD_SSE2
+    __m128i zero=_mm_setzero_si128();
+    __m128i excess=_mm_set1_epi16((short)(uint16_t)~max);
+    for(; (length-i)>=16; i+=16) {
+        __m128i v0=_mm_loadu_si128((const __m128i *)(src+i));
+        __m128i v1=_mm_loadu_si128((const __m128i *)(src+i+8));
+        __m128i high=_mm_and_si128(_mm_or_si128(v0, v1), excess);
+        if(_mm_movemask_epi8(_mm_cmpeq_epi8(high, zero))!=0xffff) {
+            break;
+        }
+        _mm_storeu_si128((__m128i *)(dest+i), _mm_packus_epi16(v0, v1));
+    }
+#elif U_ASCII_SIMD_NEON
+    for(; (length-i)>=16; i+=16) {
+        uint16x8_t v0=vld1q_u16((const uint16_t *)(src+i));
+        uint16x8_t v1=vld1q_u16((const uint16_t *)(src+i+8));
+        if(vmaxvq_u16(vorrq_u16(v0, v1))>max) {
+            break;
+        }
+        vst1q_u8(dest+i, vcombine_u8(vmovn_u16(v0), vmovn_u16(v1)));
+    }
+#else
+    for(; (length-i)>=8; i+=8) {
+        UChar oredChars=
+            src[i]|src[i+1]|src[i+2]|src[i+3]|
+            src[i+4]|src[i+5]|src[i+6]|src[i+7];
+        if(oredChars>max) {
+            break;
+        }
+        dest[i]=(uint8_t)src[i];
+        dest[i+1]=(uint8_t)src[i+1];
+        dest[i+2]=(uint8_t)src[i+2];
+        dest[i+3]=(uint8_t)src[i+3];
+        dest[i+4]=(uint8_t)src[i+4];
+        dest[i+5]=(uint8_t)src[i+5];
+        dest[i+6]=(uint8_t)src[i+6];
+        dest[i+7]=(uint8_t)src[i+7];
+    }
+#endif
+    UChar c;
+    while(i<length && (c=src[i])<=max) {
+        dest[i++]=(uint8_t)c;
+    }
+    return i;
+}
+
+/**
+ * Copies the initial run of ASCII bytes from src to dest,
+ * lowercasing A-Z, or uppercasing a-z if toUpper is TRUE.
+ * Stops before the first non-ASCII byte or after length bytes.
+ * @return the number of bytes copied
+ */
+static inline int32_t
+uprv_asciiCaseMap(uint8_t *dest, const uint8_t *src, int32_t length, UBool toUpper) {
+    uint8_t first=toUpper ? 0x61 : 0x41;  /* 'a' or 'A' */
+    int32_t i=0;
+#if U_ASCII_SIMD_SSE2
+    __m128i belowFirst=_mm_set1_epi8((char)(first-1));
+    __m128i aboveLast=_mm_set1_epi8((char)(first+26));
+    __m128i caseBit=_mm_set1_epi8(0x20);
+    for(; (length-i)>=16; i+=16) {
+        __m128i v=_mm_loadu_si128((const __m128i *)(src+i));
+        if(_mm_movemask_epi8(v)!=0) {
+            break;
+        }
+        __m128i isLetter=_mm_and_si128(_mm_cmpgt_epi8(v, belowFirst), _mm_cmplt_epi8(v, aboveLast));
+        _mm_storeu_si128((__m128i *)(dest+i), _mm_xor_si128(v, _mm_and_si128(isLetter, caseBit)));
+    }
+#elif U_ASCII_SIMD_NEON
+    uint8x16_t firstV=vdupq_n_u8(first);
+    uint8x16_t lastV=vdupq_n_u8((uint8_t)(first+25));
+    uint8x16_t caseBit=vdupq_n_u8(0x20);
+    for(; (length-i)>=16; i+=16) {
+        uint8x16_t v=vld1q_u8(src+i);
+        if(vmaxvq_u8(v)>=0x80) {
+            break;
+        }
+        uint8x16_t isLetter=vandq_u8(vcgeq_u8(v, firstV), vcleq_u8(v, lastV));
+        vst1q_u8(dest+i, veorq_u8(v, vandq_u8(isLetter, caseBit)));
+    }
+#else
+    /*
+     * For ASCII bytes, adding 0x80-first sets a byte's high bit if it is at least first,
+     * and adding 0x80-(first+26) sets it if it is above the last letter;
+     * neither addition carries into the next byte.
+     */
+    uint64_t atLeastFirst=0x0101010101010101ULL*(uint8_t)(0x80-first);
+    uint64_t aboveLast=0x0101010101010101ULL*(uint8_t)(0x80-(first+26));
+    for(; (length-i)>=8; i+=8) {
+        uint64_t w;
+        uprv_memcpy(&w, src+i, 8);
+        if((w&0x8080808080808080ULL)!=0) {
+            break;
+        }
+        uint64_t isLetter=((w+atLeastFirst)^(w+aboveLast))&0x8080808080808080ULL;
+        w^=isLetter>>2;
+        uprv_memcpy(dest+i, &w, 8);
+    }
+#endif
+    uint8_t b;
+    while(i<length && (b=src[i])<=0x7f) {
+        if((uint8_t)(b-first)<26) {
+            b^=0x20;
+        }
+        dest[i++]=b;
+    }
+    return i;
+}
+
+/**
+ * Copies the initial run of ASCII UChars from src to dest,
+ * lowercasing A-Z, or uppercasing a-z if toUpper is TRUE.
+ * Stops before the first non-ASCII UChar or after length UChars.
+ * @return the number of UChars copied
+ */
+static inline int32_t
+uprv_asciiCaseMap_UChars(UChar *dest, const UChar *src, int32_t length, UBool toUpper) {
+    UChar first=toUpper ? 0x61 : 0x41;  /* 'a' or 'A' */
+    int32_t i=0;
+#if U_ASCII_SIMD_SSE2
+    __m128i zero=_mm_setzero_si128();
+    __m128i nonASCII=_mm_set1_epi16((short)0xff80);
+    __m128i belowFirst=_mm_set1_epi16((short)(first-1));
+    __m128i aboveLast=_mm_set1_epi16((short)(first+26));
+    __m128i caseBit=_mm_set1_epi16(0x20);
+    for(; (length-i)>=8; i+=8) {
+        __m128i v=_mm_loadu_si128((const __m128i *)(src+i));
+        if(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, nonASCII), zero))!=0xffff) {
+            break;
+        }
+        __m128i isLetter=_mm_and_si128(_mm_cmpgt_epi16(v, belowFirst), _mm_cmplt_epi16(v, aboveLast));
+        _mm_storeu_si128((__m128i *)(dest+i), _mm_xor_si128(v, _mm_and_si128(isLetter, caseBit)));
+    }
+#elif U_ASCII_SIMD_NEON
+    uint16x8_t firstV=vdupq_n_u16(first);
+    uint16x8_t lastV=vdupq_n_u16((uint16_t)(first+25));
+    uint16x8_t caseBit=vdupq_n_u16(0x20);
+    for(; (length-i)>=8; i+=8) {
+        uint16x8_t v=vld1q_u16((const uint16_t *)(src+i));
+        if(vmaxvq_u16(v)>=0x80) {
+            break;
+        }
+        uint16x8_t isLetter=vandq_u16(vcgeq_u16(v, firstV), vcleq_u16(v, lastV));
+        vst1q_u16((uint16_t *)(dest+i), veorq_u16(v, vandq_u16(isLetter, caseBit)));
+    }
+#endif
+    UChar c;
+    while(i<length && (c=src[i])<=0x7f) {
+        if((UChar)(c-first)<26) {
+            c^=0x20;
+        }
+        dest[i++]=c;
+    }
+    return i;
+}
+
+/**
+ * Sets offsets[i]=sourceIndex+i for 0<=i<length.
+ */
+static inline void
+uprv_fillIncreasingOffsets(int32_t *offsets, int32_t sourceIndex, int32_t length) {
+    for(int32_t i=0; i<length; ++i) {
+        offsets[i]=sourceIndex+i;
+    }
+}
+
+#endif
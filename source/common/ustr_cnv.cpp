@@ -29,24 +29,63 @@
 #include "umutex.h"
 #include "ustr_cnv.h"
 
-/* mutexed access to a shared default converter ----------------------------- */
+/* mutexed access to shared default converters ------------------------------ */
 
-static UConverter *gDefaultConverter = NULL;
+/*
+ * The default converters are cached in several shards, each with its own mutex,
+ * so that threads rarely wait for each other.
+ * A thread starts with the shard selected by the address of its stack,
+ * so that concurrent threads tend to use different shards.
+ */
+#define DEFAULT_CONVERTER_SHARDS 8
+
+typedef struct DefaultConverterShard {
+    UMutex mutex;
+    UConverter *converter;
+} DefaultConverterShard;
+
+static DefaultConverterShard gDefaultConverters[DEFAULT_CONVERTER_SHARDS] = {
+    { U_MUTEX_INITIALIZER, NULL }, { U_MUTEX_INITIALIZER, NULL },
+    { U_MUTEX_INITIALIZER, NULL }, { U_MUTEX_INITIALIZER, NULL },
+    { U_MUTEX_INITIALIZER, NULL }, { U_MUTEX_INITIALIZER, NULL },
+    { U_MUTEX_INITIALIZER, NULL }, { U_MUTEX_INITIALIZER, NULL }
+};
+
+static int32_t
+getFirstShard() {
+    char local;
+    /* thread stacks are at least a few pages apart */
+    uintptr_t address = (uintptr_t)&local >> 12;
+    return (int32_t)((address ^ (address >> 3) ^ (address >> 8)) % DEFAULT_CONVERTER_SHARDS);
+}
+
+/* Removes the converter from the shard and returns it, or NULL if there is none. */
+static UConverter *
+takeConverter(DefaultConverterShard *shard) {
+    UConverter *converter = NULL;
+
+    if (shard->converter != NULL) {
+        umtx_lock(&shard->mutex);
+
+        /* need to check to make sure it wasn't taken out from under us */
+        if (shard->converter != NULL) {
+            converter = shard->converter;
+            shard->converter = NULL;
+        }
+        umtx_unlock(&shard->mutex);
+    }
+    return converter;
+}
 
 U_CAPI UConverter* U_EXPORT2
 u_getDefaultConverter(UErrorCode *status)
 {
     UConverter *converter = NULL;
-    
-    if (gDefaultConverter != NULL) {
-        umtx_lock(NULL);
-        
-        /* need to check to make sure it wasn't taken out from under us */
-        if (gDefaultConverter != NULL) {
-            converter = gDefaultConverter;
-            gDefaultConverter = NULL;
-        }
-        umtx_unlock(NULL);
+    int32_t first = getFirstShard();
+    int32_t i;
+
+    for (i = 0; converter == NULL && i < DEFAULT_CONVERTER_SHARDS; ++i) {
+        converter = takeConverter(&gDefaultConverters[(first + i) % DEFAULT_CONVERTER_SHARDS]);
     }
 
     /* if the cache was empty, create a converter */
@@ -64,19 +103,27 @@ u_getDefaultConverter(UErrorCode *status)
 U_CAPI void U_EXPORT2
 u_releaseDefaultConverter(UConverter *converter)
 {
-    if(gDefaultConverter == NULL) {
-        if (converter != NULL) {
-            ucnv_reset(converter);
-        }
-        umtx_lock(NULL);
+    int32_t first = getFirstShard();
+    int32_t i;
 
-        if(gDefaultConverter == NULL) {
-            gDefaultConverter = converter;
-            converter = NULL;
+    if (converter == NULL) {
+        return;
+    }
+    ucnv_reset(converter);
+    for (i = 0; converter != NULL && i < DEFAULT_CONVERTER_SHARDS; ++i) {
+        DefaultConverterShard *shard = &gDefaultConverters[(first + i) % DEFAULT_CONVERTER_SHARDS];
+        if (shard->converter == NULL) {
+            umtx_lock(&shard->mutex);
+
+            if (shard->converter == NULL) {
+                shard->converter = converter;
+                converter = NULL;
+            }
+            umtx_unlock(&shard->mutex);
         }
-        umtx_unlock(NULL);
     }
 
+    /* all shards are full */
     if(converter != NULL) {
         ucnv_close(converter);
     }
@@ -85,22 +132,14 @@ u_releaseDefaultConverter(UConverter *converter)
 U_CAPI void U_EXPORT2
 u_flushDefaultConverter()
 {
-    UConverter *converter = NULL;
-    
-    if (gDefaultConverter != NULL) {
-        umtx_lock(NULL);
-        
-        /* need to check to make sure it wasn't taken out from under us */
-        if (gDefaultConverter != NULL) {
-            converter = gDefaultConverter;
-            gDefaultConverter = NULL;
-        }
-        umtx_unlock(NULL);
-    }
+    int32_t i;
 
     /* if the cache was populated, flush it */
-    if(converter != NULL) {
-         ucnv_close(converter);
+    for (i = 0; i < DEFAULT_CONVERTER_SHARDS; ++i) {
+        UConverter *converter = takeConverter(&gDefaultConverters[i]);
+        if(converter != NULL) {
+            ucnv_close(converter);
+        }
     }
 }
 
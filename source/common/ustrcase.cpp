@@ -30,9 +30,12 @@
 #include "unicode/ubrk.h"
 #include "unicode/utf.h"
 #include "unicode/utf16.h"
+#include "unicode/utf8.h"
 #include "cmemory.h"
+#include "cstring.h"
 #include "ucase.h"
 #include "ucasemap_imp.h"
+#include "ustr_ascii.h"
 #include "ustr_imp.h"
 #include "uassert.h"
 
@@ -163,6 +166,36 @@ appendUnchanged(UChar *dest, int32_t destIndex, int32_t destCapacity,
     return appendNonEmptyUnchanged(dest, destIndex, destCapacity, s, length, options, edits);
 }
 
+/**
+ * Case-maps a run of ASCII in bulk, straight into dest,
+ * if there are at least 16 ASCII UChars at srcIndex and they fit into dest.
+ * Only for use without Edits and without U_OMIT_UNCHANGED_TEXT,
+ * and where ASCII maps only between A-Z and a-z.
+ * @return the number of UChars mapped, or 0 if there is no such run
+ */
+U_ASCII_NOINLINE int32_t
+mapASCIIRun(UChar *dest, int32_t &destIndex, int32_t destCapacity,
+            const UChar *src, int32_t srcIndex, int32_t srcLimit, UBool toUpper) {
+    int32_t count = srcLimit - srcIndex;
+    if (count > (destCapacity - destIndex)) {
+        count = destCapacity - destIndex;
+    }
+    if (count < 16 || !uprv_isASCII16_UChars(src + srcIndex)) {
+        return 0;
+    }
+    count = uprv_asciiCaseMap_UChars(dest + destIndex, src + srcIndex, count, toUpper);
+    destIndex += count;
+    return count;
+}
+
+/**
+ * The fast paths look for an ASCII run only after they changed a character,
+ * so that text which needs no changes keeps its plain loop.
+ * After a failed attempt, they do not look again for this many UChars,
+ * so that mixed text does not pay for checking each changed character.
+ */
+constexpr int32_t ASCII_RUN_RETRY_DISTANCE = 64;
+
 UChar32 U_CALLCONV
 utf16_caseContextIterator(void *context, int8_t dir) {
     UCaseContext *csc=(UCaseContext *)context;
@@ -216,6 +249,10 @@ int32_t toLower(int32_t caseLocale, uint32_t options,
     int32_t destIndex = 0;
     int32_t prev = srcStart;
     int32_t srcIndex = srcStart;
+    // Without Edits, lowercase ASCII runs in bulk; see mapASCIIRun().
+    int32_t nextASCIIRunIndex =
+        latinToLower == LatinCase::TO_LOWER_NORMAL && edits == nullptr &&
+        (options & U_OMIT_UNCHANGED_TEXT) == 0 ? srcStart : INT32_MAX;
     for (;;) {
         // fast path for simple cases
         UChar lead;
@@ -252,6 +289,15 @@ int32_t toLower(int32_t caseLocale, uint32_t options,
                 return 0;
             }
             prev = srcIndex;
+            if (srcIndex >= nextASCIIRunIndex) {
+                int32_t count = mapASCIIRun(dest, destIndex, destCapacity,
+                                            src, srcIndex, srcLimit, FALSE);
+                if (count > 0) {
+                    prev = srcIndex += count;
+                } else {
+                    nextASCIIRunIndex = srcIndex + ASCII_RUN_RETRY_DISTANCE;
+                }
+            }
         }
         if (srcIndex >= srcLimit) {
             break;
@@ -311,6 +357,10 @@ int32_t toUpper(int32_t caseLocale, uint32_t options,
     int32_t destIndex = 0;
     int32_t prev = 0;
     int32_t srcIndex = 0;
+    // Without Edits, uppercase ASCII runs in bulk; see mapASCIIRun().
+    int32_t nextASCIIRunIndex =
+        latinToUpper == LatinCase::TO_UPPER_NORMAL && edits == nullptr &&
+        (options & U_OMIT_UNCHANGED_TEXT) == 0 ? 0 : INT32_MAX;
     for (;;) {
         // fast path for simple cases
         UChar lead;
@@ -347,6 +397,15 @@ int32_t toUpper(int32_t caseLocale, uint32_t options,
                 return 0;
             }
             prev = srcIndex;
+            if (srcIndex >= nextASCIIRunIndex) {
+                int32_t count = mapASCIIRun(dest, destIndex, destCapacity,
+                                            src, srcIndex, srcLength, TRUE);
+                if (count > 0) {
+                    prev = srcIndex += count;
+                } else {
+                    nextASCIIRunIndex = srcIndex + ASCII_RUN_RETRY_DISTANCE;
+                }
+            }
         }
         if (srcIndex >= srcLength) {
             break;
@@ -1455,6 +1514,34 @@ static int32_t _cmpFold(
         limit2=s2+length2;
     }
 
+    /*
+     * fast path: skip the common prefix of ASCII characters that fold to the same,
+     * where there are no surrogates or multi-character foldings to keep track of;
+     * only 'I' and 'i' differ with U_FOLD_CASE_EXCLUDE_SPECIAL_I
+     */
+    for(;;) {
+        if(s1==limit1 || s2==limit2) {
+            break;
+        }
+        c1=*s1;
+        c2=*s2;
+        if(c1>0x7f || c2>0x7f || c1==0 || c2==0) {
+            break;
+        }
+        if(c1!=c2) {
+            c1|=0x20;
+            if( c1!=(c2|0x20) || c1<0x61 || 0x7a<c1 ||
+                (c1==0x69 && (options&_FOLD_CASE_OPTIONS_MASK)!=U_FOLD_CASE_DEFAULT)
+            ) {
+                break;
+            }
+        }
+        ++s1;
+        ++s2;
+    }
+    m1=s1;
+    m2=s2;
+
     level1=level2=0;
     c1=c2=-1;
 
@@ -1816,3 +1903,300 @@ u_caseInsensitivePrefixMatch(const UChar *s1, int32_t length1,
     _cmpFold(s1, length1, s2, length2, options,
         matchLen1, matchLen2, pErrorCode);
 }
+
+/* case-insensitive UTF-8 comparison and searching -------------------------- */
+
+namespace {
+
+inline UChar32 nextCodePoint(const UChar *s, int32_t &i, int32_t length) {
+    UChar32 c;
+    U16_NEXT(s, i, length, c);  // unpaired surrogates fold to themselves
+    return c;
+}
+
+inline UChar32 nextCodePoint(const uint8_t *s, int32_t &i, int32_t length) {
+    UChar32 c;
+    U8_NEXT_OR_FFFD(s, i, length, c);
+    return c;
+}
+
+/**
+ * Writes the full case folding of c to dest and returns its length.
+ * dest must have room for UCASE_MAX_STRING_LENGTH UChars.
+ * ASCII other than 'I' (see U_FOLD_CASE_EXCLUDE_SPECIAL_I) is folded without a lookup.
+ */
+inline int32_t foldCodePoint(UChar32 c, UChar *dest, uint32_t options) {
+    if(c<=0x7f && c!=0x49) {
+        dest[0]=(UChar)((0x41<=c && c<=0x5a) ? c+0x20 : c);
+        return 1;
+    }
+    const UChar *p;
+    int32_t result=ucase_toFullFolding(c, &p, options);
+    if(result<0) {
+        c=~result;
+    } else if(result<=UCASE_MAX_STRING_LENGTH) {
+        u_memcpy(dest, p, result);
+        return result;
+    } else {
+        c=result;
+    }
+    int32_t length=0;
+    U16_APPEND_UNSAFE(dest, length, c);
+    return length;
+}
+
+/**
+ * Returns the code points of the full case folding of a string one at a time,
+ * without folding the whole string into a buffer.
+ */
+template<typename Unit>
+class FoldingIterator {
+public:
+    FoldingIterator(const Unit *src, int32_t start, int32_t srcLength, uint32_t foldOptions) :
+            s(src), index(start), length(srcLength), options(foldOptions),
+            foldIndex(0), foldLength(0) {}
+
+    /** @return the next code point of the case folding, or U_SENTINEL at the end */
+    UChar32 next() {
+        UChar32 c;
+        if(foldIndex<foldLength) {
+            U16_NEXT_UNSAFE(fold, foldIndex, c);
+            return c;
+        }
+        if(index>=length) {
+            return U_SENTINEL;
+        }
+        c=s[index];
+        if(c<=0x7f && c!=0x49) {
+            ++index;
+            return (0x41<=c && c<=0x5a) ? c+0x20 : c;
+        }
+        c=nextCodePoint(s, index, length);
+        foldLength=foldCodePoint(c, fold, options);
+        foldIndex=0;
+        U16_NEXT_UNSAFE(fold, foldIndex, c);
+        return c;
+    }
+
+private:
+    const Unit *s;
+    int32_t index, length;
+    uint32_t options;
+    int32_t foldIndex, foldLength;
+    UChar fold[UCASE_MAX_STRING_LENGTH];
+};
+
+/**
+ * Searches for the case folding of sub in the case folding of s
+ * with the Boyer-Moore-Horspool algorithm.
+ * s is folded incrementally into a window that holds a bounded number
+ * of folded code units together with the source indexes of the code points
+ * where they start, so that a match can be required to start and end
+ * on code point boundaries of s.
+ */
+template<typename Unit>
+int32_t caseFind(const Unit *s, int32_t length, const Unit *sub, int32_t subLength,
+                 uint32_t options, int32_t *pMatchLength, UErrorCode &errorCode) {
+    // Fold the substring.
+    MaybeStackArray<UChar, 64> pattern;
+    int32_t patternLength=0;
+    for(int32_t i=0; i<subLength;) {
+        if((patternLength+UCASE_MAX_STRING_LENGTH)>pattern.getCapacity() &&
+                pattern.resize(2*pattern.getCapacity()+UCASE_MAX_STRING_LENGTH, patternLength)==nullptr) {
+            errorCode=U_MEMORY_ALLOCATION_ERROR;
+            return -1;
+        }
+        patternLength+=foldCodePoint(nextCodePoint(sub, i, subLength),
+                                     pattern.getAlias()+patternLength, options);
+    }
+    if(patternLength==0) {
+        if(pMatchLength!=nullptr) {
+            *pMatchLength=0;
+        }
+        return 0;
+    }
+
+    // Shift table indexed by the low byte of the folded text unit at the end of the window.
+    int32_t shift[256];
+    for(int32_t i=0; i<256; ++i) {
+        shift[i]=patternLength;
+    }
+    for(int32_t i=0; i<(patternLength-1); ++i) {
+        shift[pattern[i]&0xff]=patternLength-1-i;
+    }
+    const UChar last=pattern[patternLength-1];
+
+    // Folded text window, and for each unit the source index of the code point
+    // whose folding starts with it, or -1 for the other units of a multi-unit folding.
+    // The window keeps at most patternLength units of already-searched text.
+    int32_t capacity=patternLength+256;
+    MaybeStackArray<UChar, 512> text;
+    MaybeStackArray<int32_t, 512> starts;
+    if(capacity>text.getCapacity() &&
+            (text.resize(capacity)==nullptr || starts.resize(capacity)==nullptr)) {
+        errorCode=U_MEMORY_ALLOCATION_ERROR;
+        return -1;
+    }
+    UChar *t=text.getAlias();
+    int32_t *st=starts.getAlias();
+    int32_t textLength=0;
+    int32_t srcIndex=0;
+    int32_t end=patternLength-1;  // index of the last unit of the current window
+    for(;;) {
+        while(srcIndex<length && textLength<=(capacity-UCASE_MAX_STRING_LENGTH)) {
+            UChar32 c=s[srcIndex];
+            st[textLength]=srcIndex;
+            if(c<=0x7f && c!=0x49) {
+                t[textLength++]=(UChar)((0x41<=c && c<=0x5a) ? c+0x20 : c);
+                ++srcIndex;
+            } else {
+                int32_t n=foldCodePoint(nextCodePoint(s, srcIndex, length), t+textLength, options);
+                for(int32_t j=1; j<n; ++j) {
+                    st[textLength+j]=-1;
+                }
+                textLength+=n;
+            }
+        }
+        // A match must end before the start of a code point folding,
+        // so unless the text is finished the unit after the window must be available.
+        UBool atEnd= srcIndex>=length;
+        int32_t limit= atEnd ? textLength : textLength-1;
+        while(end<limit) {
+            UChar u=t[end];
+            if(u==last) {
+                int32_t first=end-(patternLength-1);
+                if( st[first]>=0 && ((end+1)==textLength || st[end+1]>=0) &&
+                    u_memcmp(t+first, pattern.getAlias(), patternLength-1)==0
+                ) {
+                    int32_t matchLimit= (end+1)==textLength ? length : st[end+1];
+                    if(pMatchLength!=nullptr) {
+                        *pMatchLength=matchLimit-st[first];
+                    }
+                    return st[first];
+                }
+            }
+            end+=shift[u&0xff];
+        }
+        if(atEnd) {
+            return -1;
+        }
+        // Keep the text from the start of the next window.
+        int32_t first=end-(patternLength-1);
+        textLength-=first;
+        uprv_memmove(t, t+first, textLength*U_SIZEOF_UCHAR);
+        uprv_memmove(st, st+first, textLength*(int32_t)sizeof(int32_t));
+        end-=first;
+    }
+}
+
+}  // namespace
+
+U_CAPI int32_t U_EXPORT2
+u_strCaseCompareUTF8(const char *s1, int32_t length1,
+                     const char *s2, int32_t length2,
+                     uint32_t options,
+                     UErrorCode *pErrorCode) {
+    /* argument checking */
+    if(pErrorCode==0 || U_FAILURE(*pErrorCode)) {
+        return 0;
+    }
+    if(s1==NULL || length1<-1 || s2==NULL || length2<-1) {
+        *pErrorCode=U_ILLEGAL_ARGUMENT_ERROR;
+        return 0;
+    }
+    if(length1<0) {
+        length1=(int32_t)uprv_strlen(s1);
+    }
+    if(length2<0) {
+        length2=(int32_t)uprv_strlen(s2);
+    }
+
+    /* compare the common prefix of ASCII characters directly */
+    const uint8_t *t1=(const uint8_t *)s1, *t2=(const uint8_t *)s2;
+    int32_t minLength= length1<length2 ? length1 : length2;
+    int32_t i=0;
+    while(i<minLength) {
+        UChar32 c1=t1[i], c2=t2[i];
+        if(c1>0x7f || c2>0x7f) {
+            break;
+        }
+        if(c1!=c2) {
+            if(c1==0x49 || c2==0x49) {
+                break;  /* see U_FOLD_CASE_EXCLUDE_SPECIAL_I */
+            }
+            if(0x41<=c1 && c1<=0x5a) {
+                c1+=0x20;
+            }
+            if(0x41<=c2 && c2<=0x5a) {
+                c2+=0x20;
+            }
+            if(c1!=c2) {
+                return c1-c2;
+            }
+        }
+        ++i;
+    }
+
+    FoldingIterator<uint8_t> iter1(t1, i, length1, options), iter2(t2, i, length2, options);
+    for(;;) {
+        UChar32 c1=iter1.next(), c2=iter2.next();
+        if(c1!=c2) {
+            if(c1<0) {
+                return -1;
+            } else if(c2<0) {
+                return 1;
+            }
+            return c1-c2;
+        }
+        if(c1<0) {
+            return 0;
+        }
+    }
+}
+
+U_CAPI int32_t U_EXPORT2
+u_strCaseFind(const UChar *s, int32_t length,
+              const UChar *sub, int32_t subLength,
+              uint32_t options, int32_t *pMatchLength,
+              UErrorCode *pErrorCode) {
+    if(pErrorCode==0 || U_FAILURE(*pErrorCode)) {
+        return -1;
+    }
+    if( (s==NULL && length!=0) || length<-1 ||
+        (sub==NULL && subLength!=0) || subLength<-1
+    ) {
+        *pErrorCode=U_ILLEGAL_ARGUMENT_ERROR;
+        return -1;
+    }
+    if(length<0) {
+        length=u_strlen(s);
+    }
+    if(subLength<0) {
+        subLength=u_strlen(sub);
+    }
+    return caseFind(s, length, sub, subLength, options, pMatchLength, *pErrorCode);
+}
+
+U_CAPI int32_t U_EXPORT2
+u_strCaseFindUTF8(const char *s, int32_t length,
+                  const char *sub, int32_t subLength,
+                  uint32_t options, int32_t *pMatchLength,
+                  UErrorCode *pErrorCode) {
+    if(pErrorCode==0 || U_FAILURE(*pErrorCode)) {
+        return -1;
+    }
+    if( (s==NULL && length!=0) || length<-1 ||
+        (sub==NULL && subLength!=0) || subLength<-1
+    ) {
+        *pErrorCode=U_ILLEGAL_ARGUMENT_ERROR;
+        return -1;
+    }
+    if(length<0) {
+        length=(int32_t)uprv_strlen(s);
+    }
+    if(subLength<0) {
+        subLength=(int32_t)uprv_strlen(sub);
+    }
+    return caseFind((const uint8_t *)s, length, (const uint8_t *)sub, subLength,
+                    options, pMatchLength, *pErrorCode);
+}
@@ -34,8 +34,25 @@
 #include "cstring.h"
 #include "cmemory.h"
 #include "ustr_imp.h"
+#include "ustr_ascii.h"
 #include "uassert.h"
 
+/*
+ * The UTF-8 conversion loops with known lengths convert ASCII runs in bulk
+ * (see ustr_ascii.h) and everything else one character at a time.
+ * The per-character inner loops handle at most this many characters
+ * before checking again for an ASCII run, so that mostly-ASCII text
+ * with a few non-ASCII characters returns to the bulk path.
+ * Testing every ASCII character for the start of a run costs more
+ * on mixed text than it saves.
+ */
+#define U_TRNS_BLOCK_LENGTH 64
+
+static U_ASCII_NOINLINE int32_t
+widenASCIIRun(UChar *dest, const uint8_t *src, int32_t length) {
+    return uprv_widenASCII(dest, src, length);
+}
+
 U_CAPI UChar* U_EXPORT2 
 u_strFromUTF32WithSub(UChar *dest,
                int32_t destCapacity,
@@ -256,6 +273,233 @@ u_strToUTF32(UChar32 *dest,
             pErrorCode);
 }
 
+static U_ASCII_NOINLINE int32_t
+asciiSpanRun(const uint8_t *s, int32_t length) {
+    return uprv_asciiSpan(s, length);
+}
+
+/*
+ * Returns the number of UTF-16 code units for well-formed UTF-8:
+ * one per lead or single byte, and one more per 4-byte lead byte.
+ */
+static int32_t
+countUTF16FromWellFormedUTF8(const uint8_t *s, int32_t length) {
+    int32_t i = 0;
+    int32_t utf16Length = 0;
+#if U_ASCII_SIMD_SSE2 || U_ASCII_SIMD_NEON
+    while((length - i) >= 16) {
+        /* Each 8-bit lane adds at most 2 per block; add up the lanes before they can overflow. */
+        int32_t limit = i + ((length - i) & ~15);
+        if((limit - i) > 127 * 16) {
+            limit = i + 127 * 16;
+        }
+#if U_ASCII_SIMD_SSE2
+        /* As signed bytes, trail bytes are -128..-65. */
+        const __m128i belowLead = _mm_set1_epi8(-65);
+        const __m128i lead4 = _mm_set1_epi8((char)0xf0);
+        __m128i sum = _mm_setzero_si128();
+        for(; i < limit; i += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+            sum = _mm_sub_epi8(sum, _mm_cmpgt_epi8(v, belowLead));
+            sum = _mm_sub_epi8(sum, _mm_cmpeq_epi8(_mm_max_epu8(v, lead4), v));
+        }
+        sum = _mm_sad_epu8(sum, _mm_setzero_si128());
+        utf16Length += _mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_srli_si128(sum, 8));
+#else
+        const int8x16_t belowLead = vdupq_n_s8(-65);
+        const uint8x16_t lead4 = vdupq_n_u8(0xf0);
+        uint8x16_t sum = vdupq_n_u8(0);
+        for(; i < limit; i += 16) {
+            uint8x16_t v = vld1q_u8(s + i);
+            sum = vsubq_u8(sum, vcgtq_s8(vreinterpretq_s8_u8(v), belowLead));
+            sum = vsubq_u8(sum, vcgeq_u8(v, lead4));
+        }
+        utf16Length += vaddlvq_u8(sum);
+#endif
+    }
+#endif
+    for(; i < length; ++i) {
+        uint8_t b = s[i];
+        if(!U8_IS_TRAIL(b)) {
+            utf16Length += b >= 0xf0 ? 2 : 1;
+        }
+    }
+    return utf16Length;
+}
+
+U_CAPI int32_t U_EXPORT2
+u_strCheckUTF8(const char *src, int32_t srcLength, int32_t *pUTF16Length) {
+    int32_t i = 0;
+    const uint8_t *s = (const uint8_t *)src;
+    if(src != NULL && srcLength >= -1) {
+        if(srcLength < 0) {
+            srcLength = (int32_t)uprv_strlen(src);
+        }
+        /* Up to limit, a sequence of up to 4 bytes needs no bounds checks. */
+        int32_t limit = srcLength - 3;
+        while(i < limit) {
+            /* Skip a run of ASCII in bulk, as in u_strFromUTF8WithSub(). */
+            if((srcLength - i) >= 16 && uprv_isASCII16(s + i)) {
+                i += 16 + asciiSpanRun(s + i + 16, srcLength - i - 16);
+                continue;
+            }
+            int32_t blockLimit = (limit - i) > U_TRNS_BLOCK_LENGTH ? i + U_TRNS_BLOCK_LENGTH : limit;
+            do {
+                uint8_t b = s[i];
+                if(U8_IS_SINGLE(b)) {
+                    ++i;
+                } else if(b < 0xe0) {
+                    if(b >= 0xc2 && U8_IS_TRAIL(s[i + 1])) {
+                        i += 2;
+                    } else {
+                        break;
+                    }
+                } else if(b < 0xf0) {
+                    if(U8_IS_VALID_LEAD3_AND_T1(b, s[i + 1]) && U8_IS_TRAIL(s[i + 2])) {
+                        i += 3;
+                    } else {
+                        break;
+                    }
+                } else {
+                    if( b <= 0xf4 && U8_IS_VALID_LEAD4_AND_T1(b, s[i + 1]) &&
+                        U8_IS_TRAIL(s[i + 2]) && U8_IS_TRAIL(s[i + 3])
+                    ) {
+                        i += 4;
+                    } else {
+                        break;
+                    }
+                }
+            } while(i < blockLimit);
+            if(i < blockLimit) {
+                break;  /* ill-formed sequence */
+            }
+        }
+        /* Check the last few bytes, and stop before an ill-formed sequence. */
+        while(i < srcLength) {
+            int32_t j = i;
+            UChar32 c;
+            U8_NEXT(s, j, srcLength, c);
+            if(c < 0) {
+                break;
+            }
+            i = j;
+        }
+    }
+    if(pUTF16Length != NULL) {
+        *pUTF16Length = countUTF16FromWellFormedUTF8(s, i);
+    }
+    return i;
+}
+
+/*
+ * Skips blocks of 8 UChars that contain no surrogates,
+ * and adds the number of UTF-8 bytes for them to *pUTF8Length.
+ * Returns the number of UChars skipped, a multiple of 8.
+ * Without SIMD, it skips nothing.
+ */
+static inline int32_t
+spanNonSurrogateBlocks(const UChar *s, int32_t length, int32_t *pUTF8Length) {
+    int32_t i = 0;
+#if U_ASCII_SIMD_SSE2 || U_ASCII_SIMD_NEON
+    int32_t utf8Length = *pUTF8Length;
+    while((length - i) >= 8) {
+        /*
+         * Each 16-bit lane subtracts at most 2 per block from 3 bytes per UChar;
+         * add up the lanes before they can overflow.
+         */
+        int32_t limit = i + ((length - i) & ~7);
+        if((limit - i) > 4096 * 8) {
+            limit = i + 4096 * 8;
+        }
+        int32_t start = i;
+#if U_ASCII_SIMD_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i high5Mask = _mm_set1_epi16((short)0xf800);
+        const __m128i surrogateBits = _mm_set1_epi16((short)0xd800);
+        const __m128i nonASCIIMask = _mm_set1_epi16((short)0xff80);
+        __m128i sum = zero;
+        for(; i < limit; i += 8) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+            __m128i high5 = _mm_and_si128(v, high5Mask);
+            if(_mm_movemask_epi8(_mm_cmpeq_epi16(high5, surrogateBits)) != 0) {
+                break;
+            }
+            /* Each comparison yields -1 in a lane for below U+0800, and for below U+0080. */
+            sum = _mm_add_epi16(sum, _mm_cmpeq_epi16(high5, zero));
+            sum = _mm_add_epi16(sum, _mm_cmpeq_epi16(_mm_and_si128(v, nonASCIIMask), zero));
+        }
+        __m128i sum32 = _mm_madd_epi16(sum, _mm_set1_epi16(1));
+        sum32 = _mm_add_epi32(sum32, _mm_shuffle_epi32(sum32, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum32 = _mm_add_epi32(sum32, _mm_shuffle_epi32(sum32, _MM_SHUFFLE(2, 3, 0, 1)));
+        utf8Length += 3 * (i - start) + _mm_cvtsi128_si32(sum32);
+#else
+        const uint16x8_t high5Mask = vdupq_n_u16(0xf800);
+        const uint16x8_t surrogateBits = vdupq_n_u16(0xd800);
+        int16x8_t sum = vdupq_n_s16(0);
+        for(; i < limit; i += 8) {
+            uint16x8_t v = vld1q_u16((const uint16_t *)(s + i));
+            if(vmaxvq_u16(vceqq_u16(vandq_u16(v, high5Mask), surrogateBits)) != 0) {
+                break;
+            }
+            /* Each comparison yields -1 in a lane for below U+0800, and for below U+0080. */
+            sum = vaddq_s16(sum, vreinterpretq_s16_u16(vcltq_u16(v, vdupq_n_u16(0x800))));
+            sum = vaddq_s16(sum, vreinterpretq_s16_u16(vcltq_u16(v, vdupq_n_u16(0x80))));
+        }
+        utf8Length += 3 * (i - start) + vaddlvq_s16(sum);
+#endif
+        if(i < limit) {
+            break;
+        }
+    }
+    *pUTF8Length = utf8Length;
+#else
+    (void)s;
+    (void)length;
+    (void)pUTF8Length;
+#endif
+    return i;
+}
+
+U_CAPI int32_t U_EXPORT2
+u_strCheckUTF16(const UChar *src, int32_t srcLength, int32_t *pUTF8Length) {
+    int32_t i = 0;
+    int32_t utf8Length = 0;
+    if(src != NULL && srcLength >= -1) {
+        if(srcLength < 0) {
+            srcLength = u_strlen(src);
+        }
+        while(i < srcLength) {
+            int32_t count = spanNonSurrogateBlocks(src + i, srcLength - i, &utf8Length);
+            /*
+             * Check the next block one UChar at a time, through the surrogate
+             * that stopped the bulk loop, or several blocks if there are
+             * surrogates everywhere.
+             */
+            i += count;
+            count = count > 0 ? 8 : U_TRNS_BLOCK_LENGTH;
+            int32_t limit = (srcLength - i) > count ? i + count : srcLength;
+            while(i < limit) {
+                UChar c = src[i];
+                if(!U16_IS_SURROGATE(c)) {
+                    utf8Length += 1 + (c > 0x7f) + (c > 0x7ff);
+                    ++i;
+                } else if(U16_IS_SURROGATE_LEAD(c) && (i + 1) < srcLength && U16_IS_TRAIL(src[i + 1])) {
+                    i += 2;
+                    utf8Length += 4;
+                } else {
+                    /* unpaired surrogate */
+                    srcLength = i;
+                    break;
+                }
+            }
+        }
+    }
+    if(pUTF8Length != NULL) {
+        *pUTF8Length = utf8Length;
+    }
+    return i;
+}
+
 U_CAPI UChar* U_EXPORT2
 u_strFromUTF8WithSub(UChar *dest,
               int32_t destCapacity,
@@ -379,17 +623,35 @@ u_strFromUTF8WithSub(UChar *dest,
         int32_t i = 0;
         UChar32 c;
         for(;;) {
+            /*
+             * Convert a run of ASCII in bulk, limited only by the dest capacity.
+             * Only try if there are at least 16 ASCII bytes, so that mixed text
+             * does not pay for starting and stopping the bulk conversion.
+             */
+            int32_t count = (int32_t)(pDestLimit - pDest);
+            if(count > (srcLength - i)) {
+                count = srcLength - i;
+            }
+            if(count >= 16 && uprv_isASCII16((const uint8_t *)src + i)) {
+                count = widenASCIIRun(pDest, (const uint8_t *)src + i, count);
+                pDest += count;
+                i += count;
+            }
+
             /*
              * Each iteration of the inner loop progresses by at most 3 UTF-8
              * bytes and one UChar, for most characters.
              * For supplementary code points (4 & 2), which are rare,
              * there is an additional adjustment.
              */
-            int32_t count = (int32_t)(pDestLimit - pDest);
+            count = (int32_t)(pDestLimit - pDest);
             int32_t count2 = (srcLength - i) / 3;
             if(count > count2) {
                 count = count2; /* min(remaining dest, remaining src/3) */
             }
+            if(count > U_TRNS_BLOCK_LENGTH) {
+                count = U_TRNS_BLOCK_LENGTH; /* return to the ASCII check from time to time */
+            }
             if(count < 3) {
                 /*
                  * Too much overhead if we get near the end of the string,
@@ -486,36 +748,22 @@ u_strFromUTF8WithSub(UChar *dest,
             }
         }
 
-        /* Pre-flight the rest of the string. */
+        /*
+         * Pre-flight the rest of the string:
+         * Count its well-formed parts in bulk, and substitute for each ill-formed sequence.
+         */
         while(i < srcLength) {
-            // modified copy of U8_NEXT()
-            c = (uint8_t)src[i++];
-            if(U8_IS_SINGLE(c)) {
-                ++reqLength;
-            } else {
-                uint8_t __t1, __t2;
-                if( /* handle U+0800..U+FFFF inline */
-                        (0xe0<=(c) && (c)<0xf0) &&
-                        ((i)+1)<srcLength &&
-                        U8_IS_VALID_LEAD3_AND_T1((c), src[i]) &&
-                        (__t2=src[(i)+1]-0x80)<=0x3f) {
-                    ++reqLength;
-                    i+=2;
-                } else if( /* handle U+0080..U+07FF inline */
-                        ((c)<0xe0 && (c)>=0xc2) &&
-                        ((i)!=srcLength) &&
-                        (__t1=src[i]-0x80)<=0x3f) {
-                    ++reqLength;
-                    ++(i);
-                } else {
-                    /* function call for "complicated" and error cases */
-                    (c)=utf8_nextCharSafeBody((const uint8_t *)src, &(i), srcLength, c, -1);
-                    if(c<0 && (++numSubstitutions, c = subchar) < 0) {
-                        *pErrorCode = U_INVALID_CHAR_FOUND;
-                        return NULL;
-                    }
-                    reqLength += U16_LENGTH(c);
+            int32_t utf16Length;
+            i += u_strCheckUTF8(src + i, srcLength - i, &utf16Length);
+            reqLength += utf16Length;
+            if(i < srcLength) {
+                c = (uint8_t)src[i++];
+                c = utf8_nextCharSafeBody((const uint8_t *)src, &(i), srcLength, c, -1);
+                if(c<0 && (++numSubstitutions, c = subchar) < 0) {
+                    *pErrorCode = U_INVALID_CHAR_FOUND;
+                    return NULL;
                 }
+                reqLength += U16_LENGTH(c);
             }
         }
     }
@@ -899,6 +1147,18 @@ u_strToUTF8WithSub(char *dest,
 
         /* Faster loop without ongoing checking for pSrcLimit and pDestLimit. */
         for(;;) {
+            /* Convert a run of ASCII in bulk, as in u_strFromUTF8WithSub(). */
+            count = (int32_t)(pDestLimit - pDest);
+            srcLength = (int32_t)(pSrcLimit - pSrc);
+            if(count > srcLength) {
+                count = srcLength;
+            }
+            if(count >= 16 && uprv_isASCII16_UChars(pSrc)) {
+                count = uprv_narrowToLatin1(pDest, pSrc, count, 0x7f);
+                pDest += count;
+                pSrc += count;
+            }
+
             /*
              * Each iteration of the inner loop progresses by at most 3 UTF-8
              * bytes and one UChar, for most characters.
@@ -910,6 +1170,9 @@ u_strToUTF8WithSub(char *dest,
             if(count > srcLength) {
                 count = srcLength; /* min(remaining dest/3, remaining src) */
             }
+            if(count > U_TRNS_BLOCK_LENGTH) {
+                count = U_TRNS_BLOCK_LENGTH; /* return to the ASCII check from time to time */
+            }
             if(count < 3) {
                 /*
                  * Too much overhead if we get near the end of the string,
@@ -1016,24 +1279,24 @@ u_strToUTF8WithSub(char *dest,
                 }
             }
         }
+        /*
+         * Pre-flight the rest of the string:
+         * Count its well-formed parts in bulk, and substitute for each unpaired surrogate.
+         */
         while(pSrc<pSrcLimit) {
-            ch=*pSrc++;
-            if(ch<=0x7f) {
-                ++reqLength;
-            } else if(ch<=0x7ff) {
-                reqLength+=2;
-            } else if(!U16_IS_SURROGATE(ch)) {
-                reqLength+=3;
-            } else if(U16_IS_SURROGATE_LEAD(ch) && pSrc<pSrcLimit && U16_IS_TRAIL(ch2=*pSrc)) {
+            int32_t utf8Length;
+            pSrc+=u_strCheckUTF16(pSrc, (int32_t)(pSrcLimit-pSrc), &utf8Length);
+            reqLength+=utf8Length;
+            if(pSrc<pSrcLimit) {
                 ++pSrc;
-                reqLength+=4;
-            } else if(subchar>=0) {
-                reqLength+=U8_LENGTH(subchar);
-                ++numSubstitutions;
-            } else {
-                /* Unicode 3.2 forbids surrogate code points in UTF-8 */
-                *pErrorCode = U_INVALID_CHAR_FOUND;
-                return NULL;
+                if(subchar>=0) {
+                    reqLength+=U8_LENGTH(subchar);
+                    ++numSubstitutions;
+                } else {
+                    /* Unicode 3.2 forbids surrogate code points in UTF-8 */
+                    *pErrorCode = U_INVALID_CHAR_FOUND;
+                    return NULL;
+                }
             }
         }
     }
@@ -150,7 +150,7 @@ void CharsetDetector::setRecognizers(UErrorCode &status)
 CharsetDetector::CharsetDetector(UErrorCode &status)
   : textIn(new InputText(status)), resultArray(NULL),
     resultCount(0), fStripTags(FALSE), fFreshTextSet(FALSE),
-    fEnabledRecognizers(NULL)
+    fAllMatchesFound(FALSE), fEnabledRecognizers(NULL)
 {
     if (U_FAILURE(status)) {
         return;
@@ -218,6 +218,12 @@ void CharsetDetector::setDeclaredEncoding(const char *encoding, int32_t len) con
     textIn->setDeclaredEncoding(encoding,len);
 }
 
+void CharsetDetector::setSampleLength(int32_t len)
+{
+    textIn->setSampleLength(len);
+    fFreshTextSet = TRUE;
+}
+
 int32_t CharsetDetector::getDetectableCount()
 {
     UErrorCode status = U_ZERO_ERROR;
@@ -227,13 +233,49 @@ int32_t CharsetDetector::getDetectableCount()
     return fCSRecognizers_size; 
 }
 
+void CharsetDetector::runRecognizers(UBool stopAtCertainMatch, UErrorCode &status)
+{
+    CharsetRecognizer *csr;
+    int32_t            i;
+
+    textIn->MungeInput(fStripTags);
+
+    // Iterate over all possible charsets, remember all that
+    // give a match quality > 0.
+    resultCount = 0;
+    fAllMatchesFound = TRUE;
+    for (i = 0; i < fCSRecognizers_size; i += 1) {
+        csr = fCSRecognizers[i]->recognizer;
+        if (csr->match(textIn, resultArray[resultCount])) {
+            resultCount++;
+
+            // The first match with full confidence sorts ahead of all others
+            // (the sort is stable), so the remaining recognizers cannot
+            // change the best match.
+            if (stopAtCertainMatch && resultArray[resultCount - 1]->getConfidence() >= 100) {
+                fAllMatchesFound = (UBool)(i == fCSRecognizers_size - 1);
+                break;
+            }
+        }
+    }
+
+    if (resultCount > 1) {
+        uprv_sortArray(resultArray, resultCount, sizeof resultArray[0], charsetMatchComparator, NULL, TRUE, &status);
+    }
+    fFreshTextSet = FALSE;
+}
+
 const CharsetMatch *CharsetDetector::detect(UErrorCode &status)
 {
-    int32_t maxMatchesFound = 0;
+    if(!textIn->isSet()) {
+        status = U_MISSING_RESOURCE_ERROR;// TODO:  Need to set proper status code for input text not set
 
-    detectAll(maxMatchesFound, status);
+        return NULL;
+    } else if (fFreshTextSet) {
+        runRecognizers(TRUE, status);
+    }
 
-    if(maxMatchesFound > 0) {
+    if(resultCount > 0) {
         return resultArray[0];
     } else {
         return NULL;
@@ -246,26 +288,8 @@ const CharsetMatch * const *CharsetDetector::detectAll(int32_t &maxMatchesFound,
         status = U_MISSING_RESOURCE_ERROR;// TODO:  Need to set proper status code for input text not set
 
         return NULL;
-    } else if (fFreshTextSet) {
-        CharsetRecognizer *csr;
-        int32_t            i;
-
-        textIn->MungeInput(fStripTags);
-
-        // Iterate over all possible charsets, remember all that
-        // give a match quality > 0.
-        resultCount = 0;
-        for (i = 0; i < fCSRecognizers_size; i += 1) {
-            csr = fCSRecognizers[i]->recognizer;
-            if (csr->match(textIn, resultArray[resultCount])) {
-                resultCount++;
-            }
-        }
-
-        if (resultCount > 1) {
-            uprv_sortArray(resultArray, resultCount, sizeof resultArray[0], charsetMatchComparator, NULL, TRUE, &status);
-        }
-        fFreshTextSet = FALSE;
+    } else if (fFreshTextSet || !fAllMatchesFound) {
+        runRecognizers(FALSE, status);
     }
 
     maxMatchesFound = resultCount;
@@ -30,7 +30,9 @@ private:
     int32_t resultCount;
     UBool fStripTags;   // If true, setText() will strip tags from input text.
     UBool fFreshTextSet;
+    UBool fAllMatchesFound; // FALSE if detect() stopped before running all recognizers.
     static void setRecognizers(UErrorCode &status);
+    void runRecognizers(UBool stopAtCertainMatch, UErrorCode &status);
 
     UBool *fEnabledRecognizers;  // If not null, active set of charset recognizers had
                                 // been changed from the default. The array index is
@@ -49,6 +51,8 @@ public:
 
     void setDeclaredEncoding(const char *encoding, int32_t len) const;
 
+    void setSampleLength(int32_t len);
+
     UBool setStripTagsFlag(UBool flag);
 
     UBool getStripTagsFlag() const;
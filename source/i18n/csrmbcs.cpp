@@ -131,7 +131,7 @@ charValue(0), index(-1), nextIndex(0), error(FALSE), done(FALSE)
 
 int32_t IteratedChar::nextByte(InputText *det)
 {
-    if (nextIndex >= det->fRawLength) {
+    if (nextIndex >= det->fSampleLength) {
         done = TRUE;
 
         return -1;
@@ -20,70 +20,57 @@
 
 U_NAMESPACE_BEGIN
 
-NGramParser::NGramParser(const int32_t *theNgramList, const uint8_t *theCharMap)
- : ngram(0), byteIndex(0)
-{
-    ngramList = theNgramList;
-    charMap   = theCharMap;
-
-    ngramCount = hitCount = 0;
-}
-
-NGramParser::~NGramParser()
-{
-}
+#define N_GRAM_SET_SIZE 128
 
 /*
- * Binary search for value in table, which must have exactly 64 entries.
+ * Hash for an n-gram, with as many bits as needed to index a slot
+ * in ngramSet. The n-gram tables have exactly 64 entries, so the set
+ * is half full and most lookups need one or two probes.
  */
-
-int32_t NGramParser::search(const int32_t *table, int32_t value)
+static inline int32_t ngramHash(int32_t ngram)
 {
-    int32_t index = 0;
-
-    if (table[index + 32] <= value) {
-        index += 32;
-    }
-
-    if (table[index + 16] <= value) {
-        index += 16;
-    }
-
-    if (table[index + 8] <= value) {
-        index += 8;
-    }
+    return (int32_t)(((uint32_t)ngram * 0x9E3779B1) >> 25);
+}
 
-    if (table[index + 4] <= value) {
-        index += 4;
-    }
+NGramParser::NGramParser(const int32_t *theNgramList, const uint8_t *theCharMap)
+ : ngram(0), byteIndex(0)
+{
+    charMap   = theCharMap;
 
-    if (table[index + 2] <= value) {
-        index += 2;
-    }
+    ngramCount = hitCount = 0;
 
-    if (table[index + 1] <= value) {
-        index += 1;
-    }
+    uprv_memset(ngramSet, 0xff, sizeof(ngramSet));
+    for (int32_t i = 0; i < 64; i += 1) {
+        int32_t value = theNgramList[i];
+        int32_t index = ngramHash(value);
 
-    if (table[index] > value) {
-        index -= 1;
-    }
+        while (ngramSet[index] >= 0 && ngramSet[index] != value) {
+            index = (index + 1) & (N_GRAM_SET_SIZE - 1);
+        }
 
-    if (index < 0 || table[index] != value) {
-        return -1;
+        ngramSet[index] = value;
     }
+}
 
-    return index;
+NGramParser::~NGramParser()
+{
 }
 
 void NGramParser::lookup(int32_t thisNgram)
 {
+    int32_t index = ngramHash(thisNgram);
+    int32_t value;
+
     ngramCount += 1;
 
-    if (search(ngramList, thisNgram) >= 0) {
-        hitCount += 1;
-    }
+    while ((value = ngramSet[index]) >= 0) {
+        if (value == thisNgram) {
+            hitCount += 1;
+            break;
+        }
 
+        index = (index + 1) & (N_GRAM_SET_SIZE - 1);
+    }
 }
 
 void NGramParser::addByte(int32_t b)
@@ -22,7 +22,9 @@ class NGramParser : public UMemory
 {
 private:
     int32_t ngram;
-    const int32_t *ngramList;    
+    // Open-addressing hash set of the 64 n-grams from the recognizer's table;
+    // empty slots are -1.
+    int32_t ngramSet[128];
 
     int32_t ngramCount;
     int32_t hitCount;
@@ -38,11 +40,6 @@ public:
     virtual ~NGramParser();
 
 private:
-    /*
-    * Binary search for value in table, which must have exactly 64 entries.
-    */
-    int32_t search(const int32_t *table, int32_t value);
-
     void lookup(int32_t thisNgram);
     
     virtual int32_t nextByte(InputText *det);
@@ -56,7 +56,7 @@ UBool CharsetRecog_UTF_16_BE::match(InputText* textIn, CharsetMatch *results) co
 {
     const uint8_t *input = textIn->fRawInput;
     int32_t confidence = 10;
-    int32_t length = textIn->fRawLength;
+    int32_t length = textIn->fSampleLength;
 
     int32_t bytesToCheck = (length > 30) ? 30 : length;
     for (int32_t charIndex=0; charIndex<bytesToCheck-1; charIndex+=2) {
@@ -91,7 +91,7 @@ UBool CharsetRecog_UTF_16_LE::match(InputText* textIn, CharsetMatch *results) co
 {
     const uint8_t *input = textIn->fRawInput;
     int32_t confidence = 10;
-    int32_t length = textIn->fRawLength;
+    int32_t length = textIn->fSampleLength;
 
     int32_t bytesToCheck = (length > 30) ? 30 : length;
     for (int32_t charIndex=0; charIndex<bytesToCheck-1; charIndex+=2) {
@@ -123,7 +123,7 @@ CharsetRecog_UTF_32::~CharsetRecog_UTF_32()
 UBool CharsetRecog_UTF_32::match(InputText* textIn, CharsetMatch *results) const
 {
     const uint8_t *input = textIn->fRawInput;
-    int32_t limit = (textIn->fRawLength / 4) * 4;
+    int32_t limit = (textIn->fSampleLength / 4) * 4;
     int32_t numValid = 0;
     int32_t numInvalid = 0;
     bool hasBOM = FALSE;
@@ -11,6 +11,7 @@
 
 #if !UCONFIG_NO_CONVERSION
 
+#include "unicode/ustring.h"
 #include "csrutf8.h"
 #include "csmatch.h"
 
@@ -35,13 +36,23 @@ UBool CharsetRecog_UTF8::match(InputText* input, CharsetMatch *results) const {
     int32_t trailBytes = 0;
     int32_t confidence;
 
-    if (input->fRawLength >= 3 && 
+    if (input->fSampleLength >= 3 && 
         inputBytes[0] == 0xEF && inputBytes[1] == 0xBB && inputBytes[2] == 0xBF) {
             hasBOM = TRUE;
     }
 
-    // Scan for multi-byte sequences
-    for (i=0; i < input->fRawLength; i += 1) {
+    // The well-formed beginning of the input, usually all of it if it is UTF-8,
+    // is checked in bulk; each of its lead bytes starts a valid multi-byte sequence.
+    int32_t wellFormedLength =
+        u_strCheckUTF8((const char *)inputBytes, input->fSampleLength, NULL);
+    for (i=0; i < wellFormedLength; i += 1) {
+        if (inputBytes[i] >= 0xC0) {
+            numValid += 1;
+        }
+    }
+
+    // Scan the rest for multi-byte sequences
+    for (i=wellFormedLength; i < input->fSampleLength; i += 1) {
         int32_t b = inputBytes[i];
 
         if ((b & 0x80) == 0) {
@@ -64,7 +75,7 @@ UBool CharsetRecog_UTF8::match(InputText* input, CharsetMatch *results) const {
         for (;;) {
             i += 1;
 
-            if (i >= input->fRawLength) {
+            if (i >= input->fSampleLength) {
                 break;
             }
 
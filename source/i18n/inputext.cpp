@@ -32,7 +32,9 @@ InputText::InputText(UErrorCode &status)
                                                  //   Value is percent, not absolute.
       fDeclaredEncoding(0),
       fRawInput(0),
-      fRawLength(0)
+      fRawLength(0),
+      fSampleLength(0),
+      fSampleLimit(0)
 {
     if (fInputBytes == NULL || fByteStats == NULL) {
         status = U_MEMORY_ALLOCATION_ERROR;
@@ -68,6 +70,11 @@ void InputText::setDeclaredEncoding(const char* encoding, int32_t len)
     }
 }
 
+void InputText::setSampleLength(int32_t len)
+{
+    fSampleLimit = len > 0 ? len : 0;
+}
+
 UBool InputText::isSet() const 
 {
     return fRawInput != NULL;
@@ -87,6 +94,11 @@ void InputText::MungeInput(UBool fStripTags) {
     int32_t openTags = 0;
     int32_t badTags  = 0;
 
+    fSampleLength = fRawLength;
+    if (fSampleLimit > 0 && fSampleLength > fSampleLimit) {
+        fSampleLength = fSampleLimit;
+    }
+
     //
     //  html / xml markup stripping.
     //     quick and dirty, not 100% accurate, but hopefully good enough, statistically.
@@ -95,7 +107,7 @@ void InputText::MungeInput(UBool fStripTags) {
     //     guess as to whether the input was actually marked up at all.
     // TODO: Think about how this interacts with EBCDIC charsets that are detected.
     if (fStripTags) {
-        for (srci = 0; srci < fRawLength && dsti < BUFFER_SIZE; srci += 1) {
+        for (srci = 0; srci < fSampleLength && dsti < BUFFER_SIZE; srci += 1) {
             b = fRawInput[srci];
 
             if (b == (uint8_t)0x3C) { /* Check for the ASCII '<' */
@@ -125,9 +137,9 @@ void InputText::MungeInput(UBool fStripTags) {
     //    Detection will have to work on the unstripped input.
     //
     if (openTags<5 || openTags/5 < badTags || 
-        (fInputLen < 100 && fRawLength>600))
+        (fInputLen < 100 && fSampleLength>600))
     {
-        int32_t limit = fRawLength;
+        int32_t limit = fSampleLength;
 
         if (limit > BUFFER_SIZE) {
             limit = BUFFER_SIZE;
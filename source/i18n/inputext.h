@@ -35,6 +35,7 @@ public:
 
     void setText(const char *in, int32_t len);
     void setDeclaredEncoding(const char *encoding, int32_t len);
+    void setSampleLength(int32_t len);
     UBool isSet() const; 
     void MungeInput(UBool fStripTags);
 
@@ -54,6 +55,11 @@ public:
     //  If user gave us a stream, it's read to a 
     //   buffer here.
     int32_t                  fRawLength;    // Length of data in fRawInput array.
+    int32_t                  fSampleLength; // Number of leading bytes of fRawInput that
+                                            //   the recognizers examine; set by MungeInput().
+
+private:
+    int32_t                  fSampleLimit;  // Limit for fSampleLength, or 0 for the whole input.
 
 };
 
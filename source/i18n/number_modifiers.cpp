@@ -9,6 +9,7 @@
 #include "ucln_cmn.h"
 #include "ucln_in.h"
 #include "number_modifiers.h"
+#include "sharedunicodeset.h"
 
 using namespace icu;
 using namespace icu::number;
@@ -312,7 +313,15 @@ CurrencySpacingEnabledModifier::getUnicodeSet(const DecimalFormatSymbols &symbol
     } else if (pattern.compare(u"[:^S:]", -1) == 0) {
         return *UNISET_NOTS;
     } else {
-        return UnicodeSet(pattern, status);
+        // Other patterns are parsed only once and then shared via the unified cache.
+        const SharedUnicodeSet *shared = nullptr;
+        SharedUnicodeSet::getForPattern(pattern, shared, status);
+        if (U_FAILURE(status)) {
+            return UnicodeSet();
+        }
+        UnicodeSet result(**shared);
+        shared->removeRef();
+        return result;
     }
 }
 
@@ -112,6 +112,16 @@ ucsdet_setDeclaredEncoding(UCharsetDetector *ucsd, const char *encoding, int32_t
     ((CharsetDetector *) ucsd)->setDeclaredEncoding(encoding,length);
 }
 
+U_CAPI void U_EXPORT2
+ucsdet_setSampleLength(UCharsetDetector *ucsd, int32_t length, UErrorCode *status)
+{
+    if(U_FAILURE(*status)) {
+        return;
+    }
+
+    ((CharsetDetector *) ucsd)->setSampleLength(length);
+}
+
 U_CAPI const UCharsetMatch**
 ucsdet_detectAll(UCharsetDetector *ucsd,
                  int32_t *maxMatchesFound, UErrorCode *status)
@@ -149,6 +149,27 @@ ucsdet_setText(UCharsetDetector *ucsd, const char *textIn, int32_t len, UErrorCo
 U_STABLE void U_EXPORT2
 ucsdet_setDeclaredEncoding(UCharsetDetector *ucsd, const char *encoding, int32_t length, UErrorCode *status);
 
+#ifndef U_HIDE_DRAFT_API
+/**
+ * Limit the detection to a leading sample of the input text.
+ * By default all of the input text is examined, which for large inputs
+ * makes detection time proportional to the size of the input.
+ * With a sample length, the charset recognizers examine at most that many
+ * bytes from the start of the text, and detection time is bounded.
+ * The limit applies to subsequently detected texts as well;
+ * it does not affect the text returned by ucsdet_getUChars().
+ *
+ * @param ucsd      the charset detector to be used.
+ * @param length    the maximum number of bytes to examine,
+ *                  or 0 to examine all of the input text.
+ * @param status    any error conditions are reported back in this variable.
+ *
+ * @draft ICU 62
+ */
+U_DRAFT void U_EXPORT2
+ucsdet_setSampleLength(UCharsetDetector *ucsd, int32_t length, UErrorCode *status);
+#endif  /* U_HIDE_DRAFT_API */
+
 
 /**
  * Return the charset that best matches the supplied input data.
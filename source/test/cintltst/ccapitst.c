@@ -69,6 +69,10 @@ static void TestEBCDICSwapLFNL(void);
 static void TestConvertEx(void);
 static void TestConvertExFromUTF8(void);
 static void TestConvertExFromUTF8_C5F0(void);
+static void TestConvertExToUTF8(void);
+static void TestConvertParallel(void);
+static void TestConverterPool(void);
+static void TestSharedConverter(void);
 static void TestConvertAlgorithmic(void);
        void TestDefaultConverterError(void);    /* defined in cctest.c */
        void TestDefaultConverterSet(void);    /* defined in cctest.c */
@@ -104,6 +108,10 @@ void addTestConvert(TestNode** root)
     addTest(root, &TestConvertEx,               "tsconv/ccapitst/TestConvertEx");
     addTest(root, &TestConvertExFromUTF8,       "tsconv/ccapitst/TestConvertExFromUTF8");
     addTest(root, &TestConvertExFromUTF8_C5F0,  "tsconv/ccapitst/TestConvertExFromUTF8_C5F0");
+    addTest(root, &TestConvertExToUTF8,         "tsconv/ccapitst/TestConvertExToUTF8");
+    addTest(root, &TestConvertParallel,         "tsconv/ccapitst/TestConvertParallel");
+    addTest(root, &TestConverterPool,           "tsconv/ccapitst/TestConverterPool");
+    addTest(root, &TestSharedConverter,         "tsconv/ccapitst/TestSharedConverter");
     addTest(root, &TestConvertAlgorithmic,      "tsconv/ccapitst/TestConvertAlgorithmic");
     addTest(root, &TestDefaultConverterError,   "tsconv/ccapitst/TestDefaultConverterError");
     addTest(root, &TestDefaultConverterSet,     "tsconv/ccapitst/TestDefaultConverterSet");
@@ -2636,6 +2644,7 @@ static void TestConvertExFromUTF8() {
 #if !UCONFIG_NO_LEGACY_CONVERSION
         "windows-1252",
         "shift-jis",
+        "gb18030",
 #endif
         "us-ascii",
         "iso-8859-1",
@@ -2674,6 +2683,484 @@ static void TestConvertExFromUTF8() {
     ucnv_close(utf8Cnv);
 }
 
+/*
+ * Conversion from SBCS/DBCS codepages to UTF-8 may bypass the UTF-16 pivot.
+ * Check that it yields the same result as converting to UTF-16 and then to UTF-8,
+ * including for unassigned and illegal bytes.
+ */
+static void TestConvertExToUTF8() {
+    static const char *const converterNames[]={
+#if !UCONFIG_NO_LEGACY_CONVERSION
+        "windows-1252",
+        "ibm-1047",
+        "ibm-1047,swaplfnl",
+        "shift-jis",
+        "windows-936",
+        "euc-kr",
+        "gb18030",
+#endif
+        "iso-8859-1"
+    };
+    static const char ascii[]="Hello, World! 0123456789 the quick brown fox\n";
+
+    UConverter *utf8Cnv, *cnv;
+    UErrorCode errorCode;
+    int32_t i, j;
+
+    UChar utf16[400];
+    char bytes[500], expect[1000], output[1000];
+    int32_t utf16Length, bytesLength, expectLength, outputLength;
+
+    errorCode=U_ZERO_ERROR;
+    utf8Cnv=ucnv_open("UTF-8", &errorCode);
+    if(U_FAILURE(errorCode)) {
+        log_data_err("unable to open UTF-8 converter - %s\n", u_errorName(errorCode));
+        return;
+    }
+
+    for(i=0; i<UPRV_LENGTHOF(converterNames); ++i) {
+        USet *set;
+        int32_t setSize;
+
+        errorCode=U_ZERO_ERROR;
+        cnv=ucnv_open(converterNames[i], &errorCode);
+        if(U_FAILURE(errorCode)) {
+            log_data_err("unable to open %s converter - %s\n", converterNames[i], u_errorName(errorCode));
+            continue;
+        }
+
+        /* ASCII, then some round-tripping characters, then all high bytes */
+        u_charsToUChars(ascii, utf16, (int32_t)strlen(ascii));
+        utf16Length=(int32_t)strlen(ascii);
+        set=uset_open(1, 0);
+        ucnv_getUnicodeSet(cnv, set, UCNV_ROUNDTRIP_SET, &errorCode);
+        setSize=uset_size(set);
+        for(j=0; j<60; ++j) {
+            U16_APPEND_UNSAFE(utf16, utf16Length, uset_charAt(set, (int32_t)(((int64_t)setSize*j)/60)));
+        }
+        uset_close(set);
+        bytesLength=ucnv_fromUChars(cnv, bytes, 300, utf16, utf16Length, &errorCode);
+        for(j=0x80; j<=0xff; ++j) {
+            bytes[bytesLength++]=(char)j;
+        }
+        bytes[bytesLength++]='A';
+
+        /* expected: pivot through UTF-16 explicitly */
+        utf16Length=ucnv_toUChars(cnv, utf16, UPRV_LENGTHOF(utf16), bytes, bytesLength, &errorCode);
+        expectLength=ucnv_fromUChars(utf8Cnv, expect, UPRV_LENGTHOF(expect), utf16, utf16Length, &errorCode);
+        if(U_FAILURE(errorCode)) {
+            log_err("unable to convert test strings for %s - %s\n", converterNames[i], u_errorName(errorCode));
+            ucnv_close(cnv);
+            continue;
+        }
+
+        outputLength=ucnv_convert("UTF-8", converterNames[i], output, UPRV_LENGTHOF(output),
+                                  bytes, bytesLength, &errorCode);
+        if(U_FAILURE(errorCode) || outputLength!=expectLength || 0!=memcmp(output, expect, expectLength)) {
+            log_err("ucnv_convert(%s to UTF-8) differs from pivoting through UTF-16 - %s\n",
+                    converterNames[i], u_errorName(errorCode));
+        }
+        convertExMultiStreaming(cnv, utf8Cnv,
+                                bytes, bytesLength,
+                                expect, expectLength,
+                                converterNames[i],
+                                U_ZERO_ERROR);
+        ucnv_close(cnv);
+    }
+    ucnv_close(utf8Cnv);
+}
+
+/* convert with ucnv_convertEx() and check ucnv_convertParallel() against it */
+static void
+checkConvertParallel(const char *targetName, const char *sourceName,
+                     const char *source, int32_t sourceLength,
+                     UConverterToUCallback toUCallback) {
+    UConverter *targetCnv, *sourceCnv;
+    UErrorCode errorCode=U_ZERO_ERROR;
+    char *expect, *output;
+    int32_t *expectOffsets, *offsets;
+    int32_t capacity=sourceLength*4+100, expectLength, length, numThreads, i;
+    UBool withOffsets;
+
+    targetCnv=ucnv_open(targetName, &errorCode);
+    sourceCnv=ucnv_open(sourceName, &errorCode);
+    if(U_FAILURE(errorCode)) {
+        log_data_err("unable to open %s or %s converter - %s\n", targetName, sourceName, u_errorName(errorCode));
+        ucnv_close(targetCnv);
+        ucnv_close(sourceCnv);
+        return;
+    }
+    if(toUCallback!=NULL) {
+        ucnv_setToUCallBack(sourceCnv, toUCallback, NULL, NULL, NULL, &errorCode);
+    }
+    expect=(char *)malloc(capacity);
+    output=(char *)malloc(capacity);
+    expectOffsets=(int32_t *)malloc(capacity*4);
+    offsets=(int32_t *)malloc(capacity*4);
+
+    /* expected output from one thread, which converts the whole string at once */
+    expectLength=ucnv_convertParallel(targetCnv, sourceCnv, expect, capacity,
+                                      source, sourceLength, expectOffsets, 1, &errorCode);
+    if(toUCallback==NULL) {
+        char *target=output;
+        const char *src=source;
+        UErrorCode convertExErrorCode=U_ZERO_ERROR;
+        ucnv_convertEx(targetCnv, sourceCnv, &target, output+capacity,
+                       &src, source+sourceLength,
+                       NULL, NULL, NULL, NULL, TRUE, TRUE, &convertExErrorCode);
+        if( U_FAILURE(errorCode) || U_FAILURE(convertExErrorCode) ||
+            expectLength!=(int32_t)(target-output) || 0!=memcmp(expect, output, expectLength)
+        ) {
+            log_err("ucnv_convertParallel(%s to %s, 1 thread) differs from ucnv_convertEx() - %s\n",
+                    sourceName, targetName, u_errorName(errorCode));
+        }
+    } else if(errorCode!=U_ILLEGAL_CHAR_FOUND) {
+        log_err("ucnv_convertParallel(%s to %s, 1 thread, stop) sets %s instead of U_ILLEGAL_CHAR_FOUND\n",
+                sourceName, targetName, u_errorName(errorCode));
+    }
+    for(i=0; i<expectLength; ++i) {
+        if(expectOffsets[i]<(i>0 ? expectOffsets[i-1] : 0) || expectOffsets[i]>=sourceLength) {
+            log_err("ucnv_convertParallel(%s to %s, 1 thread) offsets[%d]=%d out of order\n",
+                    sourceName, targetName, (int)i, (int)expectOffsets[i]);
+            break;
+        }
+    }
+
+    for(numThreads=2; numThreads<=8; numThreads+=3) {
+        for(withOffsets=FALSE; withOffsets<=TRUE; ++withOffsets) {
+            if(toUCallback!=NULL && !withOffsets) {
+                /* without offsets, the output before the error depends on the pivoting */
+                continue;
+            }
+            errorCode=U_ZERO_ERROR;
+            length=ucnv_convertParallel(targetCnv, sourceCnv, output, capacity,
+                                        source, sourceLength,
+                                        withOffsets ? offsets : NULL, numThreads, &errorCode);
+            if( (toUCallback==NULL ? U_FAILURE(errorCode) : errorCode!=U_ILLEGAL_CHAR_FOUND) ||
+                length!=expectLength || 0!=memcmp(expect, output, expectLength)
+            ) {
+                log_err("ucnv_convertParallel(%s to %s, %d threads) differs from 1 thread - %s\n",
+                        sourceName, targetName, (int)numThreads, u_errorName(errorCode));
+            } else if(withOffsets && 0!=memcmp(expectOffsets, offsets, expectLength*4)) {
+                log_err("ucnv_convertParallel(%s to %s, %d threads) offsets differ from 1 thread\n",
+                        sourceName, targetName, (int)numThreads);
+            }
+        }
+    }
+
+    /* preflighting */
+    if(toUCallback==NULL) {
+        errorCode=U_ZERO_ERROR;
+        length=ucnv_convertParallel(targetCnv, sourceCnv, NULL, 0,
+                                    source, sourceLength, NULL, 4, &errorCode);
+        if(errorCode!=U_BUFFER_OVERFLOW_ERROR || length!=expectLength) {
+            log_err("ucnv_convertParallel(%s to %s, preflighting) returns %d instead of %d - %s\n",
+                    sourceName, targetName, (int)length, (int)expectLength, u_errorName(errorCode));
+        }
+    }
+
+    free(expect);
+    free(output);
+    free(expectOffsets);
+    free(offsets);
+    ucnv_close(targetCnv);
+    ucnv_close(sourceCnv);
+}
+
+static void TestConvertParallel() {
+    static const UChar32 chars[]={
+        0x61, 0x62, 0x20, 0x30, 0xe4, 0xdf, 0x3b1, 0x430, 0x4e00, 0x3042, 0x20ac, 0x1f600, 0x2e
+    };
+    UChar *text;
+    char *utf8, *bytes;
+    int32_t textLength=0, utf8Length, bytesLength, i;
+    UErrorCode errorCode=U_ZERO_ERROR;
+
+    /* lines of various lengths, long enough to be split into many chunks */
+    text=(UChar *)malloc(300000*U_SIZEOF_UCHAR);
+    utf8=(char *)malloc(1000000);
+    bytes=(char *)malloc(1000000);
+    for(i=0; textLength<299000; ++i) {
+        U16_APPEND_UNSAFE(text, textLength, chars[(i*7)%UPRV_LENGTHOF(chars)]);
+        if((i%97)==96) {
+            text[textLength++]=0xa;
+        }
+    }
+    utf8Length=ucnv_convert("UTF-8", "UTF-16LE", utf8, 1000000,
+                            (const char *)text, textLength*U_SIZEOF_UCHAR, &errorCode);
+    if(U_FAILURE(errorCode)) {
+        log_err("unable to convert the test text to UTF-8 - %s\n", u_errorName(errorCode));
+    } else {
+        checkConvertParallel("UTF-16LE", "UTF-8", utf8, utf8Length, NULL);
+        checkConvertParallel("UTF-32BE", "UTF-8", utf8, utf8Length, NULL);
+        checkConvertParallel("UTF-8", "UTF-16LE", (const char *)text, textLength*U_SIZEOF_UCHAR, NULL);
+#if !UCONFIG_NO_LEGACY_CONVERSION
+        checkConvertParallel("shift-jis", "UTF-8", utf8, utf8Length, NULL);
+        checkConvertParallel("windows-1252", "UTF-16LE", (const char *)text, textLength*U_SIZEOF_UCHAR, NULL);
+        /* stateful: converted on one thread */
+        checkConvertParallel("ISO-2022-JP", "UTF-8", utf8, utf8Length, NULL);
+#endif
+
+        /* an illegal sequence near the end */
+        utf8[utf8Length-100]=(char)0xff;
+        checkConvertParallel("UTF-16BE", "UTF-8", utf8, utf8Length, UCNV_TO_U_CALLBACK_STOP);
+        checkConvertParallel("UTF-16BE", "UTF-8", utf8, utf8Length, NULL);
+    }
+
+#if !UCONFIG_NO_LEGACY_CONVERSION
+    /* EBCDIC with 0x25 line feeds, and Shift-JIS with ASCII lines */
+    errorCode=U_ZERO_ERROR;
+    bytesLength=ucnv_convert("ibm-1047", "UTF-16LE", bytes, 1000000,
+                             (const char *)text, textLength*U_SIZEOF_UCHAR, &errorCode);
+    if(U_SUCCESS(errorCode)) {
+        checkConvertParallel("UTF-8", "ibm-1047", bytes, bytesLength, NULL);
+    } else {
+        log_data_err("unable to convert the test text to ibm-1047 - %s\n", u_errorName(errorCode));
+    }
+    errorCode=U_ZERO_ERROR;
+    bytesLength=ucnv_convert("shift-jis", "UTF-16LE", bytes, 1000000,
+                             (const char *)text, textLength*U_SIZEOF_UCHAR, &errorCode);
+    if(U_SUCCESS(errorCode)) {
+        checkConvertParallel("UTF-8", "shift-jis", bytes, bytesLength, NULL);
+        checkConvertParallel("euc-jp", "shift-jis", bytes, bytesLength, NULL);
+    } else {
+        log_data_err("unable to convert the test text to shift-jis - %s\n", u_errorName(errorCode));
+    }
+#endif
+
+    free(text);
+    free(utf8);
+    free(bytes);
+}
+
+static void TestConverterPool() {
+    static const char iso2022[]={ 0x1b, 0x24, 0x42, 0x30, 0x21 };  /* switch to JIS X 0208 */
+    UConverterPool *pool;
+    UConverter *cnv, *cnv2;
+    UConverterToUCallback toUAction;
+    const void *toUContext;
+    UChar u[8];
+    char bytes[8];
+    int8_t length;
+    int32_t uLength;
+    UErrorCode errorCode=U_ZERO_ERROR;
+
+    pool=ucnv_openPool(0, &errorCode);
+    if(U_FAILURE(errorCode)) {
+        log_err("ucnv_openPool(0) failed - %s\n", u_errorName(errorCode));
+        return;
+    }
+
+    /* a released converter is returned again for the same name, with default settings */
+    cnv=ucnv_openFromPool(pool, "windows-1252", &errorCode);
+    if(U_FAILURE(errorCode)) {
+        log_data_err("ucnv_openFromPool(windows-1252) failed - %s\n", u_errorName(errorCode));
+        ucnv_closePool(pool);
+        return;
+    }
+    ucnv_setSubstChars(cnv, "?", 1, &errorCode);
+    ucnv_setFallback(cnv, TRUE);
+    ucnv_releaseToPool(pool, cnv);
+    cnv2=ucnv_openFromPool(pool, "WINDOWS-1252", &errorCode);
+    length=(int8_t)sizeof(bytes);
+    ucnv_getSubstChars(cnv2, bytes, &length, &errorCode);
+    if(U_FAILURE(errorCode) || cnv2!=cnv) {
+        log_err("ucnv_openFromPool(WINDOWS-1252) did not return the idle converter - %s\n",
+                u_errorName(errorCode));
+    } else if(length!=1 || bytes[0]!=0x1a || ucnv_usesFallback(cnv2)) {
+        log_err("ucnv_releaseToPool() did not restore the substitution character and fallback setting\n");
+    }
+
+    /* a second converter for the same charset is cloned */
+    cnv=ucnv_openFromPool(pool, "windows-1252", &errorCode);
+    if(U_FAILURE(errorCode) || cnv==cnv2 || uprv_strcmp(ucnv_getName(cnv, &errorCode), ucnv_getName(cnv2, &errorCode))!=0) {
+        log_err("ucnv_openFromPool(windows-1252) did not clone a second converter - %s\n", u_errorName(errorCode));
+    }
+    uLength=ucnv_toUChars(cnv, u, UPRV_LENGTHOF(u), "\x80", 1, &errorCode);
+    if(U_FAILURE(errorCode) || uLength!=1 || u[0]!=0x20ac) {
+        log_err("pooled windows-1252 converter did not convert 80 to U+20AC - %s\n", u_errorName(errorCode));
+    }
+    ucnv_releaseToPool(pool, cnv);
+    ucnv_releaseToPool(pool, cnv2);
+
+    /* a converter with a custom callback is not pooled */
+    cnv=ucnv_openFromPool(pool, "windows-1252", &errorCode);
+    ucnv_setToUCallBack(cnv, UCNV_TO_U_CALLBACK_STOP, NULL, NULL, NULL, &errorCode);
+    ucnv_releaseToPool(pool, cnv);
+    cnv=ucnv_openFromPool(pool, "windows-1252", &errorCode);
+    cnv2=ucnv_openFromPool(pool, "windows-1252", &errorCode);
+    ucnv_getToUCallBack(cnv2, &toUAction, &toUContext);
+    if(U_FAILURE(errorCode) || toUAction!=UCNV_TO_U_CALLBACK_SUBSTITUTE) {
+        log_err("ucnv_openFromPool() returned a converter with a custom callback - %s\n", u_errorName(errorCode));
+    }
+    ucnv_releaseToPool(pool, cnv);
+    ucnv_releaseToPool(pool, cnv2);
+
+#if !UCONFIG_NO_LEGACY_CONVERSION
+    /* a stateful converter is reset */
+    cnv=ucnv_openFromPool(pool, "ISO-2022-JP", &errorCode);
+    uLength=0;
+    if(U_SUCCESS(errorCode)) {
+        UChar *target=u;
+        const char *source=iso2022;
+        ucnv_toUnicode(cnv, &target, u+UPRV_LENGTHOF(u), &source, iso2022+sizeof(iso2022), NULL, FALSE, &errorCode);
+        ucnv_releaseToPool(pool, cnv);
+        cnv=ucnv_openFromPool(pool, "iso-2022-jp", &errorCode);
+        uLength=ucnv_toUChars(cnv, u, UPRV_LENGTHOF(u), "\x30\x21", 2, &errorCode);
+    }
+    if(U_FAILURE(errorCode)) {
+        log_data_err("pooled ISO-2022-JP converter failed - %s\n", u_errorName(errorCode));
+    } else if(uLength!=2 || u[0]!=0x30 || u[1]!=0x21) {
+        log_err("ucnv_releaseToPool() did not reset the ISO-2022-JP converter\n");
+    }
+    ucnv_releaseToPool(pool, cnv);
+
+    /* the substitution bytes that the converter sets when it is opened are kept */
+    errorCode=U_ZERO_ERROR;
+    cnv2=ucnv_open("ISO_2022,locale=ko,version=1", &errorCode);
+    cnv=ucnv_openFromPool(pool, "ISO_2022,locale=ko,version=1", &errorCode);
+    if(U_FAILURE(errorCode)) {
+        log_data_err("pooled ISO-2022-KR converter failed - %s\n", u_errorName(errorCode));
+    } else {
+        char expected[8];
+        int8_t expectedLength=(int8_t)sizeof(expected);
+        ucnv_getSubstChars(cnv2, expected, &expectedLength, &errorCode);
+        ucnv_releaseToPool(pool, cnv);
+        cnv=ucnv_openFromPool(pool, "ISO_2022,locale=ko,version=1", &errorCode);
+        length=(int8_t)sizeof(bytes);
+        ucnv_getSubstChars(cnv, bytes, &length, &errorCode);
+        if(U_FAILURE(errorCode) || length!=expectedLength || uprv_memcmp(bytes, expected, length)!=0) {
+            log_err("ucnv_releaseToPool() changed the ISO-2022-KR substitution bytes - %s\n",
+                    u_errorName(errorCode));
+        }
+    }
+    ucnv_releaseToPool(pool, cnv);
+    ucnv_close(cnv2);
+#endif
+
+    /* unknown names */
+    errorCode=U_ZERO_ERROR;
+    cnv=ucnv_openFromPool(pool, "no-such-charset", &errorCode);
+    if(errorCode!=U_FILE_ACCESS_ERROR || cnv!=NULL) {
+        log_err("ucnv_openFromPool(no-such-charset) returned %s instead of U_FILE_ACCESS_ERROR\n",
+                u_errorName(errorCode));
+    }
+
+    /* converters taken from the pool outlive it */
+    errorCode=U_ZERO_ERROR;
+    cnv=ucnv_openFromPool(pool, "UTF-16BE", &errorCode);
+    ucnv_closePool(pool);
+    uLength=ucnv_toUChars(cnv, u, UPRV_LENGTHOF(u), "\x00\x61", 2, &errorCode);
+    if(U_FAILURE(errorCode) || uLength!=1 || u[0]!=0x61) {
+        log_err("UTF-16BE converter from a closed pool failed - %s\n", u_errorName(errorCode));
+    }
+    ucnv_close(cnv);
+
+    errorCode=U_ZERO_ERROR;
+    if(ucnv_openPool(-1, &errorCode)!=NULL || errorCode!=U_ILLEGAL_ARGUMENT_ERROR) {
+        log_err("ucnv_openPool(-1) did not set U_ILLEGAL_ARGUMENT_ERROR\n");
+    }
+    errorCode=U_ZERO_ERROR;
+    if(ucnv_openPool(0x7fffffff, &errorCode)!=NULL || errorCode!=U_ILLEGAL_ARGUMENT_ERROR) {
+        log_err("ucnv_openPool(0x7fffffff) did not set U_ILLEGAL_ARGUMENT_ERROR\n");
+    }
+    errorCode=U_ZERO_ERROR;
+    pool=ucnv_openPool(1024, &errorCode);
+    if(U_FAILURE(errorCode)) {
+        log_err("ucnv_openPool(1024) failed - %s\n", u_errorName(errorCode));
+    }
+    ucnv_closePool(pool);
+}
+
+static void TestSharedConverter() {
+    static const char iso2022[]={ 0x1b, 0x24, 0x42, 0x30, 0x21 };  /* JIS X 0208 U+4E9C */
+    static const UChar latin[]={ 0x61, 0x100, 0x20ac };
+    UConverterShared *utf8;
+#if !UCONFIG_NO_LEGACY_CONVERSION
+    UConverterShared *shared;
+    char bytes[8];
+#endif
+    UChar u[8];
+    int32_t length;
+    UErrorCode errorCode=U_ZERO_ERROR;
+
+    utf8=ucnv_openShared("UTF-8", &errorCode);
+    if(U_FAILURE(errorCode)) {
+        log_err("ucnv_openShared(UTF-8) failed - %s\n", u_errorName(errorCode));
+        return;
+    }
+    length=ucnv_toUCharsShared(utf8, UCNV_INVALID_SUBSTITUTE, u, UPRV_LENGTHOF(u), "a\xff" "b", 3, &errorCode);
+    if(U_FAILURE(errorCode) || length!=3 || u[0]!=0x61 || u[1]!=0xfffd || u[2]!=0x62 || u[3]!=0) {
+        log_err("ucnv_toUCharsShared(UTF-8, substitute) failed - %s\n", u_errorName(errorCode));
+    }
+    length=ucnv_toUCharsShared(utf8, UCNV_INVALID_SKIP, u, UPRV_LENGTHOF(u), "a\xff" "b", 3, &errorCode);
+    if(U_FAILURE(errorCode) || length!=2 || u[0]!=0x61 || u[1]!=0x62) {
+        log_err("ucnv_toUCharsShared(UTF-8, skip) failed - %s\n", u_errorName(errorCode));
+    }
+    ucnv_toUCharsShared(utf8, UCNV_INVALID_STOP, u, UPRV_LENGTHOF(u), "a\xff" "b", 3, &errorCode);
+    if(errorCode!=U_ILLEGAL_CHAR_FOUND) {
+        log_err("ucnv_toUCharsShared(UTF-8, stop) returned %s instead of U_ILLEGAL_CHAR_FOUND\n",
+                u_errorName(errorCode));
+    }
+    /* preflighting */
+    errorCode=U_ZERO_ERROR;
+    length=ucnv_fromUCharsShared(utf8, UCNV_INVALID_STOP, NULL, 0, latin, UPRV_LENGTHOF(latin), &errorCode);
+    if(errorCode!=U_BUFFER_OVERFLOW_ERROR || length!=6) {
+        log_err("ucnv_fromUCharsShared(UTF-8, preflighting) returned %s and length %ld instead of 6\n",
+                u_errorName(errorCode), (long)length);
+    }
+    errorCode=U_ZERO_ERROR;
+    ucnv_toUCharsShared(utf8, (UConverterInvalidAction)99, u, UPRV_LENGTHOF(u), "a", 1, &errorCode);
+    if(errorCode!=U_ILLEGAL_ARGUMENT_ERROR) {
+        log_err("ucnv_toUCharsShared(action 99) did not set U_ILLEGAL_ARGUMENT_ERROR\n");
+    }
+    ucnv_closeShared(utf8);
+
+#if !UCONFIG_NO_LEGACY_CONVERSION
+    errorCode=U_ZERO_ERROR;
+    shared=ucnv_openShared("windows-1252", &errorCode);
+    if(U_FAILURE(errorCode)) {
+        log_data_err("ucnv_openShared(windows-1252) failed - %s\n", u_errorName(errorCode));
+        return;
+    }
+    length=ucnv_fromUCharsShared(shared, UCNV_INVALID_SUBSTITUTE, bytes, sizeof(bytes), latin, UPRV_LENGTHOF(latin), &errorCode);
+    if(U_FAILURE(errorCode) || length!=3 || uprv_memcmp(bytes, "a\x1a\x80", 4)!=0) {
+        log_err("ucnv_fromUCharsShared(windows-1252, substitute) failed - %s\n", u_errorName(errorCode));
+    }
+    length=ucnv_fromUCharsShared(shared, UCNV_INVALID_SKIP, bytes, sizeof(bytes), latin, UPRV_LENGTHOF(latin), &errorCode);
+    if(U_FAILURE(errorCode) || length!=2 || uprv_memcmp(bytes, "a\x80", 3)!=0) {
+        log_err("ucnv_fromUCharsShared(windows-1252, skip) failed - %s\n", u_errorName(errorCode));
+    }
+    ucnv_fromUCharsShared(shared, UCNV_INVALID_STOP, bytes, sizeof(bytes), latin, UPRV_LENGTHOF(latin), &errorCode);
+    if(errorCode!=U_INVALID_CHAR_FOUND) {
+        log_err("ucnv_fromUCharsShared(windows-1252, stop) returned %s instead of U_INVALID_CHAR_FOUND\n",
+                u_errorName(errorCode));
+    }
+    ucnv_closeShared(shared);
+
+    /* a stateful converter does not keep its state from one call to the next */
+    errorCode=U_ZERO_ERROR;
+    shared=ucnv_openShared("ISO-2022-JP", &errorCode);
+    length=ucnv_toUCharsShared(shared, UCNV_INVALID_SUBSTITUTE, u, UPRV_LENGTHOF(u), iso2022, sizeof(iso2022), &errorCode);
+    if(U_FAILURE(errorCode) || length!=1 || u[0]!=0x4e9c) {
+        log_data_err("ucnv_toUCharsShared(ISO-2022-JP) failed - %s\n", u_errorName(errorCode));
+    } else {
+        length=ucnv_toUCharsShared(shared, UCNV_INVALID_SUBSTITUTE, u, UPRV_LENGTHOF(u), "\x30\x21", 2, &errorCode);
+        if(U_FAILURE(errorCode) || length!=2 || u[0]!=0x30 || u[1]!=0x21) {
+            log_err("ucnv_toUCharsShared(ISO-2022-JP) kept the state of the previous call - %s\n",
+                    u_errorName(errorCode));
+        }
+    }
+    ucnv_closeShared(shared);
+#endif
+
+    errorCode=U_ZERO_ERROR;
+    if(ucnv_openShared("no-such-charset", &errorCode)!=NULL || errorCode!=U_FILE_ACCESS_ERROR) {
+        log_err("ucnv_openShared(no-such-charset) returned %s instead of U_FILE_ACCESS_ERROR\n",
+                u_errorName(errorCode));
+    }
+}
+
 static void TestConvertExFromUTF8_C5F0() {
     static const char *const converterNames[]={
 #if !UCONFIG_NO_LEGACY_CONVERSION
@@ -713,6 +713,210 @@ TestCaseCompare(void) {
     }
 }
 
+static int32_t
+signum(int32_t i) {
+    return i<0 ? -1 : i>0 ? 1 : 0;
+}
+
+static void
+TestCaseCompareUTF8(void) {
+    static const char *const strings[]={
+        "", "a", "A", "abc", "ABC", "abd", "ABCD", "Stra\\u00dfe", "STRASSE", "strasse", "strase",
+        "The Quick Brown Fox Jumps Over the Lazy Dog", "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG",
+        "I", "i", "\\u0131", "\\u0130", "\\u03a3\\u03b9\\u03c3\\u03c5\\u03c6\\u03bf\\u03c2",
+        "\\u03c3\\u0399\\u03a3\\u03a5\\u03a6\\u039f\\u03a3", "\\ufb03", "FFI", "\\U0001043c", "\\U00010414",
+        "\\uffe0", "\\U00010400x", "abc\\u00e9", "ABC\\u00c9", "ABC\\u00c9Z"
+    };
+    static const uint32_t options[]={ U_FOLD_CASE_DEFAULT, U_FOLD_CASE_EXCLUDE_SPECIAL_I };
+    UChar u1[64], u2[64];
+    char s1[128], s2[128];
+    int32_t i, j, k, length1, length2, expected, result;
+    UErrorCode errorCode;
+
+    for(i=0; i<UPRV_LENGTHOF(strings); ++i) {
+        length1=u_unescape(strings[i], u1, UPRV_LENGTHOF(u1));
+        errorCode=U_ZERO_ERROR;
+        u_strToUTF8(s1, (int32_t)sizeof(s1), &length1, u1, length1, &errorCode);
+        for(j=0; j<UPRV_LENGTHOF(strings); ++j) {
+            length2=u_unescape(strings[j], u2, UPRV_LENGTHOF(u2));
+            u_strToUTF8(s2, (int32_t)sizeof(s2), &length2, u2, length2, &errorCode);
+            for(k=0; k<UPRV_LENGTHOF(options); ++k) {
+                /* UTF-8 compares in code point order */
+                expected=u_strCaseCompare(u1, -1, u2, -1,
+                                          options[k]|U_COMPARE_CODE_POINT_ORDER, &errorCode);
+                result=u_strCaseCompareUTF8(s1, length1, s2, -1, options[k], &errorCode);
+                if(U_FAILURE(errorCode) || signum(result)!=signum(expected)) {
+                    log_err("error: u_strCaseCompareUTF8(%s, %s, options %lx)=%ld instead of %ld like UTF-16 - %s\n",
+                            strings[i], strings[j], (long)options[k],
+                            (long)result, (long)expected, u_errorName(errorCode));
+                }
+            }
+        }
+    }
+
+    /* ill-formed sequences compare like U+FFFD */
+    errorCode=U_ZERO_ERROR;
+    result=u_strCaseCompareUTF8("a\xff" "B", 3, "A\xef\xbf\xbd" "b", 5, U_FOLD_CASE_DEFAULT, &errorCode);
+    if(U_FAILURE(errorCode) || result!=0) {
+        log_err("error: u_strCaseCompareUTF8(ill-formed)=%ld instead of 0 - %s\n",
+                (long)result, u_errorName(errorCode));
+    }
+    result=u_strCaseCompareUTF8(NULL, 0, "a", 1, U_FOLD_CASE_DEFAULT, &errorCode);
+    if(errorCode!=U_ILLEGAL_ARGUMENT_ERROR) {
+        log_err("error: u_strCaseCompareUTF8(NULL) did not set U_ILLEGAL_ARGUMENT_ERROR\n");
+    }
+}
+
+static void
+TestCaseFind(void) {
+    static const struct {
+        const char *s, *sub;
+        uint32_t options;
+        int32_t index, matchLength;  /* in UTF-16 */
+    } cases[]={
+        { "", "", U_FOLD_CASE_DEFAULT, 0, 0 },
+        { "abc", "", U_FOLD_CASE_DEFAULT, 0, 0 },
+        { "", "a", U_FOLD_CASE_DEFAULT, -1, 0 },
+        { "Hello World", "WORLD", U_FOLD_CASE_DEFAULT, 6, 5 },
+        { "Hello World", "worlds", U_FOLD_CASE_DEFAULT, -1, 0 },
+        { "aaaaab", "AAB", U_FOLD_CASE_DEFAULT, 3, 3 },
+        /* U+00DF folds to "ss" */
+        { "Die Stra\\u00dfe", "STRASSE", U_FOLD_CASE_DEFAULT, 4, 6 },
+        { "Die Strasse", "stra\\u00dfe", U_FOLD_CASE_DEFAULT, 4, 7 },
+        { "Die Stra\\u00dfe", "ss", U_FOLD_CASE_DEFAULT, 8, 1 },
+        /* a match must not start or end in the middle of a folding */
+        { "Stra\\u00dfe", "as", U_FOLD_CASE_DEFAULT, -1, 0 },
+        { "Stra\\u00dfe", "se", U_FOLD_CASE_DEFAULT, -1, 0 },
+        { "a\\u00dfb", "sb", U_FOLD_CASE_DEFAULT, -1, 0 },
+        { "\\u00df\\u00dfs", "sss", U_FOLD_CASE_DEFAULT, 1, 2 },
+        { "\\u00df\\u00dfs", "ss\\u00df", U_FOLD_CASE_DEFAULT, 0, 2 },
+        { "\\u00dfsS\\u00df", "sss", U_FOLD_CASE_DEFAULT, 0, 2 },
+        { "s\\u00dfS\\u00df", "sS\\u00df", U_FOLD_CASE_DEFAULT, 0, 3 },
+        { "x\\ufb03y", "FFI", U_FOLD_CASE_DEFAULT, 1, 1 },
+        { "x\\ufb03y", "FF", U_FOLD_CASE_DEFAULT, -1, 0 },
+        /* Greek final sigma folds to sigma */
+        { "\\u039f\\u0394\\u039f\\u03a3 \\u03bf\\u03b4\\u03bf\\u03c2", "\\u03bf\\u03b4\\u03bf\\u03c3 ", U_FOLD_CASE_DEFAULT, 0, 5 },
+        /* supplementary case pairs */
+        { "ab\\U00010400\\U00010401", "\\U00010429", U_FOLD_CASE_DEFAULT, 4, 2 },
+        /* Turkic dotless i */
+        { "KILIM", "kilim", U_FOLD_CASE_DEFAULT, 0, 5 },
+        { "KILIM", "kilim", U_FOLD_CASE_EXCLUDE_SPECIAL_I, -1, 0 },
+        { "KILIM", "k\\u0131l\\u0131m", U_FOLD_CASE_EXCLUDE_SPECIAL_I, 0, 5 },
+        { "K\\u0130L\\u0130M", "kilim", U_FOLD_CASE_EXCLUDE_SPECIAL_I, 0, 5 }
+    };
+    UChar s[64], sub[64];
+    char s8[128], sub8[128];
+    int32_t i, length, subLength, length8, subLength8, index, matchLength, expected8;
+    UErrorCode errorCode;
+
+    for(i=0; i<UPRV_LENGTHOF(cases); ++i) {
+        length=u_unescape(cases[i].s, s, UPRV_LENGTHOF(s));
+        subLength=u_unescape(cases[i].sub, sub, UPRV_LENGTHOF(sub));
+        errorCode=U_ZERO_ERROR;
+        matchLength=-99;
+        index=u_strCaseFind(s, length, sub, -1, cases[i].options, &matchLength, &errorCode);
+        if( U_FAILURE(errorCode) || index!=cases[i].index ||
+            (index>=0 && matchLength!=cases[i].matchLength)
+        ) {
+            log_err("error: u_strCaseFind(%s, %s)=%ld match length %ld instead of %ld, %ld - %s\n",
+                    cases[i].s, cases[i].sub, (long)index, (long)matchLength,
+                    (long)cases[i].index, (long)cases[i].matchLength, u_errorName(errorCode));
+        }
+
+        /* UTF-8: convert the expected UTF-16 indexes */
+        u_strToUTF8(s8, (int32_t)sizeof(s8), &length8, s, length, &errorCode);
+        u_strToUTF8(sub8, (int32_t)sizeof(sub8), &subLength8, sub, subLength, &errorCode);
+        expected8=-1;
+        if(cases[i].index>=0) {
+            u_strToUTF8(NULL, 0, &expected8, s, cases[i].index, &errorCode);
+            errorCode=U_ZERO_ERROR;
+        }
+        matchLength=-99;
+        index=u_strCaseFindUTF8(s8, -1, sub8, subLength8, cases[i].options, &matchLength, &errorCode);
+        if(U_FAILURE(errorCode) || index!=expected8) {
+            log_err("error: u_strCaseFindUTF8(%s, %s)=%ld instead of %ld - %s\n",
+                    cases[i].s, cases[i].sub, (long)index, (long)expected8, u_errorName(errorCode));
+        } else if(index>=0) {
+            int32_t expectedLength8;
+            u_strToUTF8(NULL, 0, &expectedLength8, s+cases[i].index, cases[i].matchLength, &errorCode);
+            errorCode=U_ZERO_ERROR;
+            if(matchLength!=expectedLength8) {
+                log_err("error: u_strCaseFindUTF8(%s, %s) match length %ld instead of %ld\n",
+                        cases[i].s, cases[i].sub, (long)matchLength, (long)expectedLength8);
+            }
+        }
+    }
+}
+
+/*
+ * Long text and substrings so that u_strCaseFind() moves its folding window
+ * many times; compare with a simple search over the case-folded string.
+ */
+static void
+TestCaseFindLong(void) {
+    static const char *const pieces[]={
+        "lorem ", "IPSUM ", "Stra\\u00dfe ", "\\u03a3\\u03bf\\u03c6\\u03af\\u03b1 ", "\\ufb03ce ", "\\U00010400 "
+    };
+    UChar text[3000], folded[3500], sub[400], piece[20];
+    int32_t textLength=0, foldedLength, i, subLength, index, matchLength, expected;
+    UErrorCode errorCode=U_ZERO_ERROR;
+
+    for(i=0; textLength<2900; ++i) {
+        int32_t length=u_unescape(pieces[(i*7)%UPRV_LENGTHOF(pieces)], piece, UPRV_LENGTHOF(piece));
+        u_memcpy(text+textLength, piece, length);
+        textLength+=length;
+    }
+    /* an upper-cased pattern at the end of the text, long enough for several windows */
+    subLength=300;
+    u_strToUpper(sub, UPRV_LENGTHOF(sub), text+textLength-subLength, subLength, "", &errorCode);
+    foldedLength=u_strFoldCase(folded, UPRV_LENGTHOF(folded), text, textLength, U_FOLD_CASE_DEFAULT, &errorCode);
+    if(U_FAILURE(errorCode)) {
+        log_err("error: u_strToUpper()/u_strFoldCase() failed - %s\n", u_errorName(errorCode));
+        return;
+    }
+    (void)foldedLength;
+    index=u_strCaseFind(text, textLength, sub, u_strlen(sub), U_FOLD_CASE_DEFAULT, &matchLength, &errorCode);
+    /* the first occurrence must be no later than the one at the end */
+    if(U_FAILURE(errorCode) || index<0 || index>(textLength-subLength) ||
+            u_strCaseCompare(text+index, matchLength, sub, -1, U_FOLD_CASE_DEFAULT, &errorCode)!=0) {
+        log_err("error: u_strCaseFind(long text, long sub)=%ld - %s\n", (long)index, u_errorName(errorCode));
+    }
+
+    /* short substrings at each position, against the first match in the folded text */
+    for(i=0; (i+6)<=textLength; i+=97) {
+        UChar foldedSub[40];
+        int32_t foldedSubLength;
+        if(U16_IS_TRAIL(text[i]) || U16_IS_TRAIL(text[i+6])) {
+            continue;
+        }
+        foldedSubLength=u_strFoldCase(foldedSub, UPRV_LENGTHOF(foldedSub), text+i, 6, U_FOLD_CASE_DEFAULT, &errorCode);
+        index=u_strCaseFind(text, textLength, text+i, 6, U_FOLD_CASE_DEFAULT, &matchLength, &errorCode);
+        expected=-1;
+        {
+            /* naive search: the first code point boundary where the folded text matches */
+            int32_t start=0;
+            while(start<=i) {
+                int32_t limit=start, folded2Length=0;
+                UChar folded2[60];
+                while(folded2Length<foldedSubLength && limit<textLength) {
+                    U16_FWD_1(text, limit, textLength);
+                    folded2Length=u_strFoldCase(folded2, UPRV_LENGTHOF(folded2), text+start, limit-start,
+                                                U_FOLD_CASE_DEFAULT, &errorCode);
+                }
+                if(folded2Length==foldedSubLength && 0==u_memcmp(folded2, foldedSub, foldedSubLength)) {
+                    expected=start;
+                    break;
+                }
+                U16_FWD_1(text, start, textLength);
+            }
+        }
+        if(U_FAILURE(errorCode) || index!=expected) {
+            log_err("error: u_strCaseFind(long text, text[%ld..+6])=%ld instead of %ld - %s\n",
+                    (long)i, (long)index, (long)expected, u_errorName(errorCode));
+        }
+    }
+}
+
 /* test UCaseMap ------------------------------------------------------------ */
 
 /*
@@ -994,6 +1198,116 @@ TestUCaseMapToTitle(void) {
 
 #endif
 
+/*
+ * Long strings with ASCII runs of varying lengths between non-ASCII characters,
+ * to exercise the bulk ASCII case mapping paths and their boundaries.
+ */
+static void
+TestCaseMapLongASCII(void) {
+    static const char ascii[]="The Quick BROWN fox Jumps over 13 LAZY dogs; @[`{ ";
+    UChar src16[1000], lower16[1000], upper16[1000], dest16[1000];
+    char src8[1100], lower8[1100], upper8[1100], dest8[1100];
+    int32_t length16=0, length8=0, length, runLength, i, capacity;
+    UCaseMap *csm;
+    UErrorCode errorCode;
+
+    /* runs of 0..39 ASCII characters, each followed by U+00C4 U+00E4 */
+    for(runLength=0; runLength<40; ++runLength) {
+        for(i=0; i<runLength; ++i) {
+            char c=ascii[(runLength+i)%(sizeof(ascii)-1)];
+            char lc= 'A'<=c && c<='Z' ? (char)(c+0x20) : c;
+            char uc= 'a'<=c && c<='z' ? (char)(c-0x20) : c;
+            src16[length16]=(UChar)c;
+            lower16[length16]=(UChar)lc;
+            upper16[length16++]=(UChar)uc;
+            src8[length8]=c;
+            lower8[length8]=lc;
+            upper8[length8++]=uc;
+        }
+        src16[length16]=0xc4;
+        lower16[length16]=0xe4;
+        upper16[length16++]=0xc4;
+        src16[length16]=0xe4;
+        lower16[length16]=0xe4;
+        upper16[length16++]=0xc4;
+        uprv_memcpy(src8+length8, "\xc3\x84\xc3\xa4", 4);
+        uprv_memcpy(lower8+length8, "\xc3\xa4\xc3\xa4", 4);
+        uprv_memcpy(upper8+length8, "\xc3\x84\xc3\x84", 4);
+        length8+=4;
+    }
+    /* end with a long ASCII run */
+    for(i=0; i<100; ++i) {
+        char c=ascii[i%(sizeof(ascii)-1)];
+        char lc= 'A'<=c && c<='Z' ? (char)(c+0x20) : c;
+        char uc= 'a'<=c && c<='z' ? (char)(c-0x20) : c;
+        src16[length16]=(UChar)c;
+        lower16[length16]=(UChar)lc;
+        upper16[length16++]=(UChar)uc;
+        src8[length8]=c;
+        lower8[length8]=lc;
+        upper8[length8++]=uc;
+    }
+
+    errorCode=U_ZERO_ERROR;
+    length=u_strToLower(dest16, UPRV_LENGTHOF(dest16), src16, length16, "", &errorCode);
+    if(U_FAILURE(errorCode) || length!=length16 || 0!=u_memcmp(dest16, lower16, length16)) {
+        log_err("error: u_strToLower(long ASCII runs)=%ld error=%s\n", (long)length, u_errorName(errorCode));
+    }
+    errorCode=U_ZERO_ERROR;
+    length=u_strToUpper(dest16, UPRV_LENGTHOF(dest16), src16, length16, "", &errorCode);
+    if(U_FAILURE(errorCode) || length!=length16 || 0!=u_memcmp(dest16, upper16, length16)) {
+        log_err("error: u_strToUpper(long ASCII runs)=%ld error=%s\n", (long)length, u_errorName(errorCode));
+    }
+    errorCode=U_ZERO_ERROR;
+    length=u_strFoldCase(dest16, UPRV_LENGTHOF(dest16), src16, length16, U_FOLD_CASE_DEFAULT, &errorCode);
+    if(U_FAILURE(errorCode) || length!=length16 || 0!=u_memcmp(dest16, lower16, length16)) {
+        log_err("error: u_strFoldCase(long ASCII runs)=%ld error=%s\n", (long)length, u_errorName(errorCode));
+    }
+
+    /* with any smaller capacity, the full length must be returned without writing past the end */
+    for(capacity=0; capacity<length16; capacity+=37) {
+        u_memset(dest16, 0xffff, UPRV_LENGTHOF(dest16));
+        errorCode=U_ZERO_ERROR;
+        length=u_strToUpper(dest16, capacity, src16, length16, "", &errorCode);
+        if(errorCode!=U_BUFFER_OVERFLOW_ERROR || length!=length16 || dest16[capacity]!=0xffff) {
+            log_err("error: u_strToUpper(long ASCII runs, capacity %ld)=%ld error=%s\n",
+                    (long)capacity, (long)length, u_errorName(errorCode));
+        }
+    }
+
+    errorCode=U_ZERO_ERROR;
+    csm=ucasemap_open("", 0, &errorCode);
+    if(U_FAILURE(errorCode)) {
+        log_err("ucasemap_open(\"\") failed - %s\n", u_errorName(errorCode));
+        return;
+    }
+    length=ucasemap_utf8ToLower(csm, dest8, (int32_t)sizeof(dest8), src8, length8, &errorCode);
+    if(U_FAILURE(errorCode) || length!=length8 || 0!=uprv_memcmp(dest8, lower8, length8)) {
+        log_err("error: ucasemap_utf8ToLower(long ASCII runs)=%ld error=%s\n", (long)length, u_errorName(errorCode));
+    }
+    errorCode=U_ZERO_ERROR;
+    length=ucasemap_utf8ToUpper(csm, dest8, (int32_t)sizeof(dest8), src8, length8, &errorCode);
+    if(U_FAILURE(errorCode) || length!=length8 || 0!=uprv_memcmp(dest8, upper8, length8)) {
+        log_err("error: ucasemap_utf8ToUpper(long ASCII runs)=%ld error=%s\n", (long)length, u_errorName(errorCode));
+    }
+    errorCode=U_ZERO_ERROR;
+    length=ucasemap_utf8FoldCase(csm, dest8, (int32_t)sizeof(dest8), src8, length8, &errorCode);
+    if(U_FAILURE(errorCode) || length!=length8 || 0!=uprv_memcmp(dest8, lower8, length8)) {
+        log_err("error: ucasemap_utf8FoldCase(long ASCII runs)=%ld error=%s\n", (long)length, u_errorName(errorCode));
+    }
+    for(capacity=0; capacity<length8; capacity+=37) {
+        uprv_memset(dest8, 0xff, sizeof(dest8));
+        errorCode=U_ZERO_ERROR;
+        length=ucasemap_utf8ToLower(csm, dest8, capacity, src8, length8, &errorCode);
+        if(errorCode!=U_BUFFER_OVERFLOW_ERROR || length!=length8 ||
+                0!=uprv_memcmp(dest8, lower8, capacity) || (uint8_t)dest8[capacity]!=0xff) {
+            log_err("error: ucasemap_utf8ToLower(long ASCII runs, capacity %ld)=%ld error=%s\n",
+                    (long)capacity, (long)length, u_errorName(errorCode));
+        }
+    }
+    ucasemap_close(csm);
+}
+
 /* Test case for internal API u_caseInsensitivePrefixMatch */
 static void
 TestUCaseInsensitivePrefixMatch(void) {
@@ -1049,9 +1363,13 @@ void addCaseTest(TestNode** root) {
 #endif
     addTest(root, &TestCaseFolding, "tsutil/cstrcase/TestCaseFolding");
     addTest(root, &TestCaseCompare, "tsutil/cstrcase/TestCaseCompare");
+    addTest(root, &TestCaseCompareUTF8, "tsutil/cstrcase/TestCaseCompareUTF8");
+    addTest(root, &TestCaseFind, "tsutil/cstrcase/TestCaseFind");
+    addTest(root, &TestCaseFindLong, "tsutil/cstrcase/TestCaseFindLong");
     addTest(root, &TestUCaseMap, "tsutil/cstrcase/TestUCaseMap");
 #if !UCONFIG_NO_BREAK_ITERATION && !UCONFIG_NO_FILE_IO
     addTest(root, &TestUCaseMapToTitle, "tsutil/cstrcase/TestUCaseMapToTitle");
 #endif
     addTest(root, &TestUCaseInsensitivePrefixMatch, "tsutil/cstrcase/TestUCaseInsensitivePrefixMatch");
+    addTest(root, &TestCaseMapLongASCII, "tsutil/cstrcase/TestCaseMapLongASCII");
 }
@@ -61,6 +61,7 @@ static void TestPropertyNames(void);
 static void TestPropertyValues(void);
 static void TestConsistency(void);
 static void TestCaseFolding(void);
+static void TestPropertyBundle(void);
 
 /* internal methods used */
 static int32_t MakeProp(char* str);
@@ -196,6 +197,7 @@ void addUnicodeTest(TestNode** root)
     addTest(root, &TestPropertyValues, "tsutil/cucdtst/TestPropertyValues");
     addTest(root, &TestConsistency, "tsutil/cucdtst/TestConsistency");
     addTest(root, &TestCaseFolding, "tsutil/cucdtst/TestCaseFolding");
+    addTest(root, &TestPropertyBundle, "tsutil/cucdtst/TestPropertyBundle");
 }
 
 /*==================================================== */
@@ -3522,3 +3524,121 @@ TestCaseFolding() {
 
     uset_close(data.notSeen);
 }
+
+static const UProperty bundleBinaryProperties[]={
+    UCHAR_ALPHABETIC,
+    UCHAR_WHITE_SPACE,
+    UCHAR_LOWERCASE,
+    UCHAR_UPPERCASE,
+    UCHAR_IDEOGRAPHIC,
+    UCHAR_DEFAULT_IGNORABLE_CODE_POINT,
+    UCHAR_BIDI_MIRRORED,
+    UCHAR_DASH,
+    UCHAR_DIACRITIC,
+    UCHAR_EXTENDER,
+    UCHAR_XID_START,
+    UCHAR_XID_CONTINUE,
+    UCHAR_TERMINAL_PUNCTUATION,
+    UCHAR_EMOJI,
+    UCHAR_EMOJI_PRESENTATION,
+    UCHAR_EXTENDED_PICTOGRAPHIC
+};
+
+static UBool
+checkPropertyBundle(UChar32 c, const UCharPropertyBundle *bundle) {
+    uint16_t binaryProperties=0;
+    int32_t i;
+    for(i=0; i<UPRV_LENGTHOF(bundleBinaryProperties); ++i) {
+        if(u_hasBinaryProperty(c, bundleBinaryProperties[i])) {
+            binaryProperties|=(uint16_t)(1<<i);
+        }
+    }
+    if( bundle->generalCategory!=u_charType(c) ||
+        bundle->bidiClass!=u_charDirection(c) ||
+        bundle->wordBreak!=u_getIntPropertyValue(c, UCHAR_WORD_BREAK) ||
+        bundle->lineBreak!=u_getIntPropertyValue(c, UCHAR_LINE_BREAK) ||
+        bundle->sentenceBreak!=u_getIntPropertyValue(c, UCHAR_SENTENCE_BREAK) ||
+        bundle->graphemeClusterBreak!=u_getIntPropertyValue(c, UCHAR_GRAPHEME_CLUSTER_BREAK) ||
+        bundle->eastAsianWidth!=u_getIntPropertyValue(c, UCHAR_EAST_ASIAN_WIDTH) ||
+        bundle->numericType!=u_getIntPropertyValue(c, UCHAR_NUMERIC_TYPE) ||
+        bundle->script!=u_getIntPropertyValue(c, UCHAR_SCRIPT) ||
+        bundle->binaryProperties!=binaryProperties
+    ) {
+        log_err("u_getPropertyBundle(U+%04lx) differs from the individual property values\n", (long)c);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static void
+TestPropertyBundle() {
+    static const UChar s[]={
+        0x61, 0x20, 0x39, 0x4e00, 0xd83d, 0xde00, 0x5d0, 0xdc00, 0x300, 0xd800, 0x3002, 0
+    };
+    static const UChar32 cps[]={
+        0x61, 0x20, 0x39, 0x4e00, 0x1f600, 0x5d0, 0xdc00, 0x300, 0xd800, 0x3002
+    };
+    UCharPropertyBundle bundles[UPRV_LENGTHOF(cps)+1];
+    UCharPropertyBundle bundle;
+    UErrorCode errorCode=U_ZERO_ERROR;
+    UChar32 c;
+    int32_t i, length;
+
+    for(c=0; c<=0x10ffff; ++c) {
+        u_getPropertyBundle(c, &bundle, &errorCode);
+        if(U_FAILURE(errorCode)) {
+            log_err("u_getPropertyBundle(U+%04lx) failed - %s\n", (long)c, u_errorName(errorCode));
+            return;
+        }
+        if(!checkPropertyBundle(c, &bundle)) {
+            break;
+        }
+    }
+    u_getPropertyBundle(-1, &bundle, &errorCode);
+    checkPropertyBundle(-1, &bundle);
+    u_getPropertyBundle(0x110000, &bundle, &errorCode);
+    checkPropertyBundle(0x110000, &bundle);
+    if( U_FAILURE(errorCode) ||
+        bundle.generalCategory!=U_UNASSIGNED ||
+        (bundle.binaryProperties&UCHAR_BUNDLE_ALPHABETIC)!=0
+    ) {
+        log_err("u_getPropertyBundle(out of range) is wrong - %s\n", u_errorName(errorCode));
+    }
+    u_getPropertyBundle(0x41, &bundle, &errorCode);
+    if( bundle.generalCategory!=U_UPPERCASE_LETTER ||
+        (bundle.binaryProperties&(UCHAR_BUNDLE_ALPHABETIC|UCHAR_BUNDLE_UPPERCASE|UCHAR_BUNDLE_LOWERCASE))!=
+            (UCHAR_BUNDLE_ALPHABETIC|UCHAR_BUNDLE_UPPERCASE)
+    ) {
+        log_err("u_getPropertyBundle(A) is wrong\n");
+    }
+
+    /* preflighting */
+    length=u_strGetPropertyBundles(s, UPRV_LENGTHOF(s)-1, NULL, 0, &errorCode);
+    if(errorCode!=U_BUFFER_OVERFLOW_ERROR || length!=UPRV_LENGTHOF(cps)) {
+        log_err("u_strGetPropertyBundles(preflighting)=%ld - %s\n", (long)length, u_errorName(errorCode));
+    }
+    errorCode=U_ZERO_ERROR;
+    length=u_strGetPropertyBundles(s, UPRV_LENGTHOF(s)-1, bundles, 3, &errorCode);
+    if(errorCode!=U_BUFFER_OVERFLOW_ERROR || length!=UPRV_LENGTHOF(cps) ||
+            !checkPropertyBundle(cps[2], &bundles[2])) {
+        log_err("u_strGetPropertyBundles(overflow)=%ld - %s\n", (long)length, u_errorName(errorCode));
+    }
+    errorCode=U_ZERO_ERROR;
+    length=u_strGetPropertyBundles(s, UPRV_LENGTHOF(s)-1, bundles, UPRV_LENGTHOF(bundles), &errorCode);
+    if(U_FAILURE(errorCode) || length!=UPRV_LENGTHOF(cps)) {
+        log_err("u_strGetPropertyBundles()=%ld - %s\n", (long)length, u_errorName(errorCode));
+        return;
+    }
+    for(i=0; i<length; ++i) {
+        checkPropertyBundle(cps[i], &bundles[i]);
+    }
+    /* NUL-terminated */
+    length=u_strGetPropertyBundles(s, -1, bundles, UPRV_LENGTHOF(bundles), &errorCode);
+    if(U_FAILURE(errorCode) || length!=UPRV_LENGTHOF(cps)) {
+        log_err("u_strGetPropertyBundles(NUL-terminated)=%ld - %s\n", (long)length, u_errorName(errorCode));
+    }
+    length=u_strGetPropertyBundles(NULL, 1, bundles, UPRV_LENGTHOF(bundles), &errorCode);
+    if(errorCode!=U_ILLEGAL_ARGUMENT_ERROR) {
+        log_err("u_strGetPropertyBundles(NULL, 1) did not fail - %s\n", u_errorName(errorCode));
+    }
+}
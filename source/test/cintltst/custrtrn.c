@@ -38,6 +38,8 @@ static void Test_strFromUTF32_surrogates(void);
 static void Test_UChar_UTF8_API(void);
 static void Test_FromUTF8(void);
 static void Test_FromUTF8Lenient(void);
+static void Test_strCheckUTF8(void);
+static void Test_strCheckUTF16(void);
 static void Test_UChar_WCHART_API(void);
 static void Test_widestrs(void);
 static void Test_WCHART_LongString(void);
@@ -55,6 +57,8 @@ addUCharTransformTest(TestNode** root)
    addTest(root, &Test_UChar_UTF8_API, "custrtrn/Test_UChar_UTF8_API");
    addTest(root, &Test_FromUTF8, "custrtrn/Test_FromUTF8");
    addTest(root, &Test_FromUTF8Lenient, "custrtrn/Test_FromUTF8Lenient");
+   addTest(root, &Test_strCheckUTF8, "custrtrn/Test_strCheckUTF8");
+   addTest(root, &Test_strCheckUTF16, "custrtrn/Test_strCheckUTF16");
    addTest(root, &Test_UChar_WCHART_API,  "custrtrn/Test_UChar_WCHART_API");
    addTest(root, &Test_widestrs,  "custrtrn/Test_widestrs");
 #if !UCONFIG_NO_FILE_IO && !UCONFIG_NO_LEGACY_CONVERSION
@@ -928,6 +932,149 @@ Test_FromUTF8(void) {
     }
 }
 
+/* test u_strCheckUTF8() */
+static void
+Test_strCheckUTF8(void) {
+    static const struct {
+        const char *s;
+        int32_t length, wellFormedLength, utf16Length;
+    } cases[]={
+        { "", 0, 0, 0 },
+        { "abc", 3, 3, 3 },
+        { "a\xc3\xa9\xe4\xb8\xad\xf0\x9f\x98\x80z", 11, 11, 6 },
+        { "ab\xc0\x80", 4, 2, 2 },                  /* non-shortest form */
+        { "ab\xed\xa0\x80", 5, 2, 2 },              /* surrogate */
+        { "ab\xf4\x90\x80\x80", 6, 2, 2 },         /* above U+10FFFF */
+        { "ab\xf5\x80\x80\x80", 6, 2, 2 },         /* not a lead byte */
+        { "\xc3\xa9\x80", 3, 2, 1 },                /* stray trail byte */
+        { "\xe4\xb8\xad\xe4\xb8", 5, 3, 1 },      /* truncated at the end */
+        { "\xf0\x9f\x98\x80\xf0\x9f\x98", 7, 4, 2 },
+        { "a\xe4\xb8\xad", -1, 4, 2 }               /* NUL-terminated */
+    };
+    /* long enough for the bulk code paths */
+    static const char *pieces[]={
+        "The quick brown fox jumps over the lazy dog. ",
+        "\xc3\xa9", "\xe4\xb8\xad", "\xf0\x9f\x98\x80", "x"
+    };
+    char s[2000];
+    UChar dest[2000];
+    int32_t i, length, result, utf16Length, expectedLength;
+    UErrorCode errorCode;
+
+    for(i=0; i<UPRV_LENGTHOF(cases); ++i) {
+        utf16Length=-99;
+        result=u_strCheckUTF8(cases[i].s, cases[i].length, &utf16Length);
+        if(result!=cases[i].wellFormedLength || utf16Length!=cases[i].utf16Length) {
+            log_err("error: u_strCheckUTF8(cases[%d])=%ld utf16Length=%ld, expected %ld and %ld\n",
+                    (int)i, (long)result, (long)utf16Length,
+                    (long)cases[i].wellFormedLength, (long)cases[i].utf16Length);
+        }
+    }
+    if(u_strCheckUTF8(NULL, 0, NULL)!=0) {
+        log_err("error: u_strCheckUTF8(NULL, 0)!=0\n");
+    }
+
+    length=0;
+    for(i=0; length<1800; ++i) {
+        const char *piece=pieces[(i*7)%UPRV_LENGTHOF(pieces)];
+        int32_t pieceLength=(int32_t)strlen(piece);
+        uprv_memcpy(s+length, piece, pieceLength);
+        length+=pieceLength;
+    }
+    errorCode=U_ZERO_ERROR;
+    u_strFromUTF8(dest, UPRV_LENGTHOF(dest), &expectedLength, s, length, &errorCode);
+    result=u_strCheckUTF8(s, length, &utf16Length);
+    if(U_FAILURE(errorCode) || result!=length || utf16Length!=expectedLength) {
+        log_err("error: u_strCheckUTF8(long string)=%ld utf16Length=%ld, expected %ld and %ld\n",
+                (long)result, (long)utf16Length, (long)length, (long)expectedLength);
+    }
+
+    /* make the string ill-formed at various positions, before a lead byte */
+    for(i=0; i<length; i+=37) {
+        int32_t start=i;
+        char saved;
+        while(U8_IS_TRAIL(s[start])) {
+            ++start;
+        }
+        saved=s[start];
+        s[start]=(char)0xff;
+        errorCode=U_ZERO_ERROR;
+        u_strFromUTF8(NULL, 0, &expectedLength, s, start, &errorCode);
+        result=u_strCheckUTF8(s, length, &utf16Length);
+        if(result!=start || utf16Length!=expectedLength) {
+            log_err("error: u_strCheckUTF8(ill-formed at %ld)=%ld utf16Length=%ld, expected %ld\n",
+                    (long)start, (long)result, (long)utf16Length, (long)expectedLength);
+        }
+        s[start]=saved;
+    }
+}
+
+/* test u_strCheckUTF16() */
+static void
+Test_strCheckUTF16(void) {
+    static const UChar good[]={ 0x61, 0xe9, 0x4e2d, 0xd83d, 0xde00, 0x7a, 0 };
+    static const UChar lead[]={ 0x61, 0xd83d, 0x62 };
+    static const UChar trail[]={ 0x61, 0xe9, 0xde00, 0xd83d, 0xde00 };
+    static const UChar leadAtEnd[]={ 0x61, 0x4e2d, 0xd83d };
+    static const UChar pieces[]={ 0x41, 0x42, 0x43, 0xe9, 0x20, 0x4e2d, 0xd83d, 0xde00, 0x7ff, 0x800, 0xffff };
+    UChar s[2000];
+    char dest[8000];
+    int32_t i, length, result, utf8Length, expectedLength;
+    UErrorCode errorCode;
+
+    utf8Length=-99;
+    if((result=u_strCheckUTF16(good, 6, &utf8Length))!=6 || utf8Length!=11) {
+        log_err("error: u_strCheckUTF16(good)=%ld utf8Length=%ld\n", (long)result, (long)utf8Length);
+    }
+    if((result=u_strCheckUTF16(good, -1, &utf8Length))!=6 || utf8Length!=11) {
+        log_err("error: u_strCheckUTF16(good, -1)=%ld utf8Length=%ld\n", (long)result, (long)utf8Length);
+    }
+    if((result=u_strCheckUTF16(lead, 3, &utf8Length))!=1 || utf8Length!=1) {
+        log_err("error: u_strCheckUTF16(lead)=%ld utf8Length=%ld\n", (long)result, (long)utf8Length);
+    }
+    if((result=u_strCheckUTF16(trail, 5, &utf8Length))!=2 || utf8Length!=3) {
+        log_err("error: u_strCheckUTF16(trail)=%ld utf8Length=%ld\n", (long)result, (long)utf8Length);
+    }
+    if((result=u_strCheckUTF16(leadAtEnd, 3, &utf8Length))!=2 || utf8Length!=4) {
+        log_err("error: u_strCheckUTF16(leadAtEnd)=%ld utf8Length=%ld\n", (long)result, (long)utf8Length);
+    }
+    if(u_strCheckUTF16(NULL, 0, NULL)!=0) {
+        log_err("error: u_strCheckUTF16(NULL, 0)!=0\n");
+    }
+
+    /* long enough for the bulk code paths, with and without supplementary code points */
+    for(length=0; length<1800; ++length) {
+        s[length]=pieces[(length*5)%UPRV_LENGTHOF(pieces)];
+        if(U16_IS_LEAD(s[length])) {
+            s[++length]=0xde00;
+        } else if(U16_IS_TRAIL(s[length])) {
+            s[length]=0x7a;
+        }
+    }
+    errorCode=U_ZERO_ERROR;
+    u_strToUTF8(dest, UPRV_LENGTHOF(dest), &expectedLength, s, length, &errorCode);
+    result=u_strCheckUTF16(s, length, &utf8Length);
+    if(U_FAILURE(errorCode) || result!=length || utf8Length!=expectedLength) {
+        log_err("error: u_strCheckUTF16(long string)=%ld utf8Length=%ld, expected %ld and %ld\n",
+                (long)result, (long)utf8Length, (long)length, (long)expectedLength);
+    }
+
+    /* insert an unpaired surrogate at various positions, not inside a pair */
+    for(i=0; i<length; i+=29) {
+        int32_t start=U16_IS_TRAIL(s[i]) ? i+1 : i;
+        UChar saved=s[start];
+        s[start]=0xdc00;
+        errorCode=U_ZERO_ERROR;
+        u_strToUTF8(NULL, 0, &expectedLength, s, start, &errorCode);
+        result=u_strCheckUTF16(s, length, &utf8Length);
+        if(result!=start || utf8Length!=expectedLength) {
+            log_err("error: u_strCheckUTF16(unpaired at %ld)=%ld utf8Length=%ld, expected %ld\n",
+                    (long)start, (long)result, (long)utf8Length, (long)expectedLength);
+        }
+        s[start]=saved;
+    }
+}
+
 /* test u_strFromUTF8Lenient() */
 static void
 Test_FromUTF8Lenient(void) {
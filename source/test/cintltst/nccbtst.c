@@ -85,6 +85,7 @@ static void setNuConvTestName(const char *codepage, const char *direction)
 
 
 static void TestCallBackFailure(void);
+static void TestFFFDCallBack(void);
 
 void addTestConvertErrorCallBack(TestNode** root);
 
@@ -101,6 +102,7 @@ void addTestConvertErrorCallBack(TestNode** root)
 #endif
 
     addTest(root, &TestCallBackFailure,  "tsconv/nccbtst/TestCallBackFailure");
+    addTest(root, &TestFFFDCallBack,  "tsconv/nccbtst/TestFFFDCallBack");
 }
 
 static void TestSkipCallBack()
@@ -3385,3 +3387,122 @@ static void TestCallBackFailure(void) {
         log_err("Error: ucnv_cbToUWriteUChars did not react correctly to a bad UErrorCode\n");
     }
 }
+
+/* Same as UCNV_TO_U_CALLBACK_FFFD, but converters do not handle it inline. */
+static void U_CALLCONV
+toUCallbackFFFD(const void *context, UConverterToUnicodeArgs *toUArgs,
+                const char *codeUnits, int32_t length,
+                UConverterCallbackReason reason, UErrorCode *pErrorCode) {
+    static const UChar fffd = 0xfffd;
+    (void)context;
+    (void)codeUnits;
+    (void)length;
+    if (reason <= UCNV_IRREGULAR) {
+        *pErrorCode = U_ZERO_ERROR;
+        ucnv_cbToUWriteUChars(toUArgs, &fffd, 1, 0, pErrorCode);
+    }
+}
+
+/*
+ * Converts with offsets in one call if chunkSize==0,
+ * else with source and target chunks of varying sizes up to chunkSize and no offsets.
+ */
+static int32_t
+toUnicodeInChunks(UConverter *cnv, const char *src, int32_t srcLength,
+                  UChar *dest, int32_t destCapacity, int32_t *offsets,
+                  int32_t chunkSize, UErrorCode *pErrorCode) {
+    const char *source = src, *srcLimit = src + srcLength;
+    UChar *target = dest;
+    int32_t i = 0;
+    ucnv_resetToUnicode(cnv);
+    if (chunkSize == 0) {
+        ucnv_toUnicode(cnv, &target, dest + destCapacity, &source, srcLimit, offsets, TRUE, pErrorCode);
+        return (int32_t)(target - dest);
+    }
+    for (;;) {
+        const char *sourceLimit = source + 1 + i % chunkSize;
+        UChar *targetLimit = target + 1 + (i * 3) % chunkSize;
+        UBool flush;
+        ++i;
+        if (sourceLimit >= srcLimit) {
+            sourceLimit = srcLimit;
+        }
+        if (targetLimit > dest + destCapacity) {
+            targetLimit = dest + destCapacity;
+        }
+        flush = (UBool)(sourceLimit == srcLimit);
+        ucnv_toUnicode(cnv, &target, targetLimit, &source, sourceLimit, NULL, flush, pErrorCode);
+        if (*pErrorCode == U_BUFFER_OVERFLOW_ERROR && target < dest + destCapacity) {
+            *pErrorCode = U_ZERO_ERROR;
+        } else if (U_FAILURE(*pErrorCode) || (flush && source == srcLimit)) {
+            break;
+        }
+    }
+    return (int32_t)(target - dest);
+}
+
+/*
+ * UCNV_TO_U_CALLBACK_FFFD must yield the same output and offsets
+ * whether the converter handles it inline or calls it.
+ */
+static void TestFFFDCallBack(void) {
+    static const char *const names[] = {
+        "UTF-8", "CESU-8", "UTF-16BE", "UTF-16LE", "UTF-16",
+#if !UCONFIG_NO_LEGACY_CONVERSION
+        "ibm-1162", "Shift_JIS", "EUC-JP", "GB18030", "ibm-930", "ibm-1390",
+        "ISO-2022-JP",
+#endif
+        "US-ASCII"
+    };
+    char src[600];
+    UChar expected[1400], actual[1400];
+    int32_t expectedOffsets[1400], actualOffsets[1400];
+    uint32_t seed = 1;
+    int32_t i, n;
+
+    /* mostly garbage, with runs of ASCII and some surrogate-like UTF-16 units */
+    for (i = 0; i < UPRV_LENGTHOF(src); ++i) {
+        seed = seed * 1103515245 + 12345;
+        src[i] = (char)((seed >> 16) % 5 == 0 ? 0x41 + i % 26 :
+                        (seed >> 16) % 7 == 0 ? 0xdc : (seed >> 8));
+    }
+
+    for (n = 0; n < UPRV_LENGTHOF(names); ++n) {
+        static const int32_t chunkSizes[] = { 0, 1, 5, 37 };
+        UErrorCode errorCode = U_ZERO_ERROR;
+        UConverter *cnv = ucnv_open(names[n], &errorCode);
+        int32_t c;
+        if (U_FAILURE(errorCode)) {
+            log_data_err("ucnv_open(%s) failed - %s\n", names[n], u_errorName(errorCode));
+            continue;
+        }
+        for (c = 0; c < UPRV_LENGTHOF(chunkSizes); ++c) {
+            UErrorCode expectedErrorCode = U_ZERO_ERROR, actualErrorCode = U_ZERO_ERROR;
+            int32_t expectedLength, actualLength;
+            int32_t *eo = chunkSizes[c] == 0 ? expectedOffsets : NULL;
+            int32_t *ao = chunkSizes[c] == 0 ? actualOffsets : NULL;
+
+            ucnv_setToUCallBack(cnv, toUCallbackFFFD, NULL, NULL, NULL, &errorCode);
+            expectedLength = toUnicodeInChunks(cnv, src, UPRV_LENGTHOF(src), expected, UPRV_LENGTHOF(expected),
+                                               eo, chunkSizes[c], &expectedErrorCode);
+            ucnv_setToUCallBack(cnv, UCNV_TO_U_CALLBACK_FFFD, NULL, NULL, NULL, &errorCode);
+            actualLength = toUnicodeInChunks(cnv, src, UPRV_LENGTHOF(src), actual, UPRV_LENGTHOF(actual),
+                                             ao, chunkSizes[c], &actualErrorCode);
+            if (U_FAILURE(expectedErrorCode) || U_FAILURE(actualErrorCode)) {
+                log_err("%s chunks of %ld: toUnicode() failed - %s / %s\n",
+                        names[n], (long)chunkSizes[c],
+                        u_errorName(expectedErrorCode), u_errorName(actualErrorCode));
+            } else if (expectedLength != actualLength ||
+                       u_memcmp(expected, actual, expectedLength) != 0) {
+                log_err("%s chunks of %ld: UCNV_TO_U_CALLBACK_FFFD output differs from the callback's\n",
+                        names[n], (long)chunkSizes[c]);
+            } else if (eo != NULL &&
+                       memcmp(expectedOffsets, actualOffsets, expectedLength * sizeof(int32_t)) != 0) {
+                log_err("%s: UCNV_TO_U_CALLBACK_FFFD offsets differ from the callback's\n", names[n]);
+            } else if (u_memchr(actual, 0xfffd, actualLength) == NULL) {
+                log_err("%s chunks of %ld: no U+FFFD in the output\n", names[n], (long)chunkSizes[c]);
+            }
+        }
+        ucnv_close(cnv);
+    }
+}
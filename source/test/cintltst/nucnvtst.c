@@ -51,9 +51,11 @@ static void TestUTF32(void);
 static void TestUTF32BE(void);
 static void TestUTF32LE(void);
 static void TestLATIN1(void);
+static void TestASCIIRuns(void);
 
 #if !UCONFIG_NO_LEGACY_CONVERSION
 static void TestSBCS(void);
+static void TestSBCSRuns(void);
 static void TestDBCS(void);
 static void TestMBCS(void);
 #if !UCONFIG_NO_LEGACY_CONVERSION && !UCONFIG_NO_FILE_IO
@@ -98,6 +100,7 @@ static void TestISCII(void);
 
 static void TestCoverageMBCS(void);
 static void TestJitterbug2346(void);
+static void TestISO_2022_JP_Runs(void);
 static void TestJitterbug2411(void);
 static void TestJB5275(void);
 static void TestJB5275_1(void);
@@ -274,9 +277,11 @@ void addTestNewConvert(TestNode** root)
 #endif
 
    addTest(root, &TestLATIN1, "tsconv/nucnvtst/TestLATIN1");
+   addTest(root, &TestASCIIRuns, "tsconv/nucnvtst/TestASCIIRuns");
 
 #if !UCONFIG_NO_LEGACY_CONVERSION
    addTest(root, &TestSBCS, "tsconv/nucnvtst/TestSBCS");
+   addTest(root, &TestSBCSRuns, "tsconv/nucnvtst/TestSBCSRuns");
 #if !UCONFIG_NO_FILE_IO
    addTest(root, &TestDBCS, "tsconv/nucnvtst/TestDBCS");
    addTest(root, &TestICCRunout, "tsconv/nucnvtst/TestICCRunout");
@@ -328,6 +333,7 @@ void addTestNewConvert(TestNode** root)
 
 #if !UCONFIG_NO_LEGACY_CONVERSION
    addTest(root, &TestJitterbug2346, "tsconv/nucnvtst/TestJitterbug2346");
+   addTest(root, &TestISO_2022_JP_Runs, "tsconv/nucnvtst/TestISO_2022_JP_Runs");
    addTest(root, &TestJitterbug2411, "tsconv/nucnvtst/TestJitterbug2411");
    addTest(root, &TestJitterbug6175, "tsconv/nucnvtst/TestJitterbug6175");
 
@@ -2400,6 +2406,151 @@ TestUTF32LE() {
     ucnv_close(cnv);
 }
 
+/*
+ * Long runs of ASCII are converted in bulk by the UTF-8, Latin-1 and US-ASCII
+ * converters. Convert text with runs of different lengths between non-ASCII
+ * characters in small target chunks and check the output and offsets.
+ */
+static void
+TestASCIIRuns() {
+    static const char *const names[]={ "UTF-8", "ISO-8859-1", "US-ASCII" };
+    UChar text[400], result[400];
+    char bytes[1200], back[1200];
+    int32_t offsets[1200], expectOffsets[1200];
+    int32_t i, n, length, byteLength, runLength;
+
+    /* ASCII runs of lengths 0..30, each followed by U+00E9 (or by a '#' for US-ASCII) */
+    for(n=0; n<UPRV_LENGTHOF(names); ++n) {
+        UErrorCode errorCode=U_ZERO_ERROR;
+        UConverter *cnv=ucnv_open(names[n], &errorCode);
+        UChar nonASCII= n==2 ? 0x23 : 0xe9;
+        const UChar *source;
+        char *target;
+        int32_t chunk;
+
+        if(U_FAILURE(errorCode)) {
+            log_data_err("unable to open %s converter - %s\n", names[n], u_errorName(errorCode));
+            continue;
+        }
+        length=byteLength=0;
+        for(runLength=0; runLength<=30 && length<(UPRV_LENGTHOF(text)-32); ++runLength) {
+            for(i=0; i<runLength; ++i) {
+                text[length]=(UChar)(0x61+(length%26));
+                expectOffsets[byteLength++]=length++;
+            }
+            text[length]=nonASCII;
+            expectOffsets[byteLength++]=length;
+            if(n==0) {
+                expectOffsets[byteLength++]=length;
+            }
+            ++length;
+        }
+
+        for(chunk=1; chunk<=40; chunk+=13) {
+            /* fromUnicode with offsets, in chunks of the target */
+            ucnv_resetFromUnicode(cnv);
+            source=text;
+            target=bytes;
+            errorCode=U_ZERO_ERROR;
+            do {
+                int32_t *pOffsets=offsets+(target-bytes);
+                const char *targetLimit=target+chunk;
+                if(targetLimit>bytes+UPRV_LENGTHOF(bytes)) {
+                    targetLimit=bytes+UPRV_LENGTHOF(bytes);
+                }
+                errorCode=U_ZERO_ERROR;
+                {
+                    char *chunkStart=target;
+                    int32_t sourceIndex=(int32_t)(source-text);
+                    ucnv_fromUnicode(cnv, &target, targetLimit, &source, text+length,
+                                     pOffsets, TRUE, &errorCode);
+                    for(i=0; i<(int32_t)(target-chunkStart); ++i) {
+                        pOffsets[i]+=sourceIndex;
+                    }
+                }
+            } while(errorCode==U_BUFFER_OVERFLOW_ERROR);
+            if(U_FAILURE(errorCode) || (target-bytes)!=byteLength) {
+                log_err("%s fromUnicode(chunk %d) failed - %s, length %d instead of %d\n",
+                        names[n], (int)chunk, u_errorName(errorCode),
+                        (int)(target-bytes), (int)byteLength);
+                continue;
+            }
+            for(i=0; i<byteLength; ++i) {
+                if(offsets[i]!=expectOffsets[i]) {
+                    log_err("%s fromUnicode(chunk %d) offsets[%d]=%d instead of %d\n",
+                            names[n], (int)chunk, (int)i, (int)offsets[i], (int)expectOffsets[i]);
+                    break;
+                }
+            }
+
+            /* toUnicode with offsets, in chunks of the target */
+            {
+                const char *bytesSource=bytes;
+                UChar *uTarget=result;
+                ucnv_resetToUnicode(cnv);
+                do {
+                    int32_t *pOffsets=offsets+(uTarget-result);
+                    const UChar *uTargetLimit=uTarget+chunk;
+                    if(uTargetLimit>result+UPRV_LENGTHOF(result)) {
+                        uTargetLimit=result+UPRV_LENGTHOF(result);
+                    }
+                    errorCode=U_ZERO_ERROR;
+                    {
+                        UChar *chunkStart=uTarget;
+                        int32_t sourceIndex=(int32_t)(bytesSource-bytes);
+                        ucnv_toUnicode(cnv, &uTarget, uTargetLimit, &bytesSource, bytes+byteLength,
+                                       pOffsets, TRUE, &errorCode);
+                        for(i=0; i<(int32_t)(uTarget-chunkStart); ++i) {
+                            pOffsets[i]+=sourceIndex;
+                        }
+                    }
+                } while(errorCode==U_BUFFER_OVERFLOW_ERROR);
+                if(U_FAILURE(errorCode) || (uTarget-result)!=length ||
+                        0!=u_memcmp(text, result, length)) {
+                    log_err("%s toUnicode(chunk %d) failed - %s, or wrong output\n",
+                            names[n], (int)chunk, u_errorName(errorCode));
+                    continue;
+                }
+                for(i=0; i<length; ++i) {
+                    int32_t expected=i;
+                    if(n==0) {
+                        /* each non-ASCII character before i took two bytes */
+                        int32_t j;
+                        for(j=0; j<i; ++j) {
+                            if(text[j]>=0x80) {
+                                ++expected;
+                            }
+                        }
+                    }
+                    if(offsets[i]!=expected) {
+                        log_err("%s toUnicode(chunk %d) offsets[%d]=%d instead of %d\n",
+                                names[n], (int)chunk, (int)i, (int)offsets[i], (int)expected);
+                        break;
+                    }
+                }
+            }
+
+            /* UTF-8 to this charset via ucnv_convertEx(), with the same chunking */
+            if(n>0) {
+                UErrorCode convErrorCode=U_ZERO_ERROR;
+                UConverter *utf8=ucnv_open("UTF-8", &convErrorCode);
+                char utf8Bytes[1200];
+                int32_t utf8Length=ucnv_fromUChars(utf8, utf8Bytes, UPRV_LENGTHOF(utf8Bytes),
+                                                   text, length, &convErrorCode);
+                int32_t backLength=ucnv_convert(names[n], "UTF-8", back, UPRV_LENGTHOF(back),
+                                                utf8Bytes, utf8Length, &convErrorCode);
+                if(U_FAILURE(convErrorCode) || backLength!=byteLength ||
+                        0!=memcmp(back, bytes, byteLength)) {
+                    log_err("UTF-8 to %s via ucnv_convert() failed - %s\n",
+                            names[n], u_errorName(convErrorCode));
+                }
+                ucnv_close(utf8);
+            }
+        }
+        ucnv_close(cnv);
+    }
+}
+
 static void
 TestLATIN1() {
     /* test input */
@@ -2563,6 +2714,119 @@ TestSBCS() {
     ucnv_close(cnv);
 }
 
+/*
+ * Convert text with long runs through SBCS converters in one call each,
+ * and compare with the conversion of one unit at a time,
+ * which does not use the bulk conversion of 16-unit blocks.
+ */
+static void
+TestSBCSRuns() {
+    static const char *const names[]={
+        "windows-1252", "ibm-037", "ibm-1047,swaplfnl", "x-mac-turkish", "ibm-874"
+    };
+    UChar text[700], result[700], result1[700];
+    char bytes[700], bytes1[700];
+    int32_t offsets[700], offsets1[700];
+    int32_t i, n, length, resultLength, result1Length;
+
+    /* Latin-1 runs of various lengths, interrupted by other characters */
+    for(i=length=0; length<600; ++i) {
+        int32_t runLength=i%40, j;
+        for(j=0; j<runLength; ++j) {
+            text[length++]=(UChar)((0x20+i*7+j)&0xff);
+        }
+        text[length++]= (i&1)==0 ? 0x20ac : 0x4e00;
+    }
+
+    for(n=0; n<UPRV_LENGTHOF(names); ++n) {
+        UErrorCode errorCode=U_ZERO_ERROR;
+        UConverter *cnv=ucnv_open(names[n], &errorCode);
+        const UChar *source;
+        const char *bytesSource;
+        char *target;
+        UChar *uTarget;
+
+        if(U_FAILURE(errorCode)) {
+            log_data_err("unable to open %s converter - %s\n", names[n], u_errorName(errorCode));
+            continue;
+        }
+
+        /* fromUnicode all at once, and one unit at a time */
+        source=text;
+        target=bytes1;
+        ucnv_fromUnicode(cnv, &target, bytes1+UPRV_LENGTHOF(bytes1), &source, text+length,
+                         offsets1, TRUE, &errorCode);
+        resultLength=(int32_t)(target-bytes1);
+        ucnv_resetFromUnicode(cnv);
+        source=text;
+        target=bytes;
+        for(i=1; i<=length && U_SUCCESS(errorCode); ++i) {
+            int32_t *pOffsets=offsets+(target-bytes);
+            char *start=target;
+            int32_t j;
+            ucnv_fromUnicode(cnv, &target, bytes+UPRV_LENGTHOF(bytes), &source, text+i,
+                             pOffsets, i==length, &errorCode);
+            for(j=0; j<(int32_t)(target-start); ++j) {
+                pOffsets[j]+=i-1;
+            }
+        }
+        result1Length=(int32_t)(target-bytes);
+        if(U_FAILURE(errorCode) || resultLength!=result1Length ||
+                0!=uprv_memcmp(bytes, bytes1, resultLength)) {
+            log_err("%s fromUnicode of runs differs from unit-by-unit conversion - %s\n",
+                    names[n], u_errorName(errorCode));
+        } else {
+            for(i=0; i<resultLength; ++i) {
+                if(offsets[i]!=offsets1[i]) {
+                    log_err("%s fromUnicode offsets[%d]=%d instead of %d\n",
+                            names[n], (int)i, (int)offsets1[i], (int)offsets[i]);
+                    break;
+                }
+            }
+        }
+
+        /* toUnicode all at once, and one byte at a time */
+        /* all bytes, in runs interrupted by bytes that are unassigned in some codepages */
+        for(i=0; i<600; ++i) {
+            bytes[i]= (i%37)==36 ? (char)0xff : (char)(i*5+i/256);
+        }
+        bytesSource=bytes;
+        uTarget=result1;
+        ucnv_toUnicode(cnv, &uTarget, result1+UPRV_LENGTHOF(result1), &bytesSource, bytes+600,
+                       offsets1, TRUE, &errorCode);
+        resultLength=(int32_t)(uTarget-result1);
+        ucnv_resetToUnicode(cnv);
+        bytesSource=bytes;
+        uTarget=result;
+        for(i=1; i<=600 && U_SUCCESS(errorCode); ++i) {
+            int32_t *pOffsets=offsets+(uTarget-result);
+            UChar *start=uTarget;
+            int32_t j;
+            ucnv_toUnicode(cnv, &uTarget, result+UPRV_LENGTHOF(result), &bytesSource, bytes+i,
+                           pOffsets, i==600, &errorCode);
+            for(j=0; j<(int32_t)(uTarget-start); ++j) {
+                pOffsets[j]+=i-1;
+            }
+        }
+        result1Length=(int32_t)(uTarget-result);
+        if(U_FAILURE(errorCode) || resultLength!=result1Length ||
+                0!=u_memcmp(result, result1, resultLength)) {
+            log_err("%s toUnicode of runs differs from byte-by-byte conversion - %s\n",
+                    names[n], u_errorName(errorCode));
+        } else {
+            for(i=0; i<resultLength; ++i) {
+                if(offsets[i]!=offsets1[i]) {
+                    log_err("%s toUnicode offsets[%d]=%d instead of %d\n",
+                            names[n], (int)i, (int)offsets1[i], (int)offsets[i]);
+                    break;
+                }
+            }
+        }
+
+        ucnv_close(cnv);
+    }
+}
+
 static void
 TestDBCS() {
     /* test input */
@@ -3831,6 +4095,77 @@ static void TestJitterbug2346(){
 
 }
 
+/*
+ * Runs of ASCII and of JIS X 0208 are converted in bulk.
+ * Check that the runs end at the right bytes, and that the output and offsets
+ * do not depend on how the input is split up.
+ */
+static void TestISO_2022_JP_Runs(){
+    static const char source[] = {
+        0x46,0x72,0x6f,0x6d,0x3a,0x20,0x61,0x0d,0x0a,         /* "From: a" CRLF */
+        0x1b,0x24,0x42,0x30,0x21,0x30,0x22,0x29,0x21,0x30,0x23,   /* ESC $ B, 2 pairs, unassigned pair, pair */
+        0x30,0x7f,0x30,0x24,                                  /* illegal trail byte, pair */
+        0x1b,0x28,0x42,0x78,0x79,0x0d,0x0a,                   /* ESC ( B "xy" CRLF */
+        0x1b,0x24,0x42,0x30,0x25,0x0d,0x0a,0x7a               /* CRLF switches back to ASCII */
+    };
+    UChar whole[100], chunked[100];
+    int32_t wholeOffsets[100], chunkedOffsets[100];
+    UChar *target;
+    int32_t *offsets;
+    const char *src;
+    int32_t wholeLength, chunkedLength, i;
+    UErrorCode err = U_ZERO_ERROR;
+
+    UConverter *conv = ucnv_open("ISO_2022_JP", &err);
+    if(U_FAILURE(err)) {
+        log_data_err("Unable to open a iso-2022 converter: %s\n", u_errorName(err));
+        return;
+    }
+    target = whole;
+    offsets = wholeOffsets;
+    src = source;
+    ucnv_toUnicode(conv, &target, whole + UPRV_LENGTHOF(whole), &src, source + sizeof(source),
+                   wholeOffsets, TRUE, &err);
+    wholeLength = (int32_t)(target - whole);
+    if(U_FAILURE(err) || wholeLength != 23 ||
+            whole[9] != 0x4e9c || whole[10] != 0x5516 || whole[11] != 0xfffd || whole[12] != 0x5a03 ||
+            wholeOffsets[12] != 18 || wholeOffsets[14] != 22 || whole[19] != 0x54c0 ||
+            wholeOffsets[19] != 34 || whole[22] != 0x7a) {
+        log_err("ISO_2022_JP to Unicode of runs is wrong: %s, length %d\n",
+                u_errorName(err), (int)wholeLength);
+    }
+
+    ucnv_reset(conv);
+    target = chunked;
+    offsets = chunkedOffsets;
+    for(i = 0; i < (int32_t)sizeof(source) && U_SUCCESS(err); ++i) {
+        UChar *chunkStart = target;
+        src = source + i;
+        ucnv_toUnicode(conv, &target, chunked + UPRV_LENGTHOF(chunked), &src, source + i + 1,
+                       offsets, i + 1 == (int32_t)sizeof(source), &err);
+        /* offsets are relative to the start of each chunk */
+        for(; chunkStart < target; ++chunkStart, ++offsets) {
+            if(*offsets >= 0) {
+                *offsets += i;
+            }
+        }
+    }
+    chunkedLength = (int32_t)(target - chunked);
+    if(U_FAILURE(err) || chunkedLength != wholeLength ||
+            memcmp(chunked, whole, wholeLength * U_SIZEOF_UCHAR) != 0) {
+        log_err("ISO_2022_JP to Unicode of runs differs when converting byte by byte: %s\n",
+                u_errorName(err));
+    } else {
+        for(i = 0; i < wholeLength; ++i) {
+            if(chunkedOffsets[i] >= 0 && chunkedOffsets[i] != wholeOffsets[i]) {
+                log_err("ISO_2022_JP to Unicode offset[%d]=%d byte by byte, %d at once\n",
+                        (int)i, (int)chunkedOffsets[i], (int)wholeOffsets[i]);
+            }
+        }
+    }
+    ucnv_close(conv);
+}
+
 static void
 TestISO_2022_JP_1() {
     /* test input */
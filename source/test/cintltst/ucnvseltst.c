@@ -32,12 +32,14 @@
 #define TDSRCPATH  ".." U_FILE_SEP_STRING "test" U_FILE_SEP_STRING "testdata" U_FILE_SEP_STRING
 
 static void TestSelector(void);
+static void TestSelectorState(void);
 static void TestUPropsVector(void);
 void addCnvSelTest(TestNode** root);  /* Declaration required to suppress compiler warnings. */
 
 void addCnvSelTest(TestNode** root)
 {
     addTest(root, &TestSelector, "tsconv/ucnvseltst/TestSelector");
+    addTest(root, &TestSelectorState, "tsconv/ucnvseltst/TestSelectorState");
     addTest(root, &TestUPropsVector, "tsconv/ucnvseltst/TestUPropsVector");
 }
 
@@ -347,6 +349,40 @@ static void verifyResult(UEnumeration* res, const UBool *resultsManually) {
   uenum_close(res);
 }
 
+/* selects for s in chunks of chunkLength bytes via a UConverterSelectorState */
+static UEnumeration *
+selectForUTF8Chunks(const UConverterSelector *sel, const char *s, int32_t length,
+                    int32_t chunkLength, UErrorCode *status) {
+  UEnumeration *res;
+  UConverterSelectorState *state = ucnvsel_openState(sel, status);
+  while (length > 0 && U_SUCCESS(*status)) {
+    int32_t n = length < chunkLength ? length : chunkLength;
+    ucnvsel_addUTF8(state, s, n, status);
+    s += n;
+    length -= n;
+  }
+  res = ucnvsel_selectForState(state, status);
+  ucnvsel_closeState(state);
+  return res;
+}
+
+/* selects for s in chunks of chunkLength UChars via a UConverterSelectorState */
+static UEnumeration *
+selectForStringChunks(const UConverterSelector *sel, const UChar *s, int32_t length,
+                      int32_t chunkLength, UErrorCode *status) {
+  UEnumeration *res;
+  UConverterSelectorState *state = ucnvsel_openState(sel, status);
+  while (length > 0 && U_SUCCESS(*status)) {
+    int32_t n = length < chunkLength ? length : chunkLength;
+    ucnvsel_addString(state, s, n, status);
+    s += n;
+    length -= n;
+  }
+  res = ucnvsel_selectForState(state, status);
+  ucnvsel_closeState(state);
+  return res;
+}
+
 static UConverterSelector *
 serializeAndUnserialize(UConverterSelector *sel, char **buffer, UErrorCode *status) {
   char *new_buffer;
@@ -469,6 +505,9 @@ static void TestSelector()
         /* UTF-8 NUL-terminated */
         verifyResult(ucnvsel_selectForUTF8(sel_rt, s, -1, &status), manual_rt);
         verifyResult(ucnvsel_selectForUTF8(sel_fb, s, -1, &status), manual_fb);
+        /* UTF-8 in chunks, splitting some characters */
+        verifyResult(selectForUTF8Chunks(sel_rt, s, length8, 1 + text.number % 5, &status), manual_rt);
+        verifyResult(selectForUTF8Chunks(sel_fb, s, length8, 2 + text.number % 7, &status), manual_fb);
 
         u_strFromUTF8(utf16, UPRV_LENGTHOF(utf16), &length16, s, length8, &status);
         if (U_FAILURE(status)) {
@@ -485,6 +524,9 @@ static void TestSelector()
             /* UTF-16 NUL-terminated */
             verifyResult(ucnvsel_selectForString(sel_rt, utf16, -1, &status), manual_rt);
             verifyResult(ucnvsel_selectForString(sel_fb, utf16, -1, &status), manual_fb);
+            /* UTF-16 in chunks, splitting some surrogate pairs */
+            verifyResult(selectForStringChunks(sel_rt, utf16, length16, 1 + text.number % 3, &status), manual_rt);
+            verifyResult(selectForStringChunks(sel_fb, utf16, length16, 3, &status), manual_fb);
           }
         }
 
@@ -505,6 +547,113 @@ static void TestSelector()
   }
 }
 
+static int32_t countSelected(UEnumeration *res) {
+  UErrorCode status = U_ZERO_ERROR;
+  int32_t count = uenum_count(res, &status);
+  uenum_close(res);
+  return count;
+}
+
+static void TestSelectorState() {
+  static const char *const encodings[] = { "US-ASCII", "ISO-8859-1", "UTF-8", "Shift_JIS" };
+  static const UChar uml[] = { 0x61, 0xfc };
+  static const UChar hiragana[] = { 0x3042 };
+  static const UChar emoji[] = { 0xd83d, 0xde00 };
+  static const UChar loneLead[] = { 0x61, 0xd83d, 0x62 };
+  UErrorCode status = U_ZERO_ERROR;
+  UConverterSelector *sel;
+  UConverterSelectorState *state;
+  int32_t count;
+
+  sel = ucnvsel_open(encodings, UPRV_LENGTHOF(encodings), NULL, UCNV_ROUNDTRIP_SET, &status);
+  if (U_FAILURE(status)) {
+    log_data_err("ucnvsel_open() failed - %s\n", u_errorName(status));
+    return;
+  }
+  state = ucnvsel_openState(sel, &status);
+  if (U_FAILURE(status)) {
+    log_err("ucnvsel_openState() failed - %s\n", u_errorName(status));
+    ucnvsel_close(sel);
+    return;
+  }
+
+  /* no text selects all encodings */
+  if ((count = countSelected(ucnvsel_selectForState(state, &status))) != 4) {
+    log_err("empty state selects %ld encodings, expected 4\n", (long)count);
+  }
+  /* U+00FC leaves ISO-8859-1 and UTF-8 */
+  if ((count = ucnvsel_addString(state, uml, 2, &status)) != 2 ||
+      countSelected(ucnvsel_selectForState(state, &status)) != 2) {
+    log_err("after U+00FC: %ld encodings, expected 2\n", (long)count);
+  }
+  /* U+3042 leaves only UTF-8 */
+  if ((count = ucnvsel_addString(state, hiragana, 1, &status)) != 1) {
+    log_err("after U+3042: %ld encodings, expected 1\n", (long)count);
+  }
+
+  /* a surrogate pair split across chunks */
+  ucnvsel_resetState(state);
+  ucnvsel_addString(state, emoji, 1, &status);
+  if ((count = ucnvsel_addString(state, emoji + 1, 1, &status)) != 1) {
+    log_err("after a split surrogate pair: %ld encodings, expected 1\n", (long)count);
+  }
+
+  /* an unpaired lead surrogate gets the selector's error value, like in the one-shot functions */
+  ucnvsel_resetState(state);
+  ucnvsel_addString(state, loneLead, 2, &status);
+  ucnvsel_addString(state, loneLead + 2, 1, &status);
+  count = countSelected(ucnvsel_selectForState(state, &status));
+  if (count != countSelected(ucnvsel_selectForString(sel, loneLead, 3, &status))) {
+    log_err("a lone lead surrogate between chunks selects %ld encodings, "
+            "unlike the one-shot function\n", (long)count);
+  }
+
+  /* a UTF-8 sequence split across three chunks; U+3042=E3 81 82 leaves UTF-8 and Shift_JIS */
+  ucnvsel_resetState(state);
+  ucnvsel_addUTF8(state, "a\xe3", 2, &status);
+  if ((count = ucnvsel_addUTF8(state, "\x81", 1, &status)) != 4) {
+    log_err("an incomplete UTF-8 sequence removed encodings: %ld left\n", (long)count);
+  }
+  if ((count = ucnvsel_addUTF8(state, "\x82" "b", 2, &status)) != 2) {
+    log_err("after a split UTF-8 sequence: %ld encodings, expected 2\n", (long)count);
+  }
+
+  /* ill-formed UTF-8 removes nothing, also when it ends the text */
+  ucnvsel_resetState(state);
+  ucnvsel_addUTF8(state, "\xe3\x81", 2, &status);
+  if ((count = countSelected(ucnvsel_selectForState(state, &status))) != 4) {
+    log_err("truncated UTF-8 at the end selects %ld encodings, expected 4\n", (long)count);
+  }
+  if ((count = ucnvsel_addUTF8(state, "\x41", 1, &status)) != 4) {
+    log_err("ill-formed UTF-8 removed encodings: %ld left\n", (long)count);
+  }
+
+  if (U_FAILURE(status)) {
+    log_err("ucnvsel_add...() failed - %s\n", u_errorName(status));
+  }
+  ucnvsel_closeState(state);
+  ucnvsel_close(sel);
+
+  /* once no encoding is left, more text changes nothing */
+  sel = ucnvsel_open(encodings, 2, NULL, UCNV_ROUNDTRIP_SET, &status);
+  state = ucnvsel_openState(sel, &status);
+  if (U_FAILURE(status)) {
+    log_err("ucnvsel_open[State]() failed - %s\n", u_errorName(status));
+  } else {
+    if ((count = ucnvsel_addString(state, hiragana, 1, &status)) != 0 ||
+        (count = ucnvsel_addUTF8(state, "a", 1, &status)) != 0 ||
+        (count = countSelected(ucnvsel_selectForState(state, &status))) != 0) {
+      log_err("after U+3042 in Latin-1: %ld encodings, expected 0\n", (long)count);
+    }
+    ucnvsel_resetState(state);
+    if ((count = ucnvsel_addUTF8(state, "a\xc3\xbc", 3, &status)) != 1) {
+      log_err("after resetting and adding U+00FC: %ld encodings, expected 1\n", (long)count);
+    }
+  }
+  ucnvsel_closeState(state);
+  ucnvsel_close(sel);
+}
+
 /* Improve code coverage of UPropsVectors */
 static void TestUPropsVector() {
     UErrorCode errorCode = U_ILLEGAL_ARGUMENT_ERROR;
@@ -0,0 +1,970 @@
+// © 2018 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+/*
+******************************************************************************
+*   file name:  ucptrietest.c
+*   encoding:   UTF-8
+*   tab size:   8 (not used)
+*   indentation:4
+*
+*   Tests for UCPTrie and UMutableCPTrie, starting from a copy of trie2test.c.
+*/
+
+#include <stdio.h>
+#include "unicode/utypes.h"
+#include "unicode/utf8.h"
+#include "unicode/utf16.h"
+#include "ucptrie.h"
+#include "cstring.h"
+#include "cmemory.h"
+#include "cintltst.h"
+
+void addUCPTrieTest(TestNode** root);
+
+/* Values for setting possibly overlapping, out-of-order ranges of values */
+typedef struct SetRange {
+    UChar32 start, limit;
+    uint32_t value;
+} SetRange;
+
+/*
+ * Values for testing:
+ * value is set from the previous boundary's limit to before
+ * this boundary's limit
+ *
+ * There must be an entry with limit 0 and the intialValue.
+ * It may be preceded by an entry with negative limit and the errorValue.
+ */
+typedef struct CheckRange {
+    UChar32 limit;
+    uint32_t value;
+} CheckRange;
+
+static int32_t
+getSpecialValues(const CheckRange checkRanges[], int32_t countCheckRanges,
+                 uint32_t *pInitialValue, uint32_t *pErrorValue) {
+    int32_t i=0;
+    if(i<countCheckRanges && checkRanges[i].limit<0) {
+        *pErrorValue=checkRanges[i++].value;
+    } else {
+        *pErrorValue=0xad;
+    }
+    if(i<countCheckRanges && checkRanges[i].limit==0) {
+        *pInitialValue=checkRanges[i++].value;
+    } else {
+        *pInitialValue=0;
+    }
+    return i;
+}
+
+static uint32_t
+getValueMask(UCPTrieValueWidth valueWidth) {
+    return valueWidth==UCPTRIE_VALUE_BITS_16 ? 0xffff :
+        valueWidth==UCPTRIE_VALUE_BITS_32 ? 0xffffffff : 0xff;
+}
+
+static const char *
+getTypeName(UCPTrieType type) {
+    return type==UCPTRIE_TYPE_FAST ? "fast" : "small";
+}
+
+static const char *
+getValueWidthName(UCPTrieValueWidth valueWidth) {
+    return valueWidth==UCPTRIE_VALUE_BITS_16 ? "16" :
+        valueWidth==UCPTRIE_VALUE_BITS_32 ? "32" : "8";
+}
+
+/* expected value for code point c, or the error value if c is out of range */
+static uint32_t
+getExpectedValue(const CheckRange checkRanges[], int32_t countCheckRanges, UChar32 c) {
+    uint32_t initialValue, errorValue;
+    int32_t i=getSpecialValues(checkRanges, countCheckRanges, &initialValue, &errorValue);
+    if(c<0 || 0x10ffff<c) {
+        return errorValue;
+    }
+    for(; i<countCheckRanges; ++i) {
+        if(c<checkRanges[i].limit) {
+            return checkRanges[i].value;
+        }
+    }
+    return initialValue;
+}
+
+/* ucptrie_getRange() filter, modifies a value */
+static uint32_t U_CALLCONV
+testFilter(const void *context, uint32_t value) {
+    return value^0x5555;
+}
+
+/* verify ranges via ucptrie_getRange() or umutablecptrie_getRange() */
+static void
+testTrieGetRanges(const char *testName, const UCPTrie *trie, const UMutableCPTrie *mutableTrie,
+                  uint32_t mask, UBool withFilter,
+                  const CheckRange checkRanges[], int32_t countCheckRanges) {
+    uint32_t initialValue, errorValue;
+    uint32_t value, expected;
+    UChar32 start, end, expectedEnd;
+    int32_t i;
+    const char *const typeName= trie!=NULL ? "trie" : "mutableTrie";
+    UCPMapValueFilter *filter= withFilter ? testFilter : NULL;
+
+    i=getSpecialValues(checkRanges, countCheckRanges, &initialValue, &errorValue);
+    start=0;
+    while(i<countCheckRanges) {
+        /* merge adjacent ranges whose values are equal after masking */
+        expected=checkRanges[i].value&mask;
+        while(i<countCheckRanges && (checkRanges[i].value&mask)==expected) {
+            ++i;
+        }
+        expectedEnd=checkRanges[i-1].limit-1;
+        if(withFilter) {
+            expected^=0x5555;
+        }
+        if(trie!=NULL) {
+            end=ucptrie_getRange(trie, start, filter, NULL, &value);
+        } else {
+            end=umutablecptrie_getRange(mutableTrie, start, filter, NULL, &value);
+        }
+        if(end!=expectedEnd || value!=expected) {
+            log_err("error: %s getRange(%s, U+%04lx) -> U+%04lx.0x%lx instead of U+%04lx.0x%lx\n",
+                    typeName, testName, (long)start, (long)end, (long)value,
+                    (long)expectedEnd, (long)expected);
+            return;
+        }
+        start=end+1;
+    }
+    if(trie!=NULL) {
+        end=ucptrie_getRange(trie, 0x110000, NULL, NULL, &value);
+    } else {
+        end=umutablecptrie_getRange(mutableTrie, 0x110000, NULL, NULL, &value);
+    }
+    if(end>=0) {
+        log_err("error: %s getRange(%s, U+110000) did not return <0\n", typeName, testName);
+    }
+}
+
+/* verify all expected values via ucptrie_get() and the UCPTRIE_..._GET() macros */
+static void
+testTrieGetters(const char *testName, const UCPTrie *trie,
+                UCPTrieType type, UCPTrieValueWidth valueWidth,
+                const CheckRange checkRanges[], int32_t countCheckRanges) {
+    uint32_t initialValue, errorValue;
+    uint32_t value, value2;
+    UChar32 start, limit;
+    int32_t i, countSpecials, countErrors=0;
+    uint32_t mask=getValueMask(valueWidth);
+
+    countSpecials=getSpecialValues(checkRanges, countCheckRanges, &initialValue, &errorValue);
+
+    start=0;
+    for(i=countSpecials; i<countCheckRanges; ++i) {
+        limit=checkRanges[i].limit;
+        value=checkRanges[i].value&mask;
+
+        while(start<limit) {
+            if(type==UCPTRIE_TYPE_FAST) {
+                if(valueWidth==UCPTRIE_VALUE_BITS_16) {
+                    value2=UCPTRIE_FAST_GET(trie, UCPTRIE_16, start);
+                } else if(valueWidth==UCPTRIE_VALUE_BITS_32) {
+                    value2=UCPTRIE_FAST_GET(trie, UCPTRIE_32, start);
+                } else {
+                    value2=UCPTRIE_FAST_GET(trie, UCPTRIE_8, start);
+                }
+                if(value!=value2) {
+                    log_err("error: %s(%s).fastGet(U+%04lx)==0x%lx instead of 0x%lx\n",
+                            testName, getValueWidthName(valueWidth), (long)start, (long)value2, (long)value);
+                    ++countErrors;
+                }
+                if(start<=0xffff) {
+                    if(valueWidth==UCPTRIE_VALUE_BITS_16) {
+                        value2=UCPTRIE_FAST_BMP_GET(trie, UCPTRIE_16, start);
+                    } else if(valueWidth==UCPTRIE_VALUE_BITS_32) {
+                        value2=UCPTRIE_FAST_BMP_GET(trie, UCPTRIE_32, start);
+                    } else {
+                        value2=UCPTRIE_FAST_BMP_GET(trie, UCPTRIE_8, start);
+                    }
+                    if(value!=value2) {
+                        log_err("error: %s(%s).fastBmpGet(U+%04lx)==0x%lx instead of 0x%lx\n",
+                                testName, getValueWidthName(valueWidth), (long)start, (long)value2, (long)value);
+                        ++countErrors;
+                    }
+                } else {
+                    if(valueWidth==UCPTRIE_VALUE_BITS_16) {
+                        value2=UCPTRIE_FAST_SUPP_GET(trie, UCPTRIE_16, start);
+                    } else if(valueWidth==UCPTRIE_VALUE_BITS_32) {
+                        value2=UCPTRIE_FAST_SUPP_GET(trie, UCPTRIE_32, start);
+                    } else {
+                        value2=UCPTRIE_FAST_SUPP_GET(trie, UCPTRIE_8, start);
+                    }
+                    if(value!=value2) {
+                        log_err("error: %s(%s).fastSuppGet(U+%04lx)==0x%lx instead of 0x%lx\n",
+                                testName, getValueWidthName(valueWidth), (long)start, (long)value2, (long)value);
+                        ++countErrors;
+                    }
+                }
+            } else {
+                if(valueWidth==UCPTRIE_VALUE_BITS_16) {
+                    value2=UCPTRIE_SMALL_GET(trie, UCPTRIE_16, start);
+                } else if(valueWidth==UCPTRIE_VALUE_BITS_32) {
+                    value2=UCPTRIE_SMALL_GET(trie, UCPTRIE_32, start);
+                } else {
+                    value2=UCPTRIE_SMALL_GET(trie, UCPTRIE_8, start);
+                }
+                if(value!=value2) {
+                    log_err("error: %s(%s).smallGet(U+%04lx)==0x%lx instead of 0x%lx\n",
+                            testName, getValueWidthName(valueWidth), (long)start, (long)value2, (long)value);
+                    ++countErrors;
+                }
+            }
+            if(start<=0x7f) {
+                if(valueWidth==UCPTRIE_VALUE_BITS_16) {
+                    value2=UCPTRIE_ASCII_GET(trie, UCPTRIE_16, start);
+                } else if(valueWidth==UCPTRIE_VALUE_BITS_32) {
+                    value2=UCPTRIE_ASCII_GET(trie, UCPTRIE_32, start);
+                } else {
+                    value2=UCPTRIE_ASCII_GET(trie, UCPTRIE_8, start);
+                }
+                if(value!=value2) {
+                    log_err("error: %s(%s).asciiGet(U+%04lx)==0x%lx instead of 0x%lx\n",
+                            testName, getValueWidthName(valueWidth), (long)start, (long)value2, (long)value);
+                    ++countErrors;
+                }
+            }
+            value2=ucptrie_get(trie, start);
+            if(value!=value2) {
+                log_err("error: %s(%s).get(U+%04lx)==0x%lx instead of 0x%lx\n",
+                        testName, getValueWidthName(valueWidth), (long)start, (long)value2, (long)value);
+                ++countErrors;
+            }
+            ++start;
+            if(countErrors>10) {
+                return;
+            }
+        }
+    }
+
+    /* test errorValue */
+    errorValue&=mask;
+    value=ucptrie_get(trie, -1);
+    value2=ucptrie_get(trie, 0x110000);
+    if(value!=errorValue || value2!=errorValue) {
+        log_err("error: %s(%s).get(out of range) != errorValue\n",
+                testName, getValueWidthName(valueWidth));
+    }
+    if(type==UCPTRIE_TYPE_FAST) {
+        if(valueWidth==UCPTRIE_VALUE_BITS_16) {
+            value=UCPTRIE_FAST_GET(trie, UCPTRIE_16, -1);
+        } else if(valueWidth==UCPTRIE_VALUE_BITS_32) {
+            value=UCPTRIE_FAST_GET(trie, UCPTRIE_32, 0x110000);
+        } else {
+            value=UCPTRIE_FAST_GET(trie, UCPTRIE_8, -1);
+        }
+        if(value!=errorValue) {
+            log_err("error: %s(%s).fastGet(out of range) != errorValue\n",
+                    testName, getValueWidthName(valueWidth));
+        }
+    }
+}
+
+static uint32_t
+getMutableValue(const UMutableCPTrie *mutableTrie, UChar32 c, uint32_t mask) {
+    return umutablecptrie_get(mutableTrie, c)&mask;
+}
+
+/* verify all expected values of a mutable trie, masked to the value width */
+static void
+testMutableTrieGetters(const char *testName, const UMutableCPTrie *mutableTrie, uint32_t mask,
+                       const CheckRange checkRanges[], int32_t countCheckRanges) {
+    uint32_t initialValue, errorValue;
+    uint32_t value, value2;
+    UChar32 start, limit;
+    int32_t i, countSpecials;
+
+    countSpecials=getSpecialValues(checkRanges, countCheckRanges, &initialValue, &errorValue);
+
+    start=0;
+    for(i=countSpecials; i<countCheckRanges; ++i) {
+        limit=checkRanges[i].limit;
+        value=checkRanges[i].value&mask;
+
+        while(start<limit) {
+            value2=getMutableValue(mutableTrie, start, mask);
+            if(value!=value2) {
+                log_err("error: %s mutableTrie.get(U+%04lx)==0x%lx instead of 0x%lx\n",
+                        testName, (long)start, (long)value2, (long)value);
+                return;
+            }
+            ++start;
+        }
+    }
+    if(getMutableValue(mutableTrie, -1, mask)!=(errorValue&mask) ||
+            getMutableValue(mutableTrie, 0x110000, mask)!=(errorValue&mask)) {
+        log_err("error: %s mutableTrie.get(out of range) != errorValue\n", testName);
+    }
+}
+
+static void
+testTrieUTF16(const char *testName,
+              const UCPTrie *trie, UCPTrieValueWidth valueWidth,
+              const CheckRange checkRanges[], int32_t countCheckRanges) {
+    UChar s[300];
+    uint32_t values[150];
+
+    const UChar *p, *limit;
+
+    uint32_t initialValue, errorValue;
+    uint32_t value, expected;
+    UChar32 prevCP, c, c2;
+    int32_t i, length, sIndex, countValues;
+    uint32_t mask=getValueMask(valueWidth);
+
+    /* write a string */
+    prevCP=0;
+    length=0;
+    for(i=getSpecialValues(checkRanges, countCheckRanges, &initialValue, &errorValue);
+            i<countCheckRanges; ++i) {
+        /* write three code points */
+        U16_APPEND_UNSAFE(s, length, prevCP);   /* start of the range */
+        c=checkRanges[i].limit;
+        prevCP=(prevCP+c)/2;                    /* middle of the range */
+        U16_APPEND_UNSAFE(s, length, prevCP);
+        prevCP=c;
+        --c;                                    /* end of the range */
+        U16_APPEND_UNSAFE(s, length, c);
+    }
+    /* an unpaired lead surrogate at the end */
+    s[length++]=0xd900;
+    limit=s+length;
+
+    /* try forward, and remember the values for backward iteration */
+    p=s;
+    countValues=0;
+    while(p<limit) {
+        sIndex=(int32_t)(p-s);
+        U16_NEXT(s, sIndex, length, c2);
+        expected= U_IS_SURROGATE(c2) ? errorValue :
+            getExpectedValue(checkRanges, countCheckRanges, c2);
+        expected&=mask;
+        c=0x33;
+        if(valueWidth==UCPTRIE_VALUE_BITS_16) {
+            UCPTRIE_FAST_U16_NEXT(trie, UCPTRIE_16, p, limit, c, value);
+        } else if(valueWidth==UCPTRIE_VALUE_BITS_32) {
+            UCPTRIE_FAST_U16_NEXT(trie, UCPTRIE_32, p, limit, c, value);
+        } else {
+            UCPTRIE_FAST_U16_NEXT(trie, UCPTRIE_8, p, limit, c, value);
+        }
+        if(value!=expected) {
+            log_err("error: wrong value from UCPTRIE_FAST_U16_NEXT(%s)(U+%04lx): 0x%lx instead of 0x%lx\n",
+                    testName, (long)c, (long)value, (long)expected);
+        }
+        if(c!=c2) {
+            log_err("error: wrong code point from UCPTRIE_FAST_U16_NEXT(%s): U+%04lx != U+%04lx\n",
+                    testName, (long)c, (long)c2);
+            return;
+        }
+        values[countValues++]=expected;
+    }
+
+    /* try backward */
+    p=limit;
+    i=countValues;
+    while(s<p) {
+        --i;
+        sIndex=(int32_t)(p-s);
+        U16_PREV(s, 0, sIndex, c2);
+        c=0x33;
+        if(valueWidth==UCPTRIE_VALUE_BITS_16) {
+            UCPTRIE_FAST_U16_PREV(trie, UCPTRIE_16, s, p, c, value);
+        } else if(valueWidth==UCPTRIE_VALUE_BITS_32) {
+            UCPTRIE_FAST_U16_PREV(trie, UCPTRIE_32, s, p, c, value);
+        } else {
+            UCPTRIE_FAST_U16_PREV(trie, UCPTRIE_8, s, p, c, value);
+        }
+        if(value!=values[i]) {
+            log_err("error: wrong value from UCPTRIE_FAST_U16_PREV(%s)(U+%04lx): 0x%lx instead of 0x%lx\n",
+                    testName, (long)c, (long)value, (long)values[i]);
+        }
+        if(c!=c2) {
+            log_err("error: wrong code point from UCPTRIE_FAST_U16_PREV(%s): U+%04lx != U+%04lx\n",
+                    testName, (long)c, (long)c2);
+            return;
+        }
+    }
+}
+
+static void
+testTrieUTF8(const char *testName,
+             const UCPTrie *trie, UCPTrieValueWidth valueWidth,
+             const CheckRange checkRanges[], int32_t countCheckRanges) {
+    // Any sequence that is not a prefix of a valid one
+    // is treated as multiple single-byte errors.
+    // For testing, we only rely on U8_... and UCPTrie UTF-8 macros
+    // iterating consistently.
+    static const uint8_t illegal[]={
+        0xc0, 0x80,                         /* non-shortest U+0000 */
+        0xc1, 0xbf,                         /* non-shortest U+007f */
+        0xc2,                               /* truncated */
+        0xe0, 0x90, 0x80,                   /* non-shortest U+0400 */
+        0xe0, 0xa0,                         /* truncated */
+        0xed, 0xa0, 0x80,                   /* lead surrogate U+d800 */
+        0xed, 0xbf, 0xbf,                   /* trail surrogate U+dfff */
+        0xf0, 0x8f, 0xbf, 0xbf,             /* non-shortest U+ffff */
+        0xf0, 0x90, 0x80,                   /* truncated */
+        0xf4, 0x90, 0x80, 0x80,             /* beyond-Unicode U+110000 */
+        0xf8, 0x80, 0x80, 0x80,             /* truncated */
+        0xf8, 0x80, 0x80, 0x80, 0x80,       /* 5-byte UTF-8 */
+        0xfd, 0xbf, 0xbf, 0xbf, 0xbf,       /* truncated */
+        0xfd, 0xbf, 0xbf, 0xbf, 0xbf, 0xbf, /* 6-byte UTF-8 */
+        0xfe,
+        0xff
+    };
+    uint8_t s[800];
+    uint32_t values[400];
+
+    const uint8_t *p, *limit;
+
+    uint32_t initialValue, errorValue;
+    uint32_t value, bytes, expected;
+    UChar32 prevCP, c;
+    int32_t i, countSpecials, length, countValues;
+    int32_t prev8, i8;
+    uint32_t mask=getValueMask(valueWidth);
+
+    countSpecials=getSpecialValues(checkRanges, countCheckRanges, &initialValue, &errorValue);
+
+    /* write a string */
+    prevCP=0;
+    length=0;
+    /* first a couple of trail bytes in lead position */
+    s[length++]=0x80;
+    s[length++]=0xbf;
+    prev8=i8=0;
+    for(i=countSpecials; i<countCheckRanges; ++i) {
+        /* write three legal (or surrogate) code points */
+        U8_APPEND_UNSAFE(s, length, prevCP);    /* start of the range */
+        c=checkRanges[i].limit;
+        prevCP=(prevCP+c)/2;                    /* middle of the range */
+        U8_APPEND_UNSAFE(s, length, prevCP);
+        prevCP=c;
+        --c;                                    /* end of the range */
+        U8_APPEND_UNSAFE(s, length, c);
+        /* write an illegal byte sequence */
+        if(i8<(int32_t)sizeof(illegal)) {
+            U8_FWD_1(illegal, i8, sizeof(illegal));
+            while(prev8<i8) {
+                s[length++]=illegal[prev8++];
+            }
+        }
+    }
+    /* write the remaining illegal byte sequences */
+    while(i8<(int32_t)sizeof(illegal)) {
+        U8_FWD_1(illegal, i8, sizeof(illegal));
+        while(prev8<i8) {
+            s[length++]=illegal[prev8++];
+        }
+    }
+    limit=s+length;
+
+    /* try forward, and remember the values for backward iteration */
+    p=s;
+    countValues=0;
+    while(p<limit) {
+        prev8=i8=(int32_t)(p-s);
+        U8_NEXT(s, i8, length, c);
+        /* c<0 for an ill-formed sequence, including a surrogate */
+        expected=getExpectedValue(checkRanges, countCheckRanges, c)&mask;
+        if(valueWidth==UCPTRIE_VALUE_BITS_16) {
+            UCPTRIE_FAST_U8_NEXT(trie, UCPTRIE_16, p, limit, value);
+        } else if(valueWidth==UCPTRIE_VALUE_BITS_32) {
+            UCPTRIE_FAST_U8_NEXT(trie, UCPTRIE_32, p, limit, value);
+        } else {
+            UCPTRIE_FAST_U8_NEXT(trie, UCPTRIE_8, p, limit, value);
+        }
+        bytes=0;
+        if(value!=expected || i8!=(p-s)) {
+            int32_t k=prev8;
+            while(k<i8) {
+                bytes=(bytes<<8)|s[k++];
+            }
+        }
+        if(value!=expected) {
+            log_err("error: wrong value from UCPTRIE_FAST_U8_NEXT(%s)(from %d %lx->U+%04lx) (read %d bytes): "
+                    "0x%lx instead of 0x%lx\n",
+                    testName, (int)prev8, (unsigned long)bytes, (long)c, (int)((p-s)-prev8),
+                    (long)value, (long)expected);
+        }
+        if(i8!=(p-s)) {
+            log_err("error: wrong end index from UCPTRIE_FAST_U8_NEXT(%s)(from %d %lx->U+%04lx): %ld != %ld\n",
+                    testName, (int)prev8, (unsigned long)bytes, (long)c, (long)(p-s), (long)i8);
+            return;
+        }
+        values[countValues++]=expected;
+    }
+
+    /* try backward */
+    p=limit;
+    i=countValues;
+    while(s<p) {
+        --i;
+        prev8=i8=(int32_t)(p-s);
+        U8_PREV(s, 0, i8, c);
+        if(valueWidth==UCPTRIE_VALUE_BITS_16) {
+            UCPTRIE_FAST_U8_PREV(trie, UCPTRIE_16, s, p, value);
+        } else if(valueWidth==UCPTRIE_VALUE_BITS_32) {
+            UCPTRIE_FAST_U8_PREV(trie, UCPTRIE_32, s, p, value);
+        } else {
+            UCPTRIE_FAST_U8_PREV(trie, UCPTRIE_8, s, p, value);
+        }
+        bytes=0;
+        if(value!=values[i] || i8!=(p-s)) {
+            int32_t k=i8;
+            while(k<prev8) {
+                bytes=(bytes<<8)|s[k++];
+            }
+        }
+        if(value!=values[i]) {
+            log_err("error: wrong value from UCPTRIE_FAST_U8_PREV(%s)(from %d %lx->U+%04lx) (read %d bytes): "
+                    ": 0x%lx instead of 0x%lx\n",
+                    testName, (int)prev8, (unsigned long)bytes, (long)c, (int)(prev8-(p-s)),
+                    (long)value, (long)values[i]);
+        }
+        if(i8!=(p-s)) {
+            log_err("error: wrong end index from UCPTRIE_FAST_U8_PREV(%s)(from %d %lx->U+%04lx): %ld != %ld\n",
+                    testName, (int)prev8, (unsigned long)bytes, (long)c, (long)(p-s), (long)i8);
+            return;
+        }
+    }
+}
+
+static void
+testTrie(const char *testName, const UCPTrie *trie,
+         UCPTrieType type, UCPTrieValueWidth valueWidth,
+         const CheckRange checkRanges[], int32_t countCheckRanges) {
+    uint32_t mask=getValueMask(valueWidth);
+    testTrieGetters(testName, trie, type, valueWidth, checkRanges, countCheckRanges);
+    testTrieGetRanges(testName, trie, NULL, mask, FALSE, checkRanges, countCheckRanges);
+    testTrieGetRanges(testName, trie, NULL, mask, TRUE, checkRanges, countCheckRanges);
+    if(type==UCPTRIE_TYPE_FAST) {
+        testTrieUTF16(testName, trie, valueWidth, checkRanges, countCheckRanges);
+        testTrieUTF8(testName, trie, valueWidth, checkRanges, countCheckRanges);
+    }
+}
+
+static void
+testTrieSerialize(const char *testName, const UCPTrie *trie,
+                  UCPTrieType type, UCPTrieValueWidth valueWidth,
+                  const CheckRange checkRanges[], int32_t countCheckRanges) {
+    uint32_t storage[10000];
+    int32_t length1, length2, length3;
+    UCPTrie *trie2;
+    UMutableCPTrie *mutableTrie;
+    UErrorCode errorCode;
+
+    /* preflight */
+    errorCode=U_ZERO_ERROR;
+    length1=ucptrie_toBinary(trie, NULL, 0, &errorCode);
+    if(errorCode!=U_BUFFER_OVERFLOW_ERROR) {
+        log_err("error: ucptrie_toBinary(%s) preflighting set %s != U_BUFFER_OVERFLOW_ERROR\n",
+                testName, u_errorName(errorCode));
+        return;
+    }
+    if(length1>(int32_t)sizeof(storage)) {
+        log_err("error: ucptrie_toBinary(%s) needs %ld bytes, more than the test buffer\n",
+                testName, (long)length1);
+        return;
+    }
+    errorCode=U_ZERO_ERROR;
+    length2=ucptrie_toBinary(trie, storage, sizeof(storage), &errorCode);
+    if(U_FAILURE(errorCode) || length2!=length1 || (length1&3)!=0) {
+        log_err("error: ucptrie_toBinary(%s) failed: %s, length %ld (preflighting %ld)\n",
+                testName, u_errorName(errorCode), (long)length2, (long)length1);
+        return;
+    }
+
+    /* the type and value width must match unless ANY */
+    errorCode=U_ZERO_ERROR;
+    trie2=ucptrie_openFromBinary(type==UCPTRIE_TYPE_FAST ? UCPTRIE_TYPE_SMALL : UCPTRIE_TYPE_FAST,
+                                 UCPTRIE_VALUE_BITS_ANY, storage, length2, NULL, &errorCode);
+    if(errorCode!=U_INVALID_FORMAT_ERROR) {
+        log_err("error: ucptrie_openFromBinary(%s, wrong type) did not fail with U_INVALID_FORMAT_ERROR: %s\n",
+                testName, u_errorName(errorCode));
+        ucptrie_close(trie2);
+    }
+    errorCode=U_ZERO_ERROR;
+    trie2=ucptrie_openFromBinary(UCPTRIE_TYPE_ANY, UCPTRIE_VALUE_BITS_ANY, storage, length2-4,
+                                 NULL, &errorCode);
+    if(errorCode!=U_INVALID_FORMAT_ERROR) {
+        log_err("error: ucptrie_openFromBinary(%s, too short) did not fail with U_INVALID_FORMAT_ERROR: %s\n",
+                testName, u_errorName(errorCode));
+        ucptrie_close(trie2);
+    }
+
+    errorCode=U_ZERO_ERROR;
+    trie2=ucptrie_openFromBinary(UCPTRIE_TYPE_ANY, UCPTRIE_VALUE_BITS_ANY, storage, sizeof(storage),
+                                 &length3, &errorCode);
+    if(U_FAILURE(errorCode)) {
+        log_err("error: ucptrie_openFromBinary(%s) failed, %s\n", testName, u_errorName(errorCode));
+        return;
+    }
+    if(ucptrie_getType(trie2)!=type || ucptrie_getValueWidth(trie2)!=valueWidth) {
+        log_err("error: ucptrie_openFromBinary(%s) type/valueWidth mismatch\n", testName);
+    } else if(length3!=length2) {
+        log_err("error: ucptrie_openFromBinary(%s) actual length %ld != serialized length %ld\n",
+                testName, (long)length3, (long)length2);
+    } else {
+        testTrie(testName, trie2, type, valueWidth, checkRanges, countCheckRanges);
+    }
+
+    /* round-trip through a mutable trie */
+    errorCode=U_ZERO_ERROR;
+    mutableTrie=umutablecptrie_fromUCPTrie(trie2, &errorCode);
+    ucptrie_close(trie2);
+    if(U_FAILURE(errorCode)) {
+        log_err("error: umutablecptrie_fromUCPTrie(%s) failed - %s\n", testName, u_errorName(errorCode));
+        return;
+    }
+    testMutableTrieGetters(testName, mutableTrie, getValueMask(valueWidth),
+                           checkRanges, countCheckRanges);
+    trie2=umutablecptrie_buildImmutable(mutableTrie, type, valueWidth, &errorCode);
+    umutablecptrie_close(mutableTrie);
+    if(U_FAILURE(errorCode)) {
+        log_err("error: umutablecptrie_buildImmutable(%s) from UCPTrie failed - %s\n",
+                testName, u_errorName(errorCode));
+        return;
+    }
+    errorCode=U_ZERO_ERROR;
+    length3=ucptrie_toBinary(trie2, NULL, 0, &errorCode);
+    if(length3!=length2) {
+        log_err("error: rebuilt trie (%s) serializes to %ld bytes instead of %ld\n",
+                testName, (long)length3, (long)length2);
+    }
+    ucptrie_close(trie2);
+}
+
+static UMutableCPTrie *
+makeTrieWithRanges(const char *testName, UBool withClone,
+                   const SetRange setRanges[], int32_t countSetRanges,
+                   const CheckRange checkRanges[], int32_t countCheckRanges) {
+    UMutableCPTrie *mutableTrie;
+    uint32_t initialValue, errorValue;
+    uint32_t value;
+    UChar32 start, limit;
+    int32_t i;
+    UErrorCode errorCode;
+
+    log_verbose("\ntesting Trie '%s'\n", testName);
+    errorCode=U_ZERO_ERROR;
+    getSpecialValues(checkRanges, countCheckRanges, &initialValue, &errorValue);
+    mutableTrie=umutablecptrie_open(initialValue, errorValue, &errorCode);
+    if(U_FAILURE(errorCode)) {
+        log_err("error: umutablecptrie_open(%s) failed: %s\n", testName, u_errorName(errorCode));
+        return NULL;
+    }
+
+    /* set values from setRanges[] */
+    for(i=0; i<countSetRanges; ++i) {
+        if(withClone && i==countSetRanges/2) {
+            /* switch to a clone in the middle of setting values */
+            UMutableCPTrie *clone=umutablecptrie_clone(mutableTrie, &errorCode);
+            if(U_FAILURE(errorCode)) {
+                log_err("error: umutablecptrie_clone(%s) failed - %s\n",
+                        testName, u_errorName(errorCode));
+                errorCode=U_ZERO_ERROR;  /* continue with the original */
+            } else {
+                umutablecptrie_close(mutableTrie);
+                mutableTrie=clone;
+            }
+        }
+        start=setRanges[i].start;
+        limit=setRanges[i].limit;
+        value=setRanges[i].value;
+        if((limit-start)==1) {
+            umutablecptrie_set(mutableTrie, start, value, &errorCode);
+        } else {
+            umutablecptrie_setRange(mutableTrie, start, limit-1, value, &errorCode);
+        }
+    }
+
+    if(U_SUCCESS(errorCode)) {
+        return mutableTrie;
+    } else {
+        log_err("error: setting values into a mutable trie (%s) failed - %s\n",
+                testName, u_errorName(errorCode));
+        umutablecptrie_close(mutableTrie);
+        return NULL;
+    }
+}
+
+static void
+testTrieRanges(const char *testName, UBool withClone,
+               const SetRange setRanges[], int32_t countSetRanges,
+               const CheckRange checkRanges[], int32_t countCheckRanges) {
+    UMutableCPTrie *mutableTrie=makeTrieWithRanges(testName, withClone,
+                                                   setRanges, countSetRanges,
+                                                   checkRanges, countCheckRanges);
+    int32_t typeInt, valueWidthInt;
+    if(mutableTrie==NULL) {
+        return;
+    }
+    testMutableTrieGetters(testName, mutableTrie, 0xffffffff, checkRanges, countCheckRanges);
+    testTrieGetRanges(testName, NULL, mutableTrie, 0xffffffff, FALSE, checkRanges, countCheckRanges);
+    testTrieGetRanges(testName, NULL, mutableTrie, 0xffffffff, TRUE, checkRanges, countCheckRanges);
+
+    /* build each type and value width from the same, unchanged mutable trie */
+    for(typeInt=UCPTRIE_TYPE_FAST; typeInt<=UCPTRIE_TYPE_SMALL; ++typeInt) {
+        for(valueWidthInt=UCPTRIE_VALUE_BITS_16; valueWidthInt<=UCPTRIE_VALUE_BITS_8; ++valueWidthInt) {
+            UCPTrieType type=(UCPTrieType)typeInt;
+            UCPTrieValueWidth valueWidth=(UCPTrieValueWidth)valueWidthInt;
+            char name[80];
+            UErrorCode errorCode=U_ZERO_ERROR;
+            UCPTrie *trie=umutablecptrie_buildImmutable(mutableTrie, type, valueWidth, &errorCode);
+            sprintf(name, "%s.%s.%s", testName, getTypeName(type), getValueWidthName(valueWidth));
+            if(U_FAILURE(errorCode)) {
+                log_err("error: umutablecptrie_buildImmutable(%s) failed - %s\n",
+                        name, u_errorName(errorCode));
+                continue;
+            }
+            testTrie(name, trie, type, valueWidth, checkRanges, countCheckRanges);
+            testTrieSerialize(name, trie, type, valueWidth, checkRanges, countCheckRanges);
+            ucptrie_close(trie);
+        }
+    }
+    umutablecptrie_close(mutableTrie);
+}
+
+/* test data ----------------------------------------------------------------*/
+
+/* set consecutive ranges, even with value 0 */
+static const SetRange
+setRanges1[]={
+    { 0,        0x40,     0      },
+    { 0x40,     0xe7,     0x34   },
+    { 0xe7,     0x3400,   0      },
+    { 0x3400,   0x9fa6,   0x61   },
+    { 0x9fa6,   0xda9e,   0x31   },
+    { 0xdada,   0xeeee,   0xff   },
+    { 0xeeee,   0x11111,  1      },
+    { 0x11111,  0x44444,  0x61   },
+    { 0x44444,  0x60003,  0      },
+    { 0xf0003,  0xf0004,  0xf    },
+    { 0xf0004,  0xf0006,  0x10   },
+    { 0xf0006,  0xf0007,  0x11   },
+    { 0xf0007,  0xf0040,  0x12   },
+    { 0xf0040,  0x110000, 0      }
+};
+
+static const CheckRange
+checkRanges1[]={
+    { 0,        0 },
+    { 0x40,     0 },
+    { 0xe7,     0x34 },
+    { 0x3400,   0 },
+    { 0x9fa6,   0x61 },
+    { 0xda9e,   0x31 },
+    { 0xdada,   0 },
+    { 0xeeee,   0xff },
+    { 0x11111,  1 },
+    { 0x44444,  0x61 },
+    { 0xf0003,  0 },
+    { 0xf0004,  0xf },
+    { 0xf0006,  0x10 },
+    { 0xf0007,  0x11 },
+    { 0xf0040,  0x12 },
+    { 0x110000, 0 }
+};
+
+/* set some interesting overlapping ranges */
+static const SetRange
+setRanges2[]={
+    { 0x21,     0x7f,     0x5555 },
+    { 0x2f800,  0x2fedc,  0x7a   },
+    { 0x72,     0xdd,     3      },
+    { 0xdd,     0xde,     4      },
+    { 0x201,    0x240,    6      },  /* 3 consecutive blocks with the same pattern but */
+    { 0x241,    0x280,    6      },  /* discontiguous value ranges, testing getRange() */
+    { 0x281,    0x2c0,    6      },
+    { 0x2f987,  0x2fa98,  5      },
+    { 0x2f777,  0x2f883,  0      },
+    { 0x2fedc,  0x2ffaa,  1      },
+    { 0x2ffaa,  0x2ffab,  2      },
+    { 0x2ffbb,  0x2ffc0,  7      }
+};
+
+static const CheckRange
+checkRanges2[]={
+    { 0,        0 },
+    { 0x21,     0 },
+    { 0x72,     0x5555 },
+    { 0xdd,     3 },
+    { 0xde,     4 },
+    { 0x201,    0 },
+    { 0x240,    6 },
+    { 0x241,    0 },
+    { 0x280,    6 },
+    { 0x281,    0 },
+    { 0x2c0,    6 },
+    { 0x2f883,  0 },
+    { 0x2f987,  0x7a },
+    { 0x2fa98,  5 },
+    { 0x2fedc,  0x7a },
+    { 0x2ffaa,  1 },
+    { 0x2ffab,  2 },
+    { 0x2ffbb,  0 },
+    { 0x2ffc0,  7 },
+    { 0x110000, 0 }
+};
+
+/* use a non-zero initial value */
+static const SetRange
+setRanges3[]={
+    { 0x31,     0xa4,     1 },
+    { 0x3400,   0x6789,   2 },
+    { 0x8000,   0x89ab,   9 },
+    { 0x9000,   0xa000,   4 },
+    { 0xabcd,   0xbcde,   3 },
+    { 0x55555,  0x110000, 6 },  /* highStart<U+ffff with non-initialValue */
+    { 0xcccc,   0x55555,  6 }
+};
+
+static const CheckRange
+checkRanges3[]={
+    { 0,        9 },  /* non-zero initialValue */
+    { 0x31,     9 },
+    { 0xa4,     1 },
+    { 0x3400,   9 },
+    { 0x6789,   2 },
+    { 0x9000,   9 },
+    { 0xa000,   4 },
+    { 0xabcd,   9 },
+    { 0xbcde,   3 },
+    { 0xcccc,   9 },
+    { 0x110000, 6 }
+};
+
+/* empty or single-value tries, testing highStart==fast limit */
+static const SetRange
+setRangesEmpty[]={
+    { 0,        0,        0 },  /* need some values for it to compile */
+};
+
+static const CheckRange
+checkRangesEmpty[]={
+    { 0,        3 },
+    { 0x110000, 3 }
+};
+
+static const SetRange
+setRangesSingleValue[]={
+    { 0,        0x110000, 5 },
+};
+
+static const CheckRange
+checkRangesSingleValue[]={
+    { -1,       0xdad },  /* non-default errorValue */
+    { 0,        3 },
+    { 0x110000, 5 }
+};
+
+/* values that differ in the low bits only after the value width truncation */
+static const SetRange
+setRangesWide[]={
+    { 0x80,     0x100,    0x12345678 },
+    { 0xd7ff,   0xe001,   0x1ffff    },
+    { 0x1f000,  0x1f100,  0xfedcba98 },
+    { 0x10fff0, 0x10fff1, 0x100      }
+};
+
+static const CheckRange
+checkRangesWide[]={
+    { -1,       0xbadbad },
+    { 0,        0x10000 },
+    { 0x80,     0x10000 },
+    { 0x100,    0x12345678 },
+    { 0xd7ff,   0x10000 },
+    { 0xe001,   0x1ffff },
+    { 0x1f000,  0x10000 },
+    { 0x1f100,  0xfedcba98 },
+    { 0x10fff0, 0x10000 },
+    { 0x10fff1, 0x100 },
+    { 0x110000, 0x10000 }
+};
+
+static void
+TrieTest(void) {
+    testTrieRanges("set1", FALSE,
+        setRanges1, UPRV_LENGTHOF(setRanges1),
+        checkRanges1, UPRV_LENGTHOF(checkRanges1));
+    testTrieRanges("set2-overlap", FALSE,
+        setRanges2, UPRV_LENGTHOF(setRanges2),
+        checkRanges2, UPRV_LENGTHOF(checkRanges2));
+    testTrieRanges("set3-initial-9", FALSE,
+        setRanges3, UPRV_LENGTHOF(setRanges3),
+        checkRanges3, UPRV_LENGTHOF(checkRanges3));
+    testTrieRanges("set-empty", FALSE,
+        setRangesEmpty, 0,
+        checkRangesEmpty, UPRV_LENGTHOF(checkRangesEmpty));
+    testTrieRanges("set-single-value", FALSE,
+        setRangesSingleValue, UPRV_LENGTHOF(setRangesSingleValue),
+        checkRangesSingleValue, UPRV_LENGTHOF(checkRangesSingleValue));
+    testTrieRanges("set-wide-values", FALSE,
+        setRangesWide, UPRV_LENGTHOF(setRangesWide),
+        checkRangesWide, UPRV_LENGTHOF(checkRangesWide));
+
+    testTrieRanges("set2-overlap.withClone", TRUE,
+        setRanges2, UPRV_LENGTHOF(setRanges2),
+        checkRanges2, UPRV_LENGTHOF(checkRanges2));
+}
+
+/* distinct values per code point need 18-bit data offsets, or exceed the data limit */
+static void
+ManyDataBlocksTest(void) {
+    UErrorCode errorCode=U_ZERO_ERROR;
+    UMutableCPTrie *mutableTrie=umutablecptrie_open(0, 0xad, &errorCode);
+    UCPTrie *trie;
+    UChar32 c;
+    if(U_FAILURE(errorCode)) {
+        log_err("error: umutablecptrie_open() failed: %s\n", u_errorName(errorCode));
+        return;
+    }
+    for(c=0x10000; c<0x30000; ++c) {
+        umutablecptrie_set(mutableTrie, c, (uint32_t)c, &errorCode);
+    }
+    trie=umutablecptrie_buildImmutable(mutableTrie, UCPTRIE_TYPE_FAST, UCPTRIE_VALUE_BITS_32, &errorCode);
+    if(U_FAILURE(errorCode)) {
+        log_err("error: umutablecptrie_buildImmutable(18-bit data offsets) failed: %s\n",
+                u_errorName(errorCode));
+    } else {
+        for(c=0; c<=0x10ffff; ++c) {
+            uint32_t expected= (0x10000<=c && c<0x30000) ? (uint32_t)c : 0;
+            uint32_t value=UCPTRIE_FAST_GET(trie, UCPTRIE_32, c);
+            if(value!=expected || ucptrie_get(trie, c)!=expected) {
+                log_err("error: 18-bit data offsets trie get(U+%04lx)==0x%lx instead of 0x%lx\n",
+                        (long)c, (long)value, (long)expected);
+                break;
+            }
+        }
+        if(ucptrie_getRange(trie, 0x30000, NULL, NULL, NULL)!=0x10ffff) {
+            log_err("error: 18-bit data offsets trie getRange(U+30000) did not return U+10FFFF\n");
+        }
+        ucptrie_close(trie);
+    }
+
+    /* too many distinct values for 18-bit data offsets */
+    umutablecptrie_setRange(mutableTrie, 0, 0x10ffff, 0, &errorCode);
+    for(c=0; c<=0x10ffff; ++c) {
+        umutablecptrie_set(mutableTrie, c, (uint32_t)c, &errorCode);
+    }
+    trie=umutablecptrie_buildImmutable(mutableTrie, UCPTRIE_TYPE_SMALL, UCPTRIE_VALUE_BITS_32, &errorCode);
+    if(errorCode!=U_INDEX_OUTOFBOUNDS_ERROR) {
+        log_err("error: umutablecptrie_buildImmutable(too many distinct values) "
+                "did not fail with U_INDEX_OUTOFBOUNDS_ERROR: %s\n", u_errorName(errorCode));
+    }
+    ucptrie_close(trie);
+    umutablecptrie_close(mutableTrie);
+}
+
+void
+addUCPTrieTest(TestNode** root) {
+    addTest(root, &TrieTest, "tsutil/ucptrietest/TrieTest");
+    addTest(root, &ManyDataBlocksTest, "tsutil/ucptrietest/ManyDataBlocksTest");
+}
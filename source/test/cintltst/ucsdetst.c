@@ -29,6 +29,7 @@ static void TestC1Bytes(void);
 static void TestInputFilter(void);
 static void TestChaining(void);
 static void TestBufferOverflow(void);
+static void TestSampleLength(void);
 static void TestIBM424(void);
 static void TestIBM420(void);
 
@@ -43,6 +44,7 @@ void addUCsdetTest(TestNode** root)
     addTest(root, &TestInputFilter, "ucsdetst/TestInputFilter");
     addTest(root, &TestChaining, "ucsdetst/TestErrorChaining");
     addTest(root, &TestBufferOverflow, "ucsdetst/TestBufferOverflow");
+    addTest(root, &TestSampleLength, "ucsdetst/TestSampleLength");
 #if !UCONFIG_NO_LEGACY_CONVERSION
     addTest(root, &TestIBM424, "ucsdetst/TestIBM424");
     addTest(root, &TestIBM420, "ucsdetst/TestIBM420");
@@ -426,6 +428,80 @@ bail:
     ucsdet_close(csd);
 }
 
+static int32_t getMatchConfidence(const UCharsetMatch **matches, int32_t count, const char *name)
+{
+    UErrorCode status = U_ZERO_ERROR;
+    int32_t i;
+
+    for (i = 0; i < count; i += 1) {
+        if (strcmp(ucsdet_getName(matches[i], &status), name) == 0) {
+            return ucsdet_getConfidence(matches[i], &status);
+        }
+    }
+    return 0;
+}
+
+static void TestSampleLength(void)
+{
+    UErrorCode status = U_ZERO_ERROR;
+    UCharsetDetector *csd = ucsdet_open(&status);
+    UCharsetDetector *csdAll = ucsdet_open(&status);
+    const UCharsetMatch *match;
+    const UCharsetMatch **matches;
+    char bytes[2010];
+    int32_t i, count, countAll, confidence;
+
+    /* valid UTF-8 followed by some bytes that are never valid in UTF-8 */
+    for (i = 0; i < 2000; i += 6) {
+        memcpy(bytes + i, "caf\xc3\xa9 ", 6);
+    }
+    memset(bytes + 2000, 0xff, 10);
+
+    ucsdet_setText(csd, bytes, sizeof(bytes), &status);
+    ucsdet_setText(csdAll, bytes, sizeof(bytes), &status);
+    matches = ucsdet_detectAll(csd, &count, &status);
+    if (U_FAILURE(status)) {
+        log_err("ucsdet_detectAll() failed - %s\n", u_errorName(status));
+        goto bail;
+    }
+    confidence = getMatchConfidence(matches, count, "UTF-8");
+    if (confidence <= 0 || confidence >= 100) {
+        log_err("UTF-8 with invalid bytes at the end got confidence %d\n", (int)confidence);
+    }
+
+    /* the sample excludes the invalid bytes */
+    ucsdet_setSampleLength(csd, 1000, &status);
+    ucsdet_setSampleLength(csdAll, 1000, &status);
+    match = ucsdet_detect(csd, &status);
+    if (U_FAILURE(status) || match == NULL ||
+            strcmp(ucsdet_getName(match, &status), "UTF-8") != 0 ||
+            ucsdet_getConfidence(match, &status) != 100) {
+        log_err("sampled detection did not find UTF-8 with confidence 100 - %s\n", u_errorName(status));
+        goto bail;
+    }
+
+    /* detect() may stop at a certain match; detectAll() must still run all recognizers */
+    matches = ucsdet_detectAll(csd, &count, &status);
+    ucsdet_detectAll(csdAll, &countAll, &status);
+    if (U_FAILURE(status) || count != countAll || count < 2) {
+        log_err("ucsdet_detectAll() after ucsdet_detect() found %d matches, expected %d - %s\n",
+                (int)count, (int)countAll, u_errorName(status));
+    } else if (strcmp(ucsdet_getName(matches[0], &status), "UTF-8") != 0) {
+        log_err("ucsdet_detectAll() after ucsdet_detect() changed the best match\n");
+    }
+
+    /* 0 examines all of the input again */
+    ucsdet_setSampleLength(csd, 0, &status);
+    matches = ucsdet_detectAll(csd, &count, &status);
+    if (getMatchConfidence(matches, count, "UTF-8") != confidence) {
+        log_err("ucsdet_setSampleLength(0) did not restore detection of the whole input\n");
+    }
+
+bail:
+    ucsdet_close(csdAll);
+    ucsdet_close(csd);
+}
+
 static void TestIBM424(void)
 {
     UErrorCode status = U_ZERO_ERROR;
@@ -27,6 +27,7 @@
 #include "sharedobject.h"
 #include "unifiedcache.h"
 #include "uassert.h"
+#include "ustr_cnv.h"
 
 
 #define TSMTHREAD_FAIL(msg) errln("%s at file %s, line %d", msg, __FILE__, __LINE__)
@@ -74,6 +75,9 @@ void MultithreadTest::runIndexedTest( int32_t index, UBool exec,
     TESTCASE_AUTO(TestCollators);
 #endif /* #if !UCONFIG_NO_COLLATION */
     TESTCASE_AUTO(TestString);
+    TESTCASE_AUTO(TestDefaultConverter);
+    TESTCASE_AUTO(TestSharedConverterData);
+    TESTCASE_AUTO(TestConverterShared);
     TESTCASE_AUTO(TestArabicShapingThreads);
     TESTCASE_AUTO(TestAnyTranslit);
     TESTCASE_AUTO(TestConditionVariables);
@@ -1121,6 +1125,251 @@ void MultithreadTest::TestString()
 }
 
 
+//-------------------------------------------------------------------------------------------
+//
+//   DefaultConverterThread
+//      Stress test for the cache of default converters used by
+//      UnicodeString(const char *) and extract(), u_uastrcpy() etc.
+//      Run with -v to see the time per get/convert/release.
+//
+//-------------------------------------------------------------------------------------------
+
+#if !UCONFIG_NO_CONVERSION
+const int kDefaultConverterIterations = 20000;
+const int kDefaultConverterThreads    = 8;
+
+class DefaultConverterThread : public SimpleThread
+{
+public:
+    int fNum;
+
+    DefaultConverterThread() : SimpleThread(), fNum(0) {}
+
+    virtual void run()
+    {
+        static const char text[] = "Default converter stress test 0123456789";
+        UChar u[64];
+        char s[64];
+
+        for (int i = 0; i < kDefaultConverterIterations; ++i) {
+            UErrorCode status = U_ZERO_ERROR;
+            UConverter *cnv = u_getDefaultConverter(&status);
+            if (U_FAILURE(status) || cnv == NULL) {
+                IntlTest::gTest->dataerrln("%s:%d u_getDefaultConverter() failed - %s",
+                                           __FILE__, __LINE__, u_errorName(status));
+                return;
+            }
+            int32_t length = ucnv_toUChars(cnv, u, UPRV_LENGTHOF(u), text, -1, &status);
+            length = ucnv_fromUChars(cnv, s, UPRV_LENGTHOF(s), u, length, &status);
+            u_releaseDefaultConverter(cnv);
+            if (U_FAILURE(status) || length != (int32_t)uprv_strlen(text) || uprv_strcmp(s, text) != 0) {
+                IntlTest::gTest->errln("%s:%d default converter roundtrip failed - %s",
+                                       __FILE__, __LINE__, u_errorName(status));
+                return;
+            }
+            // the u_ functions get and release the default converter themselves
+            u_uastrcpy(u, text);
+            if (uprv_strcmp(u_austrcpy(s, u), text) != 0) {
+                IntlTest::gTest->errln("%s:%d u_uastrcpy()/u_austrcpy() roundtrip failed",
+                                       __FILE__, __LINE__);
+                return;
+            }
+            if (fNum == 0 && (i % 1000) == 999) {
+                // concurrent with the other threads, as when the default name changes
+                u_flushDefaultConverter();
+            }
+        }
+    }
+};
+#endif
+
+void MultithreadTest::TestDefaultConverter()
+{
+#if !UCONFIG_NO_CONVERSION
+    DefaultConverterThread threads[kDefaultConverterThreads];
+    int j;
+
+    UDate start = uprv_getRawUTCtime();
+    for (j = 0; j < kDefaultConverterThreads; j++) {
+        threads[j].fNum = j;
+        int32_t threadStatus = threads[j].start();
+        if (threadStatus != 0) {
+            errln("%s:%d System Error %d starting thread number %d.", __FILE__, __LINE__, threadStatus, j);
+        }
+    }
+    for (j = 0; j < kDefaultConverterThreads; j++) {
+        threads[j].join();
+    }
+    UDate elapsed = uprv_getRawUTCtime() - start;
+    logln("%d threads * %d iterations: %.0f ms, %.3f us per iteration and thread",
+          kDefaultConverterThreads, kDefaultConverterIterations, elapsed,
+          (elapsed * 1000.0) / ((double)kDefaultConverterThreads * kDefaultConverterIterations));
+    u_flushDefaultConverter();
+#endif
+}
+
+
+//-------------------------------------------------------------------------------------------
+//
+//   SharedConverterDataThread
+//
+//     Opens, clones and closes data-based converters while one thread
+//     flushes the shared data cache, exercising the reference counting
+//     of UConverterSharedData.
+//
+//-------------------------------------------------------------------------------------------
+
+#if !UCONFIG_NO_CONVERSION
+const int kSharedConverterDataIterations = 5000;
+const int kSharedConverterDataThreads    = 8;
+
+class SharedConverterDataThread : public SimpleThread
+{
+public:
+    int fNum;
+
+    SharedConverterDataThread() : SimpleThread(), fNum(0) {}
+
+    virtual void run()
+    {
+        static const char *const names[] = { "ibm-1047", "windows-1252", "Shift_JIS", "ibm-1047,swaplfnl" };
+        static const char text[] = "Shared data stress test 0123456789";
+        UChar u[64];
+        char s[64];
+
+        for (int i = 0; i < kSharedConverterDataIterations; ++i) {
+            UErrorCode status = U_ZERO_ERROR;
+            UConverter *cnv = ucnv_open(names[(fNum + i) % UPRV_LENGTHOF(names)], &status);
+            UConverter *clone = ucnv_safeClone(cnv, NULL, NULL, &status);
+            ucnv_close(cnv);
+            if (U_FAILURE(status)) {
+                IntlTest::gTest->dataerrln("%s:%d ucnv_open()/ucnv_safeClone() failed - %s",
+                                           __FILE__, __LINE__, u_errorName(status));
+                ucnv_close(clone);
+                return;
+            }
+            int32_t length = ucnv_toUChars(clone, u, UPRV_LENGTHOF(u), text, -1, &status);
+            length = ucnv_fromUChars(clone, s, UPRV_LENGTHOF(s), u, length, &status);
+            ucnv_close(clone);
+            if (U_FAILURE(status) || length != (int32_t)uprv_strlen(text) || uprv_strcmp(s, text) != 0) {
+                IntlTest::gTest->errln("%s:%d converter roundtrip failed - %s",
+                                       __FILE__, __LINE__, u_errorName(status));
+                return;
+            }
+            if (fNum == 0 && (i % 100) == 99) {
+                ucnv_flushCache();
+            }
+        }
+    }
+};
+#endif
+
+void MultithreadTest::TestSharedConverterData()
+{
+#if !UCONFIG_NO_CONVERSION
+    SharedConverterDataThread threads[kSharedConverterDataThreads];
+    int j;
+
+    UDate start = uprv_getRawUTCtime();
+    for (j = 0; j < kSharedConverterDataThreads; j++) {
+        threads[j].fNum = j;
+        int32_t threadStatus = threads[j].start();
+        if (threadStatus != 0) {
+            errln("%s:%d System Error %d starting thread number %d.", __FILE__, __LINE__, threadStatus, j);
+        }
+    }
+    for (j = 0; j < kSharedConverterDataThreads; j++) {
+        threads[j].join();
+    }
+    UDate elapsed = uprv_getRawUTCtime() - start;
+    logln("%d threads * %d iterations: %.0f ms, %.3f us per iteration and thread",
+          kSharedConverterDataThreads, kSharedConverterDataIterations, elapsed,
+          (elapsed * 1000.0) / ((double)kSharedConverterDataThreads * kSharedConverterDataIterations));
+    // all converters are closed, so the cache must be flushed completely
+    ucnv_flushCache();
+    UErrorCode status = U_ZERO_ERROR;
+    UConverter *cnv = ucnv_open("ibm-1047", &status);
+    ucnv_close(cnv);
+    if (U_SUCCESS(status) && ucnv_flushCache() != 1) {
+        errln("%s:%d ucnv_flushCache() after ucnv_close() did not unload ibm-1047 - reference count leaked",
+              __FILE__, __LINE__);
+    }
+#endif
+}
+
+//-------------------------------------------------------------------------------------------
+//
+//   ConverterSharedThread
+//
+//     All threads convert with the same UConverterShared objects,
+//     a stateless one and a stateful one.
+//
+//-------------------------------------------------------------------------------------------
+
+#if !UCONFIG_NO_LEGACY_CONVERSION
+const int kConverterSharedIterations = 2000;
+const int kConverterSharedThreads    = 8;
+
+static UConverterShared *gConverterShared[2];
+
+class ConverterSharedThread : public SimpleThread
+{
+public:
+    int fNum;
+
+    ConverterSharedThread() : SimpleThread(), fNum(0) {}
+
+    virtual void run()
+    {
+        static const UChar text[] = { 0x61, 0x3042, 0x4e9c, 0x62, 0x4e00, 0x63 };
+        UChar u[16];
+        char s[32];
+
+        for (int i = 0; i < kConverterSharedIterations; ++i) {
+            UErrorCode status = U_ZERO_ERROR;
+            const UConverterShared *shared = gConverterShared[(fNum + i) % 2];
+            int32_t length = ucnv_fromUCharsShared(shared, UCNV_INVALID_STOP, s, UPRV_LENGTHOF(s),
+                                                   text, UPRV_LENGTHOF(text), &status);
+            length = ucnv_toUCharsShared(shared, UCNV_INVALID_STOP, u, UPRV_LENGTHOF(u), s, length, &status);
+            if (U_FAILURE(status) || length != UPRV_LENGTHOF(text) || u_memcmp(u, text, length) != 0) {
+                IntlTest::gTest->errln("%s:%d shared converter roundtrip failed - %s",
+                                       __FILE__, __LINE__, u_errorName(status));
+                return;
+            }
+        }
+    }
+};
+#endif
+
+void MultithreadTest::TestConverterShared()
+{
+#if !UCONFIG_NO_LEGACY_CONVERSION
+    UErrorCode status = U_ZERO_ERROR;
+    LocalUConverterSharedPointer sjis(ucnv_openShared("Shift_JIS", &status));
+    LocalUConverterSharedPointer jis(ucnv_openShared("ISO-2022-JP", &status));
+    if (U_FAILURE(status)) {
+        dataerrln("%s:%d ucnv_openShared() failed - %s", __FILE__, __LINE__, u_errorName(status));
+        return;
+    }
+    gConverterShared[0] = sjis.getAlias();
+    gConverterShared[1] = jis.getAlias();
+
+    ConverterSharedThread threads[kConverterSharedThreads];
+    int j;
+    for (j = 0; j < kConverterSharedThreads; j++) {
+        threads[j].fNum = j;
+        int32_t threadStatus = threads[j].start();
+        if (threadStatus != 0) {
+            errln("%s:%d System Error %d starting thread number %d.", __FILE__, __LINE__, threadStatus, j);
+        }
+    }
+    for (j = 0; j < kConverterSharedThreads; j++) {
+        threads[j].join();
+    }
+    gConverterShared[0] = gConverterShared[1] = NULL;
+#endif
+}
+
 //
 // Test for ticket #10673, race in cache code in AnyTransliterator.
 // It's difficult to make the original unsafe code actually fail, but
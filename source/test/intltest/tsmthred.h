@@ -48,6 +48,9 @@ public:
 #endif
     void TestCollators(void);
     void TestString();
+    void TestDefaultConverter();
+    void TestSharedConverterData();
+    void TestConverterShared();
     void TestAnyTranslit();
     void TestConditionVariables();
     void TestUnifiedCache();
@@ -20,6 +20,7 @@
 #include "unicode/uniset.h"
 #include "unicode/uchar.h"
 #include "unicode/usetiter.h"
+#include "unicode/uscript.h"
 #include "unicode/ustring.h"
 #include "unicode/parsepos.h"
 #include "unicode/symtable.h"
@@ -28,6 +29,7 @@
 #include "unicode/uversion.h"
 #include "cmemory.h"
 #include "hash.h"
+#include "sharedunicodeset.h"
 
 #define TEST_ASSERT_SUCCESS(status) {if (U_FAILURE(status)) { \
     dataerrln("fail in file \"%s\", line %d: \"%s\"", __FILE__, __LINE__, \
@@ -92,6 +94,10 @@ UnicodeSetTest::runIndexedTest(int32_t index, UBool exec,
     TESTCASE_AUTO(TestIntOverflow);
     TESTCASE_AUTO(TestUnusedCcc);
     TESTCASE_AUTO(TestDeepPattern);
+    TESTCASE_AUTO(TestFrozenTrie);
+    TESTCASE_AUTO(TestFrozenASCIISpan);
+    TESTCASE_AUTO(TestStringSpanAutomaton);
+    TESTCASE_AUTO(TestSharedUnicodeSetCache);
     TESTCASE_AUTO_END;
 }
 
@@ -3978,3 +3984,308 @@ void UnicodeSetTest::TestDeepPattern() {
     assertTrue("[a[a[a...1000s...]]] -> error", errorCode.isFailure());
     errorCode.reset();
 }
+
+void UnicodeSetTest::TestFrozenTrie() {
+    // Frozen sets with long inversion lists above U+07FF look up
+    // mixed BMP blocks and supplementary code points in a bit trie.
+    IcuTestErrorCode errorCode(*this, "TestFrozenTrie");
+    UnicodeSet many;
+    for (UChar32 c = 0x1f000; c < 0x1f800; c += 3) {
+        many.add(c);
+    }
+    many.add(0x800, 0x9ff).add(0xfffd).add(0x10fffe, 0x10ffff).add(0x20000, 0x2a6df);
+    static const char16_t *const patterns[] = {
+        u"[:L:]", u"[:Han:]", u"[[:^Cn:]-[:Co:]]", u"[:Emoji:]", u"[:Lu:]"
+    };
+    for (int32_t i = 0; i <= UPRV_LENGTHOF(patterns); ++i) {
+        UnicodeSet thawed;
+        if (i < UPRV_LENGTHOF(patterns)) {
+            thawed.applyPattern(UnicodeString(patterns[i]), errorCode);
+            if (errorCode.logIfFailureAndReset("UnicodeSet(%d)", (int)i)) {
+                continue;
+            }
+        } else {
+            thawed = many;
+        }
+        UnicodeSet frozen(thawed);
+        frozen.freeze();
+        UnicodeSet frozenCopy(frozen);  // copies the frozen lookup data
+        UnicodeString s;
+        for (UChar32 c = 0; c <= 0x10ffff; ++c) {
+            UBool expected = thawed.contains(c);
+            if (frozen.contains(c) != expected || frozenCopy.contains(c) != expected) {
+                errln("set %d: frozen contains(U+%04lx) != %d", (int)i, (long)c, expected);
+                break;
+            }
+            if ((c & 0x1ff) == 0x17 || (0x1f000 <= c && c < 0x1f100)) {
+                s.append(c);
+            }
+        }
+        std::string s8;
+        s.toUTF8String(s8);
+        for (int32_t j = 0; j < 2; ++j) {
+            USetSpanCondition spanCondition = j == 0 ? USET_SPAN_NOT_CONTAINED : USET_SPAN_CONTAINED;
+            int32_t start = 0, start8 = 0;
+            while (start < s.length()) {
+                int32_t expected = thawed.span(s.getBuffer() + start, s.length() - start, spanCondition);
+                int32_t actual = frozen.span(s.getBuffer() + start, s.length() - start, spanCondition);
+                int32_t expected8 = thawed.spanUTF8(s8.data() + start8, (int32_t)s8.length() - start8, spanCondition);
+                int32_t actual8 = frozenCopy.spanUTF8(s8.data() + start8, (int32_t)s8.length() - start8, spanCondition);
+                if (actual != expected || actual8 != expected8) {
+                    errln("set %d: frozen span(%d) %d/%d != %d/%d", (int)i, (int)start,
+                          (int)actual, (int)actual8, (int)expected, (int)expected8);
+                    break;
+                }
+                start += expected;
+                start8 += expected8;
+                spanCondition = spanCondition == USET_SPAN_NOT_CONTAINED ? USET_SPAN_CONTAINED : USET_SPAN_NOT_CONTAINED;
+            }
+            int32_t limit = s.length();
+            while (limit > 0) {
+                int32_t expected = thawed.spanBack(s.getBuffer(), limit, spanCondition);
+                int32_t actual = frozen.spanBack(s.getBuffer(), limit, spanCondition);
+                if (actual != expected) {
+                    errln("set %d: frozen spanBack(%d) %d != %d", (int)i, (int)limit, (int)actual, (int)expected);
+                    break;
+                }
+                limit = expected;
+                spanCondition = spanCondition == USET_SPAN_NOT_CONTAINED ? USET_SPAN_CONTAINED : USET_SPAN_NOT_CONTAINED;
+            }
+        }
+    }
+}
+
+void UnicodeSetTest::TestFrozenASCIISpan() {
+    // Frozen sets span runs of ASCII 16 code units at a time
+    // and continue with the per-character code at the first block with
+    // a non-ASCII unit or with a unit that ends the span.
+    IcuTestErrorCode errorCode(*this, "TestFrozenASCIISpan");
+    static const char16_t *const patterns[] = {
+        u"[\\ \\t-\\r]", u"[0-9A-Z_a-z]", u"[^<\\&]", u"[aeiou]", u"[\\u0000-\\u007f]",
+        u"[:L:]", u"[a-z\\u00e9]", u"[^a-z]"
+    };
+    static const char16_t *const pieces[] = {
+        u"The quick brown fox jumps over the lazy dog",
+        u"                                      ", u"\t\r\n", u"<a href=\"x\">&amp;</a>",
+        u"caf\u00e9", u"\u4e2d\u6587", u"\U0001F600", u"_0123456789_"
+    };
+    UnicodeString s;
+    uint32_t r = 1;
+    while (s.length() < 1500) {
+        r = r * 1103515245 + 12345;
+        const char16_t *piece = pieces[(r >> 16) % UPRV_LENGTHOF(pieces)];
+        for (int32_t n = ((r >> 8) & 3) + 1; n > 0; --n) {
+            s.append(piece);
+        }
+    }
+    std::string s8;
+    s.toUTF8String(s8);
+    for (int32_t i = 0; i < UPRV_LENGTHOF(patterns); ++i) {
+        UnicodeSet thawed(UnicodeString(patterns[i]), errorCode);
+        if (errorCode.logIfFailureAndReset("UnicodeSet(%d)", (int)i)) {
+            continue;
+        }
+        UnicodeSet frozen(thawed);
+        frozen.freeze();
+        UnicodeSet frozenCopy(frozen);  // copies the frozen lookup data
+        for (int32_t j = 0; j < 2; ++j) {
+            USetSpanCondition spanCondition = j == 0 ? USET_SPAN_NOT_CONTAINED : USET_SPAN_CONTAINED;
+            for (int32_t start = 0; start < s.length(); ++start) {
+                int32_t expected = thawed.span(s.getBuffer() + start, s.length() - start, spanCondition);
+                int32_t actual = frozen.span(s.getBuffer() + start, s.length() - start, spanCondition);
+                if (actual != expected) {
+                    errln("set %d: frozen span(%d, %d) %d != %d", (int)i, (int)start, (int)spanCondition,
+                          (int)actual, (int)expected);
+                    break;
+                }
+            }
+            for (int32_t start8 = 0; start8 < (int32_t)s8.length(); ++start8) {
+                if (U8_IS_TRAIL(s8[start8])) {
+                    continue;
+                }
+                int32_t expected8 = thawed.spanUTF8(s8.data() + start8, (int32_t)s8.length() - start8, spanCondition);
+                int32_t actual8 = frozenCopy.spanUTF8(s8.data() + start8, (int32_t)s8.length() - start8, spanCondition);
+                if (actual8 != expected8) {
+                    errln("set %d: frozen spanUTF8(%d, %d) %d != %d", (int)i, (int)start8, (int)spanCondition,
+                          (int)actual8, (int)expected8);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void UnicodeSetTest::TestStringSpanAutomaton() {
+    // Frozen sets with many strings match them with automata;
+    // thawed sets try each string in turn.
+    // Strings and text are made from few pieces so that there are many overlapping matches.
+    IcuTestErrorCode errorCode(*this, "TestStringSpanAutomaton");
+    static const char *const escapedPieces[] = {
+        "a", "b", "c", "\\u00e9", "\\U0001F600", "\\uD83D", "\\uDE00"
+    };
+    UnicodeString pieces[UPRV_LENGTHOF(escapedPieces)];
+    for (int32_t i = 0; i < UPRV_LENGTHOF(escapedPieces); ++i) {
+        pieces[i] = UnicodeString(escapedPieces[i], -1, US_INV).unescape();
+    }
+    static const char16_t *const codePoints[] = {
+        u"[ab]", u"[a\u00e9\U0001F600]", u"[]", u"[abc\u00e9]"
+    };
+    static const int32_t numStrings[] = { 8, 20, 60 };
+    uint32_t r = 1;
+    for (int32_t i = 0; i < UPRV_LENGTHOF(codePoints); ++i) {
+        for (int32_t j = 0; j < UPRV_LENGTHOF(numStrings); ++j) {
+            UnicodeSet thawed(UnicodeString(codePoints[i]), errorCode);
+            if (errorCode.logIfFailureAndReset("UnicodeSet(%d)", (int)i)) {
+                return;
+            }
+            UnicodeString strings[60];
+            int32_t count = 0;
+            while (count < numStrings[j]) {
+                UnicodeString &str = strings[count];
+                str.remove();
+                r = r * 1103515245 + 12345;
+                for (int32_t n = ((r >> 8) % 5) + 2; n > 0; --n) {
+                    r = r * 1103515245 + 12345;
+                    str.append(pieces[(r >> 16) % UPRV_LENGTHOF(pieces)]);
+                }
+                if (!thawed.contains(str)) {
+                    thawed.add(str);
+                    ++count;
+                }
+            }
+            UnicodeString s;
+            while (s.length() < 300) {
+                r = r * 1103515245 + 12345;
+                if ((r >> 12) % 4 == 0) {
+                    s.append(strings[(r >> 16) % count]);
+                } else {
+                    s.append(pieces[(r >> 16) % UPRV_LENGTHOF(pieces)]);
+                }
+            }
+            std::string s8;
+            s.toUTF8String(s8);
+            UnicodeSet frozen(thawed);
+            frozen.freeze();
+            UnicodeSet frozenCopy(frozen);  // copies the automata
+            const UChar *s16 = s.getBuffer();
+            int32_t length = s.length(), length8 = (int32_t)s8.length();
+            for (int32_t k = 0; k < 2; ++k) {
+                USetSpanCondition spanCondition = k == 0 ? USET_SPAN_CONTAINED : USET_SPAN_SIMPLE;
+                for (int32_t start = 0; start < length; ++start) {
+                    int32_t expected = thawed.span(s16 + start, length - start, spanCondition);
+                    int32_t actual = frozen.span(s16 + start, length - start, spanCondition);
+                    if (actual != expected) {
+                        errln("set %d/%d: frozen span(%d, %d) %d != %d", (int)i, (int)j,
+                              (int)start, (int)spanCondition, (int)actual, (int)expected);
+                        break;
+                    }
+                }
+                for (int32_t limit = length; limit > 0; --limit) {
+                    int32_t expected = thawed.spanBack(s16, limit, spanCondition);
+                    int32_t actual = frozenCopy.spanBack(s16, limit, spanCondition);
+                    if (actual != expected) {
+                        errln("set %d/%d: frozen spanBack(%d, %d) %d != %d", (int)i, (int)j,
+                              (int)limit, (int)spanCondition, (int)actual, (int)expected);
+                        break;
+                    }
+                }
+                for (int32_t start8 = 0; start8 < length8; ++start8) {
+                    int32_t expected8 = thawed.spanUTF8(s8.data() + start8, length8 - start8, spanCondition);
+                    int32_t actual8 = frozenCopy.spanUTF8(s8.data() + start8, length8 - start8, spanCondition);
+                    if (actual8 != expected8) {
+                        errln("set %d/%d: frozen spanUTF8(%d, %d) %d != %d", (int)i, (int)j,
+                              (int)start8, (int)spanCondition, (int)actual8, (int)expected8);
+                        break;
+                    }
+                }
+                for (int32_t limit8 = length8; limit8 > 0; --limit8) {
+                    int32_t expected8 = thawed.spanBackUTF8(s8.data(), limit8, spanCondition);
+                    int32_t actual8 = frozen.spanBackUTF8(s8.data(), limit8, spanCondition);
+                    if (actual8 != expected8) {
+                        errln("set %d/%d: frozen spanBackUTF8(%d, %d) %d != %d", (int)i, (int)j,
+                              (int)limit8, (int)spanCondition, (int)actual8, (int)expected8);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void UnicodeSetTest::TestSharedUnicodeSetCache() {
+    IcuTestErrorCode errorCode(*this, "TestSharedUnicodeSetCache");
+    UnicodeString pattern(u"[[:Lu:][:Nd:]-[a-z]]");
+    const SharedUnicodeSet *shared = NULL;
+    SharedUnicodeSet::getForPattern(pattern, shared, errorCode);
+    if (errorCode.logIfFailureAndReset("getForPattern()")) {
+        return;
+    }
+    const SharedUnicodeSet *shared2 = NULL;
+    SharedUnicodeSet::getForPattern(pattern, shared2, errorCode);
+    errorCode.logIfFailureAndReset("getForPattern() again");
+    assertTrue("getForPattern() returns the cached set", shared == shared2);
+    assertTrue("cached pattern set is frozen", (*shared)->isFrozen());
+    // Compare with the properties themselves, not with another parsed set:
+    // Parsing uses the same cache for [:Lu:] and [:Nd:].
+    for (UChar32 c = 0; c <= 0x10ffff; ++c) {
+        UBool expected = (U_GET_GC_MASK(c) & (U_GC_LU_MASK | U_GC_ND_MASK)) != 0 &&
+            !(0x61 <= c && c <= 0x7a);
+        if ((*shared)->contains(c) != expected) {
+            errln("cached pattern set contains(U+%04lX) != %d", (long)c, (int)expected);
+            break;
+        }
+    }
+    SharedObject::clearPtr(shared2);
+
+    // A bad pattern fails every time.
+    SharedUnicodeSet::getForPattern(UnicodeString(u"[:NoSuchProperty:]"), shared2, errorCode);
+    assertEquals("bad pattern", U_ILLEGAL_ARGUMENT_ERROR, errorCode.reset());
+    SharedUnicodeSet::getForPattern(UnicodeString(u"[:NoSuchProperty:]"), shared2, errorCode);
+    assertEquals("bad pattern again", U_ILLEGAL_ARGUMENT_ERROR, errorCode.reset());
+    assertTrue("no set for a bad pattern", shared2 == NULL);
+
+    static const struct {
+        UProperty prop;
+        int32_t value;
+    } props[] = {
+        { UCHAR_GENERAL_CATEGORY_MASK, U_GC_L_MASK },
+        { UCHAR_GENERAL_CATEGORY, U_DECIMAL_DIGIT_NUMBER },
+        { UCHAR_SCRIPT, USCRIPT_GREEK },
+        { UCHAR_SCRIPT_EXTENSIONS, USCRIPT_DEVANAGARI },
+        { UCHAR_WHITE_SPACE, 1 },
+        { UCHAR_LINE_BREAK, U_LB_COMPLEX_CONTEXT }
+    };
+    for (int32_t i = 0; i < UPRV_LENGTHOF(props); ++i) {
+        SharedUnicodeSet::getForIntPropertyValue(props[i].prop, props[i].value, shared2, errorCode);
+        if (errorCode.logIfFailureAndReset("getForIntPropertyValue(%d, %d)",
+                                           (int)props[i].prop, (int)props[i].value)) {
+            continue;
+        }
+        assertTrue("cached property set is frozen", (*shared2)->isFrozen());
+        for (UChar32 c = 0; c <= 0x10ffff; ++c) {
+            UBool expected;
+            if (props[i].prop == UCHAR_GENERAL_CATEGORY_MASK) {
+                expected = (U_GET_GC_MASK(c) & props[i].value) != 0;
+            } else if (props[i].prop == UCHAR_SCRIPT_EXTENSIONS) {
+                expected = uscript_hasScript(c, (UScriptCode)props[i].value);
+            } else {
+                expected = u_getIntPropertyValue(c, props[i].prop) == props[i].value;
+            }
+            if ((*shared2)->contains(c) != expected) {
+                errln("cached set for property %d value %d: contains(U+%04lX) != %d",
+                      (int)props[i].prop, (int)props[i].value, (long)c, (int)expected);
+                break;
+            }
+        }
+        UnicodeSet set;
+        set.applyIntPropertyValue(props[i].prop, props[i].value, errorCode);
+        errorCode.logIfFailureAndReset("applyIntPropertyValue()");
+        assertTrue("applyIntPropertyValue() == cached set", set == **shared2);
+        assertFalse("applyIntPropertyValue() leaves the set thawed", set.isFrozen());
+        set.add(0x10fffe).remove(0x20);  // still modifiable
+        assertTrue("modified copy contains U+10FFFE", set.contains(0x10fffe));
+        assertFalse("cached set is not modified", **shared2 == set);
+        SharedObject::clearPtr(shared2);
+    }
+    SharedObject::clearPtr(shared);
+}
@@ -94,6 +94,10 @@ private:
     void TestIntOverflow();
     void TestUnusedCcc();
     void TestDeepPattern();
+    void TestFrozenTrie();
+    void TestFrozenASCIISpan();
+    void TestStringSpanAutomaton();
+    void TestSharedUnicodeSetCache();
 
 private:
 
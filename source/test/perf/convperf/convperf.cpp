@@ -116,6 +116,19 @@ UPerfFunction* ConverterPerformanceTest::runIndexedTest(int32_t index, UBool exe
         TESTCASE(52,TestWinANSI_ISO2022JP_ToUnicode);
         TESTCASE(53,TestWinANSI_ISO2022JP_FromUnicode);
 
+        TESTCASE(54,TestICU_UTF8_ToUTF16_1Thread);
+        TESTCASE(55,TestICU_UTF8_ToUTF16_2Threads);
+        TESTCASE(56,TestICU_UTF8_ToUTF16_4Threads);
+        TESTCASE(57,TestICU_UTF8_ToUTF16_AllThreads);
+
+        TESTCASE(58,TestICU_SJIS_ToUTF8_1Thread);
+        TESTCASE(59,TestICU_SJIS_ToUTF8_AllThreads);
+
+        TESTCASE(60,TestICU_EBCDIC_Arabic_ToUTF8_1Thread);
+        TESTCASE(61,TestICU_EBCDIC_Arabic_ToUTF8_AllThreads);
+
+        TESTCASE(62,TestICU_ISO2022JP_Mail_ToUnicode);
+
         default: 
             name = ""; 
             return NULL;
@@ -657,3 +670,109 @@ UPerfFunction*  ConverterPerformanceTest::TestWinANSI_ISO2022JP_ToUnicode(){
     }
     return pf;
 }
+
+UPerfFunction* ConverterPerformanceTest::TestICU_UTF8_ToUTF16_1Thread(){
+    UErrorCode status = U_ZERO_ERROR;
+    UPerfFunction* pf = new ICUConvertParallelPerfFunction("utf-16le","utf-8",(char*)utf8_encSource, UPRV_LENGTHOF(utf8_encSource), 1, status);
+    if(U_FAILURE(status)){
+        return NULL;
+    }
+    return pf;
+}
+
+UPerfFunction* ConverterPerformanceTest::TestICU_UTF8_ToUTF16_2Threads(){
+    UErrorCode status = U_ZERO_ERROR;
+    UPerfFunction* pf = new ICUConvertParallelPerfFunction("utf-16le","utf-8",(char*)utf8_encSource, UPRV_LENGTHOF(utf8_encSource), 2, status);
+    if(U_FAILURE(status)){
+        return NULL;
+    }
+    return pf;
+}
+
+UPerfFunction* ConverterPerformanceTest::TestICU_UTF8_ToUTF16_4Threads(){
+    UErrorCode status = U_ZERO_ERROR;
+    UPerfFunction* pf = new ICUConvertParallelPerfFunction("utf-16le","utf-8",(char*)utf8_encSource, UPRV_LENGTHOF(utf8_encSource), 4, status);
+    if(U_FAILURE(status)){
+        return NULL;
+    }
+    return pf;
+}
+
+UPerfFunction* ConverterPerformanceTest::TestICU_UTF8_ToUTF16_AllThreads(){
+    UErrorCode status = U_ZERO_ERROR;
+    UPerfFunction* pf = new ICUConvertParallelPerfFunction("utf-16le","utf-8",(char*)utf8_encSource, UPRV_LENGTHOF(utf8_encSource), 0, status);
+    if(U_FAILURE(status)){
+        return NULL;
+    }
+    return pf;
+}
+
+UPerfFunction* ConverterPerformanceTest::TestICU_SJIS_ToUTF8_1Thread(){
+    UErrorCode status = U_ZERO_ERROR;
+    UPerfFunction* pf = new ICUConvertParallelPerfFunction("utf-8","sjis",(char*)sjis_encSource, UPRV_LENGTHOF(sjis_encSource), 1, status);
+    if(U_FAILURE(status)){
+        return NULL;
+    }
+    return pf;
+}
+
+UPerfFunction* ConverterPerformanceTest::TestICU_SJIS_ToUTF8_AllThreads(){
+    UErrorCode status = U_ZERO_ERROR;
+    UPerfFunction* pf = new ICUConvertParallelPerfFunction("utf-8","sjis",(char*)sjis_encSource, UPRV_LENGTHOF(sjis_encSource), 0, status);
+    if(U_FAILURE(status)){
+        return NULL;
+    }
+    return pf;
+}
+
+UPerfFunction* ConverterPerformanceTest::TestICU_EBCDIC_Arabic_ToUTF8_1Thread(){
+    UErrorCode status = U_ZERO_ERROR;
+    UPerfFunction* pf = new ICUConvertParallelPerfFunction("utf-8","x-EBCDIC-Arabic",(char*)ebcdic_arabic_encSource, UPRV_LENGTHOF(ebcdic_arabic_encSource), 1, status);
+    if(U_FAILURE(status)){
+        return NULL;
+    }
+    return pf;
+}
+
+UPerfFunction* ConverterPerformanceTest::TestICU_EBCDIC_Arabic_ToUTF8_AllThreads(){
+    UErrorCode status = U_ZERO_ERROR;
+    UPerfFunction* pf = new ICUConvertParallelPerfFunction("utf-8","x-EBCDIC-Arabic",(char*)ebcdic_arabic_encSource, UPRV_LENGTHOF(ebcdic_arabic_encSource), 0, status);
+    if(U_FAILURE(status)){
+        return NULL;
+    }
+    return pf;
+}
+
+/*
+ * A mail message: ASCII header lines followed by a body that switches
+ * between JIS X 0208 and ASCII on every line.
+ */
+static const char mailHeader[] =
+    "Received: from mail.example.co.jp (mail.example.co.jp [192.0.2.25])\r\n"
+    "\tby mx.example.com with ESMTP id 4A1B2C3D4E5F\r\n"
+    "Date: Mon, 02 Apr 2018 10:15:42 +0900\r\n"
+    "From: sender@example.co.jp\r\n"
+    "To: recipient@example.com\r\n"
+    "Message-ID: <20180402101542.12345@mail.example.co.jp>\r\n"
+    "MIME-Version: 1.0\r\n"
+    "Content-Type: text/plain; charset=ISO-2022-JP\r\n"
+    "Content-Transfer-Encoding: 7bit\r\n"
+    "\r\n";
+
+static char iso2022jp_mailSource[(sizeof(mailHeader) - 1 + sizeof(iso2022jp_encSource)) * 4];
+
+UPerfFunction* ConverterPerformanceTest::TestICU_ISO2022JP_Mail_ToUnicode(){
+    UErrorCode status = U_ZERO_ERROR;
+    int32_t length = 0;
+    for(int32_t i = 0; i < 4; ++i) {
+        uprv_memcpy(iso2022jp_mailSource + length, mailHeader, sizeof(mailHeader) - 1);
+        length += (int32_t)sizeof(mailHeader) - 1;
+        uprv_memcpy(iso2022jp_mailSource + length, iso2022jp_encSource, sizeof(iso2022jp_encSource));
+        length += (int32_t)sizeof(iso2022jp_encSource);
+    }
+    UPerfFunction* pf = new ICUToUnicodePerfFunction("iso-2022-jp", iso2022jp_mailSource, length, status);
+    if(U_FAILURE(status)){
+        return NULL;
+    }
+    return pf;
+}
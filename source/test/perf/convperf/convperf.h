@@ -149,6 +149,73 @@ public:
     }
 };
 
+/*
+ * Converts a long text made of copies of the sample text
+ * with ucnv_convertParallel(), to measure the scaling across cores.
+ * Use the same test with different numbers of threads and compare.
+ */
+class ICUConvertParallelPerfFunction : public UPerfFunction{
+private:
+    UConverter* targetConv;
+    UConverter* sourceConv;
+    char* src;
+    int32_t srcLen;
+    char* target;
+    int32_t targetCapacity;
+    int32_t numThreads;
+
+public:
+    ICUConvertParallelPerfFunction(const char* targetName, const char* sourceName,
+                                   const char* source, int32_t sourceLen,
+                                   int32_t threads, UErrorCode& status){
+        targetConv = ucnv_open(targetName, &status);
+        sourceConv = ucnv_open(sourceName, &status);
+        src = NULL;
+        target = NULL;
+        numThreads = threads;
+        if(U_FAILURE(status)){
+            return;
+        }
+        // about 16MB of input
+        int32_t copies = (16*1024*1024)/sourceLen + 1;
+        srcLen = copies*sourceLen;
+        src = (char*)malloc(srcLen);
+        if(src == NULL){
+            status = U_MEMORY_ALLOCATION_ERROR;
+            return;
+        }
+        for(int32_t i = 0; i < copies; ++i){
+            memcpy(src + i*sourceLen, source, sourceLen);
+        }
+        targetCapacity = ucnv_convertParallel(targetConv, sourceConv, NULL, 0,
+                                              src, srcLen, NULL, numThreads, &status);
+        if(status==U_BUFFER_OVERFLOW_ERROR) {
+            status=U_ZERO_ERROR;
+            target=(char*)malloc(targetCapacity);
+            if(target == NULL){
+                status = U_MEMORY_ALLOCATION_ERROR;
+                return;
+            }
+        }
+    }
+    virtual void call(UErrorCode* status){
+        ucnv_convertParallel(targetConv, sourceConv, target, targetCapacity,
+                             src, srcLen, NULL, numThreads, status);
+        if(*status==U_STRING_NOT_TERMINATED_WARNING) {
+            *status=U_ZERO_ERROR;
+        }
+    }
+    virtual long getOperationsPerIteration(void){
+        return srcLen;
+    }
+    ~ICUConvertParallelPerfFunction(){
+        free(target);
+        free(src);
+        ucnv_close(targetConv);
+        ucnv_close(sourceConv);
+    }
+};
+
 class WinANSIToUnicodePerfFunction : public UPerfFunction{
 
 private:
@@ -566,6 +633,16 @@ public:
     UPerfFunction* TestWinIML2_ISO2022JP_ToUnicode();
     UPerfFunction* TestWinIML2_ISO2022JP_FromUnicode(); 
 
+    UPerfFunction* TestICU_UTF8_ToUTF16_1Thread();
+    UPerfFunction* TestICU_UTF8_ToUTF16_2Threads();
+    UPerfFunction* TestICU_UTF8_ToUTF16_4Threads();
+    UPerfFunction* TestICU_UTF8_ToUTF16_AllThreads();
+    UPerfFunction* TestICU_SJIS_ToUTF8_1Thread();
+    UPerfFunction* TestICU_SJIS_ToUTF8_AllThreads();
+    UPerfFunction* TestICU_EBCDIC_Arabic_ToUTF8_1Thread();
+    UPerfFunction* TestICU_EBCDIC_Arabic_ToUTF8_AllThreads();
+    UPerfFunction* TestICU_ISO2022JP_Mail_ToUnicode();
+
 };
 
 #endif
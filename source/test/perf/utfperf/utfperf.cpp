@@ -21,7 +21,9 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "unicode/uperf.h"
+#include "unicode/ustring.h"
 #include "cmemory.h" // for UPRV_LENGTHOF
 #include "uoptions.h"
 
@@ -38,6 +40,7 @@ static UChar pivot[INTERMEDIATE_CAPACITY];
 
 static UChar output[OUTPUT_CAPACITY];
 static char intermediate[OUTPUT_CAPACITY];
+static UChar32 utf32[OUTPUT_CAPACITY];
 
 static int32_t utf8Length, encodedLength, outputLength, countInputCodePoints;
 
@@ -50,13 +53,15 @@ enum {
     CHARSET,
     CHUNK_LENGTH,
     PIVOT_LENGTH,
+    CORPUS,
     UTFPERF_OPTIONS_COUNT
 };
 
 static UOption options[UTFPERF_OPTIONS_COUNT]={
     UOPTION_DEF("charset",  '\x01', UOPT_REQUIRES_ARG),
     UOPTION_DEF("chunk",    '\x01', UOPT_REQUIRES_ARG),
-    UOPTION_DEF("pivot",    '\x01', UOPT_REQUIRES_ARG)
+    UOPTION_DEF("pivot",    '\x01', UOPT_REQUIRES_ARG),
+    UOPTION_DEF("corpus",   '\x01', UOPT_REQUIRES_ARG)
 };
 
 static const char *const utfperf_usage =
@@ -64,7 +69,27 @@ static const char *const utfperf_usage =
     "\t            Default: UTF-8\n"
     "\t--chunk     Length (in bytes) of charset output chunks. [4096]\n"
     "\t--pivot     Length (in UChars) of the UTF-16 pivot buffer, if applicable.\n"
-    "\t            [1024]\n";
+    "\t            [1024]\n"
+    "\t--corpus    Use generated text instead of a file:\n"
+    "\t            ascii, latin, cjk or emoji.\n";
+
+// Generated corpora, repeated to CORPUS_LENGTH UChars (unescaped with u_unescape()).
+#define CORPUS_LENGTH (200*1000)
+
+static const struct {
+    const char *name;
+    const char *text;
+} corpora[] = {
+    { "ascii", "The quick brown fox jumps over the lazy dog; 0123456789 times.\n" },
+    { "latin", "Gr\\u00F6\\u00DFere \\u00DCbungen f\\u00FCr \\u00C4pfel, caf\\u00E9 na\\u00EFve fa\\u00E7ade, "
+               "se\\u00F1or Ji\\u0159\\u00ED \\u0141\\u00F3d\\u017A.\n" },
+    { "cjk",   "\\u4ECA\\u65E5\\u306F\\u826F\\u3044\\u5929\\u6C17\\u3067\\u3059\\u3002"
+               "\\u6211\\u4EEC\\u53BB\\u516C\\u56ED\\u6563\\u6B65\\u5427\\uFF01"
+               "\\uD55C\\uAD6D\\uC5B4 \\u30C6\\u30AD\\u30B9\\u30C8 2018\\u5E74\\n" },
+    { "emoji", "\\U0001F600\\U0001F389 ok \\U0001F44D\\U0001F3FD\\u2764\\uFE0F "
+               "\\U0001F1E9\\U0001F1EA\\U0001F680\\U0001F4A9 \\U0001F468\\u200D\\U0001F4BB\\n" }
+};
+
 
 // Test object.
 class  UtfPerformanceTest : public UPerfTest{
@@ -86,8 +111,12 @@ public:
                 status = U_ILLEGAL_ARGUMENT_ERROR;
             }
 
-            int32_t inputLength;
-            UPerfTest::getBuffer(inputLength, status);
+            if (options[CORPUS].doesOccur) {
+                makeCorpus(options[CORPUS].value, status);
+            } else {
+                int32_t inputLength;
+                UPerfTest::getBuffer(inputLength, status);
+            }
             countInputCodePoints = u_countChar32(buffer, bufferLen);
             u_strToUTF8(utf8, (int32_t)sizeof(utf8), &utf8Length, buffer, bufferLen, &status);
         }
@@ -95,6 +124,30 @@ public:
 
     virtual UPerfFunction* runIndexedTest(int32_t index, UBool exec, const char* &name, char* par = NULL);
 
+    void makeCorpus(const char *name, UErrorCode &status) {
+        if (U_FAILURE(status)) {
+            return;
+        }
+        for (int32_t i = 0; i < UPRV_LENGTHOF(corpora); ++i) {
+            if (strcmp(name, corpora[i].name) == 0) {
+                UChar text[200];
+                int32_t textLength = u_unescape(corpora[i].text, text, UPRV_LENGTHOF(text));
+                buffer = (UChar *)uprv_malloc(U_SIZEOF_UCHAR * (CORPUS_LENGTH + 1));
+                if (buffer == NULL) {
+                    status = U_MEMORY_ALLOCATION_ERROR;
+                    return;
+                }
+                for (bufferLen = 0; (bufferLen + textLength) <= CORPUS_LENGTH; bufferLen += textLength) {
+                    u_memcpy(buffer + bufferLen, text, textLength);
+                }
+                buffer[bufferLen] = 0;
+                return;
+            }
+        }
+        fprintf(stderr, "error: unknown corpus \"%s\"\n", name);
+        status = U_ILLEGAL_ARGUMENT_ERROR;
+    }
+
     const UChar *getBuffer() const { return buffer; }
     int32_t getBufferLen() const { return bufferLen; }
 
@@ -328,11 +381,58 @@ protected:
     int32_t input8Length;
 };
 
+// Test the UTF-8 and UTF-32 string transformation functions (ustring.h),
+// which do not use a converter.
+class StrTransform : public UPerfFunction {
+public:
+    enum Kind { TO_UTF8, FROM_UTF8, TO_UTF32, FROM_UTF32 };
+
+    StrTransform(const UtfPerformanceTest &testcase, Kind kind)
+            : kind(kind), input(testcase.getBuffer()), inputLength(testcase.getBufferLen()),
+              utf32Length(0) {
+        UErrorCode errorCode = U_ZERO_ERROR;
+        u_strToUTF32(utf32, UPRV_LENGTHOF(utf32), &utf32Length, input, inputLength, &errorCode);
+    }
+    virtual void call(UErrorCode* pErrorCode){
+        int32_t length;
+        switch (kind) {
+        case TO_UTF8:
+            u_strToUTF8WithSub(intermediate, (int32_t)sizeof(intermediate), &length,
+                               input, inputLength, 0xfffd, NULL, pErrorCode);
+            break;
+        case FROM_UTF8:
+            u_strFromUTF8WithSub(output, UPRV_LENGTHOF(output), &length,
+                                 utf8, utf8Length, 0xfffd, NULL, pErrorCode);
+            break;
+        case TO_UTF32:
+            u_strToUTF32WithSub(utf32, UPRV_LENGTHOF(utf32), &length,
+                                input, inputLength, 0xfffd, NULL, pErrorCode);
+            break;
+        case FROM_UTF32:
+            u_strFromUTF32WithSub(output, UPRV_LENGTHOF(output), &length,
+                                  utf32, utf32Length, 0xfffd, NULL, pErrorCode);
+            break;
+        }
+    }
+    virtual long getOperationsPerIteration(){
+        return countInputCodePoints;
+    }
+
+    Kind kind;
+    const UChar *input;
+    int32_t inputLength;
+    int32_t utf32Length;
+};
+
 UPerfFunction* UtfPerformanceTest::runIndexedTest(int32_t index, UBool exec, const char* &name, char* par) {
     switch (index) {
         case 0: name = "Roundtrip";     if (exec) return Roundtrip::get(*this); break;
         case 1: name = "FromUnicode";   if (exec) return FromUnicode::get(*this); break;
         case 2: name = "FromUTF8";      if (exec) return FromUTF8::get(*this); break;
+        case 3: name = "StrToUTF8";     if (exec) return new StrTransform(*this, StrTransform::TO_UTF8); break;
+        case 4: name = "StrFromUTF8";   if (exec) return new StrTransform(*this, StrTransform::FROM_UTF8); break;
+        case 5: name = "StrToUTF32";    if (exec) return new StrTransform(*this, StrTransform::TO_UTF32); break;
+        case 6: name = "StrFromUTF32";  if (exec) return new StrTransform(*this, StrTransform::FROM_UTF32); break;
         default: name = ""; break;
     }
     return NULL;
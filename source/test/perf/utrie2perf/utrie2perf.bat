@@ -19,4 +19,10 @@ rem %PERF% CheckFCDAlwaysGet  -f \temp\udhr\%%f -v -e UTF-8 --passes 3 --iterati
 rem %PERF% CheckFCDUTF8       -f \temp\udhr\%%f -v -e UTF-8 --passes 3 --iterations 30000
     %PERF% ToNFC              -f \temp\udhr\%%f -v -e UTF-8 --passes 3 --iterations 30000
     %PERF% GetBiDiClass       -f \temp\udhr\%%f -v -e UTF-8 --passes 3 --iterations 30000
+    %PERF% UTrie2U16Next      -f \temp\udhr\%%f -v -e UTF-8 --passes 3 --iterations 30000
+    %PERF% UCPTrieFastU16Next -f \temp\udhr\%%f -v -e UTF-8 --passes 3 --iterations 30000
+    %PERF% UCPTrieFast8U16Next -f \temp\udhr\%%f -v -e UTF-8 --passes 3 --iterations 30000
+    %PERF% UCPTrieSmallGet    -f \temp\udhr\%%f -v -e UTF-8 --passes 3 --iterations 30000
+    %PERF% UTrie2U8Next       -f \temp\udhr\%%f -v -e UTF-8 --passes 3 --iterations 30000
+    %PERF% UCPTrieFastU8Next  -f \temp\udhr\%%f -v -e UTF-8 --passes 3 --iterations 30000
 )
@@ -15,7 +15,7 @@
  *  created on: 2008sep07
  *  created by: Markus W. Scherer
  *
- *  Performance test program for UTrie2.
+ *  Performance test program for UTrie2 and UCPTrie.
  */
 
 #include <stdio.h>
@@ -23,7 +23,11 @@
 #include "unicode/uchar.h"
 #include "unicode/unorm.h"
 #include "unicode/uperf.h"
+#include "unicode/utf8.h"
+#include "unicode/utf16.h"
+#include "ucptrie.h"
 #include "uoptions.h"
+#include "utrie2.h"
 
 #if 0
 // Left over from when icu/branches/markus/utf8 could use both old UTrie
@@ -48,7 +52,8 @@ class UTrie2PerfTest : public UPerfTest {
 public:
     UTrie2PerfTest(int32_t argc, const char *argv[], UErrorCode &status)
             : UPerfTest(argc, argv, NULL, 0, "", status),
-              utf8(NULL), utf8Length(0), countInputCodePoints(0) {
+              utf8(NULL), utf8Length(0), countInputCodePoints(0),
+              trie2(NULL), fastTrie(NULL), fastTrie8(NULL), smallTrie(NULL) {
         if (U_SUCCESS(status)) {
 #if 0       // See comment at unorm_initUTrie2() forward declaration.
             unorm_initUTrie2(&status);
@@ -78,9 +83,18 @@ public:
                            (double)utf8Length/countInputCodePoints);
                 }
             }
+            buildTries(status);
         }
     }
 
+    ~UTrie2PerfTest() {
+        free(utf8);
+        utrie2_close(trie2);
+        ucptrie_close(fastTrie);
+        ucptrie_close(fastTrie8);
+        ucptrie_close(smallTrie);
+    }
+
     virtual UPerfFunction* runIndexedTest(int32_t index, UBool exec, const char* &name, char* par = NULL);
 
     const UChar *getBuffer() const { return buffer; }
@@ -91,6 +105,54 @@ public:
 
     // Number of code points in the input text.
     int32_t countInputCodePoints;
+
+    // Tries with the same data, the Bidi_Class values of all code points,
+    // for comparing lookups in a UTrie2 with those in UCPTrie variants.
+    UTrie2 *trie2;
+    UCPTrie *fastTrie;
+    UCPTrie *fastTrie8;
+    UCPTrie *smallTrie;
+
+private:
+    void buildTries(UErrorCode &status) {
+        UMutableCPTrie *mutableTrie=umutablecptrie_open(0, 0, &status);
+        trie2=utrie2_open(0, 0, &status);
+        UChar32 start=0;
+        int32_t value=u_charDirection(0);
+        for(UChar32 c=1; c<=0x110000 && U_SUCCESS(status); ++c) {
+            int32_t nextValue= c<=0x10ffff ? u_charDirection(c) : -1;
+            if(nextValue!=value) {
+                if(value!=0) {
+                    utrie2_setRange32(trie2, start, c-1, value, TRUE, &status);
+                    umutablecptrie_setRange(mutableTrie, start, c-1, value, &status);
+                }
+                start=c;
+                value=nextValue;
+            }
+        }
+        utrie2_freeze(trie2, UTRIE2_16_VALUE_BITS, &status);
+        if(U_SUCCESS(status)) {
+            fastTrie=umutablecptrie_buildImmutable(mutableTrie, UCPTRIE_TYPE_FAST,
+                                                   UCPTRIE_VALUE_BITS_16, &status);
+            fastTrie8=umutablecptrie_buildImmutable(mutableTrie, UCPTRIE_TYPE_FAST,
+                                                    UCPTRIE_VALUE_BITS_8, &status);
+            smallTrie=umutablecptrie_buildImmutable(mutableTrie, UCPTRIE_TYPE_SMALL,
+                                                    UCPTRIE_VALUE_BITS_16, &status);
+        }
+        umutablecptrie_close(mutableTrie);
+        if(U_SUCCESS(status) && verbose) {
+            UErrorCode sizeStatus=U_ZERO_ERROR;
+            int32_t size2=utrie2_serialize(trie2, NULL, 0, &sizeStatus);
+            sizeStatus=U_ZERO_ERROR;
+            int32_t sizeFast=ucptrie_toBinary(fastTrie, NULL, 0, &sizeStatus);
+            sizeStatus=U_ZERO_ERROR;
+            int32_t sizeFast8=ucptrie_toBinary(fastTrie8, NULL, 0, &sizeStatus);
+            sizeStatus=U_ZERO_ERROR;
+            int32_t sizeSmall=ucptrie_toBinary(smallTrie, NULL, 0, &sizeStatus);
+            printf("Bidi_Class trie bytes: UTrie2:%ld  fast:%ld  fast8:%ld  small:%ld\n",
+                   (long)size2, (long)sizeFast, (long)sizeFast8, (long)sizeSmall);
+        }
+    }
 };
 
 // Performance test function object.
@@ -229,14 +291,167 @@ public:
     }
 };
 
+// Lookups of the Bidi_Class values in the test's own tries.
+// Each collects the bits for the values to keep the compiler from optimizing away the loop.
+class TrieCommand : public Command {
+protected:
+    TrieCommand(const UTrie2PerfTest &testcase) : Command(testcase), bits(0) {}
+
+    // Stores the bits so that the compiler cannot skip the lookups.
+    void checkBits(uint32_t bitSet) {
+        if(testcase.getBufferLen()>0 && bitSet==0) {
+            fprintf(stderr, "error: trie lookups did not collect bits\n");
+        }
+        bits=bitSet;
+    }
+
+    uint32_t bits;
+};
+
+class UTrie2U16Next : public TrieCommand {
+protected:
+    UTrie2U16Next(const UTrie2PerfTest &testcase) : TrieCommand(testcase) {}
+public:
+    static UPerfFunction* get(const UTrie2PerfTest &testcase) {
+        return new UTrie2U16Next(testcase);
+    }
+    virtual void call(UErrorCode* pErrorCode) {
+        const UTrie2 *trie=testcase.trie2;
+        const UChar *s=testcase.getBuffer();
+        const UChar *limit=s+testcase.getBufferLen();
+        UChar32 c;
+        uint16_t value;
+        uint32_t bitSet=0;
+        while(s<limit) {
+            UTRIE2_U16_NEXT16(trie, s, limit, c, value);
+            bitSet|=(uint32_t)1<<value;
+        }
+        checkBits(bitSet);
+    }
+};
+
+class UCPTrieFastU16Next : public TrieCommand {
+protected:
+    UCPTrieFastU16Next(const UTrie2PerfTest &testcase) : TrieCommand(testcase) {}
+public:
+    static UPerfFunction* get(const UTrie2PerfTest &testcase) {
+        return new UCPTrieFastU16Next(testcase);
+    }
+    virtual void call(UErrorCode* pErrorCode) {
+        const UCPTrie *trie=testcase.fastTrie;
+        const UChar *s=testcase.getBuffer();
+        const UChar *limit=s+testcase.getBufferLen();
+        UChar32 c;
+        uint16_t value;
+        uint32_t bitSet=0;
+        while(s<limit) {
+            UCPTRIE_FAST_U16_NEXT(trie, UCPTRIE_16, s, limit, c, value);
+            bitSet|=(uint32_t)1<<value;
+        }
+        checkBits(bitSet);
+    }
+};
+
+class UCPTrieFast8U16Next : public TrieCommand {
+protected:
+    UCPTrieFast8U16Next(const UTrie2PerfTest &testcase) : TrieCommand(testcase) {}
+public:
+    static UPerfFunction* get(const UTrie2PerfTest &testcase) {
+        return new UCPTrieFast8U16Next(testcase);
+    }
+    virtual void call(UErrorCode* pErrorCode) {
+        const UCPTrie *trie=testcase.fastTrie8;
+        const UChar *s=testcase.getBuffer();
+        const UChar *limit=s+testcase.getBufferLen();
+        UChar32 c;
+        uint8_t value;
+        uint32_t bitSet=0;
+        while(s<limit) {
+            UCPTRIE_FAST_U16_NEXT(trie, UCPTRIE_8, s, limit, c, value);
+            bitSet|=(uint32_t)1<<value;
+        }
+        checkBits(bitSet);
+    }
+};
+
+class UCPTrieSmallGet : public TrieCommand {
+protected:
+    UCPTrieSmallGet(const UTrie2PerfTest &testcase) : TrieCommand(testcase) {}
+public:
+    static UPerfFunction* get(const UTrie2PerfTest &testcase) {
+        return new UCPTrieSmallGet(testcase);
+    }
+    virtual void call(UErrorCode* pErrorCode) {
+        const UCPTrie *trie=testcase.smallTrie;
+        const UChar *s=testcase.getBuffer();
+        int32_t length=testcase.getBufferLen();
+        UChar32 c;
+        int32_t i;
+        uint32_t bitSet=0;
+        for(i=0; i<length;) {
+            U16_NEXT(s, i, length, c);
+            bitSet|=(uint32_t)1<<UCPTRIE_SMALL_GET(trie, UCPTRIE_16, c);
+        }
+        checkBits(bitSet);
+    }
+};
+
+class UTrie2U8Next : public TrieCommand {
+protected:
+    UTrie2U8Next(const UTrie2PerfTest &testcase) : TrieCommand(testcase) {}
+public:
+    static UPerfFunction* get(const UTrie2PerfTest &testcase) {
+        return new UTrie2U8Next(testcase);
+    }
+    virtual void call(UErrorCode* pErrorCode) {
+        const UTrie2 *trie=testcase.trie2;
+        const uint8_t *s=(const uint8_t *)testcase.utf8;
+        const uint8_t *limit=s+testcase.utf8Length;
+        uint16_t value;
+        uint32_t bitSet=0;
+        while(s<limit) {
+            UTRIE2_U8_NEXT16(trie, s, limit, value);
+            bitSet|=(uint32_t)1<<value;
+        }
+        checkBits(bitSet);
+    }
+};
+
+class UCPTrieFastU8Next : public TrieCommand {
+protected:
+    UCPTrieFastU8Next(const UTrie2PerfTest &testcase) : TrieCommand(testcase) {}
+public:
+    static UPerfFunction* get(const UTrie2PerfTest &testcase) {
+        return new UCPTrieFastU8Next(testcase);
+    }
+    virtual void call(UErrorCode* pErrorCode) {
+        const UCPTrie *trie=testcase.fastTrie;
+        const char *s=testcase.utf8;
+        const char *limit=s+testcase.utf8Length;
+        uint16_t value;
+        uint32_t bitSet=0;
+        while(s<limit) {
+            UCPTRIE_FAST_U8_NEXT(trie, UCPTRIE_16, s, limit, value);
+            bitSet|=(uint32_t)1<<value;
+        }
+        checkBits(bitSet);
+    }
+};
+
 UPerfFunction* UTrie2PerfTest::runIndexedTest(int32_t index, UBool exec, const char* &name, char* par) {
     switch (index) {
         case 0: name = "CheckFCD";              if (exec) return CheckFCD::get(*this); break;
         case 1: name = "ToNFC";                 if (exec) return ToNFC::get(*this); break;
         case 2: name = "GetBiDiClass";          if (exec) return GetBiDiClass::get(*this); break;
+        case 3: name = "UTrie2U16Next";         if (exec) return UTrie2U16Next::get(*this); break;
+        case 4: name = "UCPTrieFastU16Next";    if (exec) return UCPTrieFastU16Next::get(*this); break;
+        case 5: name = "UCPTrieFast8U16Next";   if (exec) return UCPTrieFast8U16Next::get(*this); break;
+        case 6: name = "UCPTrieSmallGet";       if (exec) return UCPTrieSmallGet::get(*this); break;
+        case 7: name = "UTrie2U8Next";          if (exec) return UTrie2U8Next::get(*this); break;
+        case 8: name = "UCPTrieFastU8Next";     if (exec) return UCPTrieFastU8Next::get(*this); break;
 #if 0  // See comment at unorm_initUTrie2() forward declaration.
-        case 3: name = "CheckFCDAlwaysGet";     if (exec) return CheckFCDAlwaysGet::get(*this); break;
-        case 4: name = "CheckFCDUTF8";          if (exec) return CheckFCDUTF8::get(*this); break;
+        case 9: name = "CheckFCDAlwaysGet";     if (exec) return CheckFCDAlwaysGet::get(*this); break;
+        case 10: name = "CheckFCDUTF8";         if (exec) return CheckFCDUTF8::get(*this); break;
 #endif
         default: name = ""; break;
     }
@@ -25,4 +25,10 @@ for file in udhr_eng.txt \
 # $PERF CheckFCDUTF8        -f ~/udhr/$file -v -e UTF-8 --passes 3 --iterations 30000
   $PERF ToNFC               -f ~/udhr/$file -v -e UTF-8 --passes 3 --iterations 30000
   $PERF GetBiDiClass        -f ~/udhr/$file -v -e UTF-8 --passes 3 --iterations 30000
+  $PERF UTrie2U16Next       -f ~/udhr/$file -v -e UTF-8 --passes 3 --iterations 30000
+  $PERF UCPTrieFastU16Next  -f ~/udhr/$file -v -e UTF-8 --passes 3 --iterations 30000
+  $PERF UCPTrieFast8U16Next -f ~/udhr/$file -v -e UTF-8 --passes 3 --iterations 30000
+  $PERF UCPTrieSmallGet     -f ~/udhr/$file -v -e UTF-8 --passes 3 --iterations 30000
+  $PERF UTrie2U8Next        -f ~/udhr/$file -v -e UTF-8 --passes 3 --iterations 30000
+  $PERF UCPTrieFastU8Next   -f ~/udhr/$file -v -e UTF-8 --passes 3 --iterations 30000
 done
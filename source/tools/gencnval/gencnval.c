@@ -35,6 +35,7 @@
 #include "unicode/uclean.h"
 #include "unewdata.h"
 #include "uoptions.h"
+#include "toolutil.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -86,7 +87,7 @@ static const UDataInfo dataInfo={
     0,
 
     {0x43, 0x76, 0x41, 0x6c},     /* dataFormat="CvAl" */
-    {3, 0, 1, 0},                 /* formatVersion */
+    {3, 1, 0, 0},                 /* formatVersion */
     {1, 4, 2, 0}                  /* dataVersion */
 };
 
@@ -151,6 +152,12 @@ static UConverterAliasOptions tableOptions = {
  */
 const char *path;
 
+/**
+ * .cnv files in the data build, from the command line
+ */
+static char **cnvFiles = NULL;
+static int32_t cnvFileCount = 0;
+
 /* prototypes --------------------------------------------------------------- */
 
 static void
@@ -242,8 +249,12 @@ main(int argc, char* argv[]) {
     }
     if(argc<0 || options[HELP1].doesOccur || options[HELP2].doesOccur) {
         fprintf(stderr,
-            "usage: %s [-options] [convrtrs.txt]\n"
+            "usage: %s [-options] [convrtrs.txt [files.cnv...]]\n"
             "\tread convrtrs.txt and create " U_ICUDATA_NAME "_" DATA_NAME "." DATA_TYPE "\n"
+            "\tThe optional .cnv file names list the converters that are built into\n"
+            "\tthe same data; ucnv_countAvailable() will not test-load those.\n"
+            "\tIf such files are later removed from the data, then the alias table\n"
+            "\tmust be rebuilt without them.\n"
             "options:\n"
             "\t-h or -? or --help  this usage text\n"
             "\t-v or --verbose     prints out extra information about the alias table\n"
@@ -265,6 +276,8 @@ main(int argc, char* argv[]) {
 
     if(argc>=2) {
         path=argv[1];
+        cnvFiles=argv+2;
+        cnvFileCount=argc-2;
     } else {
         path=options[SOURCEDIR].value;
         if(path!=NULL && *path!=0) {
@@ -976,6 +989,68 @@ createNormalizedAliasStrings(char *normalizedStrings, const char *origStringBloc
     }
 }
 
+/*
+ * Create the alias hash table (section 10, see ucnv_io.cpp) for the sorted
+ * unique aliases, with at most 50% of the buckets in use.
+ * Returns the number of buckets; the table has one more unit for that number.
+ */
+static uint32_t
+createAliasHashTable(uint16_t **pHashTable, const char *normalizedStrings,
+                     const uint16_t *uniqueAliases, uint32_t uniqueAliasesSize) {
+    uint32_t bucketCount = 4, mask, i, j, probes, maxProbes = 0;
+    uint16_t *hashTable;
+
+    while (bucketCount < 2 * uniqueAliasesSize) {
+        bucketCount <<= 1;
+    }
+    if (bucketCount > 0x8000) {
+        fprintf(stderr, "error: too many aliases (%u) for the alias hash table\n", (unsigned)uniqueAliasesSize);
+        exit(U_BUFFER_OVERFLOW_ERROR);
+    }
+    mask = bucketCount - 1;
+    hashTable = (uint16_t *)uprv_malloc((1 + bucketCount) * sizeof(uint16_t));
+    uprv_memset(hashTable, 0, (1 + bucketCount) * sizeof(uint16_t));
+    hashTable[0] = (uint16_t)bucketCount;
+
+    for (i = 0; i < uniqueAliasesSize; ++i) {
+        const char *name = normalizedStrings + 2 * (size_t)uniqueAliases[i];
+        j = ucnv_io_hashNormalizedName(name) & mask;
+        for (probes = 1; hashTable[1 + j] != 0; ++probes) {
+            j = (j + 1) & mask;
+        }
+        hashTable[1 + j] = (uint16_t)(i + 1);
+        if (probes > maxProbes) {
+            maxProbes = probes;
+        }
+    }
+    if (verbose) {
+        printf("alias hash table: %u aliases in %u buckets, at most %u probes\n",
+               (unsigned)uniqueAliasesSize, (unsigned)bucketCount, (unsigned)maxProbes);
+    }
+    *pHashTable = hashTable;
+    return bucketCount;
+}
+
+/*
+ * Returns TRUE if the converter's .cnv file was listed on the command line.
+ * Options in the converter name (after a comma) are ignored.
+ */
+static UBool
+isConverterFileBuiltIn(const char *converterName) {
+    int32_t nameLength, i;
+    const char *comma = uprv_strchr(converterName, UCNV_OPTION_SEP_CHAR);
+
+    nameLength = comma != NULL ? (int32_t)(comma - converterName) : (int32_t)uprv_strlen(converterName);
+    for (i = 0; i < cnvFileCount; ++i) {
+        const char *file = findBasename(cnvFiles[i]);
+        if (uprv_strncmp(file, converterName, nameLength) == 0 &&
+                uprv_strcmp(file + nameLength, ".cnv") == 0) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
 static void
 writeAliasTable(UNewDataMemory *out) {
     uint32_t i, j;
@@ -984,10 +1059,21 @@ writeAliasTable(UNewDataMemory *out) {
     uint16_t *aliasArrLists = (uint16_t *)uprv_malloc(tagCount * converterCount * sizeof(uint16_t));
     uint16_t *uniqueAliases = (uint16_t *)uprv_malloc(knownAliasesCount * sizeof(uint16_t));
     uint16_t *uniqueAliasesToConverter = (uint16_t *)uprv_malloc(knownAliasesCount * sizeof(uint16_t));
+    char *normalizedStrings = NULL;
+    uint16_t *aliasHashTable = NULL;
+    uint32_t aliasHashTableSize = 0;
 
     qsort(knownAliases, knownAliasesCount, sizeof(knownAliases[0]), compareAliases);
     uniqueAliasesSize = resolveAliases(uniqueAliases, uniqueAliasesToConverter, aliasOffset);
 
+    if (tableOptions.stringNormalizationType != UCNV_IO_UNNORMALIZED) {
+        normalizedStrings = (char *)uprv_malloc(tagBlock.top + stringBlock.top);
+        createNormalizedAliasStrings(normalizedStrings, tagBlock.store, tagBlock.top);
+        createNormalizedAliasStrings(normalizedStrings + tagBlock.top, stringBlock.store, stringBlock.top);
+        aliasHashTableSize = 1 + createAliasHashTable(&aliasHashTable, normalizedStrings,
+                                                      uniqueAliases, uniqueAliasesSize);
+    }
+
     /* Array index starts at 1. aliasLists[0] is the size of the lists section. */
     aliasListsSize = 0;
 
@@ -1003,7 +1089,7 @@ writeAliasTable(UNewDataMemory *out) {
         udata_write32(out, 8);
     }
     else {
-        udata_write32(out, 9);
+        udata_write32(out, 11);
     }
 
     /* Write the sizes of each section */
@@ -1018,6 +1104,8 @@ writeAliasTable(UNewDataMemory *out) {
     udata_write32(out, (tagBlock.top + stringBlock.top) / sizeof(uint16_t));
     if (tableOptions.stringNormalizationType != UCNV_IO_UNNORMALIZED) {
         udata_write32(out, (tagBlock.top + stringBlock.top) / sizeof(uint16_t));
+        udata_write32(out, aliasHashTableSize);
+        udata_write32(out, cnvFileCount > 0 ? converterCount : 0);
     }
 
     /* write the table of converters */
@@ -1063,15 +1151,33 @@ writeAliasTable(UNewDataMemory *out) {
 
     /* write the normalized aliases strings */
     if (tableOptions.stringNormalizationType != UCNV_IO_UNNORMALIZED) {
-        char *normalizedStrings = (char *)uprv_malloc(tagBlock.top + stringBlock.top);
-        createNormalizedAliasStrings(normalizedStrings, tagBlock.store, tagBlock.top);
-        createNormalizedAliasStrings(normalizedStrings + tagBlock.top, stringBlock.store, stringBlock.top);
-
         /* Write out the complete normalized array. */
         udata_writeString(out, normalizedStrings, tagBlock.top + stringBlock.top);
-        uprv_free(normalizedStrings);
+
+        /* write the hash table over the normalized aliases */
+        udata_writeBlock(out, aliasHashTable, aliasHashTableSize * sizeof(uint16_t));
+
+        /* write the converter flags */
+        if (cnvFileCount > 0) {
+            uint32_t builtInCount = 0;
+            for (i = 0; i < converterCount; ++i) {
+                if (isConverterFileBuiltIn(GET_ALIAS_STR(converters[i].converter))) {
+                    udata_write16(out, UCNV_IO_CNV_FILE_BUILT_IN);
+                    ++builtInCount;
+                } else {
+                    udata_write16(out, 0);
+                }
+            }
+            if (verbose) {
+                printf("%u of %u converters have built-in .cnv files\n",
+                       (unsigned)builtInCount, (unsigned)converterCount);
+            }
+        }
     }
 
+    uprv_free(aliasHashTable);
+    uprv_free(normalizedStrings);
+
     uprv_free(uniqueAliasesToConverter);
     uprv_free(uniqueAliases);
     uprv_free(aliasArrLists);